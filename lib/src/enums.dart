@@ -49,6 +49,32 @@ enum WebviewPopupWindowPolicy { allow, deny, sameWindow }
 // Order must match WebviewHostResourceAccessKind (see webview.h)
 enum WebviewHostResourceAccessKind { deny, allow, denyCors }
 
+/// How a [ResponseCacheRule] caches responses.
+///
+/// [headers] caches responses as far as their caching headers allow.
+/// [always] caches every successful response for the max age of the rule,
+/// whatever its headers say.
+/// [never] doesn't cache, to exclude URLs from a broader rule.
+// Order must match CachePolicy::Mode (see cache_policy.h)
+enum ResponseCacheMode { headers, always, never }
+
+/// How a [DevToolsEventCondition] compares the value at its path.
+///
+/// [contains] and [startsWith] only match strings, and [lessThan] and
+/// [greaterThan] only numbers. [notEquals] also matches events without a
+/// value at the path.
+// Order must match DevToolsEventFilter::Operator (see devtools_subscriptions.h)
+enum DevToolsEventOperator {
+  equals,
+  notEquals,
+  contains,
+  startsWith,
+  lessThan,
+  greaterThan,
+  exists,
+  notExists
+}
+
 enum WebErrorStatus {
   WebErrorStatusUnknown,
   WebErrorStatusCertificateCommonNameIsIncorrect,
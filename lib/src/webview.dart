@@ -1,5 +1,6 @@
 import 'dart:async';
 import 'dart:convert';
+import 'dart:typed_data';
 import 'dart:ui';
 
 import 'package:flutter/gestures.dart';
@@ -31,6 +32,115 @@ class WebviewDownloadEvent {
   );
 }
 
+/// A rule of the response cache for the URLs that match [urlPattern].
+///
+/// In [urlPattern], `*` matches any sequence of characters and `?` any
+/// single character. For [ResponseCacheMode.headers], [maxAge] is the
+/// lifetime of responses that don't specify one; for
+/// [ResponseCacheMode.always], the lifetime of all responses, one hour if
+/// omitted.
+class ResponseCacheRule {
+  final String urlPattern;
+  final ResponseCacheMode mode;
+  final Duration? maxAge;
+  const ResponseCacheRule(this.urlPattern,
+      {this.mode = ResponseCacheMode.headers, this.maxAge});
+}
+
+/// The number of rules a URL filter list was compiled to, and of the rules
+/// in it that are not supported and were skipped.
+class UrlFilterInfo {
+  final int ruleCount;
+  final int skippedRuleCount;
+  const UrlFilterInfo(this.ruleCount, this.skippedRuleCount);
+}
+
+/// A condition on the params of a DevTools protocol event, which is checked
+/// natively so that the events that don't meet it never reach Dart.
+///
+/// [path] lists member names and array indices separated by dots, such as
+/// `response.status`. [value] is null, a bool, a number or a string, and is
+/// ignored by [DevToolsEventOperator.exists] and
+/// [DevToolsEventOperator.notExists].
+class DevToolsEventCondition {
+  final String path;
+  final DevToolsEventOperator op;
+  final Object? value;
+  const DevToolsEventCondition(this.path, this.op, [this.value]);
+}
+
+/// What a page did between two samples of its DevTools protocol performance
+/// metrics. Values that are not available are null.
+///
+/// Times are in milliseconds and usages are shares of a CPU core. The memory
+/// values beyond the JavaScript heap are only available if memory is
+/// included, see [WebviewController.setPerformanceMetricsInterval].
+class PerformanceMetrics {
+  /// Page time between the samples.
+  final double? intervalMs;
+  final double? cpuUsage;
+  final double? mainThreadUsage;
+  final double? taskMs;
+  final double? scriptMs;
+  final double? layoutMs;
+  final double? recalcStyleMs;
+  final double? layoutCount;
+  final double? recalcStyleCount;
+  final double? layoutsPerSecond;
+  final double? recalcStylesPerSecond;
+  final double? jsHeapUsedBytes;
+  final double? jsHeapTotalBytes;
+  final double? jsHeapGrowthBytesPerSecond;
+  final double? nodes;
+  final double? documents;
+  final double? frames;
+  final double? jsEventListeners;
+  final double? layoutObjects;
+
+  /// Frames rendered by the page and published to the texture, and the
+  /// longest time between two rendered frames.
+  final double? renderedFramesPerSecond;
+  final double? publishedFramesPerSecond;
+  final double? longestFrameIntervalMs;
+  final double? embedderHeapUsedBytes;
+  final double? backingStorageBytes;
+
+  // Order must match PerformanceSampler::Field in
+  // windows/performance_sampler.h.
+  PerformanceMetrics._(List<double> values)
+      : intervalMs = _value(values, 0),
+        cpuUsage = _value(values, 1),
+        mainThreadUsage = _value(values, 2),
+        taskMs = _value(values, 3),
+        scriptMs = _value(values, 4),
+        layoutMs = _value(values, 5),
+        recalcStyleMs = _value(values, 6),
+        layoutCount = _value(values, 7),
+        recalcStyleCount = _value(values, 8),
+        layoutsPerSecond = _value(values, 9),
+        recalcStylesPerSecond = _value(values, 10),
+        jsHeapUsedBytes = _value(values, 11),
+        jsHeapTotalBytes = _value(values, 12),
+        jsHeapGrowthBytesPerSecond = _value(values, 13),
+        nodes = _value(values, 14),
+        documents = _value(values, 15),
+        frames = _value(values, 16),
+        jsEventListeners = _value(values, 17),
+        layoutObjects = _value(values, 18),
+        renderedFramesPerSecond = _value(values, 19),
+        publishedFramesPerSecond = _value(values, 20),
+        longestFrameIntervalMs = _value(values, 21),
+        embedderHeapUsedBytes = _value(values, 22),
+        backingStorageBytes = _value(values, 23);
+
+  static double? _value(List<double> values, int index) {
+    if (index >= values.length || values[index].isNaN) {
+      return null;
+    }
+    return values[index];
+  }
+}
+
 typedef PermissionRequestedDelegate
     = FutureOr<WebviewPermissionDecision> Function(
         String url, WebviewPermissionKind permissionKind, bool isUserInitiated);
@@ -55,6 +165,18 @@ PointerButton getButton(int value) {
 const String _pluginChannelPrefix = 'io.jns.webview.win';
 const MethodChannel _pluginChannel = MethodChannel(_pluginChannelPrefix);
 
+// Bits of the event subscription mask; must match WebviewEvents in
+// windows/webview.h.
+const int _kEventUrlChanged = 1 << 0;
+const int _kEventLoadingStateChanged = 1 << 1;
+const int _kEventLoadError = 1 << 2;
+const int _kEventHistoryChanged = 1 << 3;
+const int _kEventSecurityStateChanged = 1 << 4;
+const int _kEventTitleChanged = 1 << 5;
+const int _kEventWebMessageReceived = 1 << 6;
+const int _kEventContainsFullScreenElementChanged = 1 << 7;
+const int _kEventAll = (1 << 8) - 1;
+
 class WebviewValue {
   const WebviewValue({
     required this.isInitialized,
@@ -82,23 +204,134 @@ class WebviewController extends ValueNotifier<WebviewValue> {
   /// using  an optional [browserExePath], an optional [userDataPath]
   /// and optional Chromium command line arguments [additionalArguments].
   ///
-  /// The environment is shared between all WebviewController instances and
-  /// can be initialized only once. Initialization must take place before any
-  /// WebviewController is created/initialized.
+  /// The environment is shared between all WebviewController instances that
+  /// are initialized with the same [profile] and can be initialized only
+  /// once per profile. Initialization must take place before any
+  /// WebviewController of that profile is created/initialized.
+  /// Omitting [profile] initializes the default profile.
   ///
-  /// Throws [PlatformException] if the environment was initialized before.
+  /// Profiles with a different [userDataPath], [browserExePath] or
+  /// [additionalArguments] run in separate browser processes. Profiles with
+  /// equal settings share one environment.
+  ///
+  /// The environment is created without blocking the UI. The returned future
+  /// completes once it is ready. Calls to [initialize] made in the meantime
+  /// are queued until then.
+  ///
+  /// Throws [PlatformException] if the environment was initialized before or
+  /// is currently being initialized.
   static Future<void> initializeEnvironment(
       {String? userDataPath,
       String? browserExePath,
-      String? additionalArguments}) async {
+      String? additionalArguments,
+      String? profile}) async {
     return _pluginChannel
         .invokeMethod('initializeEnvironment', <String, dynamic>{
       'userDataPath': userDataPath,
       'browserExePath': browserExePath,
-      'additionalArguments': additionalArguments
+      'additionalArguments': additionalArguments,
+      'profile': profile
+    });
+  }
+
+  /// Sets how long an environment is kept alive after its last webview has
+  /// been disposed. Defaults to 60 seconds.
+  static Future<void> setEnvironmentGracePeriod(Duration gracePeriod) async {
+    return _pluginChannel.invokeMethod(
+        'setEnvironmentGracePeriod', gracePeriod.inMilliseconds);
+  }
+
+  /// Configures the pool of prewarmed webviews.
+  ///
+  /// The plugin keeps up to [size] idle webviews that [initialize] can hand
+  /// out immediately and refills the pool in the background. Idle webviews
+  /// that are not used within [idleTimeout] are released.
+  /// A [size] of 0 (the default) disables prewarming.
+  static Future<void> setPrewarmPoolOptions(
+      {int size = 0, Duration? idleTimeout}) async {
+    return _pluginChannel
+        .invokeMethod('setPrewarmPoolOptions', <String, dynamic>{
+      'size': size,
+      'idleTimeoutMs': idleTimeout?.inMilliseconds,
     });
   }
 
+  /// Limits the frames published by all webviews combined.
+  ///
+  /// [maxFps] and [maxCopyBytesPerSecond] are shared between webviews based
+  /// on their hints set with [setFrameSchedulingHints]. Both must be positive.
+  /// Pass [null] for both to remove the budget. Frames held back by the
+  /// budget are published as soon as the webview's share allows it.
+  static Future<void> setFrameBudget(
+      {int? maxFps, int? maxCopyBytesPerSecond}) async {
+    return _pluginChannel.invokeMethod('setFrameBudget', <String, dynamic>{
+      'maxFps': maxFps,
+      'maxCopyBytesPerSecond': maxCopyBytesPerSecond,
+    });
+  }
+
+  /// Configures when webviews are suspended automatically.
+  ///
+  /// Once more than [maxActiveWebviews] webviews are active or the processes
+  /// of all webviews together use more than [maxMemoryBytes], the least
+  /// recently used webviews are suspended. The memory usage is checked every
+  /// [memoryCheckInterval], which must be positive. Suspended webviews are
+  /// resumed as soon as they receive input or are navigated.
+  /// Pass [null] for both limits to disable automatic suspension.
+  static Future<void> setSuspendPolicy(
+      {int? maxActiveWebviews,
+      int? maxMemoryBytes,
+      Duration? memoryCheckInterval}) async {
+    return _pluginChannel.invokeMethod('setSuspendPolicy', <String, dynamic>{
+      'maxActiveWebviews': maxActiveWebviews,
+      'maxMemoryBytes': maxMemoryBytes,
+      'memoryCheckIntervalMs': memoryCheckInterval?.inMilliseconds,
+    });
+  }
+
+  /// Returns the native startup trace spans as Chrome trace event JSON.
+  ///
+  /// The result can be loaded into chrome://tracing or Perfetto. Setting the
+  /// `WEBVIEW_WINDOWS_TRACE_FILE` environment variable writes the same trace
+  /// to that file when the plugin is destroyed.
+  static Future<String> exportTrace() async {
+    return (await _pluginChannel.invokeMethod<String>('exportTrace'))!;
+  }
+
+  /// Returns a snapshot of the native flight recorder, which continuously
+  /// records frame, input and resize events of all webviews.
+  ///
+  /// The snapshot is in a compact binary format meant for offline decoding.
+  static Future<Uint8List> snapshotFlightRecorder() async {
+    return (await _pluginChannel
+        .invokeMethod<Uint8List>('snapshotFlightRecorder'))!;
+  }
+
+  /// Writes a flight recorder snapshot into [hitchSnapshotDirectory] whenever
+  /// a rendering hitch is detected. Pass [null] to stop writing snapshots.
+  static Future<void> setFlightRecorderOptions(
+      {String? hitchSnapshotDirectory}) async {
+    return _pluginChannel
+        .invokeMethod('setFlightRecorderOptions', <String, dynamic>{
+      'hitchSnapshotDirectory': hitchSnapshotDirectory,
+    });
+  }
+
+  /// Records every method call received by the native webviews into the file
+  /// at [path], replacing a recording in progress.
+  ///
+  /// The recording can be replayed offline with the `webview_windows_replay`
+  /// tool in `windows/bench` to reproduce and profile a session.
+  static Future<void> startMethodCallRecording(String path) async {
+    return _pluginChannel.invokeMethod('startMethodCallRecording', path);
+  }
+
+  /// Stops the recording started with [startMethodCallRecording] and writes
+  /// the remaining calls to its file.
+  static Future<void> stopMethodCallRecording() async {
+    return _pluginChannel.invokeMethod('stopMethodCallRecording');
+  }
+
   /// Get the browser version info including channel name if it is not the
   /// WebView2 Runtime.
   /// Returns [null] if the webview2 runtime is not installed.
@@ -109,6 +342,20 @@ class WebviewController extends ValueNotifier<WebviewValue> {
   late Completer<void> _creatingCompleter;
   int _textureId = 0;
   bool _isDisposed = false;
+  bool _nativeJsonDecoding = false;
+
+  // Event streams the native side produces events for. All of them start
+  // subscribed, so that single-subscription streams buffer the events fired
+  // before their first listener, and are only unsubscribed once their
+  // listeners cancel.
+  int _eventSubscriptions = _kEventAll;
+
+  Duration _performanceMetricsInterval = const Duration(seconds: 1);
+  bool _performanceMetricsIncludeMemory = false;
+
+  // Streams returned by devToolsProtocolEvents, by native subscription.
+  final Map<int, StreamController<Map<String, dynamic>>>
+      _devToolsEventStreamControllers = {};
 
   Future<void> get ready => _creatingCompleter.future;
 
@@ -118,20 +365,21 @@ class WebviewController extends ValueNotifier<WebviewValue> {
   late EventChannel _eventChannel;
   StreamSubscription? _eventStreamSubscription;
 
-  final StreamController<String> _urlStreamController =
-      StreamController<String>();
+  late final StreamController<String> _urlStreamController =
+      _createEventStreamController(_kEventUrlChanged);
 
   /// A stream reflecting the current URL.
   Stream<String> get url => _urlStreamController.stream;
 
-  final StreamController<LoadingState> _loadingStateStreamController =
-      StreamController<LoadingState>.broadcast();
+  late final StreamController<LoadingState> _loadingStateStreamController =
+      _createEventStreamController(_kEventLoadingStateChanged,
+          broadcast: true);
 
   final StreamController<WebviewDownloadEvent> _downloadEventStreamController =
       StreamController<WebviewDownloadEvent>.broadcast();
 
-  final StreamController<WebErrorStatus> _onLoadErrorStreamController =
-      StreamController<WebErrorStatus>();
+  late final StreamController<WebErrorStatus> _onLoadErrorStreamController =
+      _createEventStreamController(_kEventLoadError);
 
   /// A stream reflecting the current loading state.
   Stream<LoadingState> get loadingState => _loadingStateStreamController.stream;
@@ -142,22 +390,23 @@ class WebviewController extends ValueNotifier<WebviewValue> {
   /// A stream reflecting the navigation error when navigation completed with an error.
   Stream<WebErrorStatus> get onLoadError => _onLoadErrorStreamController.stream;
 
-  final StreamController<HistoryChanged> _historyChangedStreamController =
-      StreamController<HistoryChanged>();
+  late final StreamController<HistoryChanged>
+      _historyChangedStreamController =
+      _createEventStreamController(_kEventHistoryChanged);
 
   /// A stream reflecting the current history state.
   Stream<HistoryChanged> get historyChanged =>
       _historyChangedStreamController.stream;
 
-  final StreamController<String> _securityStateChangedStreamController =
-      StreamController<String>();
+  late final StreamController<String> _securityStateChangedStreamController =
+      _createEventStreamController(_kEventSecurityStateChanged);
 
   /// A stream reflecting the current security state.
   Stream<String> get securityStateChanged =>
       _securityStateChangedStreamController.stream;
 
-  final StreamController<String> _titleStreamController =
-      StreamController<String>();
+  late final StreamController<String> _titleStreamController =
+      _createEventStreamController(_kEventTitleChanged);
 
   /// A stream reflecting the current document title.
   Stream<String> get title => _titleStreamController.stream;
@@ -168,30 +417,47 @@ class WebviewController extends ValueNotifier<WebviewValue> {
   /// A stream reflecting the current cursor style.
   Stream<SystemMouseCursor> get _cursor => _cursorStreamController.stream;
 
-  final StreamController<dynamic> _webMessageStreamController =
-      StreamController<dynamic>();
+  late final StreamController<dynamic> _webMessageStreamController =
+      _createEventStreamController(_kEventWebMessageReceived);
 
   Stream<dynamic> get webMessage => _webMessageStreamController.stream;
 
-  final StreamController<bool>
+  late final StreamController<bool>
       _containsFullScreenElementChangedStreamController =
-      StreamController<bool>.broadcast();
+      _createEventStreamController(_kEventContainsFullScreenElementChanged,
+          broadcast: true);
 
   /// A stream reflecting whether the document currently contains full-screen elements.
   Stream<bool> get containsFullScreenElementChanged =>
       _containsFullScreenElementChangedStreamController.stream;
 
+  late final StreamController<PerformanceMetrics>
+      _performanceMetricsStreamController =
+      StreamController<PerformanceMetrics>.broadcast(
+          onListen: _updatePerformanceMetricsSampling,
+          onCancel: _updatePerformanceMetricsSampling);
+
+  /// A stream of the performance metrics of the page, sampled natively at
+  /// the interval set with [setPerformanceMetricsInterval] while the stream
+  /// has listeners.
+  Stream<PerformanceMetrics> get performanceMetrics =>
+      _performanceMetricsStreamController.stream;
+
   WebviewController() : super(WebviewValue.uninitialized());
 
   /// Initializes the underlying platform view.
-  Future<void> initialize() async {
+  ///
+  /// The webview is created in the environment of the given [profile] (see
+  /// [initializeEnvironment]) or of the default profile if omitted.
+  Future<void> initialize({String? profile}) async {
     if (_isDisposed) {
       return Future<void>.value();
     }
     _creatingCompleter = Completer<void>();
     try {
       final reply =
-          await _pluginChannel.invokeMapMethod<String, dynamic>('initialize');
+          await _pluginChannel.invokeMapMethod<String, dynamic>(
+              'initialize', <String, dynamic>{'profile': profile});
 
       _textureId = reply!['textureId'];
       _methodChannel = MethodChannel('$_pluginChannelPrefix/$_textureId');
@@ -237,7 +503,9 @@ class WebviewController extends ValueNotifier<WebviewValue> {
             break;
           case 'webMessageReceived':
             try {
-              final message = json.decode(map['value']);
+              final message = map['decoded'] == true
+                  ? map['value']
+                  : json.decode(map['value']);
               _webMessageStreamController.add(message);
             } catch (ex) {
               _webMessageStreamController.addError(ex);
@@ -246,6 +514,26 @@ class WebviewController extends ValueNotifier<WebviewValue> {
           case 'containsFullScreenElementChanged':
             _containsFullScreenElementChangedStreamController.add(map['value']);
             break;
+          case 'performanceMetrics':
+            _performanceMetricsStreamController
+                .add(PerformanceMetrics._(map['value'] as List<double>));
+            break;
+          case 'devToolsProtocolEvent':
+            final value = map['value'] as Map<dynamic, dynamic>;
+            final controller =
+                _devToolsEventStreamControllers[value['subscription']];
+            if (controller == null) {
+              break;
+            }
+            try {
+              final params = map['decoded'] == true
+                  ? value['params']
+                  : json.decode(value['params']);
+              controller.add((params as Map).cast<String, dynamic>());
+            } catch (ex) {
+              controller.addError(ex);
+            }
+            break;
         }
       });
 
@@ -259,6 +547,13 @@ class WebviewController extends ValueNotifier<WebviewValue> {
       });
 
       value = value.copyWith(isInitialized: true);
+      if (_eventSubscriptions != _kEventAll) {
+        _methodChannel.invokeMethod(
+            'setEventSubscriptions', _eventSubscriptions);
+      }
+      if (_performanceMetricsStreamController.hasListener) {
+        _updatePerformanceMetricsSampling();
+      }
       _creatingCompleter.complete();
     } on PlatformException catch (e) {
       _creatingCompleter.completeError(e);
@@ -267,6 +562,30 @@ class WebviewController extends ValueNotifier<WebviewValue> {
     return _creatingCompleter.future;
   }
 
+  /// Creates a controller for an event stream that tells the native side
+  /// once its listeners cancel, so that unused events aren't produced.
+  StreamController<T> _createEventStreamController<T>(int event,
+      {bool broadcast = false}) {
+    void onListen() => _setEventSubscribed(event, true);
+    void onCancel() => _setEventSubscribed(event, false);
+    return broadcast
+        ? StreamController<T>.broadcast(onListen: onListen, onCancel: onCancel)
+        : StreamController<T>(onListen: onListen, onCancel: onCancel);
+  }
+
+  void _setEventSubscribed(int event, bool subscribed) {
+    final subscriptions = subscribed
+        ? _eventSubscriptions | event
+        : _eventSubscriptions & ~event;
+    if (subscriptions == _eventSubscriptions) {
+      return;
+    }
+    _eventSubscriptions = subscriptions;
+    if (!_isDisposed && value.isInitialized) {
+      _methodChannel.invokeMethod('setEventSubscriptions', subscriptions);
+    }
+  }
+
   Future<bool?> _onPermissionRequested(Map<dynamic, dynamic> args) async {
     if (_permissionRequested == null) {
       return null;
@@ -397,11 +716,104 @@ class WebviewController extends ValueNotifier<WebviewValue> {
     }
     assert(value.isInitialized);
 
+    if (_nativeJsonDecoding) {
+      return _methodChannel.invokeMethod('executeScript', <String, dynamic>{
+        'script': script,
+        'decode': true,
+      });
+    }
+
     final data = await _methodChannel.invokeMethod('executeScript', script);
     if (data == null) return null;
     return jsonDecode(data as String);
   }
 
+  /// Calls the DevTools protocol [method] with [params] and returns its
+  /// result.
+  ///
+  /// Throws a [PlatformException] whose details are the protocol error if
+  /// the call fails.
+  ///
+  /// see https://chromedevtools.github.io/devtools-protocol/
+  Future<Map<String, dynamic>?> callDevToolsProtocolMethod(String method,
+      [Map<String, dynamic> params = const {}]) async {
+    if (_isDisposed) {
+      return null;
+    }
+    assert(value.isInitialized);
+    final args = <String, dynamic>{
+      'method': method,
+      'params': jsonEncode(params),
+      'decode': _nativeJsonDecoding,
+    };
+    if (_nativeJsonDecoding) {
+      return _methodChannel.invokeMapMethod<String, dynamic>(
+          'callDevToolsProtocolMethod', args);
+    }
+    final data = await _methodChannel.invokeMethod<String>(
+        'callDevToolsProtocolMethod', args);
+    if (data == null) return null;
+    return jsonDecode(data) as Map<String, dynamic>;
+  }
+
+  /// Returns a stream of the params of the DevTools protocol [event], such
+  /// as `Network.responseReceived`, that meet all the conditions in [where].
+  ///
+  /// Events are received while the stream has a listener, and the streams of
+  /// an event share one native receiver. The domain of the event usually
+  /// has to be enabled first, e.g. with
+  /// `callDevToolsProtocolMethod('Network.enable')`.
+  Stream<Map<String, dynamic>> devToolsProtocolEvents(String event,
+      {List<DevToolsEventCondition> where = const []}) {
+    final args = <String, dynamic>{
+      'event': event,
+      'filter': [
+        for (final condition in where)
+          <String, dynamic>{
+            'path': condition.path,
+            'op': condition.op.index,
+            'value': condition.value,
+          }
+      ],
+    };
+    int? subscription;
+    var cancelled = false;
+    late final StreamController<Map<String, dynamic>> controller;
+    controller = StreamController<Map<String, dynamic>>(onListen: () async {
+      if (_isDisposed) {
+        return;
+      }
+      assert(value.isInitialized);
+      try {
+        final id = await _methodChannel.invokeMethod<int>(
+            'subscribeDevToolsProtocolEvent', args);
+        if (cancelled) {
+          if (!_isDisposed) {
+            _methodChannel.invokeMethod('unsubscribeDevToolsProtocolEvent', id);
+          }
+          return;
+        }
+        subscription = id;
+        _devToolsEventStreamControllers[id!] = controller;
+      } on PlatformException catch (e) {
+        controller.addError(e);
+      }
+    }, onCancel: () {
+      cancelled = true;
+      final id = subscription;
+      if (id == null) {
+        return null;
+      }
+      _devToolsEventStreamControllers.remove(id);
+      if (_isDisposed) {
+        return null;
+      }
+      return _methodChannel.invokeMethod(
+          'unsubscribeDevToolsProtocolEvent', id);
+    });
+    return controller.stream;
+  }
+
   /// Posts the given JSON-formatted message to the current document.
   Future<void> postWebMessage(String message) async {
     if (_isDisposed) {
@@ -523,6 +935,33 @@ class WebviewController extends ValueNotifier<WebviewValue> {
         'setVirtualHostNameMapping', [hostName, folderPath, accessKind.index]);
   }
 
+  /// Serves [hostName] from the zip archive at [archivePath] instead of a
+  /// folder.
+  ///
+  /// The archive is memory-mapped and indexed once, which makes cold loads
+  /// of bundles with many files much cheaper than a folder mapping. Its
+  /// entries must be stored uncompressed (`zip -0`); compressed entries are
+  /// skipped. Precompressed variants stored as `<path>.br` or `<path>.gz`
+  /// are served to clients that accept them, and range and conditional
+  /// requests are supported.
+  ///
+  /// Requests for paths that aren't in the archive get [fallbackPath]
+  /// instead if it is set, e.g. `index.html` for single page apps.
+  /// Use [removeVirtualHostNameMapping] to remove the mapping.
+  Future<void> addVirtualHostNameArchiveMapping(
+      String hostName, String archivePath, {String? fallbackPath}) async {
+    if (_isDisposed) {
+      return;
+    }
+    assert(value.isInitialized);
+    return _methodChannel
+        .invokeMethod('setVirtualHostNameArchiveMapping', <String, dynamic>{
+      'hostName': hostName,
+      'path': archivePath,
+      'fallbackPath': fallbackPath,
+    });
+  }
+
   /// Removes a Virtual Host Name Mapping.
   ///
   /// Please refer to
@@ -535,6 +974,139 @@ class WebviewController extends ValueNotifier<WebviewValue> {
     return _methodChannel.invokeMethod('clearVirtualHostNameMapping', hostName);
   }
 
+  /// Answers requests that match [rules] from a native response cache in
+  /// [directory], and stores the responses to them.
+  ///
+  /// The first rule that matches a URL applies. The cache is kept across
+  /// sessions and shared by all webviews that use the same [directory].
+  /// Recently used responses are kept in memory, up to [maxMemoryBytes],
+  /// and the least recently used ones are removed from disk once it holds
+  /// more than [maxDiskBytes].
+  /// Pass an empty list of [rules] to stop using the cache.
+  Future<void> setResponseCache(String directory, List<ResponseCacheRule> rules,
+      {int? maxMemoryBytes, int? maxDiskBytes}) async {
+    if (_isDisposed) {
+      return;
+    }
+    assert(value.isInitialized);
+    return _methodChannel.invokeMethod('setResponseCache', <String, dynamic>{
+      'path': directory,
+      'rules': rules
+          .map((rule) => <String, dynamic>{
+                'urlPattern': rule.urlPattern,
+                'mode': rule.mode.index,
+                'maxAgeSeconds': rule.maxAge?.inSeconds,
+              })
+          .toList(),
+      'maxMemoryBytes': maxMemoryBytes,
+      'maxDiskBytes': maxDiskBytes,
+    });
+  }
+
+  /// Removes all responses from the cache set with [setResponseCache].
+  Future<void> clearResponseCache() async {
+    if (_isDisposed) {
+      return;
+    }
+    assert(value.isInitialized);
+    return _methodChannel.invokeMethod('clearResponseCache');
+  }
+
+  /// Blocks the requests that match [rules], a filter list in the syntax
+  /// of Adblock Plus that EasyList uses, with one rule per line.
+  ///
+  /// Supports blocked domains (`||example.com^`), patterns with anchors,
+  /// `*` and `^`, `@@` exceptions and the resource type, `third-party`,
+  /// `domain=` and `match-case` options. Element hiding rules, regular
+  /// expressions and rules with other options are skipped. Blocked requests
+  /// get an empty 403 response.
+  /// The list replaces the previous one; pass an empty string to stop
+  /// filtering.
+  Future<UrlFilterInfo?> setUrlFilter(String rules) async {
+    if (_isDisposed) {
+      return null;
+    }
+    assert(value.isInitialized);
+    final reply = await _methodChannel.invokeMapMethod<String, dynamic>(
+        'setUrlFilter', rules);
+    return UrlFilterInfo(reply!['ruleCount'], reply['skippedRuleCount']);
+  }
+
+  /// Returns the number of requests each rule of the filter set with
+  /// [setUrlFilter] has decided, for the rules that decided any: blocking
+  /// rules count the requests they blocked, and exceptions the requests
+  /// they let through.
+  ///
+  /// If [reset] is true, the counts start over from zero afterwards.
+  Future<Map<String, int>> getUrlFilterHits({bool reset = false}) async {
+    if (_isDisposed) {
+      return <String, int>{};
+    }
+    assert(value.isInitialized);
+    final hits = await _methodChannel.invokeMapMethod<String, int>(
+        'getUrlFilterHits', <String, dynamic>{'reset': reset});
+    return hits ?? <String, int>{};
+  }
+
+  /// Stores a native permission decision for [origin] and [permissionKind].
+  ///
+  /// Matching permission requests are answered natively without invoking the
+  /// [PermissionRequestedDelegate]. If [isUserInitiated] is omitted, the
+  /// decision applies to both user-initiated and other requests.
+  /// The decision expires after [ttl] or, if omitted, stays in effect until
+  /// it is removed with [clearPermissionDecisions].
+  Future<void> setPermissionDecision(String origin,
+      WebviewPermissionKind permissionKind, WebviewPermissionDecision decision,
+      {bool? isUserInitiated, Duration? ttl}) async {
+    if (_isDisposed) {
+      return;
+    }
+    assert(value.isInitialized);
+    assert(ttl == null || ttl.inMilliseconds > 0);
+    if (decision == WebviewPermissionDecision.none) {
+      return clearPermissionDecisions(
+          origin: origin, permissionKind: permissionKind);
+    }
+    return _methodChannel
+        .invokeMethod('setPermissionDecision', <String, dynamic>{
+      'origin': origin,
+      'permissionKind': permissionKind.index,
+      'isUserInitiated': isUserInitiated,
+      'allow': decision == WebviewPermissionDecision.allow,
+      'ttlMs': ttl?.inMilliseconds,
+    });
+  }
+
+  /// Removes native permission decisions matching [origin] and/or
+  /// [permissionKind]. Removes all decisions if neither is given.
+  Future<void> clearPermissionDecisions(
+      {String? origin, WebviewPermissionKind? permissionKind}) async {
+    if (_isDisposed) {
+      return;
+    }
+    assert(value.isInitialized);
+    return _methodChannel
+        .invokeMethod('clearPermissionDecisions', <String, dynamic>{
+      'origin': origin,
+      'permissionKind': permissionKind?.index,
+    });
+  }
+
+  /// Sets how long the answers of the [PermissionRequestedDelegate] are
+  /// stored natively. Requests for the same origin, kind and initiation are
+  /// then answered from the stored decision until it expires or is removed
+  /// with [clearPermissionDecisions]. If [ttl] is null, which is the
+  /// default, answers are not stored and the delegate is asked every time.
+  Future<void> setPermissionAnswerTtl(Duration? ttl) async {
+    if (_isDisposed) {
+      return;
+    }
+    assert(value.isInitialized);
+    assert(ttl == null || ttl.inMilliseconds > 0);
+    return _methodChannel.invokeMethod(
+        'setPermissionAnswerTtl', ttl?.inMilliseconds);
+  }
+
   /// Limits the number of frames per second to the given value.
   Future<void> setFpsLimit([int? maxFps = 0]) async {
     if (_isDisposed) {
@@ -544,15 +1116,115 @@ class WebviewController extends ValueNotifier<WebviewValue> {
     return _methodChannel.invokeMethod('setFpsLimit', maxFps);
   }
 
+  /// Sets the hints used to share the frame budget set with [setFrameBudget].
+  ///
+  /// Focused webviews get a larger share than unfocused ones, invisible
+  /// webviews get none. [priority] scales the share.
+  Future<void> setFrameSchedulingHints(
+      {bool focused = false,
+      bool visible = true,
+      double priority = 1.0}) async {
+    if (_isDisposed) {
+      return;
+    }
+    assert(value.isInitialized);
+    return _methodChannel.invokeMethod('setFrameSchedulingHints',
+        <String, dynamic>{
+      'focused': focused,
+      'visible': visible,
+      'priority': priority,
+    });
+  }
+
+  /// Sets whether [webMessage] payloads and [executeScript] results are decoded
+  /// from JSON natively instead of on the UI isolate.
+  ///
+  /// The decoded values are the same as those of [jsonDecode].
+  Future<void> setNativeJsonDecoding(bool enabled) async {
+    if (_isDisposed) {
+      return;
+    }
+    assert(value.isInitialized);
+    _nativeJsonDecoding = enabled;
+    return _methodChannel.invokeMethod('setNativeJsonDecoding', enabled);
+  }
+
+  /// Makes touches reach the page where they are predicted to be
+  /// [lookahead] from now, to hide input latency. [Duration.zero] turns
+  /// prediction off.
+  ///
+  /// Predictions are at most [maxDistance] logical pixels away from the
+  /// touch.
+  Future<void> setTouchPrediction(Duration lookahead,
+      {double maxDistance = 32}) async {
+    if (_isDisposed) {
+      return;
+    }
+    assert(value.isInitialized);
+    return _methodChannel.invokeMethod('setTouchPrediction', <String, dynamic>{
+      'lookaheadUs': lookahead.inMicroseconds,
+      'maxDistance': maxDistance,
+    });
+  }
+
+  /// Returns the number of state events that were dropped natively because
+  /// they repeated the last value sent, by event type (`urlChanged`,
+  /// `titleChanged`, `cursorChanged` and `historyChanged`).
+  Future<Map<String, int>> getSuppressedEventCounts() async {
+    if (_isDisposed) {
+      return <String, int>{};
+    }
+    assert(value.isInitialized);
+    final counts = await _methodChannel
+        .invokeMapMethod<String, int>('getSuppressedEventCounts');
+    return counts ?? <String, int>{};
+  }
+
+  /// Sets how often [performanceMetrics] are sampled, once per second by
+  /// default, and whether they include the memory used outside of the
+  /// JavaScript heap, which takes one more query per sample.
+  ///
+  /// Intervals are at least 100 milliseconds.
+  Future<void> setPerformanceMetricsInterval(Duration interval,
+      {bool includeMemory = false}) async {
+    assert(interval > Duration.zero);
+    _performanceMetricsInterval = interval;
+    _performanceMetricsIncludeMemory = includeMemory;
+    if (_performanceMetricsStreamController.hasListener) {
+      return _updatePerformanceMetricsSampling();
+    }
+  }
+
+  Future<void> _updatePerformanceMetricsSampling() async {
+    if (_isDisposed || !value.isInitialized) {
+      return;
+    }
+    return _methodChannel
+        .invokeMethod('setPerformanceMetricsSampling', <String, dynamic>{
+      'intervalMs': _performanceMetricsStreamController.hasListener
+          ? _performanceMetricsInterval.inMilliseconds
+          : 0,
+      'includeMemory': _performanceMetricsIncludeMemory,
+    });
+  }
+
   /// Sends a Pointer (Touch) update
   Future<void> _setPointerUpdate(WebviewPointerEventKind kind, int pointer,
-      Offset position, double size, double pressure) async {
+      Offset position, double size, double pressure,
+      Duration timeStamp) async {
     if (_isDisposed) {
       return;
     }
     assert(value.isInitialized);
-    return _methodChannel.invokeMethod('setPointerUpdate',
-        [pointer, kind.index, position.dx, position.dy, size, pressure]);
+    return _methodChannel.invokeMethod('setPointerUpdate', [
+      pointer,
+      kind.index,
+      position.dx,
+      position.dy,
+      size,
+      pressure,
+      timeStamp.inMicroseconds
+    ]);
   }
 
   /// Moves the virtual cursor to [position].
@@ -691,7 +1363,8 @@ class _WebviewState extends State<Webview> {
                             ev.pointer,
                             ev.localPosition,
                             ev.size,
-                            ev.pressure);
+                            ev.pressure,
+                            ev.timeStamp);
                         return;
                       }
                       final button = getButton(ev.buttons);
@@ -706,7 +1379,8 @@ class _WebviewState extends State<Webview> {
                             ev.pointer,
                             ev.localPosition,
                             ev.size,
-                            ev.pressure);
+                            ev.pressure,
+                            ev.timeStamp);
                         return;
                       }
                       final button = _downButtons.remove(ev.pointer);
@@ -729,7 +1403,8 @@ class _WebviewState extends State<Webview> {
                             ev.pointer,
                             ev.localPosition,
                             ev.size,
-                            ev.pressure);
+                            ev.pressure,
+                            ev.timeStamp);
                       } else {
                         _controller._setCursorPos(ev.localPosition);
                       }
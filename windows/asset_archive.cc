@@ -0,0 +1,220 @@
+#include "asset_archive.h"
+
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+
+namespace {
+constexpr uint32_t kEndOfCentralDirectorySignature = 0x06054b50;
+constexpr uint32_t kCentralDirectoryHeaderSignature = 0x02014b50;
+constexpr uint32_t kLocalFileHeaderSignature = 0x04034b50;
+constexpr size_t kEndOfCentralDirectorySize = 22;
+constexpr size_t kCentralDirectoryHeaderSize = 46;
+constexpr size_t kLocalFileHeaderSize = 30;
+constexpr size_t kMaxCommentSize = 0xffff;
+constexpr uint16_t kEncryptedFlag = 1;
+constexpr uint16_t kStoredMethod = 0;
+
+inline uint16_t ReadU16(const uint8_t* data) {
+  return static_cast<uint16_t>(data[0] | data[1] << 8);
+}
+
+inline uint32_t ReadU32(const uint8_t* data) {
+  return static_cast<uint32_t>(data[0]) |
+         static_cast<uint32_t>(data[1]) << 8 |
+         static_cast<uint32_t>(data[2]) << 16 |
+         static_cast<uint32_t>(data[3]) << 24;
+}
+}  // namespace
+
+std::shared_ptr<const AssetArchive> AssetArchive::Open(const std::string& path,
+                                                       std::string& error) {
+  std::shared_ptr<AssetArchive> archive(new AssetArchive());
+  archive->file_ = util::MappedFile::Open(path);
+  if (!archive->file_) {
+    error = "Failed to open " + path;
+    return nullptr;
+  }
+  if (!archive->ReadCentralDirectory(error)) {
+    return nullptr;
+  }
+
+  std::vector<std::string_view> paths;
+  paths.reserve(archive->records_.size());
+  for (const auto& record : archive->records_) {
+    paths.push_back(record.path);
+  }
+  auto index = util::PerfectHashIndex::Build(paths);
+  if (!index) {
+    error = "Failed to index " + path;
+    return nullptr;
+  }
+  archive->index_ = std::move(*index);
+
+  std::vector<Record> slots(archive->index_.slot_count());
+  for (uint32_t slot = 0; slot < slots.size(); ++slot) {
+    const auto position = archive->index_.key_at(slot);
+    if (position != util::PerfectHashIndex::kNotFound) {
+      slots[slot] = archive->records_[position];
+    }
+  }
+  archive->records_ = std::move(slots);
+  return archive;
+}
+
+std::shared_ptr<const AssetArchive> AssetArchive::OpenShared(
+    const std::string& path, std::string& error) {
+  static std::mutex mutex;
+  static std::map<std::string, std::weak_ptr<const AssetArchive>> archives;
+
+  const std::lock_guard<std::mutex> lock(mutex);
+  auto& shared_archive = archives[path];
+  if (auto archive = shared_archive.lock()) {
+    return archive;
+  }
+  auto archive = Open(path, error);
+  shared_archive = archive;
+  return archive;
+}
+
+std::optional<AssetArchive::Entry> AssetArchive::Find(
+    std::string_view path) const {
+  if (records_.empty() || path.empty()) {
+    return std::nullopt;
+  }
+  // Paths of free slots are empty, so their length never matches.
+  const auto& record = records_[index_.FindSlot(path)];
+  if (record.path.size() != path.size()) {
+    return std::nullopt;
+  }
+
+  // The data follows the local header, whose extra field may differ from
+  // the one in the central directory.
+  const uint8_t* data = file_->data();
+  const size_t size = file_->size();
+  if (size - record.local_header_offset < kLocalFileHeaderSize ||
+      ReadU32(data + record.local_header_offset) !=
+          kLocalFileHeaderSignature) {
+    return std::nullopt;
+  }
+  const uint8_t* local_header = data + record.local_header_offset;
+  const auto local_path_length = ReadU16(local_header + 26);
+  const size_t data_offset = size_t{record.local_header_offset} +
+                             kLocalFileHeaderSize + local_path_length +
+                             ReadU16(local_header + 28);
+  if (data_offset > size || size - data_offset < record.size) {
+    return std::nullopt;
+  }
+
+  // The path is compared with the copy in the local header, which shares
+  // cache lines with the data callers read next, and only compared with the
+  // central directory if the two copies differ.
+  const std::string_view local_path(
+      reinterpret_cast<const char*>(local_header + kLocalFileHeaderSize),
+      local_path_length);
+  if (local_path != path && record.path != path) {
+    return std::nullopt;
+  }
+  return Entry{record.path, data + data_offset, record.size, record.crc32};
+}
+
+bool AssetArchive::ReadCentralDirectory(std::string& error) {
+  const uint8_t* data = file_->data();
+  const size_t size = file_->size();
+  if (size < kEndOfCentralDirectorySize) {
+    error = "Not a zip archive";
+    return false;
+  }
+
+  // The end of central directory record is followed by a comment of up to
+  // 64 KiB.
+  const uint8_t* end_record = nullptr;
+  const size_t lowest = size - std::min(size, kEndOfCentralDirectorySize +
+                                                  kMaxCommentSize);
+  for (size_t offset = size - kEndOfCentralDirectorySize + 1;
+       offset-- > lowest;) {
+    if (ReadU32(data + offset) == kEndOfCentralDirectorySignature) {
+      end_record = data + offset;
+      break;
+    }
+  }
+  if (!end_record) {
+    error = "Not a zip archive";
+    return false;
+  }
+
+  const auto disk = ReadU16(end_record + 4);
+  const auto entry_count = ReadU16(end_record + 10);
+  const auto directory_size = ReadU32(end_record + 12);
+  const auto directory_offset = ReadU32(end_record + 16);
+  if (disk != 0) {
+    error = "Multi-volume zip archives are not supported";
+    return false;
+  }
+  if (entry_count == 0xffff || directory_offset == 0xffffffff) {
+    error = "ZIP64 archives are not supported";
+    return false;
+  }
+  if (directory_offset > size || directory_size > size - directory_offset) {
+    error = "The central directory is out of bounds";
+    return false;
+  }
+
+  // Later entries replace earlier ones with the same path, as in zip tools.
+  std::unordered_map<std::string_view, size_t> positions;
+  positions.reserve(entry_count);
+  records_.reserve(entry_count);
+  const uint8_t* header = data + directory_offset;
+  const uint8_t* const directory_end = header + directory_size;
+  for (uint32_t i = 0; i < entry_count; ++i) {
+    if (static_cast<size_t>(directory_end - header) <
+            kCentralDirectoryHeaderSize ||
+        ReadU32(header) != kCentralDirectoryHeaderSignature) {
+      error = "The central directory is corrupt";
+      return false;
+    }
+    const auto flags = ReadU16(header + 8);
+    const auto method = ReadU16(header + 10);
+    const auto crc32 = ReadU32(header + 16);
+    const auto compressed_size = ReadU32(header + 20);
+    const auto uncompressed_size = ReadU32(header + 24);
+    const auto name_length = ReadU16(header + 28);
+    const auto extra_length = ReadU16(header + 30);
+    const auto comment_length = ReadU16(header + 32);
+    const auto local_header_offset = ReadU32(header + 42);
+    const size_t header_size = kCentralDirectoryHeaderSize + name_length +
+                               extra_length + comment_length;
+    if (static_cast<size_t>(directory_end - header) < header_size) {
+      error = "The central directory is corrupt";
+      return false;
+    }
+    const std::string_view path(
+        reinterpret_cast<const char*>(header + kCentralDirectoryHeaderSize),
+        name_length);
+    header += header_size;
+
+    if (path.empty() || path.back() == '/') {
+      continue;
+    }
+    if ((flags & kEncryptedFlag) || method != kStoredMethod ||
+        compressed_size != uncompressed_size ||
+        compressed_size == 0xffffffff) {
+      ++skipped_count_;
+      continue;
+    }
+
+    if (local_header_offset > size) {
+      error = "The local header of " + std::string(path) + " is out of bounds";
+      return false;
+    }
+    const Record record{path, local_header_offset, compressed_size, crc32};
+    const auto [it, inserted] = positions.emplace(path, records_.size());
+    if (inserted) {
+      records_.push_back(record);
+    } else {
+      records_[it->second] = record;
+    }
+  }
+  return true;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "util/mapped_file.h"
+#include "util/perfect_hash.h"
+
+// Web assets packed into a single file that is memory-mapped, so that a
+// bundle of many small files costs one open instead of one per file.
+//
+// The file is a zip archive whose entries are stored without compression,
+// e.g. made with `zip -0 -r`. Precompressed variants of an asset can be
+// stored next to it as "<path>.br" or "<path>.gz". Compressed, encrypted and
+// ZIP64 entries are skipped.
+//
+// Opening reads only the central directory, and paths are looked up through
+// a perfect hash index built on open.
+class AssetArchive {
+ public:
+  struct Entry {
+    // Relative to the root of the archive, e.g. "assets/main.js".
+    std::string_view path;
+    const uint8_t* data;
+    size_t size;
+    uint32_t crc32;
+  };
+
+  // Opens the archive at |path|. Returns nullptr and sets |error| if it
+  // can't be read.
+  static std::shared_ptr<const AssetArchive> Open(const std::string& path,
+                                                  std::string& error);
+
+  // Like Open, but shares the archive with the other callers that have
+  // opened |path| and still hold it.
+  static std::shared_ptr<const AssetArchive> OpenShared(
+      const std::string& path, std::string& error);
+
+  // Returns the entry at |path|, or std::nullopt if there is none or its
+  // data is out of bounds.
+  std::optional<Entry> Find(std::string_view path) const;
+
+  size_t size() const { return index_.size(); }
+  // Number of entries that can't be served, e.g. compressed ones.
+  size_t skipped_count() const { return skipped_count_; }
+
+ private:
+  // An entry of the central directory. The data is found through the local
+  // header on lookup, so that opening doesn't touch every local header.
+  struct Record {
+    std::string_view path;
+    uint32_t local_header_offset = 0;
+    uint32_t size = 0;
+    uint32_t crc32 = 0;
+  };
+
+  std::unique_ptr<util::MappedFile> file_;
+  // In the order of the index's slots once opened, so that a lookup reads
+  // the record its path hashes to directly. Free slots have empty paths.
+  std::vector<Record> records_;
+  util::PerfectHashIndex index_;
+  size_t skipped_count_ = 0;
+
+  AssetArchive() = default;
+
+  bool ReadCentralDirectory(std::string& error);
+};
@@ -0,0 +1,409 @@
+#include "asset_server.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "util/http_headers.h"
+
+using util::AddHeader;
+using util::EqualsIgnoreCase;
+using util::ParseNumber;
+using util::Trim;
+
+namespace {
+constexpr char kIndexDocument[] = "index.html";
+
+struct ContentType {
+  const char* extension;
+  const char* type;
+};
+
+constexpr ContentType kContentTypes[] = {
+    {"html", "text/html; charset=utf-8"},
+    {"htm", "text/html; charset=utf-8"},
+    {"js", "text/javascript; charset=utf-8"},
+    {"mjs", "text/javascript; charset=utf-8"},
+    {"css", "text/css; charset=utf-8"},
+    {"json", "application/json"},
+    {"map", "application/json"},
+    {"txt", "text/plain; charset=utf-8"},
+    {"xml", "application/xml"},
+    {"wasm", "application/wasm"},
+    {"svg", "image/svg+xml"},
+    {"png", "image/png"},
+    {"jpg", "image/jpeg"},
+    {"jpeg", "image/jpeg"},
+    {"gif", "image/gif"},
+    {"webp", "image/webp"},
+    {"avif", "image/avif"},
+    {"ico", "image/x-icon"},
+    {"woff", "font/woff"},
+    {"woff2", "font/woff2"},
+    {"ttf", "font/ttf"},
+    {"otf", "font/otf"},
+    {"mp3", "audio/mpeg"},
+    {"wav", "audio/wav"},
+    {"ogg", "audio/ogg"},
+    {"mp4", "video/mp4"},
+    {"webm", "video/webm"},
+    {"pdf", "application/pdf"},
+};
+constexpr char kDefaultContentType[] = "application/octet-stream";
+
+// Precompressed variants by preference.
+struct Variant {
+  const char* coding;
+  const char* suffix;
+};
+
+constexpr Variant kVariants[] = {{"br", ".br"}, {"gzip", ".gz"}};
+
+inline char ToLower(char c) {
+  return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+// Splits |uri| into its host, without user info and port, and its path,
+// without query and fragment.
+bool SplitUri(std::string_view uri, std::string_view& host,
+              std::string_view& path) {
+  const auto scheme_end = uri.find("://");
+  if (scheme_end == std::string_view::npos) {
+    return false;
+  }
+  const auto rest = uri.substr(scheme_end + 3);
+  const auto path_start = rest.find_first_of("/?#");
+  auto authority = rest.substr(0, path_start);
+  const auto user_info_end = authority.rfind('@');
+  if (user_info_end != std::string_view::npos) {
+    authority.remove_prefix(user_info_end + 1);
+  }
+  const auto port_start = authority.rfind(':');
+  if (port_start != std::string_view::npos &&
+      authority.find(']', port_start) == std::string_view::npos) {
+    authority = authority.substr(0, port_start);
+  }
+  host = authority;
+
+  path = path_start == std::string_view::npos ? std::string_view()
+                                              : rest.substr(path_start);
+  path = path.substr(0, path.find_first_of("?#"));
+  return true;
+}
+
+int HexValue(char c) {
+  if (c >= '0' && c <= '9') {
+    return c - '0';
+  }
+  c = ToLower(c);
+  if (c >= 'a' && c <= 'f') {
+    return c - 'a' + 10;
+  }
+  return -1;
+}
+
+// Returns the archive path of a URI path: percent-decoded, without the
+// leading slash, and with the index document appended to directories.
+std::optional<std::string> GetArchivePath(std::string_view uri_path) {
+  while (!uri_path.empty() && uri_path.front() == '/') {
+    uri_path.remove_prefix(1);
+  }
+  std::string path;
+  path.reserve(uri_path.size() + sizeof(kIndexDocument));
+  for (size_t i = 0; i < uri_path.size(); ++i) {
+    if (uri_path[i] != '%') {
+      path.push_back(uri_path[i]);
+      continue;
+    }
+    if (i + 2 >= uri_path.size()) {
+      return std::nullopt;
+    }
+    const auto high = HexValue(uri_path[i + 1]);
+    const auto low = HexValue(uri_path[i + 2]);
+    if (high < 0 || low < 0) {
+      return std::nullopt;
+    }
+    path.push_back(static_cast<char>(high << 4 | low));
+    i += 2;
+  }
+  if (path.empty() || path.back() == '/') {
+    path += kIndexDocument;
+  }
+  return path;
+}
+
+const char* GetContentType(std::string_view path) {
+  const auto dot = path.rfind('.');
+  if (dot == std::string_view::npos ||
+      path.find('/', dot) != std::string_view::npos) {
+    return kDefaultContentType;
+  }
+  const auto extension = path.substr(dot + 1);
+  for (const auto& content_type : kContentTypes) {
+    if (EqualsIgnoreCase(extension, content_type.extension)) {
+      return content_type.type;
+    }
+  }
+  return kDefaultContentType;
+}
+
+// Whether an Accept-Encoding header accepts |coding|, i.e. lists it without
+// "q=0".
+bool AcceptsEncoding(std::string_view accept_encoding,
+                     std::string_view coding) {
+  while (!accept_encoding.empty()) {
+    const auto comma = accept_encoding.find(',');
+    auto element = accept_encoding.substr(0, comma);
+    accept_encoding = comma == std::string_view::npos
+                          ? std::string_view()
+                          : accept_encoding.substr(comma + 1);
+
+    const auto semicolon = element.find(';');
+    if (!EqualsIgnoreCase(Trim(element.substr(0, semicolon)), coding)) {
+      continue;
+    }
+    if (semicolon == std::string_view::npos) {
+      return true;
+    }
+    const auto parameter = Trim(element.substr(semicolon + 1));
+    if (parameter.size() < 2 || ToLower(parameter[0]) != 'q' ||
+        parameter[1] != '=') {
+      return true;
+    }
+    // Any non-zero digit makes the weight positive.
+    return parameter.substr(2).find_first_of("123456789") !=
+           std::string_view::npos;
+  }
+  return false;
+}
+
+enum class RangeResult { kIgnored, kSatisfiable, kUnsatisfiable };
+
+// Parses a Range header of a single byte range against a body of |size|
+// bytes. Ranges that can't be parsed, or multiple ranges, are ignored, which
+// makes the whole body get served.
+RangeResult ParseRange(std::string_view header, size_t size, size_t& first,
+                       size_t& last) {
+  constexpr std::string_view kUnit = "bytes=";
+  header = Trim(header);
+  if (header.size() < kUnit.size() ||
+      !EqualsIgnoreCase(header.substr(0, kUnit.size()), kUnit)) {
+    return RangeResult::kIgnored;
+  }
+  const auto range = Trim(header.substr(kUnit.size()));
+  const auto dash = range.find('-');
+  if (dash == std::string_view::npos ||
+      range.find(',') != std::string_view::npos) {
+    return RangeResult::kIgnored;
+  }
+
+  uint64_t start = 0;
+  uint64_t end = 0;
+  const auto start_text = Trim(range.substr(0, dash));
+  const auto end_text = Trim(range.substr(dash + 1));
+  if (start_text.empty()) {
+    // The last |end| bytes.
+    if (!ParseNumber(end_text, end)) {
+      return RangeResult::kIgnored;
+    }
+    if (end == 0 || size == 0) {
+      return RangeResult::kUnsatisfiable;
+    }
+    first = size - static_cast<size_t>(std::min<uint64_t>(end, size));
+    last = size - 1;
+    return RangeResult::kSatisfiable;
+  }
+
+  if (!ParseNumber(start_text, start) ||
+      (!end_text.empty() && !ParseNumber(end_text, end))) {
+    return RangeResult::kIgnored;
+  }
+  if (end_text.empty()) {
+    end = UINT64_MAX;
+  } else if (end < start) {
+    return RangeResult::kIgnored;
+  }
+  if (start >= size) {
+    return RangeResult::kUnsatisfiable;
+  }
+  first = static_cast<size_t>(start);
+  last = static_cast<size_t>(std::min<uint64_t>(end, size - 1));
+  return RangeResult::kSatisfiable;
+}
+
+std::string ToHex(uint64_t value) {
+  constexpr char kDigits[] = "0123456789abcdef";
+  char buffer[16];
+  size_t length = 0;
+  do {
+    buffer[sizeof(buffer) - ++length] = kDigits[value & 0xf];
+    value >>= 4;
+  } while (value);
+  return std::string(buffer + sizeof(buffer) - length, length);
+}
+
+std::string GetETag(const AssetArchive::Entry& entry) {
+  return "\"" + ToHex(entry.crc32) + "-" + ToHex(entry.size) + "\"";
+}
+
+// Whether an If-None-Match header lists |etag|, weakly compared.
+bool MatchesETag(std::string_view if_none_match, std::string_view etag) {
+  while (!if_none_match.empty()) {
+    const auto comma = if_none_match.find(',');
+    auto element = Trim(if_none_match.substr(0, comma));
+    if_none_match = comma == std::string_view::npos
+                        ? std::string_view()
+                        : if_none_match.substr(comma + 1);
+    if (element.substr(0, 2) == "W/") {
+      element.remove_prefix(2);
+    }
+    if (element == "*" || element == etag) {
+      return true;
+    }
+  }
+  return false;
+}
+
+AssetServer::Response MakeResponse(int status, std::string_view reason) {
+  AssetServer::Response response;
+  response.status = status;
+  response.reason = reason;
+  return response;
+}
+}  // namespace
+
+void AssetServer::SetMapping(std::string_view host_name,
+                             std::shared_ptr<const AssetArchive> archive,
+                             std::string fallback_path) {
+  ClearMapping(host_name);
+  mappings_.push_back(
+      {std::string(host_name), std::move(archive), std::move(fallback_path)});
+}
+
+bool AssetServer::ClearMapping(std::string_view host_name) {
+  const auto it =
+      std::find_if(mappings_.begin(), mappings_.end(),
+                   [host_name](const Mapping& mapping) {
+                     return EqualsIgnoreCase(mapping.host_name, host_name);
+                   });
+  if (it == mappings_.end()) {
+    return false;
+  }
+  mappings_.erase(it);
+  return true;
+}
+
+const AssetServer::Mapping* AssetServer::FindMapping(
+    std::string_view host_name) const {
+  for (const auto& mapping : mappings_) {
+    if (EqualsIgnoreCase(mapping.host_name, host_name)) {
+      return &mapping;
+    }
+  }
+  return nullptr;
+}
+
+std::optional<AssetServer::Response> AssetServer::Handle(
+    const Request& request) const {
+  std::string_view host;
+  std::string_view uri_path;
+  if (!SplitUri(request.uri, host, uri_path)) {
+    return std::nullopt;
+  }
+  const auto mapping = FindMapping(host);
+  if (!mapping) {
+    return std::nullopt;
+  }
+
+  const bool head = request.method == "HEAD";
+  if (!head && request.method != "GET") {
+    auto response = MakeResponse(405, "Method Not Allowed");
+    AddHeader(response.headers, "Allow", "GET, HEAD");
+    return response;
+  }
+
+  const auto path = GetArchivePath(uri_path);
+  if (!path) {
+    return MakeResponse(400, "Bad Request");
+  }
+  const auto& archive = *mapping->archive;
+  auto entry = archive.Find(*path);
+  if (!entry && !mapping->fallback_path.empty()) {
+    entry = archive.Find(mapping->fallback_path);
+  }
+  if (!entry) {
+    return MakeResponse(404, "Not Found");
+  }
+
+  // Byte ranges refer to the identity encoding, so range requests never get
+  // a precompressed variant.
+  auto representation = *entry;
+  const char* content_coding = nullptr;
+  bool has_variants = false;
+  std::string variant_path;
+  for (const auto& variant : kVariants) {
+    variant_path.assign(entry->path);
+    variant_path += variant.suffix;
+    const auto variant_entry = archive.Find(variant_path);
+    if (!variant_entry) {
+      continue;
+    }
+    has_variants = true;
+    if (!content_coding && request.range.empty() &&
+        AcceptsEncoding(request.accept_encoding, variant.coding)) {
+      representation = *variant_entry;
+      content_coding = variant.coding;
+    }
+  }
+
+  Response response = MakeResponse(200, "OK");
+  const auto etag = GetETag(representation);
+  AddHeader(response.headers, "ETag", etag);
+  AddHeader(response.headers, "Cache-Control", "no-cache");
+  if (has_variants) {
+    AddHeader(response.headers, "Vary", "Accept-Encoding");
+  }
+  if (!request.if_none_match.empty() &&
+      MatchesETag(request.if_none_match, etag)) {
+    response.status = 304;
+    response.reason = "Not Modified";
+    return response;
+  }
+
+  AddHeader(response.headers, "Content-Type", GetContentType(entry->path));
+  AddHeader(response.headers, "Accept-Ranges", "bytes");
+  if (content_coding) {
+    AddHeader(response.headers, "Content-Encoding", content_coding);
+  }
+
+  size_t first = 0;
+  size_t last = representation.size ? representation.size - 1 : 0;
+  if (!request.range.empty()) {
+    switch (ParseRange(request.range, representation.size, first, last)) {
+      case RangeResult::kIgnored:
+        break;
+      case RangeResult::kSatisfiable:
+        response.status = 206;
+        response.reason = "Partial Content";
+        AddHeader(response.headers, "Content-Range",
+                  "bytes " + std::to_string(first) + "-" +
+                      std::to_string(last) + "/" +
+                      std::to_string(representation.size));
+        break;
+      case RangeResult::kUnsatisfiable:
+        response.status = 416;
+        response.reason = "Range Not Satisfiable";
+        AddHeader(response.headers, "Content-Range",
+                  "bytes */" + std::to_string(representation.size));
+        return response;
+    }
+  }
+
+  const size_t length = representation.size ? last - first + 1 : 0;
+  AddHeader(response.headers, "Content-Length", std::to_string(length));
+  if (!head) {
+    response.body = representation.data + first;
+    response.body_size = length;
+    response.archive = mapping->archive;
+  }
+  return response;
+}
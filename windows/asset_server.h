@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "asset_archive.h"
+
+// Serves requests to virtual hosts that are mapped to asset archives, like
+// WebView2 serves virtual hosts mapped to folders.
+//
+// Besides plain GET and HEAD requests, it answers If-None-Match requests
+// with 304 and single range requests with 206, and serves precompressed
+// variants of an asset to clients that accept them.
+class AssetServer {
+ public:
+  struct Request {
+    std::string_view method = "GET";
+    std::string_view uri;
+    // Values of request headers, empty if absent.
+    std::string_view range;
+    std::string_view accept_encoding;
+    std::string_view if_none_match;
+  };
+
+  struct Response {
+    int status;
+    std::string_view reason;
+    // "Name: value" lines separated by CRLF.
+    std::string headers;
+    // Points into |archive|, which must be kept while the body is read.
+    const uint8_t* body = nullptr;
+    size_t body_size = 0;
+    std::shared_ptr<const AssetArchive> archive;
+  };
+
+  // Serves |host_name| from |archive|. Paths that aren't in the archive get
+  // |fallback_path| instead if it is not empty, for single page apps that
+  // route on the client.
+  void SetMapping(std::string_view host_name,
+                  std::shared_ptr<const AssetArchive> archive,
+                  std::string fallback_path);
+  bool ClearMapping(std::string_view host_name);
+
+  bool empty() const { return mappings_.empty(); }
+
+  // Returns std::nullopt if the host of the request isn't mapped.
+  std::optional<Response> Handle(const Request& request) const;
+
+ private:
+  struct Mapping {
+    std::string host_name;
+    std::shared_ptr<const AssetArchive> archive;
+    std::string fallback_path;
+  };
+
+  std::vector<Mapping> mappings_;
+
+  const Mapping* FindMapping(std::string_view host_name) const;
+};
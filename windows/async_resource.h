@@ -0,0 +1,112 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// Owns a resource that is created asynchronously and queues everyone who
+// needs it until the creation has completed or failed.
+//
+// State transitions:
+//   kIdle -> kCreating (Start)
+//   kCreating -> kReady | kFailed (factory completion)
+//   kFailed -> kCreating (Start, retry)
+//   any -> kIdle (Reset)
+template <typename T, typename Error>
+class AsyncResource {
+ public:
+  enum class State { kIdle, kCreating, kReady, kFailed };
+
+  // Invoked with either the resource or the creation error (which may be
+  // nullptr if the factory did not provide one).
+  typedef std::function<void(T* resource, const Error* error)> Waiter;
+  typedef std::function<void(std::unique_ptr<T>, std::unique_ptr<Error>)>
+      CompletionCallback;
+  typedef std::function<void(CompletionCallback)> Factory;
+
+  AsyncResource() : token_(std::make_shared<int>(0)) {}
+
+  // Starts creating the resource. Returns false (and does nothing) if the
+  // resource is already being created or has been created successfully.
+  bool Start(Factory factory) {
+    if (state_ == State::kCreating || state_ == State::kReady) {
+      return false;
+    }
+
+    state_ = State::kCreating;
+    error_.reset();
+    factory([this, token = std::weak_ptr<int>(token_)](
+                std::unique_ptr<T> resource, std::unique_ptr<Error> error) {
+      if (!token.lock()) {
+        return;
+      }
+      Complete(std::move(resource), std::move(error));
+    });
+    return true;
+  }
+
+  // Calls |waiter| once the resource has been created or its creation has
+  // failed. Calls it immediately if that has already happened.
+  void Await(Waiter waiter) {
+    switch (state_) {
+      case State::kReady:
+        return waiter(resource_.get(), nullptr);
+      case State::kFailed:
+        return waiter(nullptr, error_.get());
+      default:
+        waiters_.push_back(std::move(waiter));
+    }
+  }
+
+  // Destroys the resource and fails all pending waiters. Completions of
+  // creations started before are ignored.
+  void Reset() {
+    token_ = std::make_shared<int>(0);
+    state_ = State::kIdle;
+    auto waiters = std::move(waiters_);
+    waiters_.clear();
+    for (const auto& waiter : waiters) {
+      waiter(nullptr, nullptr);
+    }
+    resource_.reset();
+    error_.reset();
+  }
+
+  T* get() const { return resource_.get(); }
+  State state() const { return state_; }
+  size_t pending_count() const { return waiters_.size(); }
+
+  explicit operator bool() const { return state_ == State::kReady; }
+
+ private:
+  State state_ = State::kIdle;
+  std::unique_ptr<T> resource_;
+  std::unique_ptr<Error> error_;
+  std::vector<Waiter> waiters_;
+
+  // Invalidated on |Reset| and destruction so that late completions are
+  // dropped.
+  std::shared_ptr<int> token_;
+
+  void Complete(std::unique_ptr<T> resource, std::unique_ptr<Error> error) {
+    if (resource) {
+      resource_ = std::move(resource);
+      state_ = State::kReady;
+    } else {
+      error_ = std::move(error);
+      state_ = State::kFailed;
+    }
+
+    // Waiters may queue new waiters or reset this instance.
+    auto waiters = std::move(waiters_);
+    waiters_.clear();
+    for (const auto& waiter : waiters) {
+      if (state_ == State::kReady) {
+        waiter(resource_.get(), nullptr);
+      } else {
+        waiter(nullptr, error_.get());
+      }
+    }
+  }
+};
@@ -0,0 +1,146 @@
+#include <flutter/encodable_value.h>
+#include <flutter/method_call.h>
+
+#include <iterator>
+#include <memory>
+#include <string>
+
+#include "benchmark.h"
+#include "method_args.h"
+
+namespace bench {
+
+namespace {
+// Method names in the order WebviewBridge::HandleMethodCall tests them, and
+// the names it checks for user interaction first. Keep in sync to model the
+// cost of dispatching a call.
+constexpr const char* kBridgeMethods[] = {
+    "setCursorPos",
+    "setPointerUpdate",
+    "setScrollDelta",
+    "setPointerButton",
+    "setSize",
+    "loadUrl",
+    "loadStringContent",
+    "reload",
+    "stop",
+    "goBack",
+    "goForward",
+    "suspend",
+    "resume",
+    "setVirtualHostNameMapping",
+    "setVirtualHostNameArchiveMapping",
+    "clearVirtualHostNameMapping",
+    "setResponseCache",
+    "clearResponseCache",
+    "setUrlFilter",
+    "getUrlFilterHits",
+    "callDevToolsProtocolMethod",
+    "subscribeDevToolsProtocolEvent",
+    "unsubscribeDevToolsProtocolEvent",
+    "setPerformanceMetricsSampling",
+    "addScriptToExecuteOnDocumentCreated",
+    "removeScriptToExecuteOnDocumentCreated",
+    "executeScript",
+    "postWebMessage",
+    "setUserAgent",
+    "setBackgroundColor",
+    "setZoomFactor",
+    "openDevTools",
+    "clearCookies",
+    "clearCache",
+    "setCacheDisabled",
+    "setPopupWindowPolicy",
+    "setPermissionDecision",
+    "clearPermissionDecisions",
+    "setPermissionAnswerTtl",
+    "setFrameSchedulingHints",
+    "setEventSubscriptions",
+    "getSuppressedEventCounts",
+    "setNativeJsonDecoding",
+    "setTouchPrediction",
+    "setFpsLimit",
+};
+
+constexpr const char* kInteractionMethods[] = {
+    "setCursorPos", "setPointerUpdate", "setPointerButton", "setScrollDelta",
+    "loadUrl",      "loadStringContent", "reload",          "goBack",
+    "goForward",    "executeScript",     "postWebMessage",  "openDevTools",
+    "resume"};
+
+size_t Dispatch(const flutter::MethodCall<flutter::EncodableValue>& call) {
+  const auto& method_name = call.method_name();
+  size_t interaction = 0;
+  for (const auto name : kInteractionMethods) {
+    if (method_name.compare(name) == 0) {
+      interaction = 1;
+      break;
+    }
+  }
+  for (size_t i = 0; i < std::size(kBridgeMethods); ++i) {
+    if (method_name.compare(kBridgeMethods[i]) == 0) {
+      return i + interaction;
+    }
+  }
+  return std::size(kBridgeMethods);
+}
+
+void AddDispatchBenchmark(Registry& registry, const char* method_name,
+                          flutter::EncodableValue arguments) {
+  registry.Add(std::string("dispatch/") + method_name,
+               [method_name, arguments](size_t iterations) {
+                 const flutter::MethodCall<flutter::EncodableValue> call(
+                     method_name,
+                     std::make_unique<flutter::EncodableValue>(arguments));
+                 for (size_t i = 0; i < iterations; ++i) {
+                   DoNotOptimize(Dispatch(call));
+                 }
+               });
+}
+}  // namespace
+
+void RegisterArgsBenchmarks(Registry& registry) {
+  const flutter::EncodableValue point(flutter::EncodableList{
+      flutter::EncodableValue(120.5), flutter::EncodableValue(64.25)});
+  const flutter::EncodableValue point_and_scale(flutter::EncodableList{
+      flutter::EncodableValue(120.5), flutter::EncodableValue(64.25),
+      flutter::EncodableValue(1.5)});
+
+  // The most frequent call, a call in the middle and the last one tested.
+  AddDispatchBenchmark(registry, "setCursorPos", point);
+  AddDispatchBenchmark(registry, "executeScript",
+                       flutter::EncodableValue("document.title"));
+  AddDispatchBenchmark(registry, "setFpsLimit", flutter::EncodableValue(60));
+
+  registry.Add("args/GetPointFromArgs", [point](size_t iterations) {
+    for (size_t i = 0; i < iterations; ++i) {
+      DoNotOptimize(GetPointFromArgs(&point));
+    }
+  });
+
+  registry.Add("args/GetPointAndScaleFactorFromArgs",
+               [point_and_scale](size_t iterations) {
+                 for (size_t i = 0; i < iterations; ++i) {
+                   DoNotOptimize(
+                       GetPointAndScaleFactorFromArgs(&point_and_scale));
+                 }
+               });
+
+  registry.Add("args/GetOptionalValue/frameSchedulingHints",
+               [](size_t iterations) {
+                 const flutter::EncodableMap hints{
+                     {flutter::EncodableValue("focused"),
+                      flutter::EncodableValue(true)},
+                     {flutter::EncodableValue("visible"),
+                      flutter::EncodableValue(true)},
+                     {flutter::EncodableValue("priority"),
+                      flutter::EncodableValue(2.0)}};
+                 for (size_t i = 0; i < iterations; ++i) {
+                   DoNotOptimize(GetOptionalValue<bool>(hints, "focused"));
+                   DoNotOptimize(GetOptionalValue<bool>(hints, "visible"));
+                   DoNotOptimize(GetOptionalValue<double>(hints, "priority"));
+                 }
+               });
+}
+
+}  // namespace bench
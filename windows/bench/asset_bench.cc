@@ -0,0 +1,223 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "asset_archive.h"
+#include "asset_server.h"
+#include "benchmark.h"
+
+namespace bench {
+
+namespace {
+// The size of a large single page app bundle.
+constexpr size_t kAssetCount = 40000;
+constexpr size_t kLargeAssetSize = 1 << 20;
+constexpr size_t kReadChunkSize = 64 * 1024;
+
+void AppendU16(std::string& out, uint16_t value) {
+  out.push_back(static_cast<char>(value & 0xff));
+  out.push_back(static_cast<char>(value >> 8));
+}
+
+void AppendU32(std::string& out, uint32_t value) {
+  AppendU16(out, static_cast<uint16_t>(value & 0xffff));
+  AppendU16(out, static_cast<uint16_t>(value >> 16));
+}
+
+// Writes a zip archive of stored entries.
+std::string MakeZip(
+    const std::vector<std::pair<std::string, std::string>>& files) {
+  std::string zip;
+  std::string directory;
+  for (const auto& [name, contents] : files) {
+    const auto offset = static_cast<uint32_t>(zip.size());
+    const auto crc = static_cast<uint32_t>(std::hash<std::string>()(contents));
+    AppendU32(zip, 0x04034b50);
+    AppendU16(zip, 10);  // Version needed.
+    AppendU16(zip, 0);   // Flags.
+    AppendU16(zip, 0);   // Stored.
+    AppendU32(zip, 0);   // Modification time and date.
+    AppendU32(zip, crc);
+    AppendU32(zip, static_cast<uint32_t>(contents.size()));
+    AppendU32(zip, static_cast<uint32_t>(contents.size()));
+    AppendU16(zip, static_cast<uint16_t>(name.size()));
+    AppendU16(zip, 0);  // Extra field.
+    zip += name;
+    zip += contents;
+
+    AppendU32(directory, 0x02014b50);
+    AppendU16(directory, 20);  // Version made by.
+    AppendU16(directory, 10);  // Version needed.
+    AppendU16(directory, 0);   // Flags.
+    AppendU16(directory, 0);   // Stored.
+    AppendU32(directory, 0);   // Modification time and date.
+    AppendU32(directory, crc);
+    AppendU32(directory, static_cast<uint32_t>(contents.size()));
+    AppendU32(directory, static_cast<uint32_t>(contents.size()));
+    AppendU16(directory, static_cast<uint16_t>(name.size()));
+    AppendU16(directory, 0);  // Extra field.
+    AppendU16(directory, 0);  // Comment.
+    AppendU16(directory, 0);  // Disk.
+    AppendU16(directory, 0);  // Internal attributes.
+    AppendU32(directory, 0);  // External attributes.
+    AppendU32(directory, offset);
+    directory += name;
+  }
+
+  const auto directory_offset = static_cast<uint32_t>(zip.size());
+  zip += directory;
+  AppendU32(zip, 0x06054b50);
+  AppendU16(zip, 0);
+  AppendU16(zip, 0);
+  AppendU16(zip, static_cast<uint16_t>(files.size()));
+  AppendU16(zip, static_cast<uint16_t>(files.size()));
+  AppendU32(zip, static_cast<uint32_t>(directory.size()));
+  AppendU32(zip, directory_offset);
+  AppendU16(zip, 0);
+  return zip;
+}
+
+std::shared_ptr<const AssetArchive> OpenArchive(const std::string& path) {
+  std::string error;
+  auto archive = AssetArchive::Open(path, error);
+  if (!archive) {
+    std::fprintf(stderr, "%s\n", error.c_str());
+    std::abort();
+  }
+  return archive;
+}
+
+struct AssetBundle {
+  std::string archive_path;
+  std::vector<std::string> paths;
+  std::shared_ptr<const AssetArchive> archive;
+};
+
+// A bundle of small scripts, styles and images in nested folders, with
+// Brotli variants of the scripts and one large asset, written to a
+// temporary file once per run.
+const AssetBundle& GetAssetBundle() {
+  static const AssetBundle bundle = []() {
+    AssetBundle bundle;
+    std::mt19937 random(7);
+    std::uniform_int_distribution<size_t> size(64, 1024);
+    constexpr const char* kExtensions[] = {".js", ".css", ".png", ".svg"};
+
+    std::vector<std::pair<std::string, std::string>> files;
+    files.reserve(kAssetCount + kAssetCount / 4 + 2);
+    files.emplace_back("index.html", std::string(2048, 'h'));
+    files.emplace_back("large.bin", std::string(kLargeAssetSize, 'l'));
+    for (size_t i = 0; i < kAssetCount; ++i) {
+      std::string path = "static/module" + std::to_string(i % 97) + "/chunk-" +
+                         std::to_string(i) + kExtensions[i % 4];
+      files.emplace_back(path, std::string(size(random), 'a'));
+      if (i % 4 == 0) {
+        files.emplace_back(path + ".br", std::string(size(random) / 3, 'b'));
+      }
+      bundle.paths.push_back(std::move(path));
+    }
+
+    bundle.archive_path =
+        (std::filesystem::temp_directory_path() / "webview_windows_assets.zip")
+            .string();
+    std::ofstream(bundle.archive_path, std::ios::binary) << MakeZip(files);
+    bundle.archive = OpenArchive(bundle.archive_path);
+    return bundle;
+  }();
+  return bundle;
+}
+}  // namespace
+
+void RegisterAssetBenchmarks(Registry& registry) {
+  registry.Add("asset/archive/open_40k", [](size_t iterations) {
+    const auto& path = GetAssetBundle().archive_path;
+    for (size_t i = 0; i < iterations; ++i) {
+      DoNotOptimize(OpenArchive(path));
+    }
+  });
+
+  registry.Add("asset/archive/find_40k", [](size_t iterations) {
+    const auto& archive = GetAssetBundle().archive;
+    const auto& paths = GetAssetBundle().paths;
+    for (size_t i = 0; i < iterations; ++i) {
+      DoNotOptimize(archive->Find(paths[(i * 7919) % paths.size()])->data[0]);
+    }
+  });
+
+  // Lookups are followed by reading the data, like serving does, which
+  // touches the page of the local header that Find reads.
+  //
+  // The same lookups in a hash map of the entries, for comparison.
+  registry.Add("asset/archive/find_40k/unordered_map", [](size_t iterations) {
+    const auto& paths = GetAssetBundle().paths;
+    static const auto index = [&paths]() {
+      std::unordered_map<std::string_view, AssetArchive::Entry> index;
+      for (const auto& path : paths) {
+        index.emplace(path, *GetAssetBundle().archive->Find(path));
+      }
+      return index;
+    }();
+    for (size_t i = 0; i < iterations; ++i) {
+      DoNotOptimize(
+          index.find(paths[(i * 7919) % paths.size()])->second.data[0]);
+    }
+  });
+
+  registry.Add("asset/server/get_precompressed", [](size_t iterations) {
+    AssetServer server;
+    server.SetMapping("app.example", GetAssetBundle().archive, "index.html");
+    const auto& paths = GetAssetBundle().paths;
+    std::vector<std::string> uris;
+    for (size_t i = 0; i < 1024; ++i) {
+      uris.push_back("https://app.example/" + paths[(i * 7919) % paths.size()] +
+                     "?v=1");
+    }
+    AssetServer::Request request;
+    request.accept_encoding = "gzip, deflate, br";
+    for (size_t i = 0; i < iterations; ++i) {
+      request.uri = uris[i % uris.size()];
+      DoNotOptimize(server.Handle(request));
+    }
+  });
+
+  registry.Add("asset/server/get_range", [](size_t iterations) {
+    AssetServer server;
+    server.SetMapping("app.example", GetAssetBundle().archive, std::string());
+    AssetServer::Request request;
+    request.uri = "https://app.example/large.bin";
+    request.range = "bytes=524288-589823";
+    for (size_t i = 0; i < iterations; ++i) {
+      DoNotOptimize(server.Handle(request));
+    }
+  });
+
+  // Reads a large asset the way WebView2 reads the response stream.
+  registry.Add(
+      "asset/archive/read_large",
+      [](size_t iterations) {
+        const auto& archive = GetAssetBundle().archive;
+        const auto entry = archive->Find("large.bin");
+        std::vector<uint8_t> buffer(kReadChunkSize);
+        for (size_t i = 0; i < iterations; ++i) {
+          for (size_t offset = 0; offset < entry->size;
+               offset += kReadChunkSize) {
+            std::memcpy(buffer.data(), entry->data + offset,
+                        std::min(kReadChunkSize, entry->size - offset));
+            DoNotOptimize(buffer.data());
+          }
+        }
+      },
+      kLargeAssetSize);
+}
+
+}  // namespace bench
@@ -0,0 +1,109 @@
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <string_view>
+
+#include "benchmark.h"
+
+namespace {
+constexpr char kUsage[] =
+    "Usage: webview_windows_bench [options]\n"
+    "  --filter=<text>          Only run benchmarks containing <text>.\n"
+    "  --min-time-ms=<ms>       Minimum duration of each repetition.\n"
+    "  --repetitions=<n>        Number of repetitions.\n"
+    "  --label=<text>           Label stored with the results, e.g. a "
+    "commit.\n"
+    "  --out=<file>             Writes the results as JSON to <file>.\n"
+    "  --baseline=<file>        Compares the results to a previous run.\n"
+    "  --max-regression=<pct>   Fails if a benchmark got slower than this.\n";
+
+bool GetFlag(std::string_view arg, std::string_view name, std::string& value) {
+  if (arg.substr(0, name.size()) != name) {
+    return false;
+  }
+  value = std::string(arg.substr(name.size()));
+  return true;
+}
+
+bool ReadFile(const std::string& path, std::string& contents) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    return false;
+  }
+  std::ostringstream buffer;
+  buffer << file.rdbuf();
+  contents = buffer.str();
+  return true;
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+  bench::RunOptions options;
+  std::string label;
+  std::string out_path;
+  std::string baseline_path;
+  double max_regression_percent = 1e9;
+
+  for (int i = 1; i < argc; ++i) {
+    const std::string_view arg = argv[i];
+    std::string value;
+    if (GetFlag(arg, "--filter=", value)) {
+      options.filter = value;
+    } else if (GetFlag(arg, "--min-time-ms=", value)) {
+      options.min_time = std::chrono::milliseconds(std::atoi(value.c_str()));
+    } else if (GetFlag(arg, "--repetitions=", value)) {
+      options.repetitions = std::atoi(value.c_str());
+    } else if (GetFlag(arg, "--label=", value)) {
+      label = value;
+    } else if (GetFlag(arg, "--out=", value)) {
+      out_path = value;
+    } else if (GetFlag(arg, "--baseline=", value)) {
+      baseline_path = value;
+    } else if (GetFlag(arg, "--max-regression=", value)) {
+      max_regression_percent = std::atof(value.c_str());
+    } else {
+      std::fputs(kUsage, stderr);
+      return 2;
+    }
+  }
+
+  bench::Registry registry;
+  bench::RegisterArgsBenchmarks(registry);
+  bench::RegisterAssetBenchmarks(registry);
+  bench::RegisterCacheBenchmarks(registry);
+  bench::RegisterDevToolsBenchmarks(registry);
+  bench::RegisterEventBenchmarks(registry);
+  bench::RegisterStringBenchmarks(registry);
+  bench::RegisterFrameBenchmarks(registry);
+  bench::RegisterInputBenchmarks(registry);
+  bench::RegisterLockingBenchmarks(registry);
+  bench::RegisterUrlFilterBenchmarks(registry);
+
+  const auto results = bench::Run(registry, options);
+  const auto json = bench::ToJson(results, label);
+  if (out_path.empty()) {
+    std::fputs(json.c_str(), stdout);
+  } else {
+    std::ofstream out(out_path, std::ios::binary);
+    out << json;
+    if (!out) {
+      std::fprintf(stderr, "Failed to write %s.\n", out_path.c_str());
+      return 1;
+    }
+  }
+
+  if (!baseline_path.empty()) {
+    std::string baseline;
+    if (!ReadFile(baseline_path, baseline)) {
+      std::fprintf(stderr, "Failed to read %s.\n", baseline_path.c_str());
+      return 1;
+    }
+    if (!bench::CompareToBaseline(results, baseline,
+                                  max_regression_percent)) {
+      return 1;
+    }
+  }
+  return 0;
+}
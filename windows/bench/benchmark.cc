@@ -0,0 +1,228 @@
+#include "benchmark.h"
+
+#include <flutter/encodable_value.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <new>
+#include <sstream>
+
+#include "util/json_decoder.h"
+
+namespace {
+std::atomic<uint64_t> g_allocation_count{0};
+
+// Upper bound for the calibrated iteration count.
+constexpr uint64_t kMaxIterations = 1'000'000'000;
+
+double RunOnce(const bench::Benchmark& benchmark, uint64_t iterations) {
+  const auto start = std::chrono::steady_clock::now();
+  benchmark.function(static_cast<size_t>(iterations));
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+  return static_cast<double>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+}
+
+// Finds an iteration count that takes about |min_time| to run.
+uint64_t Calibrate(const bench::Benchmark& benchmark,
+                   std::chrono::nanoseconds min_time) {
+  const auto target = static_cast<double>(min_time.count());
+  uint64_t iterations = 1;
+  while (true) {
+    const auto elapsed = RunOnce(benchmark, iterations);
+    if (elapsed >= target / 10 || iterations >= kMaxIterations) {
+      const auto scaled = elapsed > 0 ? target * iterations / elapsed
+                                      : static_cast<double>(kMaxIterations);
+      return std::clamp<uint64_t>(static_cast<uint64_t>(scaled), 1,
+                                  kMaxIterations);
+    }
+    iterations *= 10;
+  }
+}
+
+void AppendJsonString(std::ostringstream& out, const std::string& value) {
+  out << '"';
+  for (const char c : value) {
+    if (c == '"' || c == '\\') {
+      out << '\\' << c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      char escaped[8];
+      std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+      out << escaped;
+    } else {
+      out << c;
+    }
+  }
+  out << '"';
+}
+
+std::optional<double> GetNumber(const flutter::EncodableMap& map,
+                                const char* key) {
+  const auto it = map.find(flutter::EncodableValue(key));
+  if (it == map.end()) {
+    return std::nullopt;
+  }
+  if (const auto value = std::get_if<double>(&it->second)) {
+    return *value;
+  }
+  if (const auto value = std::get_if<int32_t>(&it->second)) {
+    return *value;
+  }
+  if (const auto value = std::get_if<int64_t>(&it->second)) {
+    return static_cast<double>(*value);
+  }
+  return std::nullopt;
+}
+}  // namespace
+
+// Counts heap allocations for the allocations-per-operation metric.
+void* operator new(size_t size) {
+  g_allocation_count.fetch_add(1, std::memory_order_relaxed);
+  if (void* p = std::malloc(size ? size : 1)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) { return operator new(size); }
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+  g_allocation_count.fetch_add(1, std::memory_order_relaxed);
+  return std::malloc(size ? size : 1);
+}
+
+void* operator new[](size_t size, const std::nothrow_t& tag) noexcept {
+  return operator new(size, tag);
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+
+namespace bench {
+
+uint64_t AllocationCount() {
+  return g_allocation_count.load(std::memory_order_relaxed);
+}
+
+std::vector<Result> Run(const Registry& registry, const RunOptions& options) {
+  std::vector<Result> results;
+  for (const auto& benchmark : registry.benchmarks()) {
+    if (benchmark.name.find(options.filter) == std::string::npos) {
+      continue;
+    }
+
+    // Warm up caches and lazily initialized state.
+    RunOnce(benchmark, 1);
+    const auto iterations = Calibrate(benchmark, options.min_time);
+
+    std::vector<double> ns_per_op;
+    uint64_t allocations = 0;
+    for (int i = 0; i < std::max(options.repetitions, 1); ++i) {
+      const auto allocations_before = AllocationCount();
+      ns_per_op.push_back(RunOnce(benchmark, iterations) / iterations);
+      allocations += AllocationCount() - allocations_before;
+    }
+    std::sort(ns_per_op.begin(), ns_per_op.end());
+
+    Result result;
+    result.name = benchmark.name;
+    result.iterations = iterations;
+    result.ns_per_op = ns_per_op[ns_per_op.size() / 2];
+    result.min_ns_per_op = ns_per_op.front();
+    result.allocations_per_op = static_cast<double>(allocations) /
+                                (iterations * ns_per_op.size());
+    result.bytes_per_second =
+        benchmark.bytes_per_iteration && result.ns_per_op > 0
+            ? benchmark.bytes_per_iteration * 1e9 / result.ns_per_op
+            : 0;
+    results.push_back(result);
+
+    std::fprintf(stderr, "%-56s %12.2f ns/op %10.2f allocs/op\n",
+                 result.name.c_str(), result.ns_per_op,
+                 result.allocations_per_op);
+  }
+  return results;
+}
+
+std::string ToJson(const std::vector<Result>& results,
+                   const std::string& label) {
+  std::ostringstream out;
+  out.precision(6);
+  out << "{\n  \"label\": ";
+  AppendJsonString(out, label);
+  out << ",\n  \"benchmarks\": [";
+  bool first = true;
+  for (const auto& result : results) {
+    out << (first ? "\n" : ",\n") << "    {\"name\": ";
+    AppendJsonString(out, result.name);
+    out << ", \"iterations\": " << result.iterations
+        << ", \"ns_per_op\": " << result.ns_per_op
+        << ", \"min_ns_per_op\": " << result.min_ns_per_op
+        << ", \"allocations_per_op\": " << result.allocations_per_op
+        << ", \"bytes_per_second\": " << result.bytes_per_second << "}";
+    first = false;
+  }
+  out << "\n  ]\n}\n";
+  return out.str();
+}
+
+bool CompareToBaseline(const std::vector<Result>& results,
+                       const std::string& baseline_json,
+                       double max_regression_percent) {
+  const auto baseline =
+      util::JsonDecoder<flutter::EncodableValue, flutter::EncodableList,
+                        flutter::EncodableMap>::Decode(baseline_json);
+  const flutter::EncodableList* list = nullptr;
+  if (const auto root = baseline
+                            ? std::get_if<flutter::EncodableMap>(&*baseline)
+                            : nullptr) {
+    const auto it = root->find(flutter::EncodableValue("benchmarks"));
+    if (it != root->end()) {
+      list = std::get_if<flutter::EncodableList>(&it->second);
+    }
+  }
+  if (!list) {
+    std::fprintf(stderr, "Invalid baseline file.\n");
+    return false;
+  }
+
+  std::map<std::string, double> baseline_ns_per_op;
+  for (const auto& entry : *list) {
+    const auto map = std::get_if<flutter::EncodableMap>(&entry);
+    if (!map) {
+      continue;
+    }
+    const auto name = map->find(flutter::EncodableValue("name"));
+    const auto ns_per_op = GetNumber(*map, "ns_per_op");
+    if (name != map->end() && ns_per_op &&
+        std::holds_alternative<std::string>(name->second)) {
+      baseline_ns_per_op[std::get<std::string>(name->second)] = *ns_per_op;
+    }
+  }
+
+  bool passed = true;
+  std::fprintf(stderr, "%-56s %12s %12s %9s\n", "benchmark", "baseline",
+               "current", "change");
+  for (const auto& result : results) {
+    const auto base = baseline_ns_per_op.find(result.name);
+    if (base == baseline_ns_per_op.end() || base->second <= 0) {
+      std::fprintf(stderr, "%-56s %12s %12.2f %9s\n", result.name.c_str(),
+                   "-", result.ns_per_op, "new");
+      continue;
+    }
+    const auto change = (result.ns_per_op / base->second - 1) * 100;
+    const bool regressed = change > max_regression_percent;
+    passed = passed && !regressed;
+    std::fprintf(stderr, "%-56s %12.2f %12.2f %+8.1f%%%s\n",
+                 result.name.c_str(), base->second, result.ns_per_op, change,
+                 regressed ? " REGRESSED" : "");
+  }
+  return passed;
+}
+
+}  // namespace bench
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace bench {
+
+// Keeps the compiler from optimizing away the computation of |value|.
+template <typename T>
+inline void DoNotOptimize(const T& value) {
+#if defined(_MSC_VER)
+  static const volatile void* sink;
+  sink = &value;
+  _ReadWriteBarrier();
+#else
+  asm volatile("" : : "r,m"(value) : "memory");
+#endif
+}
+
+// Runs the measured operation |iterations| times. Setup done before the
+// loop is amortized over the iterations.
+typedef std::function<void(size_t iterations)> BenchmarkFunction;
+
+struct Benchmark {
+  std::string name;
+  BenchmarkFunction function;
+  // Bytes processed per iteration, for throughput reporting. 0 if not
+  // applicable.
+  size_t bytes_per_iteration = 0;
+};
+
+class Registry {
+ public:
+  void Add(std::string name, BenchmarkFunction function,
+           size_t bytes_per_iteration = 0) {
+    benchmarks_.push_back(
+        {std::move(name), std::move(function), bytes_per_iteration});
+  }
+
+  const std::vector<Benchmark>& benchmarks() const { return benchmarks_; }
+
+ private:
+  std::vector<Benchmark> benchmarks_;
+};
+
+struct RunOptions {
+  // Minimum duration of each repetition.
+  std::chrono::nanoseconds min_time = std::chrono::milliseconds(100);
+  int repetitions = 5;
+  // Only benchmarks whose name contains |filter| are run.
+  std::string filter;
+};
+
+struct Result {
+  std::string name;
+  uint64_t iterations;
+  // Median and minimum over the repetitions.
+  double ns_per_op;
+  double min_ns_per_op;
+  double allocations_per_op;
+  // 0 if the benchmark doesn't report processed bytes.
+  double bytes_per_second;
+};
+
+std::vector<Result> Run(const Registry& registry, const RunOptions& options);
+
+// Results in a stable JSON format, meant to be stored and compared between
+// commits with CompareToBaseline.
+std::string ToJson(const std::vector<Result>& results,
+                   const std::string& label);
+
+// Prints the change of each result relative to the same benchmark in
+// |baseline_json|. Returns false if |baseline_json| can't be parsed or a
+// benchmark got slower by more than |max_regression_percent|.
+bool CompareToBaseline(const std::vector<Result>& results,
+                       const std::string& baseline_json,
+                       double max_regression_percent);
+
+// Number of heap allocations made by the process so far.
+uint64_t AllocationCount();
+
+// Benchmark suites.
+void RegisterArgsBenchmarks(Registry& registry);
+void RegisterAssetBenchmarks(Registry& registry);
+void RegisterCacheBenchmarks(Registry& registry);
+void RegisterDevToolsBenchmarks(Registry& registry);
+void RegisterEventBenchmarks(Registry& registry);
+void RegisterStringBenchmarks(Registry& registry);
+void RegisterFrameBenchmarks(Registry& registry);
+void RegisterInputBenchmarks(Registry& registry);
+void RegisterLockingBenchmarks(Registry& registry);
+void RegisterUrlFilterBenchmarks(Registry& registry);
+
+}  // namespace bench
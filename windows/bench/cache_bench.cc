@@ -0,0 +1,164 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "benchmark.h"
+#include "cache_policy.h"
+#include "response_cache.h"
+
+namespace bench {
+
+namespace {
+// The API responses and images of a few screens.
+constexpr size_t kEntryCount = 2000;
+constexpr size_t kBodySize = 4096;
+constexpr int64_t kNow = 1700000000;
+
+constexpr char kResponseHeaders[] =
+    "Date: Tue, 14 Nov 2023 22:13:20 GMT\r\n"
+    "Content-Type: application/json\r\n"
+    "Content-Encoding: gzip\r\n"
+    "Content-Length: 1234\r\n"
+    "Cache-Control: public, max-age=600\r\n"
+    "ETag: \"5f3a-1b2c\"\r\n"
+    "Vary: Accept-Encoding\r\n"
+    "Set-Cookie: session=abc; Secure";
+
+std::string GetUrl(size_t i) {
+  return "https://api.example.com/v2/items/" + std::to_string(i) +
+         "?fields=id,name,thumbnail&locale=en-US";
+}
+
+std::shared_ptr<ResponseCache> OpenCache(const std::string& name,
+                                         const ResponseCache::Limits& limits) {
+  const auto directory = std::filesystem::temp_directory_path() / name;
+  std::string error;
+  auto cache = ResponseCache::Open(directory, error);
+  if (!cache) {
+    std::fprintf(stderr, "%s\n", error.c_str());
+    std::abort();
+  }
+  cache->Clear();
+  cache->SetLimits(limits);
+  cache->Flush();
+  return cache;
+}
+
+// A cache holding kEntryCount responses, each with a distinct body.
+std::shared_ptr<ResponseCache> FillCache(const std::string& name,
+                                         const ResponseCache::Limits& limits) {
+  auto cache = OpenCache(name, limits);
+  const auto headers = CachePolicy::GetStoredHeaders(kResponseHeaders);
+  for (size_t i = 0; i < kEntryCount; ++i) {
+    ResponseCache::Entry entry;
+    entry.url = GetUrl(i);
+    entry.headers = headers;
+    entry.body = std::string(kBodySize, 'a');
+    std::snprintf(entry.body.data(), entry.body.size(), "%zu", i);
+    entry.expires_at = kNow + 600;
+    cache->Store(std::move(entry));
+  }
+  cache->Flush();
+  return cache;
+}
+
+std::vector<std::string> GetUrls() {
+  std::vector<std::string> urls;
+  for (size_t i = 0; i < kEntryCount; ++i) {
+    urls.push_back(GetUrl((i * 7919) % kEntryCount));
+  }
+  return urls;
+}
+
+// Rules of an app that caches its API and CDN but not its auth endpoints.
+CachePolicy GetPolicy() {
+  std::vector<CachePolicy::Rule> rules;
+  rules.push_back({"https://api.example.com/v2/auth/*",
+                   CachePolicy::Mode::kNever, std::nullopt});
+  for (int i = 0; i < 16; ++i) {
+    rules.push_back({"https://cdn" + std::to_string(i) + ".example.com/*",
+                     CachePolicy::Mode::kAlways, std::chrono::hours(24)});
+  }
+  rules.push_back({"https://api.example.com/v2/items/*?*",
+                   CachePolicy::Mode::kHeaders, std::chrono::minutes(5)});
+  CachePolicy policy;
+  policy.SetRules(std::move(rules));
+  return policy;
+}
+}  // namespace
+
+void RegisterCacheBenchmarks(Registry& registry) {
+  registry.Add("cache/policy/match_18_rules", [](size_t iterations) {
+    const auto policy = GetPolicy();
+    const auto urls = GetUrls();
+    for (size_t i = 0; i < iterations; ++i) {
+      DoNotOptimize(policy.Match(urls[i % urls.size()]));
+    }
+  });
+
+  registry.Add("cache/policy/get_expiry", [](size_t iterations) {
+    const auto policy = GetPolicy();
+    const auto rule = policy.Match(GetUrl(0));
+    const CachePolicy::Request request;
+    for (size_t i = 0; i < iterations; ++i) {
+      DoNotOptimize(CachePolicy::GetExpiry(*rule, request, 200,
+                                           kResponseHeaders, kNow));
+    }
+  });
+
+  registry.Add("cache/lookup/memory_hit", [](size_t iterations) {
+    static const auto cache =
+        FillCache("webview_windows_cache_memory", ResponseCache::Limits());
+    static const auto urls = GetUrls();
+    for (size_t i = 0; i < iterations; ++i) {
+      DoNotOptimize(cache->Lookup(urls[i % urls.size()], kNow));
+    }
+  });
+
+  // Without memory, every hit reads the entry and body files, which are in
+  // the page cache of the OS after the first pass.
+  registry.Add("cache/lookup/disk_hit", [](size_t iterations) {
+    ResponseCache::Limits limits;
+    limits.max_memory_bytes = 0;
+    static const auto cache = FillCache("webview_windows_cache_disk", limits);
+    static const auto urls = GetUrls();
+    for (size_t i = 0; i < iterations; ++i) {
+      DoNotOptimize(cache->Lookup(urls[i % urls.size()], kNow));
+    }
+  });
+
+  registry.Add("cache/lookup/miss", [](size_t iterations) {
+    static const auto cache =
+        OpenCache("webview_windows_cache_miss", ResponseCache::Limits());
+    static const auto urls = GetUrls();
+    for (size_t i = 0; i < iterations; ++i) {
+      DoNotOptimize(cache->Lookup(urls[i % urls.size()], kNow));
+    }
+  });
+
+  // Includes the writes, which the cache makes on its own thread.
+  registry.Add(
+      "cache/store",
+      [](size_t iterations) {
+        static const auto cache =
+            OpenCache("webview_windows_cache_store", ResponseCache::Limits());
+        const auto headers = CachePolicy::GetStoredHeaders(kResponseHeaders);
+        for (size_t i = 0; i < iterations; ++i) {
+          ResponseCache::Entry entry;
+          entry.url = GetUrl(i % kEntryCount);
+          entry.headers = headers;
+          entry.body = std::string(kBodySize, 'a');
+          std::snprintf(entry.body.data(), entry.body.size(), "%zu", i);
+          entry.expires_at = kNow + 600;
+          DoNotOptimize(cache->Store(std::move(entry)));
+        }
+        cache->Flush();
+      },
+      kBodySize);
+}
+
+}  // namespace bench
@@ -0,0 +1,169 @@
+#include <chrono>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "benchmark.h"
+#include "devtools_subscriptions.h"
+#include "performance_sampler.h"
+#include "util/json_path.h"
+
+namespace bench {
+
+namespace {
+constexpr auto kEvent = "Network.responseReceived";
+constexpr size_t kSubscriptionCount = 8;
+constexpr size_t kSampleCount = 1024;
+
+// All the metrics that Performance.getMetrics returns, of which the sampler
+// only reads some.
+constexpr const char* kMetricNames[] = {
+    "Timestamp", "AudioHandlers", "AudioWorkletProcessors", "Documents",
+    "Frames", "JSEventListeners", "LayoutObjects", "MediaKeySessions",
+    "MediaKeys", "Nodes", "Resources", "ContextLifecycleStateObservers",
+    "V8PerContextDatas", "WorkerGlobalScopes", "UACSSResources",
+    "RTCPeerConnections", "ResourceFetchers", "AdSubframes",
+    "DetachedScriptStates", "ArrayBufferContents", "LayoutCount",
+    "RecalcStyleCount", "LayoutDuration", "RecalcStyleDuration",
+    "DevToolsCommandDuration", "ScriptDuration", "V8CompileDuration",
+    "TaskDuration", "TaskOtherDuration", "ThreadTime", "ProcessTime",
+    "JSHeapUsedSize", "JSHeapTotalSize", "FirstMeaningfulPaint",
+    "DomContentLoaded", "NavigationStart",
+};
+
+// Params of Network.responseReceived as Chromium sends them, about 2 KB with
+// the headers and the timing.
+std::string GetParams() {
+  std::string headers;
+  for (int i = 0; i < 24; ++i) {
+    headers += "\"x-header-" + std::to_string(i) +
+               "\":\"value of the header with some \\\"escapes\\\" " +
+               std::to_string(i) + "\",";
+  }
+  headers += "\"content-type\":\"application/json; charset=utf-8\"";
+  return "{\"requestId\":\"1234.56\",\"loaderId\":\"ABCDEF0123456789\","
+         "\"timestamp\":183456.789012,\"type\":\"XHR\",\"response\":{"
+         "\"url\":\"https://api.example.com/v2/items?page=3&limit=50\","
+         "\"status\":503,\"statusText\":\"Service Unavailable\","
+         "\"headers\":{" +
+         headers +
+         "},\"mimeType\":\"application/json\",\"connectionReused\":true,"
+         "\"connectionId\":1789,\"remoteIPAddress\":\"93.184.216.34\","
+         "\"remotePort\":443,\"fromDiskCache\":false,"
+         "\"fromServiceWorker\":false,\"encodedDataLength\":1543,"
+         "\"timing\":{\"requestTime\":183456.7,\"proxyStart\":-1,"
+         "\"proxyEnd\":-1,\"dnsStart\":0.12,\"dnsEnd\":4.5,"
+         "\"connectStart\":4.5,\"connectEnd\":31.2,\"sslStart\":12.1,"
+         "\"sslEnd\":31.1,\"sendStart\":31.4,\"sendEnd\":31.6,"
+         "\"receiveHeadersEnd\":88.9},\"protocol\":\"h2\","
+         "\"securityState\":\"secure\"},\"hasExtraInfo\":true,"
+         "\"frameId\":\"FEDCBA9876543210\"}";
+}
+
+// Results of Performance.getMetrics one second apart, with every metric
+// growing so that none of the samples restart the interval.
+std::vector<std::string> GetMetricsResults() {
+  std::vector<std::string> results;
+  for (size_t i = 0; i < kSampleCount; ++i) {
+    std::string result = "{\"metrics\":[";
+    for (size_t j = 0; j < std::size(kMetricNames); ++j) {
+      result += std::string(j == 0 ? "" : ",") + "{\"name\":\"" +
+                kMetricNames[j] + "\",\"value\":" +
+                std::to_string(183456.789 + i * (j + 1) * 0.25) + "}";
+    }
+    results.push_back(result + "]}");
+  }
+  return results;
+}
+
+// Subscribers that each want a different slice of the responses, as a
+// network panel, an error reporter and API monitors would.
+std::vector<DevToolsEventFilter> GetFilters() {
+  using Operator = DevToolsEventFilter::Operator;
+  std::vector<DevToolsEventFilter> filters;
+  for (size_t i = 0; i < kSubscriptionCount; ++i) {
+    switch (i % 4) {
+      case 0:
+        filters.emplace_back();
+        break;
+      case 1:
+        filters.emplace_back(std::vector<DevToolsEventFilter::Condition>{
+            {"response.status", Operator::kGreaterThan, 399.0}});
+        break;
+      case 2:
+        filters.emplace_back(std::vector<DevToolsEventFilter::Condition>{
+            {"type", Operator::kEquals, std::string("XHR")},
+            {"response.url", Operator::kContains,
+             std::string("/v" + std::to_string(i) + "/")}});
+        break;
+      default:
+        filters.emplace_back(std::vector<DevToolsEventFilter::Condition>{
+            {"response.timing.receiveHeadersEnd", Operator::kGreaterThan,
+             50.0},
+            {"response.headers.content-type", Operator::kStartsWith,
+             std::string("application/json")}});
+        break;
+    }
+  }
+  return filters;
+}
+}  // namespace
+
+void RegisterDevToolsBenchmarks(Registry& registry) {
+  registry.Add("devtools/find_json_value", [](size_t iterations) {
+    static const auto params = GetParams();
+    for (size_t i = 0; i < iterations; ++i) {
+      DoNotOptimize(util::FindJsonValue(params, "response.timing.sslEnd"));
+    }
+  });
+
+  registry.Add("devtools/dispatch_8_filtered", [](size_t iterations) {
+    static const auto params = GetParams();
+    DevToolsSubscriptions subscriptions(
+        [](const std::string& /*event*/) { return true; },
+        [](const std::string& /*event*/) {});
+    for (auto& filter : GetFilters()) {
+      subscriptions.Subscribe(kEvent, std::move(filter));
+    }
+    const std::string event = kEvent;
+    size_t delivered = 0;
+    for (size_t i = 0; i < iterations; ++i) {
+      subscriptions.Dispatch(event, params,
+                             [&delivered](DevToolsSubscriptions::Id /*id*/) {
+                               ++delivered;
+                             });
+    }
+    DoNotOptimize(delivered);
+  });
+
+  registry.Add("devtools/performance_sample", [](size_t iterations) {
+    static const auto results = GetMetricsResults();
+    PerformanceSampler sampler(std::chrono::seconds(1), true);
+    const std::string heap_usage =
+        "{\"usedSize\":18234112,\"totalSize\":25165824,"
+        "\"embedderHeapUsedSize\":1048576,\"backingStorageSize\":65536}";
+    auto now = PerformanceSampler::Clock::time_point();
+    for (size_t i = 0; i < iterations; ++i) {
+      now += std::chrono::seconds(1);
+      sampler.BeginSample(now);
+      DoNotOptimize(sampler.EndSample(results[i % results.size()],
+                                      heap_usage, {}, now));
+    }
+  });
+
+  registry.Add("devtools/subscribe_unsubscribe", [](size_t iterations) {
+    DevToolsSubscriptions subscriptions(
+        [](const std::string& /*event*/) { return true; },
+        [](const std::string& /*event*/) {});
+    const std::string event = kEvent;
+    for (size_t i = 0; i < iterations; ++i) {
+      const auto first = subscriptions.Subscribe(event, DevToolsEventFilter());
+      const auto second =
+          subscriptions.Subscribe(event, DevToolsEventFilter());
+      subscriptions.Unsubscribe(first);
+      subscriptions.Unsubscribe(second);
+    }
+  });
+}
+
+}  // namespace bench
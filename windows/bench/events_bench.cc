@@ -0,0 +1,123 @@
+#include <flutter/encodable_value.h>
+
+#include <string>
+#include <utility>
+
+#include "benchmark.h"
+#include "util/event_subscriptions.h"
+#include "util/json_decoder.h"
+
+namespace bench {
+
+namespace {
+typedef util::JsonDecoder<flutter::EncodableValue, flutter::EncodableList,
+                          flutter::EncodableMap>
+    EncodableJsonDecoder;
+
+// Builds an event the way WebviewBridge does before sending it to Dart.
+flutter::EncodableValue MakeEvent(const char* type,
+                                  flutter::EncodableValue value) {
+  return flutter::EncodableValue(flutter::EncodableMap{
+      {flutter::EncodableValue("type"), flutter::EncodableValue(type)},
+      {flutter::EncodableValue("value"), std::move(value)}});
+}
+
+std::string MakeMessagePayload() {
+  return "{\"id\":42,\"method\":\"update\",\"params\":{\"title\":\"Inbox "
+         "(3)\",\"unread\":[101,102,103],\"visible\":true,\"ratio\":0.75,"
+         "\"tags\":[\"work\",\"\\u00e9t\\u00e9\",\"\\ud83d\\ude00\"]}}";
+}
+
+std::string MakeArrayPayload() {
+  std::string json = "[";
+  for (int i = 0; i < 512; ++i) {
+    json += (i ? "," : "") + std::to_string(i * 7919 % 100003) + "." +
+            std::to_string(i % 10);
+  }
+  return json + "]";
+}
+
+std::string MakeDocumentPayload() {
+  std::string json = "{\"items\":[";
+  for (int i = 0; i < 64; ++i) {
+    json += (i ? "," : "");
+    json += "{\"id\":" + std::to_string(i) +
+            ",\"name\":\"Item number " + std::to_string(i) +
+            "\",\"description\":\"A reasonably long description of the item "
+            "that contains no escapes at all\",\"price\":" +
+            std::to_string(i * 3) + ".99,\"available\":" +
+            (i % 3 ? "true" : "false") + ",\"parent\":null}";
+  }
+  return json + "]}";
+}
+
+void AddJsonBenchmark(Registry& registry, const char* name,
+                      std::string json) {
+  const auto size = json.size();
+  registry.Add(
+      std::string("json/decode/") + name,
+      [json = std::move(json)](size_t iterations) {
+        for (size_t i = 0; i < iterations; ++i) {
+          DoNotOptimize(EncodableJsonDecoder::Decode(json));
+        }
+      },
+      size);
+}
+}  // namespace
+
+void RegisterEventBenchmarks(Registry& registry) {
+  registry.Add("events/encode/urlChanged", [](size_t iterations) {
+    const std::string url =
+        "https://example.com/some/path/to/a/page?query=value#fragment";
+    for (size_t i = 0; i < iterations; ++i) {
+      DoNotOptimize(MakeEvent("urlChanged", flutter::EncodableValue(url)));
+    }
+  });
+
+  registry.Add("events/encode/loadingStateChanged", [](size_t iterations) {
+    for (size_t i = 0; i < iterations; ++i) {
+      DoNotOptimize(
+          MakeEvent("loadingStateChanged", flutter::EncodableValue(2)));
+    }
+  });
+
+  registry.Add("events/encode/historyChanged", [](size_t iterations) {
+    for (size_t i = 0; i < iterations; ++i) {
+      DoNotOptimize(MakeEvent(
+          "historyChanged",
+          flutter::EncodableValue(flutter::EncodableMap{
+              {flutter::EncodableValue("canGoBack"),
+               flutter::EncodableValue(true)},
+              {flutter::EncodableValue("canGoForward"),
+               flutter::EncodableValue(false)}})));
+    }
+  });
+
+  registry.Add("events/encode/webMessageReceived", [](size_t iterations) {
+    const auto message = MakeMessagePayload();
+    for (size_t i = 0; i < iterations; ++i) {
+      DoNotOptimize(
+          MakeEvent("webMessageReceived", flutter::EncodableValue(message)));
+    }
+  });
+
+  registry.Add("events/subscriptions/toggle", [](size_t iterations) {
+    util::EventSubscriptions subscriptions;
+    int registered = 0;
+    for (uint32_t bit = 1; bit < (1 << 8); bit <<= 1) {
+      subscriptions.AddHandler(
+          bit, [&registered]() { ++registered; },
+          [&registered]() { --registered; });
+    }
+    for (size_t i = 0; i < iterations; ++i) {
+      subscriptions.Update(i & 1 ? 0xff : 0x0f);
+    }
+    DoNotOptimize(registered);
+  });
+
+  AddJsonBenchmark(registry, "message", MakeMessagePayload());
+  AddJsonBenchmark(registry, "numbers", MakeArrayPayload());
+  AddJsonBenchmark(registry, "document", MakeDocumentPayload());
+}
+
+}  // namespace bench
@@ -0,0 +1,119 @@
+#include <chrono>
+#include <functional>
+#include <vector>
+
+#include "benchmark.h"
+#include "dispose_queue.h"
+#include "frame_pacer.h"
+#include "frame_scheduler.h"
+#include "suspend_policy.h"
+#include "util/flight_recorder.h"
+#include "util/trace.h"
+
+namespace bench {
+
+namespace {
+constexpr size_t kFrameBytes = 1920 * 1080 * 4;
+}  // namespace
+
+void RegisterFrameBenchmarks(Registry& registry) {
+  registry.Add("frame/scheduler/may_publish/no_budget", [](size_t iterations) {
+    FrameScheduler scheduler;
+    const auto client = scheduler.Register();
+    auto now = FrameScheduler::Clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+      now += std::chrono::milliseconds(16);
+      DoNotOptimize(scheduler.MayPublish(client, kFrameBytes, now));
+    }
+  });
+
+  registry.Add("frame/scheduler/may_publish/budget_8_clients",
+               [](size_t iterations) {
+                 FrameScheduler scheduler;
+                 scheduler.SetBudget({120.0, 500.0 * 1024 * 1024});
+                 std::vector<FrameScheduler::ClientId> clients;
+                 for (int i = 0; i < 8; ++i) {
+                   clients.push_back(scheduler.Register());
+                   scheduler.SetHints(clients.back(), {i == 0, true, 1.0});
+                 }
+                 auto now = FrameScheduler::Clock::now();
+                 for (size_t i = 0; i < iterations; ++i) {
+                   now += std::chrono::milliseconds(2);
+                   DoNotOptimize(scheduler.MayPublish(clients[i % 8],
+                                                      kFrameBytes, now));
+                 }
+               });
+
+  registry.Add("frame/pacer/fps_limit_and_budget", [](size_t iterations) {
+    FrameScheduler scheduler;
+    scheduler.SetBudget({120.0, std::nullopt});
+    FramePacer pacer;
+    pacer.SetFrameScheduler(&scheduler);
+    pacer.SetFpsLimit(60);
+    auto now = FramePacer::Clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+      now += std::chrono::milliseconds(8);
+      DoNotOptimize(pacer.OnFrameArrived(kFrameBytes, now));
+    }
+  });
+
+  registry.Add("frame/flight_recorder/record", [](size_t iterations) {
+    util::FlightRecorder recorder(16384);
+    for (size_t i = 0; i < iterations; ++i) {
+      recorder.Record(1, util::FlightEventType::kFrameArrived, i);
+    }
+  });
+
+  registry.Add("frame/flight_recorder/snapshot_encode", [](size_t iterations) {
+    util::FlightRecorder recorder(16384);
+    for (uint64_t i = 0; i < recorder.capacity(); ++i) {
+      recorder.Record(1, util::FlightEventType::kFrameCopied, i);
+    }
+    for (size_t i = 0; i < iterations; ++i) {
+      DoNotOptimize(util::FlightRecorder::Encode(recorder.Snapshot()));
+    }
+  });
+
+  registry.Add("trace/span/enabled", [](size_t iterations) {
+    util::SetTracingEnabled(true);
+    for (size_t i = 0; i < iterations; ++i) {
+      const util::ScopedTraceSpan span("Benchmark");
+    }
+  });
+
+  registry.Add("trace/span/disabled", [](size_t iterations) {
+    util::SetTracingEnabled(false);
+    for (size_t i = 0; i < iterations; ++i) {
+      const util::ScopedTraceSpan span("Benchmark");
+    }
+    util::SetTracingEnabled(true);
+  });
+
+  registry.Add("dispose_queue/enqueue_run_4_stages", [](size_t iterations) {
+    StagedDisposeQueue queue;
+    size_t stages_run = 0;
+    const std::function<void()> stage = [&stages_run]() { ++stages_run; };
+    for (size_t i = 0; i < iterations; ++i) {
+      queue.Enqueue({stage, stage, stage, stage});
+      queue.RunSlice(std::chrono::microseconds(100));
+    }
+    queue.Flush();
+    DoNotOptimize(stages_run);
+  });
+
+  registry.Add("suspend_policy/touch_evaluate_32", [](size_t iterations) {
+    SuspendPolicy policy;
+    policy.SetBudget({8, std::nullopt});
+    auto now = SuspendPolicy::Clock::now();
+    for (SuspendPolicy::InstanceId id = 0; id < 32; ++id) {
+      policy.Add(id, now);
+    }
+    for (size_t i = 0; i < iterations; ++i) {
+      now += std::chrono::milliseconds(1);
+      policy.Touch(static_cast<SuspendPolicy::InstanceId>(i % 32), now);
+      DoNotOptimize(policy.Evaluate(std::nullopt));
+    }
+  });
+}
+
+}  // namespace bench
@@ -0,0 +1,95 @@
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+#include "benchmark.h"
+#include "pointer_predictor.h"
+#include "util/keyed_object_pool.h"
+
+namespace bench {
+
+namespace {
+// Stands in for ICoreWebView2PointerInfo, which the environment allocates
+// on the heap.
+struct FakePointerInfo {
+  uint32_t pointer_id = 0;
+  uint32_t pointer_flags = 0;
+  uint32_t touch_mask = 0;
+  uint32_t touch_pressure = 0;
+  int32_t x = 0;
+  int32_t y = 0;
+};
+
+typedef std::shared_ptr<FakePointerInfo> FakePointerInfoPtr;
+
+void FillPointerInfo(FakePointerInfo& info, int32_t pointer, int32_t x) {
+  info.pointer_id = static_cast<uint32_t>(pointer);
+  info.pointer_flags = 0x4 | 0x2 | 0x20000;
+  info.touch_mask = 0x1 | 0x4;
+  info.touch_pressure = 1024;
+  info.x = x;
+  info.y = x / 2;
+}
+
+// A two-finger pan: each touch sends a down, |moves| updates and an up, and
+// every new touch gets a new pointer id.
+template <typename Send>
+void RunPan(size_t iterations, Send send) {
+  constexpr size_t kMoves = 64;
+  int32_t next_pointer = 1;
+  for (size_t i = 0; i < iterations; i += 2 * (kMoves + 2)) {
+    const int32_t first = next_pointer++;
+    const int32_t second = next_pointer++;
+    for (size_t move = 0; move < kMoves + 2; ++move) {
+      const bool up = move == kMoves + 1;
+      send(first, static_cast<int32_t>(move), up);
+      send(second, static_cast<int32_t>(move) + 100, up);
+    }
+  }
+}
+}  // namespace
+
+void RegisterInputBenchmarks(Registry& registry) {
+  registry.Add("input/pointer_info/create_per_update", [](size_t iterations) {
+    RunPan(iterations, [](int32_t pointer, int32_t x, bool /*up*/) {
+      const auto info = std::make_shared<FakePointerInfo>();
+      FillPointerInfo(*info, pointer, x);
+      DoNotOptimize(info);
+    });
+  });
+
+  registry.Add("input/pointer_info/keyed_pool", [](size_t iterations) {
+    util::KeyedObjectPool<int32_t, FakePointerInfoPtr> pool(
+        []() { return std::make_shared<FakePointerInfo>(); },
+        [](FakePointerInfoPtr& info) { *info = FakePointerInfo(); }, 10);
+    RunPan(iterations, [&pool](int32_t pointer, int32_t x, bool up) {
+      const auto info = pool.Acquire(pointer);
+      FillPointerInfo(*info, pointer, x);
+      DoNotOptimize(info);
+      if (up) {
+        pool.Release(pointer);
+      }
+    });
+  });
+
+  registry.Add("input/pointer_predictor/update", [](size_t iterations) {
+    PointerPredictor predictor;
+    PointerPredictor::Options options;
+    options.lookahead = std::chrono::milliseconds(16);
+    predictor.SetOptions(options);
+    int64_t timestamp_us = 0;
+    RunPan(iterations, [&](int32_t pointer, int32_t x, bool up) {
+      timestamp_us += 4166;
+      auto phase = PointerPredictor::Phase::kMove;
+      if (up) {
+        phase = PointerPredictor::Phase::kUp;
+      } else if (x % 100 == 0) {
+        phase = PointerPredictor::Phase::kDown;
+      }
+      DoNotOptimize(
+          predictor.Update(pointer, phase, timestamp_us, x * 2.0, x * 1.5));
+    });
+  });
+}
+
+}  // namespace bench
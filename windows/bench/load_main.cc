@@ -0,0 +1,380 @@
+// Runs texture bridges fed by synthetic frame sources against a fake
+// consumer, and reports throughput, drop rates and lock wait times.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "frame_pacer.h"
+#include "frame_scheduler.h"
+#include "synthetic_frame_source.h"
+#include "util/flight_recorder.h"
+
+namespace {
+constexpr char kUsage[] =
+    "Usage: webview_windows_load [options]\n"
+    "  --bridges=<n>            Number of texture bridges.\n"
+    "  --duration-ms=<ms>       Duration of the run.\n"
+    "  --fps=<n>                Frames per second produced by each source.\n"
+    "  --jitter=<pattern>       none, uniform or bursty.\n"
+    "  --jitter-amount=<x>      Strength of the jitter, from 0 to 1.\n"
+    "  --size=<w>x<h>           Initial frame size.\n"
+    "  --resize-storm-ms=<ms>   Resizes every bridge at this interval.\n"
+    "  --fps-limit=<n>          FPS limit of each bridge.\n"
+    "  --budget-fps=<n>         Plugin-wide frame budget.\n"
+    "  --budget-mbps=<n>        Plugin-wide copy budget in MB/s.\n"
+    "  --vsync-hz=<n>           Rate at which the consumer takes frames.\n"
+    "  --no-copy                Skips copying the frames' pixels.\n";
+
+typedef std::chrono::steady_clock Clock;
+
+int64_t ElapsedNs(Clock::time_point begin, Clock::time_point end) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin)
+      .count();
+}
+
+// Mirrors TextureBridge and TextureBridgeGpu::GetSurfaceDescriptor on top of
+// a SyntheticFrameSource, copying frames into a CPU buffer instead of a
+// shared texture. Lock waits are measured on both sides.
+class LoadBridge {
+ public:
+  struct Stats {
+    uint64_t arrived = 0;
+    uint64_t published = 0;
+    uint64_t dropped = 0;
+    uint64_t deferred = 0;
+    uint64_t consumed = 0;
+    uint64_t copied_bytes = 0;
+    std::vector<int64_t> producer_lock_wait_ns;
+    std::vector<int64_t> consumer_lock_wait_ns;
+  };
+
+  LoadBridge(uint32_t instance_id,
+             const bench::SyntheticFrameSource::Options& options,
+             FrameScheduler* frame_scheduler, std::optional<int> fps_limit,
+             bool copy)
+      : instance_id_(instance_id),
+        copy_(copy),
+        frame_source_(
+            std::make_unique<bench::SyntheticFrameSource>(options)) {
+    frame_pacer_.SetFrameScheduler(frame_scheduler);
+    frame_pacer_.SetFpsLimit(fps_limit);
+  }
+
+  ~LoadBridge() { Stop(); }
+
+  bool Start() {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    if (is_running_ || !frame_source_->Start([this]() { OnFrameArrived(); })) {
+      return false;
+    }
+    is_running_ = true;
+    return true;
+  }
+
+  void Stop() {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    if (is_running_) {
+      is_running_ = false;
+      frame_source_->Stop();
+    }
+  }
+
+  // Like a setSize call: the content changes size and the frame pool is
+  // recreated with the next frame.
+  void Resize(Size size) {
+    frame_source_->SetContentSize(size);
+    const std::lock_guard<std::mutex> lock(mutex_);
+    needs_update_ = true;
+  }
+
+  // Whether a frame was published since the last call, like
+  // MarkTextureFrameAvailable.
+  bool TakeFrameAvailable() { return frame_available_.exchange(false); }
+
+  // Copies the last frame, like TextureBridgeGpu::GetSurfaceDescriptor.
+  void Consume() {
+    const auto wait_start = Clock::now();
+    const std::lock_guard<std::mutex> lock(mutex_);
+    stats_.consumer_lock_wait_ns.push_back(
+        ElapsedNs(wait_start, Clock::now()));
+    if (!is_running_ || !last_frame_) {
+      return;
+    }
+
+    const auto& frame = *last_frame_;
+    const auto bytes = frame.size.width * frame.size.height * 4;
+    if (copy_ && frame.pixels) {
+      if (surface_.size() != bytes) {
+        surface_.resize(bytes);
+      }
+      std::memcpy(surface_.data(), frame.pixels->data(),
+                  std::min(bytes, frame.pixels->size()));
+    }
+    util::RecordFlightEvent(instance_id_, util::FlightEventType::kFrameCopied);
+    ++stats_.consumed;
+    stats_.copied_bytes += bytes;
+  }
+
+  Stats TakeStats() {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    return std::move(stats_);
+  }
+
+  bench::SyntheticFrameSource::Stats GetSourceStats() {
+    return frame_source_->GetStats();
+  }
+
+ private:
+  const uint32_t instance_id_;
+  const bool copy_;
+  std::mutex mutex_;
+  bool is_running_ = false;
+  bool needs_update_ = false;
+  FramePacer frame_pacer_;
+  std::optional<bench::SyntheticFrame> last_frame_;
+  std::atomic<bool> frame_available_ = false;
+  std::vector<uint8_t> surface_;
+  Stats stats_;
+  std::unique_ptr<bench::SyntheticFrameSource> frame_source_;
+
+  void OnFrameArrived() {
+    const auto wait_start = Clock::now();
+    const std::lock_guard<std::mutex> lock(mutex_);
+    stats_.producer_lock_wait_ns.push_back(
+        ElapsedNs(wait_start, Clock::now()));
+    if (!is_running_) {
+      return;
+    }
+
+    bool has_frame = false;
+    if (auto frame = frame_source_->TryGetNextFrame()) {
+      last_frame_ = std::move(frame);
+      ++stats_.arrived;
+      util::RecordFlightEvent(instance_id_,
+                              util::FlightEventType::kFrameArrived);
+      const auto bytes = last_frame_->size.width * last_frame_->size.height * 4;
+      const auto decision =
+          frame_pacer_.OnFrameArrived(bytes, FramePacer::Clock::now());
+      switch (decision) {
+        case FramePacer::Decision::kPublish:
+          has_frame = true;
+          ++stats_.published;
+          break;
+        case FramePacer::Decision::kDroppedByFpsLimit:
+          ++stats_.dropped;
+          break;
+        case FramePacer::Decision::kDeferredByScheduler:
+          ++stats_.deferred;
+          break;
+      }
+      if (!has_frame) {
+        util::RecordFlightEvent(instance_id_,
+                                util::FlightEventType::kFrameDropped,
+                                static_cast<uint64_t>(decision));
+      }
+    }
+
+    if (needs_update_) {
+      frame_source_->Recreate();
+      needs_update_ = false;
+    }
+
+    if (has_frame) {
+      frame_available_ = true;
+    }
+  }
+};
+
+bool GetFlag(std::string_view arg, std::string_view name, std::string& value) {
+  if (arg.substr(0, name.size()) != name) {
+    return false;
+  }
+  value = std::string(arg.substr(name.size()));
+  return true;
+}
+
+int64_t Percentile(const std::vector<int64_t>& sorted, double fraction) {
+  if (sorted.empty()) {
+    return 0;
+  }
+  return sorted[static_cast<size_t>(fraction * (sorted.size() - 1))];
+}
+
+void PrintLockWaits(const char* name, std::vector<int64_t>& samples) {
+  std::sort(samples.begin(), samples.end());
+  std::printf("%s lock wait: p50 %.2f us, p99 %.2f us, max %.2f us\n", name,
+              Percentile(samples, 0.5) / 1000.0,
+              Percentile(samples, 0.99) / 1000.0,
+              samples.empty() ? 0.0 : samples.back() / 1000.0);
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+  size_t bridge_count = 4;
+  std::chrono::milliseconds duration(5000);
+  bench::SyntheticFrameSource::Options options;
+  std::optional<std::chrono::milliseconds> resize_interval;
+  std::optional<int> fps_limit;
+  FrameScheduler::Budget budget;
+  double vsync_hz = 60;
+  bool copy = true;
+
+  for (int i = 1; i < argc; ++i) {
+    const std::string_view arg = argv[i];
+    std::string value;
+    if (GetFlag(arg, "--bridges=", value)) {
+      bridge_count = std::max(std::atoi(value.c_str()), 1);
+    } else if (GetFlag(arg, "--duration-ms=", value)) {
+      duration = std::chrono::milliseconds(std::atoi(value.c_str()));
+    } else if (GetFlag(arg, "--fps=", value)) {
+      options.frames_per_second = std::max(std::atof(value.c_str()), 1.0);
+    } else if (GetFlag(arg, "--jitter=", value) &&
+               (value == "none" || value == "uniform" || value == "bursty")) {
+      options.jitter =
+          value == "none"      ? bench::SyntheticFrameSource::Jitter::kNone
+          : value == "uniform" ? bench::SyntheticFrameSource::Jitter::kUniform
+                               : bench::SyntheticFrameSource::Jitter::kBursty;
+    } else if (GetFlag(arg, "--jitter-amount=", value)) {
+      options.jitter_amount = std::atof(value.c_str());
+    } else if (GetFlag(arg, "--size=", value) &&
+               value.find('x') != std::string::npos) {
+      options.size = {
+          static_cast<size_t>(std::atoi(value.c_str())),
+          static_cast<size_t>(std::atoi(value.c_str() + value.find('x') + 1))};
+    } else if (GetFlag(arg, "--resize-storm-ms=", value)) {
+      resize_interval =
+          std::chrono::milliseconds(std::max(std::atoi(value.c_str()), 1));
+    } else if (GetFlag(arg, "--fps-limit=", value)) {
+      fps_limit = std::atoi(value.c_str());
+    } else if (GetFlag(arg, "--budget-fps=", value)) {
+      budget.frames_per_second = std::atof(value.c_str());
+    } else if (GetFlag(arg, "--budget-mbps=", value)) {
+      budget.copy_bytes_per_second = std::atof(value.c_str()) * 1024 * 1024;
+    } else if (GetFlag(arg, "--vsync-hz=", value)) {
+      vsync_hz = std::max(std::atof(value.c_str()), 1.0);
+    } else if (arg == "--no-copy") {
+      copy = false;
+    } else {
+      std::fputs(kUsage, stderr);
+      return 2;
+    }
+  }
+  options.allocate_pixels = copy;
+
+  FrameScheduler frame_scheduler;
+  frame_scheduler.SetBudget(budget);
+
+  std::vector<std::unique_ptr<LoadBridge>> bridges;
+  for (size_t i = 0; i < bridge_count; ++i) {
+    options.seed = static_cast<uint32_t>(i + 1);
+    bridges.push_back(std::make_unique<LoadBridge>(
+        static_cast<uint32_t>(i + 1), options, &frame_scheduler, fps_limit,
+        copy));
+  }
+
+  const auto start = Clock::now();
+  for (auto& bridge : bridges) {
+    bridge->Start();
+  }
+
+  // A single consumer thread, like the raster thread serving all textures.
+  std::atomic<bool> stop = false;
+  std::thread consumer([&]() {
+    const auto interval = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(1.0 / vsync_hz));
+    auto next = Clock::now();
+    while (!stop) {
+      next += interval;
+      std::this_thread::sleep_until(next);
+      for (auto& bridge : bridges) {
+        if (bridge->TakeFrameAvailable()) {
+          bridge->Consume();
+        }
+      }
+    }
+  });
+
+  std::mt19937 random(0);
+  std::uniform_int_distribution<size_t> width(320, 2560);
+  std::uniform_int_distribution<size_t> height(240, 1440);
+  while (Clock::now() - start < duration) {
+    if (!resize_interval) {
+      std::this_thread::sleep_until(start + duration);
+      break;
+    }
+    std::this_thread::sleep_for(*resize_interval);
+    for (auto& bridge : bridges) {
+      bridge->Resize({width(random), height(random)});
+    }
+  }
+
+  stop = true;
+  consumer.join();
+  for (auto& bridge : bridges) {
+    bridge->Stop();
+  }
+  const auto seconds =
+      std::chrono::duration<double>(Clock::now() - start).count();
+
+  LoadBridge::Stats total;
+  bench::SyntheticFrameSource::Stats source_total;
+  std::printf("%-8s %9s %9s %9s %9s %9s %9s %9s\n", "bridge", "produced",
+              "lost", "arrived", "dropped", "deferred", "consumed", "fps");
+  for (size_t i = 0; i < bridges.size(); ++i) {
+    auto stats = bridges[i]->TakeStats();
+    const auto source_stats = bridges[i]->GetSourceStats();
+    std::printf("%-8zu %9llu %9llu %9llu %9llu %9llu %9llu %9.1f\n", i + 1,
+                static_cast<unsigned long long>(source_stats.produced),
+                static_cast<unsigned long long>(source_stats.overwritten),
+                static_cast<unsigned long long>(stats.arrived),
+                static_cast<unsigned long long>(stats.dropped),
+                static_cast<unsigned long long>(stats.deferred),
+                static_cast<unsigned long long>(stats.consumed),
+                stats.consumed / seconds);
+
+    source_total.produced += source_stats.produced;
+    source_total.overwritten += source_stats.overwritten;
+    source_total.recreated += source_stats.recreated;
+    total.arrived += stats.arrived;
+    total.published += stats.published;
+    total.dropped += stats.dropped;
+    total.deferred += stats.deferred;
+    total.consumed += stats.consumed;
+    total.copied_bytes += stats.copied_bytes;
+    total.producer_lock_wait_ns.insert(total.producer_lock_wait_ns.end(),
+                                       stats.producer_lock_wait_ns.begin(),
+                                       stats.producer_lock_wait_ns.end());
+    total.consumer_lock_wait_ns.insert(total.consumer_lock_wait_ns.end(),
+                                       stats.consumer_lock_wait_ns.begin(),
+                                       stats.consumer_lock_wait_ns.end());
+  }
+
+  const auto produced = std::max<uint64_t>(source_total.produced, 1);
+  std::printf(
+      "throughput: %.1f frames/s, %.1f MB/s copied, %llu pool recreations\n",
+      total.consumed / seconds, total.copied_bytes / seconds / 1024 / 1024,
+      static_cast<unsigned long long>(source_total.recreated));
+  std::printf(
+      "drop rate: %.1f%% (lost in source %.1f%%, fps limit %.1f%%, "
+      "budget %.1f%%, not consumed %.1f%%)\n",
+      100.0 * (produced - total.consumed) / produced,
+      100.0 * source_total.overwritten / produced,
+      100.0 * total.dropped / produced, 100.0 * total.deferred / produced,
+      100.0 * (total.published - std::min(total.published, total.consumed)) /
+          produced);
+  PrintLockWaits("producer", total.producer_lock_wait_ns);
+  PrintLockWaits("consumer", total.consumer_lock_wait_ns);
+  return 0;
+}
@@ -0,0 +1,86 @@
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "benchmark.h"
+#include "frame_scheduler.h"
+#include "util/factory_cache.h"
+
+namespace bench {
+
+namespace {
+// Runs |work| on a background thread for the lifetime of the object.
+class BackgroundLoad {
+ public:
+  template <typename Work>
+  explicit BackgroundLoad(Work work)
+      : thread_([this, work]() {
+          while (!stop_.load(std::memory_order_relaxed)) {
+            work();
+          }
+        }) {}
+
+  ~BackgroundLoad() {
+    stop_ = true;
+    thread_.join();
+  }
+
+ private:
+  std::atomic<bool> stop_ = false;
+  std::thread thread_;
+};
+}  // namespace
+
+void RegisterLockingBenchmarks(Registry& registry) {
+  registry.Add("lock/mutex/uncontended", [](size_t iterations) {
+    std::mutex mutex;
+    size_t counter = 0;
+    for (size_t i = 0; i < iterations; ++i) {
+      const std::lock_guard<std::mutex> lock(mutex);
+      ++counter;
+    }
+    DoNotOptimize(counter);
+  });
+
+  registry.Add("lock/mutex/contended", [](size_t iterations) {
+    std::mutex mutex;
+    size_t counter = 0;
+    const BackgroundLoad load([&mutex, &counter]() {
+      const std::lock_guard<std::mutex> lock(mutex);
+      ++counter;
+    });
+    for (size_t i = 0; i < iterations; ++i) {
+      const std::lock_guard<std::mutex> lock(mutex);
+      ++counter;
+    }
+    DoNotOptimize(counter);
+  });
+
+  registry.Add("lock/factory_cache/get", [](size_t iterations) {
+    util::FactoryCache<std::wstring, std::shared_ptr<int>> cache(
+        [](const std::wstring&) { return std::make_shared<int>(1); });
+    const std::wstring key = L"Windows.UI.Composition.Compositor";
+    for (size_t i = 0; i < iterations; ++i) {
+      DoNotOptimize(cache.Get(key));
+    }
+  });
+
+  // Frame pacing while another texture bridge publishes concurrently.
+  registry.Add("lock/frame_scheduler/contended", [](size_t iterations) {
+    FrameScheduler scheduler;
+    scheduler.SetBudget({240.0, std::nullopt});
+    const auto client = scheduler.Register();
+    const auto other = scheduler.Register();
+    const BackgroundLoad load([&scheduler, other]() {
+      scheduler.MayPublish(other, 0, FrameScheduler::Clock::now());
+    });
+    for (size_t i = 0; i < iterations; ++i) {
+      DoNotOptimize(
+          scheduler.MayPublish(client, 0, FrameScheduler::Clock::now()));
+    }
+  });
+}
+
+}  // namespace bench
@@ -0,0 +1,802 @@
+#include "replay_bridge.h"
+
+#include <algorithm>
+#include <chrono>
+#include <string_view>
+
+#include "method_args.h"
+
+namespace bench {
+
+namespace {
+// Same names as in webview_bridge.cc.
+constexpr auto kMethodLoadUrl = "loadUrl";
+constexpr auto kMethodLoadStringContent = "loadStringContent";
+constexpr auto kMethodReload = "reload";
+constexpr auto kMethodStop = "stop";
+constexpr auto kMethodGoBack = "goBack";
+constexpr auto kMethodGoForward = "goForward";
+constexpr auto kMethodAddScriptToExecuteOnDocumentCreated =
+    "addScriptToExecuteOnDocumentCreated";
+constexpr auto kMethodRemoveScriptToExecuteOnDocumentCreated =
+    "removeScriptToExecuteOnDocumentCreated";
+constexpr auto kMethodExecuteScript = "executeScript";
+constexpr auto kMethodPostWebMessage = "postWebMessage";
+constexpr auto kMethodSetSize = "setSize";
+constexpr auto kMethodSetCursorPos = "setCursorPos";
+constexpr auto kMethodSetPointerUpdate = "setPointerUpdate";
+constexpr auto kMethodSetPointerButton = "setPointerButton";
+constexpr auto kMethodSetScrollDelta = "setScrollDelta";
+constexpr auto kMethodSetUserAgent = "setUserAgent";
+constexpr auto kMethodSetBackgroundColor = "setBackgroundColor";
+constexpr auto kMethodSetZoomFactor = "setZoomFactor";
+constexpr auto kMethodOpenDevTools = "openDevTools";
+constexpr auto kMethodSuspend = "suspend";
+constexpr auto kMethodResume = "resume";
+constexpr auto kMethodSetVirtualHostNameMapping = "setVirtualHostNameMapping";
+constexpr auto kMethodClearVirtualHostNameMapping =
+    "clearVirtualHostNameMapping";
+constexpr auto kMethodSetVirtualHostNameArchiveMapping =
+    "setVirtualHostNameArchiveMapping";
+constexpr auto kMethodSetResponseCache = "setResponseCache";
+constexpr auto kMethodClearResponseCache = "clearResponseCache";
+constexpr auto kMethodSetUrlFilter = "setUrlFilter";
+constexpr auto kMethodGetUrlFilterHits = "getUrlFilterHits";
+constexpr auto kMethodCallDevToolsProtocolMethod = "callDevToolsProtocolMethod";
+constexpr auto kMethodSubscribeDevToolsProtocolEvent =
+    "subscribeDevToolsProtocolEvent";
+constexpr auto kMethodUnsubscribeDevToolsProtocolEvent =
+    "unsubscribeDevToolsProtocolEvent";
+constexpr auto kMethodSetPerformanceMetricsSampling =
+    "setPerformanceMetricsSampling";
+constexpr auto kMethodClearCookies = "clearCookies";
+constexpr auto kMethodClearCache = "clearCache";
+constexpr auto kMethodSetCacheDisabled = "setCacheDisabled";
+constexpr auto kMethodSetPopupWindowPolicy = "setPopupWindowPolicy";
+constexpr auto kMethodSetPermissionDecision = "setPermissionDecision";
+constexpr auto kMethodClearPermissionDecisions = "clearPermissionDecisions";
+constexpr auto kMethodSetPermissionAnswerTtl = "setPermissionAnswerTtl";
+constexpr auto kMethodSetFrameSchedulingHints = "setFrameSchedulingHints";
+constexpr auto kMethodSetEventSubscriptions = "setEventSubscriptions";
+constexpr auto kMethodGetSuppressedEventCounts = "getSuppressedEventCounts";
+constexpr auto kMethodSetNativeJsonDecoding = "setNativeJsonDecoding";
+constexpr auto kMethodSetFpsLimit = "setFpsLimit";
+constexpr auto kMethodSetTouchPrediction = "setTouchPrediction";
+
+int64_t GetArrivalTimestamp() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+bool IsInteraction(const std::string& method_name) {
+  for (const auto name :
+       {kMethodSetCursorPos, kMethodSetPointerUpdate, kMethodSetPointerButton,
+        kMethodSetScrollDelta, kMethodLoadUrl, kMethodLoadStringContent,
+        kMethodReload, kMethodGoBack, kMethodGoForward, kMethodExecuteScript,
+        kMethodPostWebMessage, kMethodOpenDevTools, kMethodResume}) {
+    if (method_name.compare(name) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+}  // namespace
+
+std::optional<PointerPredictor::Phase> GetPointerPhase(int32_t event) {
+  switch (event) {
+    case 1:  // Down
+      return PointerPredictor::Phase::kDown;
+    case 5:  // Update
+      return PointerPredictor::Phase::kMove;
+    case 3:  // Leave
+    case 4:  // Up
+      return PointerPredictor::Phase::kUp;
+    default:
+      return std::nullopt;
+  }
+}
+
+void FakeWebview::SetCursorPos(double x, double y) {
+  ++operation_count_;
+  cursor_x_ = x;
+  cursor_y_ = y;
+}
+
+void FakeWebview::SetPointerUpdate(int32_t /*pointer*/, int32_t /*event*/,
+                                   double x, double y, double /*size*/,
+                                   double /*pressure*/) {
+  ++operation_count_;
+  cursor_x_ = x;
+  cursor_y_ = y;
+}
+
+void FakeWebview::SetPointerButtonState(int32_t button, bool is_down) {
+  ++operation_count_;
+  const auto bit = 1u << (static_cast<uint32_t>(button) & 31);
+  buttons_ = is_down ? buttons_ | bit : buttons_ & ~bit;
+}
+
+void FakeWebview::SetScrollDelta(double /*delta_x*/, double /*delta_y*/) {
+  ++operation_count_;
+}
+
+void FakeWebview::SetSurfaceSize(size_t width, size_t height,
+                                 float scale_factor) {
+  ++operation_count_;
+  width_ = width;
+  height_ = height;
+  scale_factor_ = scale_factor;
+}
+
+void FakeWebview::LoadUrl(const std::string& url) {
+  ++operation_count_;
+  url_ = url;
+}
+
+void FakeWebview::LoadStringContent(const std::string& /*content*/) {
+  ++operation_count_;
+  url_ = "about:blank";
+}
+
+bool FakeWebview::Reload() {
+  ++operation_count_;
+  return true;
+}
+
+bool FakeWebview::Stop() {
+  ++operation_count_;
+  return true;
+}
+
+bool FakeWebview::GoBack() {
+  ++operation_count_;
+  return true;
+}
+
+bool FakeWebview::GoForward() {
+  ++operation_count_;
+  return true;
+}
+
+void FakeWebview::Suspend() { ++operation_count_; }
+
+void FakeWebview::Resume() { ++operation_count_; }
+
+void FakeWebview::SetVirtualHostNameMapping(const std::string& /*host_name*/,
+                                            const std::string& /*path*/,
+                                            int32_t /*access_kind*/) {
+  ++operation_count_;
+}
+
+void FakeWebview::SetVirtualHostNameArchiveMapping(
+    const std::string& host_name, std::shared_ptr<const AssetArchive> archive,
+    const std::string& fallback_path) {
+  ++operation_count_;
+  asset_server_.SetMapping(host_name, std::move(archive), fallback_path);
+}
+
+bool FakeWebview::ClearVirtualHostNameMapping(const std::string& host_name) {
+  ++operation_count_;
+  asset_server_.ClearMapping(host_name);
+  return true;
+}
+
+void FakeWebview::SetResponseCache(std::shared_ptr<ResponseCache> cache,
+                                   std::vector<CachePolicy::Rule> rules) {
+  ++operation_count_;
+  if (!cache || rules.empty()) {
+    cache.reset();
+    rules.clear();
+  }
+  response_cache_ = std::move(cache);
+  cache_policy_.SetRules(std::move(rules));
+}
+
+void FakeWebview::SetUrlFilter(std::unique_ptr<UrlFilter> filter) {
+  ++operation_count_;
+  url_filter_ = std::move(filter);
+}
+
+std::string FakeWebview::AddScriptToExecuteOnDocumentCreated(
+    const std::string& script) {
+  ++operation_count_;
+  scripts_.push_back(script);
+  return std::to_string(next_script_id_++);
+}
+
+void FakeWebview::RemoveScriptToExecuteOnDocumentCreated(
+    const std::string& /*script_id*/) {
+  ++operation_count_;
+}
+
+void FakeWebview::ExecuteScript(const std::string& /*script*/) {
+  ++operation_count_;
+}
+
+void FakeWebview::CallDevToolsProtocolMethod(const std::string& /*method*/,
+                                             const std::string& /*params*/) {
+  ++operation_count_;
+}
+
+DevToolsSubscriptions::Id FakeWebview::SubscribeDevToolsProtocolEvent(
+    const std::string& event, DevToolsEventFilter filter) {
+  ++operation_count_;
+  return devtools_subscriptions_.Subscribe(event, std::move(filter));
+}
+
+bool FakeWebview::UnsubscribeDevToolsProtocolEvent(
+    DevToolsSubscriptions::Id id) {
+  ++operation_count_;
+  return devtools_subscriptions_.Unsubscribe(id);
+}
+
+bool FakeWebview::PostWebMessage(const std::string& /*message*/) {
+  ++operation_count_;
+  return true;
+}
+
+bool FakeWebview::SetUserAgent(const std::string& user_agent) {
+  ++operation_count_;
+  user_agent_ = user_agent;
+  return true;
+}
+
+bool FakeWebview::SetBackgroundColor(int32_t /*color*/) {
+  ++operation_count_;
+  return true;
+}
+
+bool FakeWebview::SetZoomFactor(double factor) {
+  ++operation_count_;
+  zoom_factor_ = factor;
+  return true;
+}
+
+bool FakeWebview::OpenDevTools() {
+  ++operation_count_;
+  return true;
+}
+
+bool FakeWebview::ClearCookies() {
+  ++operation_count_;
+  return true;
+}
+
+bool FakeWebview::ClearCache() {
+  ++operation_count_;
+  return true;
+}
+
+bool FakeWebview::SetCacheDisabled(bool /*disabled*/) {
+  ++operation_count_;
+  return true;
+}
+
+void FakeWebview::SetPopupWindowPolicy(int32_t /*policy*/) {
+  ++operation_count_;
+}
+
+void FakeWebview::SetEventSubscriptions(uint32_t subscriptions) {
+  ++operation_count_;
+  subscriptions_ = subscriptions;
+}
+
+void ReplayBridge::Suspend() {
+  if (suspended_) {
+    return;
+  }
+  suspended_ = true;
+  texture_bridge_.Stop();
+  webview_.Suspend();
+}
+
+void ReplayBridge::Resume() {
+  if (!suspended_) {
+    return;
+  }
+  suspended_ = false;
+  webview_.Resume();
+  texture_bridge_.Start();
+}
+
+void ReplayBridge::SetPerformanceSampling(std::chrono::milliseconds interval,
+                                          bool include_memory) {
+  const bool was_sampling = performance_sampler_ != nullptr;
+  performance_sampler_ = nullptr;
+  if (interval.count() > 0) {
+    performance_sampler_ = std::make_shared<PerformanceSampler>(
+        std::max<PerformanceSampler::Clock::duration>(
+            interval, std::chrono::milliseconds(100)),
+        include_memory);
+    if (!was_sampling) {
+      webview_.CallDevToolsProtocolMethod("Performance.enable", "{}");
+    }
+    texture_bridge_.TakeFrameCounts();
+  } else if (was_sampling) {
+    webview_.CallDevToolsProtocolMethod("Performance.disable", "{}");
+  }
+}
+
+ReplayBridge::Outcome ReplayBridge::HandleMethodCall(
+    const flutter::MethodCall<flutter::EncodableValue>& method_call) {
+  const auto& method_name = method_call.method_name();
+  const auto arguments = method_call.arguments();
+
+  if (interaction_callback_ && IsInteraction(method_name)) {
+    interaction_callback_();
+  }
+
+  if (method_name.compare(kMethodSetCursorPos) == 0) {
+    if (const auto point = GetPointFromArgs(arguments)) {
+      webview_.SetCursorPos(point->first, point->second);
+      return Outcome::kSuccess;
+    }
+    return Outcome::kError;
+  }
+
+  if (method_name.compare(kMethodSetPointerUpdate) == 0) {
+    const auto list = std::get_if<flutter::EncodableList>(arguments);
+    if (!list || (list->size() != 6 && list->size() != 7)) {
+      return Outcome::kError;
+    }
+    std::optional<int64_t> timestamp_us;
+    if (list->size() == 7) {
+      timestamp_us = GetIntegerValue((*list)[6]);
+      if (!timestamp_us) {
+        return Outcome::kError;
+      }
+    }
+    const auto pointer = std::get_if<int32_t>(&(*list)[0]);
+    const auto event = std::get_if<int32_t>(&(*list)[1]);
+    const auto x = std::get_if<double>(&(*list)[2]);
+    const auto y = std::get_if<double>(&(*list)[3]);
+    const auto size = std::get_if<double>(&(*list)[4]);
+    const auto pressure = std::get_if<double>(&(*list)[5]);
+    if (pointer && event && x && y && size && pressure) {
+      auto position = std::make_pair(*x, *y);
+      const auto phase = GetPointerPhase(*event);
+      if (phase && pointer_predictor_.enabled()) {
+        position = pointer_predictor_.Update(
+            *pointer, *phase, timestamp_us.value_or(GetArrivalTimestamp()), *x,
+            *y);
+      }
+      webview_.SetPointerUpdate(*pointer, *event, position.first,
+                                position.second, *size, *pressure);
+      return Outcome::kSuccess;
+    }
+    return Outcome::kError;
+  }
+
+  if (method_name.compare(kMethodSetScrollDelta) == 0) {
+    if (const auto delta = GetPointFromArgs(arguments)) {
+      webview_.SetScrollDelta(delta->first, delta->second);
+      return Outcome::kSuccess;
+    }
+    return Outcome::kError;
+  }
+
+  if (method_name.compare(kMethodSetPointerButton) == 0) {
+    const auto map = std::get_if<flutter::EncodableMap>(arguments);
+    if (!map) {
+      return Outcome::kError;
+    }
+    const auto button = GetOptionalValue<int32_t>(*map, "button");
+    const auto is_down = GetOptionalValue<bool>(*map, "isDown");
+    if (button && is_down) {
+      webview_.SetPointerButtonState(*button, *is_down);
+      return Outcome::kSuccess;
+    }
+    return Outcome::kError;
+  }
+
+  if (method_name.compare(kMethodSetSize) == 0) {
+    if (const auto size = GetPointAndScaleFactorFromArgs(arguments)) {
+      const auto [width, height, scale_factor] = size.value();
+      webview_.SetSurfaceSize(static_cast<size_t>(width),
+                              static_cast<size_t>(height),
+                              static_cast<float>(scale_factor));
+      if (!suspended_) {
+        texture_bridge_.Start();
+      }
+      return Outcome::kSuccess;
+    }
+    return Outcome::kError;
+  }
+
+  if (method_name.compare(kMethodLoadUrl) == 0) {
+    if (const auto url = std::get_if<std::string>(arguments)) {
+      webview_.LoadUrl(*url);
+      return Outcome::kSuccess;
+    }
+    return Outcome::kError;
+  }
+
+  if (method_name.compare(kMethodLoadStringContent) == 0) {
+    if (const auto content = std::get_if<std::string>(arguments)) {
+      webview_.LoadStringContent(*content);
+      return Outcome::kSuccess;
+    }
+    return Outcome::kError;
+  }
+
+  if (method_name.compare(kMethodReload) == 0) {
+    return webview_.Reload() ? Outcome::kSuccess : Outcome::kError;
+  }
+
+  if (method_name.compare(kMethodStop) == 0) {
+    return webview_.Stop() ? Outcome::kSuccess : Outcome::kError;
+  }
+
+  if (method_name.compare(kMethodGoBack) == 0) {
+    return webview_.GoBack() ? Outcome::kSuccess : Outcome::kError;
+  }
+
+  if (method_name.compare(kMethodGoForward) == 0) {
+    return webview_.GoForward() ? Outcome::kSuccess : Outcome::kError;
+  }
+
+  if (method_name.compare(kMethodSuspend) == 0) {
+    Suspend();
+    return Outcome::kSuccess;
+  }
+
+  if (method_name.compare(kMethodResume) == 0) {
+    Resume();
+    return Outcome::kSuccess;
+  }
+
+  if (method_name.compare(kMethodSetVirtualHostNameMapping) == 0) {
+    const auto list = std::get_if<flutter::EncodableList>(arguments);
+    if (!list || list->size() != 3) {
+      return Outcome::kError;
+    }
+    const auto host_name = std::get_if<std::string>(&(*list)[0]);
+    const auto path = std::get_if<std::string>(&(*list)[1]);
+    const auto access_kind = std::get_if<int32_t>(&(*list)[2]);
+    if (host_name && path && access_kind) {
+      webview_.SetVirtualHostNameMapping(*host_name, *path, *access_kind);
+      return Outcome::kSuccess;
+    }
+    return Outcome::kError;
+  }
+
+  if (method_name.compare(kMethodSetVirtualHostNameArchiveMapping) == 0) {
+    const auto map = std::get_if<flutter::EncodableMap>(arguments);
+    if (!map) {
+      return Outcome::kError;
+    }
+    const auto host_name = GetOptionalValue<std::string>(*map, "hostName");
+    const auto path = GetOptionalValue<std::string>(*map, "path");
+    if (!host_name || !path) {
+      return Outcome::kError;
+    }
+    std::string error;
+    auto archive = AssetArchive::OpenShared(*path, error);
+    if (!archive) {
+      return Outcome::kError;
+    }
+    webview_.SetVirtualHostNameArchiveMapping(
+        *host_name, std::move(archive),
+        GetOptionalValue<std::string>(*map, "fallbackPath")
+            .value_or(std::string()));
+    return Outcome::kSuccess;
+  }
+
+  if (method_name.compare(kMethodClearVirtualHostNameMapping) == 0) {
+    const auto host_name = std::get_if<std::string>(arguments);
+    return host_name && webview_.ClearVirtualHostNameMapping(*host_name)
+               ? Outcome::kSuccess
+               : Outcome::kError;
+  }
+
+  if (method_name.compare(kMethodSetResponseCache) == 0) {
+    const auto map = std::get_if<flutter::EncodableMap>(arguments);
+    if (!map) {
+      return Outcome::kError;
+    }
+    const auto path = GetOptionalValue<std::string>(*map, "path");
+    const auto rules_it = map->find(flutter::EncodableValue("rules"));
+    if (!path || rules_it == map->end()) {
+      return Outcome::kError;
+    }
+    auto rules = GetCacheRulesFromArgs(&rules_it->second);
+    if (!rules) {
+      return Outcome::kError;
+    }
+    std::shared_ptr<ResponseCache> cache;
+    if (!rules->empty()) {
+      std::string error;
+      cache = ResponseCache::OpenShared(*path, error);
+      if (!cache) {
+        return Outcome::kError;
+      }
+      ResponseCache::Limits limits;
+      if (const auto bytes = GetOptionalInteger(*map, "maxMemoryBytes")) {
+        limits.max_memory_bytes =
+            static_cast<uint64_t>(std::max<int64_t>(*bytes, 0));
+      }
+      if (const auto bytes = GetOptionalInteger(*map, "maxDiskBytes")) {
+        limits.max_disk_bytes =
+            static_cast<uint64_t>(std::max<int64_t>(*bytes, 0));
+      }
+      cache->SetLimits(limits);
+    }
+    webview_.SetResponseCache(std::move(cache), std::move(*rules));
+    return Outcome::kSuccess;
+  }
+
+  if (method_name.compare(kMethodClearResponseCache) == 0) {
+    if (const auto cache = webview_.response_cache()) {
+      cache->Clear();
+    }
+    return Outcome::kSuccess;
+  }
+
+  if (method_name.compare(kMethodSetUrlFilter) == 0) {
+    const auto rules = std::get_if<std::string>(arguments);
+    if (!rules) {
+      return Outcome::kError;
+    }
+    webview_.SetUrlFilter(rules->empty() ? nullptr
+                                         : UrlFilter::Compile(*rules));
+    return Outcome::kSuccess;
+  }
+
+  if (method_name.compare(kMethodGetUrlFilterHits) == 0) {
+    const auto map = std::get_if<flutter::EncodableMap>(arguments);
+    if (const auto filter = webview_.url_filter()) {
+      filter->GetHits();
+      if (map && GetOptionalValue<bool>(*map, "reset").value_or(false)) {
+        filter->ResetHits();
+      }
+    }
+    return Outcome::kSuccess;
+  }
+
+  if (method_name.compare(kMethodCallDevToolsProtocolMethod) == 0) {
+    const auto map = std::get_if<flutter::EncodableMap>(arguments);
+    const auto method =
+        map ? GetOptionalValue<std::string>(*map, "method") : std::nullopt;
+    if (!method) {
+      return Outcome::kError;
+    }
+    webview_.CallDevToolsProtocolMethod(
+        *method, GetOptionalValue<std::string>(*map, "params").value_or("{}"));
+    return Outcome::kSuccess;
+  }
+
+  if (method_name.compare(kMethodSubscribeDevToolsProtocolEvent) == 0) {
+    const auto map = std::get_if<flutter::EncodableMap>(arguments);
+    const auto event =
+        map ? GetOptionalValue<std::string>(*map, "event") : std::nullopt;
+    if (!event) {
+      return Outcome::kError;
+    }
+    const auto it = map->find(flutter::EncodableValue("filter"));
+    auto filter = GetDevToolsEventFilterFromArgs(
+        it != map->end() ? &it->second : nullptr);
+    if (!filter) {
+      return Outcome::kError;
+    }
+    webview_.SubscribeDevToolsProtocolEvent(*event, std::move(*filter));
+    return Outcome::kSuccess;
+  }
+
+  if (method_name.compare(kMethodUnsubscribeDevToolsProtocolEvent) == 0) {
+    const auto subscription =
+        arguments ? GetIntegerValue(*arguments) : std::nullopt;
+    if (!subscription) {
+      return Outcome::kError;
+    }
+    webview_.UnsubscribeDevToolsProtocolEvent(
+        static_cast<DevToolsSubscriptions::Id>(*subscription));
+    return Outcome::kSuccess;
+  }
+
+  if (method_name.compare(kMethodSetPerformanceMetricsSampling) == 0) {
+    const auto map = std::get_if<flutter::EncodableMap>(arguments);
+    const auto interval_ms =
+        map ? GetOptionalInteger(*map, "intervalMs") : std::nullopt;
+    if (!interval_ms || *interval_ms < 0) {
+      return Outcome::kError;
+    }
+    SetPerformanceSampling(
+        std::chrono::milliseconds(*interval_ms),
+        GetOptionalValue<bool>(*map, "includeMemory").value_or(false));
+    return Outcome::kSuccess;
+  }
+
+  if (method_name.compare(kMethodAddScriptToExecuteOnDocumentCreated) == 0) {
+    if (const auto script = std::get_if<std::string>(arguments)) {
+      webview_.AddScriptToExecuteOnDocumentCreated(*script);
+      return Outcome::kSuccess;
+    }
+    return Outcome::kError;
+  }
+
+  if (method_name.compare(kMethodRemoveScriptToExecuteOnDocumentCreated) == 0) {
+    if (const auto script_id = std::get_if<std::string>(arguments)) {
+      webview_.RemoveScriptToExecuteOnDocumentCreated(*script_id);
+      return Outcome::kSuccess;
+    }
+    return Outcome::kError;
+  }
+
+  if (method_name.compare(kMethodExecuteScript) == 0) {
+    std::optional<std::string> script;
+    if (const auto value = std::get_if<std::string>(arguments)) {
+      script = *value;
+    } else if (const auto map = std::get_if<flutter::EncodableMap>(arguments)) {
+      script = GetOptionalValue<std::string>(*map, "script");
+    }
+    if (!script) {
+      return Outcome::kError;
+    }
+    webview_.ExecuteScript(*script);
+    return Outcome::kSuccess;
+  }
+
+  if (method_name.compare(kMethodPostWebMessage) == 0) {
+    const auto message = std::get_if<std::string>(arguments);
+    return message && webview_.PostWebMessage(*message) ? Outcome::kSuccess
+                                                        : Outcome::kError;
+  }
+
+  if (method_name.compare(kMethodSetUserAgent) == 0) {
+    const auto user_agent = std::get_if<std::string>(arguments);
+    return user_agent && webview_.SetUserAgent(*user_agent) ? Outcome::kSuccess
+                                                            : Outcome::kError;
+  }
+
+  if (method_name.compare(kMethodSetBackgroundColor) == 0) {
+    const auto color = std::get_if<int32_t>(arguments);
+    return color && webview_.SetBackgroundColor(*color) ? Outcome::kSuccess
+                                                        : Outcome::kError;
+  }
+
+  if (method_name.compare(kMethodSetZoomFactor) == 0) {
+    const auto factor = std::get_if<double>(arguments);
+    return factor && webview_.SetZoomFactor(*factor) ? Outcome::kSuccess
+                                                     : Outcome::kError;
+  }
+
+  if (method_name.compare(kMethodOpenDevTools) == 0) {
+    return webview_.OpenDevTools() ? Outcome::kSuccess : Outcome::kError;
+  }
+
+  if (method_name.compare(kMethodClearCookies) == 0) {
+    return webview_.ClearCookies() ? Outcome::kSuccess : Outcome::kError;
+  }
+
+  if (method_name.compare(kMethodClearCache) == 0) {
+    return webview_.ClearCache() ? Outcome::kSuccess : Outcome::kError;
+  }
+
+  if (method_name.compare(kMethodSetCacheDisabled) == 0) {
+    const auto disabled = std::get_if<bool>(arguments);
+    return disabled && webview_.SetCacheDisabled(*disabled)
+               ? Outcome::kSuccess
+               : Outcome::kError;
+  }
+
+  if (method_name.compare(kMethodSetPopupWindowPolicy) == 0) {
+    if (const auto index = std::get_if<int32_t>(arguments)) {
+      webview_.SetPopupWindowPolicy(*index);
+      return Outcome::kSuccess;
+    }
+    return Outcome::kError;
+  }
+
+  if (method_name.compare(kMethodSetPermissionDecision) == 0) {
+    const auto map = std::get_if<flutter::EncodableMap>(arguments);
+    if (!map) {
+      return Outcome::kError;
+    }
+    const auto origin = GetOptionalValue<std::string>(*map, "origin");
+    const auto kind = GetOptionalValue<int32_t>(*map, "permissionKind");
+    const auto allow = GetOptionalValue<bool>(*map, "allow");
+    if (!origin || !kind || !allow) {
+      return Outcome::kError;
+    }
+    const auto ttl_ms = GetOptionalInteger(*map, "ttlMs");
+    if (ttl_ms && *ttl_ms <= 0) {
+      return Outcome::kError;
+    }
+    std::optional<PermissionCache::Clock::duration> ttl;
+    if (ttl_ms) {
+      ttl = std::chrono::milliseconds(*ttl_ms);
+    }
+    permission_cache_.Set(*origin, *kind,
+                          GetOptionalValue<bool>(*map, "isUserInitiated"),
+                          *allow, ttl, PermissionCache::Clock::now());
+    return Outcome::kSuccess;
+  }
+
+  if (method_name.compare(kMethodClearPermissionDecisions) == 0) {
+    const auto map = std::get_if<flutter::EncodableMap>(arguments);
+    if (!map) {
+      return Outcome::kError;
+    }
+    const auto origin = GetOptionalValue<std::string>(*map, "origin");
+    permission_cache_.Invalidate(
+        origin ? std::make_optional<std::string_view>(*origin) : std::nullopt,
+        GetOptionalValue<int32_t>(*map, "permissionKind"));
+    return Outcome::kSuccess;
+  }
+
+  if (method_name.compare(kMethodSetPermissionAnswerTtl) == 0) {
+    if (!arguments || arguments->IsNull()) {
+      permission_answer_ttl_ = std::nullopt;
+      return Outcome::kSuccess;
+    }
+    const auto ttl_ms = GetIntegerValue(*arguments);
+    if (!ttl_ms || *ttl_ms <= 0) {
+      return Outcome::kError;
+    }
+    permission_answer_ttl_ = std::chrono::milliseconds(*ttl_ms);
+    return Outcome::kSuccess;
+  }
+
+  if (method_name.compare(kMethodSetFrameSchedulingHints) == 0) {
+    const auto map = std::get_if<flutter::EncodableMap>(arguments);
+    if (!map) {
+      return Outcome::kError;
+    }
+    FrameScheduler::Hints hints;
+    hints.focused = GetOptionalValue<bool>(*map, "focused").value_or(false);
+    hints.visible = GetOptionalValue<bool>(*map, "visible").value_or(true);
+    hints.priority = GetOptionalValue<double>(*map, "priority").value_or(1.0);
+    texture_bridge_.SetFrameSchedulingHints(hints);
+    return Outcome::kSuccess;
+  }
+
+  if (method_name.compare(kMethodSetEventSubscriptions) == 0) {
+    if (const auto subscriptions = std::get_if<int32_t>(arguments)) {
+      webview_.SetEventSubscriptions(static_cast<uint32_t>(*subscriptions));
+      return Outcome::kSuccess;
+    }
+    return Outcome::kError;
+  }
+
+  if (method_name.compare(kMethodGetSuppressedEventCounts) == 0) {
+    return Outcome::kSuccess;
+  }
+
+  if (method_name.compare(kMethodSetNativeJsonDecoding) == 0) {
+    if (const auto enabled = std::get_if<bool>(arguments)) {
+      decode_json_natively_ = *enabled;
+      return Outcome::kSuccess;
+    }
+    return Outcome::kError;
+  }
+
+  if (method_name.compare(kMethodSetTouchPrediction) == 0) {
+    const auto map = std::get_if<flutter::EncodableMap>(arguments);
+    if (!map) {
+      return Outcome::kError;
+    }
+    const auto lookahead_us = GetOptionalValue<int32_t>(*map, "lookaheadUs");
+    if (!lookahead_us || *lookahead_us < 0) {
+      return Outcome::kError;
+    }
+    PointerPredictor::Options options;
+    options.lookahead = std::chrono::microseconds(*lookahead_us);
+    options.max_distance = GetOptionalValue<double>(*map, "maxDistance")
+                               .value_or(options.max_distance);
+    pointer_predictor_.SetOptions(options);
+    return Outcome::kSuccess;
+  }
+
+  if (method_name.compare(kMethodSetFpsLimit) == 0) {
+    if (const auto value = std::get_if<int32_t>(arguments)) {
+      texture_bridge_.SetFpsLimit(*value == 0 ? std::nullopt
+                                              : std::make_optional(*value));
+      return Outcome::kSuccess;
+    }
+  }
+
+  return Outcome::kNotImplemented;
+}
+
+}  // namespace bench
@@ -0,0 +1,160 @@
+#pragma once
+
+#include <flutter/encodable_value.h>
+#include <flutter/method_call.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "asset_server.h"
+#include "cache_policy.h"
+#include "devtools_subscriptions.h"
+#include "frame_scheduler.h"
+#include "performance_sampler.h"
+#include "permission_cache.h"
+#include "pointer_predictor.h"
+#include "response_cache.h"
+#include "url_filter.h"
+
+namespace bench {
+
+// Same as GetPointerPhase in webview_bridge.cc, for the values of
+// WebviewPointerEventKind.
+std::optional<PointerPredictor::Phase> GetPointerPhase(int32_t event);
+
+// Stand-in for Webview that only keeps the state set by the bridge, so that
+// replays measure the cost of handling calls rather than of the browser.
+class FakeWebview {
+ public:
+  void SetCursorPos(double x, double y);
+  void SetPointerUpdate(int32_t pointer, int32_t event, double x, double y,
+                        double size, double pressure);
+  void SetPointerButtonState(int32_t button, bool is_down);
+  void SetScrollDelta(double delta_x, double delta_y);
+  void SetSurfaceSize(size_t width, size_t height, float scale_factor);
+  void LoadUrl(const std::string& url);
+  void LoadStringContent(const std::string& content);
+  bool Reload();
+  bool Stop();
+  bool GoBack();
+  bool GoForward();
+  void Suspend();
+  void Resume();
+  void SetVirtualHostNameMapping(const std::string& host_name,
+                                 const std::string& path, int32_t access_kind);
+  void SetVirtualHostNameArchiveMapping(
+      const std::string& host_name,
+      std::shared_ptr<const AssetArchive> archive,
+      const std::string& fallback_path);
+  bool ClearVirtualHostNameMapping(const std::string& host_name);
+  void SetResponseCache(std::shared_ptr<ResponseCache> cache,
+                        std::vector<CachePolicy::Rule> rules);
+  ResponseCache* response_cache() const { return response_cache_.get(); }
+  void SetUrlFilter(std::unique_ptr<UrlFilter> filter);
+  UrlFilter* url_filter() const { return url_filter_.get(); }
+  std::string AddScriptToExecuteOnDocumentCreated(const std::string& script);
+  void RemoveScriptToExecuteOnDocumentCreated(const std::string& script_id);
+  void ExecuteScript(const std::string& script);
+  bool PostWebMessage(const std::string& message);
+  void CallDevToolsProtocolMethod(const std::string& method,
+                                  const std::string& params);
+  DevToolsSubscriptions::Id SubscribeDevToolsProtocolEvent(
+      const std::string& event, DevToolsEventFilter filter);
+  bool UnsubscribeDevToolsProtocolEvent(DevToolsSubscriptions::Id id);
+  bool SetUserAgent(const std::string& user_agent);
+  bool SetBackgroundColor(int32_t color);
+  bool SetZoomFactor(double factor);
+  bool OpenDevTools();
+  bool ClearCookies();
+  bool ClearCache();
+  bool SetCacheDisabled(bool disabled);
+  void SetPopupWindowPolicy(int32_t policy);
+  void SetEventSubscriptions(uint32_t subscriptions);
+
+  // Number of calls received.
+  size_t operation_count() const { return operation_count_; }
+
+ private:
+  size_t operation_count_ = 0;
+  double cursor_x_ = 0;
+  double cursor_y_ = 0;
+  uint32_t buttons_ = 0;
+  size_t width_ = 0;
+  size_t height_ = 0;
+  float scale_factor_ = 1;
+  std::string url_;
+  std::string user_agent_;
+  double zoom_factor_ = 1;
+  uint32_t subscriptions_ = 0;
+  std::vector<std::string> scripts_;
+  size_t next_script_id_ = 0;
+  AssetServer asset_server_;
+  std::shared_ptr<ResponseCache> response_cache_;
+  CachePolicy cache_policy_;
+  std::unique_ptr<UrlFilter> url_filter_;
+  DevToolsSubscriptions devtools_subscriptions_{
+      [](const std::string& /*event*/) { return true; },
+      [](const std::string& /*event*/) {}};
+};
+
+// Stand-in for TextureBridge.
+class FakeTextureBridge {
+ public:
+  void Start() { running_ = true; }
+  void Stop() { running_ = false; }
+  void SetFpsLimit(std::optional<int> limit) { fps_limit_ = limit; }
+  void SetFrameSchedulingHints(const FrameScheduler::Hints& hints) {
+    hints_ = hints;
+  }
+  FramePacer::FrameCounts TakeFrameCounts() { return {}; }
+
+  bool running() const { return running_; }
+
+ private:
+  bool running_ = false;
+  std::optional<int> fps_limit_;
+  FrameScheduler::Hints hints_;
+};
+
+// Handles method calls like WebviewBridge::HandleMethodCall does, with the
+// same dispatch order and argument validation, against a FakeWebview and a
+// FakeTextureBridge. Keep in sync with the bridge.
+class ReplayBridge {
+ public:
+  enum class Outcome { kSuccess, kError, kNotImplemented };
+
+  Outcome HandleMethodCall(
+      const flutter::MethodCall<flutter::EncodableValue>& method_call);
+
+  // Called for calls that count as user interaction.
+  void SetInteractionCallback(std::function<void()> callback) {
+    interaction_callback_ = std::move(callback);
+  }
+
+  const FakeWebview& webview() const { return webview_; }
+  const FakeTextureBridge& texture_bridge() const { return texture_bridge_; }
+
+ private:
+  FakeWebview webview_;
+  FakeTextureBridge texture_bridge_;
+  PermissionCache permission_cache_;
+  std::optional<PermissionCache::Clock::duration> permission_answer_ttl_;
+  PointerPredictor pointer_predictor_;
+  std::function<void()> interaction_callback_;
+  bool suspended_ = false;
+  bool decode_json_natively_ = false;
+  std::shared_ptr<PerformanceSampler> performance_sampler_;
+
+  void Suspend();
+  void Resume();
+  void SetPerformanceSampling(std::chrono::milliseconds interval,
+                              bool include_memory);
+};
+
+}  // namespace bench
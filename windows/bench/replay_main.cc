@@ -0,0 +1,511 @@
+// Replays method call logs recorded with
+// WebviewController.startMethodCallRecording against ReplayBridge, and
+// reports how long handling each method took. Can also replay the touches of
+// a log through PointerPredictor and report the prediction error.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <random>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "method_args.h"
+#include "method_call_log.h"
+#include "pointer_predictor.h"
+#include "replay_bridge.h"
+
+namespace {
+constexpr char kUsage[] =
+    "Usage: webview_windows_replay [options] <log>\n"
+    "  --speed=<factor>         Replays <factor> times faster than recorded.\n"
+    "                           0 replays without waiting between calls.\n"
+    "  --repeat=<n>             Replays the log <n> times.\n"
+    "  --dump                   Prints the calls instead of replaying them.\n"
+    "  --generate               Writes a synthetic session to <log> instead.\n"
+    "  --duration-ms=<ms>       Duration of the synthetic session.\n"
+    "  --predict-ms=<ms>[,...]  Reports the error of predicting the touches\n"
+    "                           of the log <ms> ahead instead.\n"
+    "  --max-distance=<px>      Limits predictions to <px> from the touch.\n";
+
+typedef std::chrono::steady_clock Clock;
+
+struct MethodStats {
+  std::vector<int64_t> handling_ns;
+  size_t errors = 0;
+  size_t not_implemented = 0;
+};
+
+bool GetFlag(std::string_view arg, std::string_view name, std::string& value) {
+  if (arg.substr(0, name.size()) != name) {
+    return false;
+  }
+  value = std::string(arg.substr(name.size()));
+  return true;
+}
+
+bool ReadFile(const std::string& path, std::string& contents) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    return false;
+  }
+  std::ostringstream buffer;
+  buffer << file.rdbuf();
+  contents = buffer.str();
+  return true;
+}
+
+void PrintValue(const flutter::EncodableValue& value) {
+  if (const auto boolean = std::get_if<bool>(&value)) {
+    std::printf(*boolean ? "true" : "false");
+  } else if (const auto int32 = std::get_if<int32_t>(&value)) {
+    std::printf("%d", *int32);
+  } else if (const auto int64 = std::get_if<int64_t>(&value)) {
+    std::printf("%lld", static_cast<long long>(*int64));
+  } else if (const auto number = std::get_if<double>(&value)) {
+    std::printf("%g", *number);
+  } else if (const auto string = std::get_if<std::string>(&value)) {
+    // Long strings such as page content are abbreviated.
+    constexpr size_t kMaxLength = 64;
+    std::printf("\"%.*s%s\"",
+                static_cast<int>(std::min(string->size(), kMaxLength)),
+                string->data(), string->size() > kMaxLength ? "..." : "");
+  } else if (const auto list = std::get_if<flutter::EncodableList>(&value)) {
+    std::printf("[");
+    for (size_t i = 0; i < list->size(); ++i) {
+      std::printf(i ? ", " : "");
+      PrintValue((*list)[i]);
+    }
+    std::printf("]");
+  } else if (const auto map = std::get_if<flutter::EncodableMap>(&value)) {
+    std::printf("{");
+    bool first = true;
+    for (const auto& [key, element] : *map) {
+      std::printf(first ? "" : ", ");
+      PrintValue(key);
+      std::printf(": ");
+      PrintValue(element);
+      first = false;
+    }
+    std::printf("}");
+  } else if (value.IsNull()) {
+    std::printf("null");
+  } else {
+    std::printf("<typed data>");
+  }
+}
+
+int Dump(const std::string& data) {
+  MethodCallLogReader reader(data);
+  while (const auto call = reader.Next()) {
+    std::printf("%10.3f ms  #%lld  %s ", call->timestamp.count() / 1000.0,
+                static_cast<long long>(call->instance_id),
+                call->method_name.c_str());
+    PrintValue(call->arguments);
+    std::printf("\n");
+  }
+  if (reader.failed()) {
+    std::fprintf(stderr, "The log is invalid or truncated.\n");
+    return 1;
+  }
+  return 0;
+}
+
+// A session of a single webview: navigation, a resize drag, and pointer
+// movement at 120 Hz with clicks, scrolling and a script call every second.
+// Every two seconds, a touch flings across the page.
+std::string GenerateSession(std::chrono::milliseconds duration) {
+  constexpr int64_t kInstanceId = 1;
+  constexpr std::chrono::microseconds kInputInterval(8333);
+  constexpr size_t kTouchStart = 200;
+  constexpr size_t kTouchLength = 36;
+  constexpr int32_t kPointerDown = 1;
+  constexpr int32_t kPointerUp = 4;
+  constexpr int32_t kPointerUpdate = 5;
+
+  // Touch samples are noisy and reach the plugin a few ms after they were
+  // taken.
+  std::mt19937 random(1);
+  std::uniform_real_distribution<double> touch_noise(-0.3, 0.3);
+  std::uniform_int_distribution<int64_t> touch_delay_us(1000, 4000);
+  int32_t next_pointer = 1;
+
+  MethodCallLogWriter writer;
+  const auto append = [&](std::chrono::microseconds timestamp,
+                          const char* method_name,
+                          const flutter::EncodableValue& arguments) {
+    writer.Append(timestamp, kInstanceId, method_name, &arguments);
+  };
+
+  append(std::chrono::microseconds(0), "setEventSubscriptions",
+         flutter::EncodableValue(0xff));
+  append(std::chrono::microseconds(200), "setSize",
+         flutter::EncodableValue(flutter::EncodableList{
+             flutter::EncodableValue(1280.0), flutter::EncodableValue(720.0),
+             flutter::EncodableValue(1.5)}));
+  append(std::chrono::microseconds(400), "loadUrl",
+         flutter::EncodableValue("https://flutter.dev"));
+  append(std::chrono::microseconds(600), "setTouchPrediction",
+         flutter::EncodableValue(flutter::EncodableMap{
+             {flutter::EncodableValue("lookaheadUs"),
+              flutter::EncodableValue(16000)}}));
+
+  size_t tick = 0;
+  for (std::chrono::microseconds timestamp(1000); timestamp < duration;
+       timestamp += kInputInterval, ++tick) {
+    const double t = timestamp.count() / 1e6;
+    const double x = 640 + 400 * std::sin(t * 1.3);
+    const double y = 360 + 200 * std::sin(t * 2.1);
+    append(timestamp, "setCursorPos",
+           flutter::EncodableValue(flutter::EncodableList{
+               flutter::EncodableValue(x), flutter::EncodableValue(y)}));
+
+    if (tick % 60 == 0 || tick % 60 == 6) {
+      append(timestamp, "setPointerButton",
+             flutter::EncodableValue(flutter::EncodableMap{
+                 {flutter::EncodableValue("button"),
+                  flutter::EncodableValue(1)},
+                 {flutter::EncodableValue("isDown"),
+                  flutter::EncodableValue(tick % 60 == 0)}}));
+    }
+    if (tick % 120 >= 90) {
+      append(timestamp, "setScrollDelta",
+             flutter::EncodableValue(flutter::EncodableList{
+                 flutter::EncodableValue(0.0),
+                 flutter::EncodableValue(-40.0)}));
+    }
+    if (tick % 120 == 0) {
+      append(timestamp, "executeScript",
+             flutter::EncodableValue("document.title"));
+    }
+    // A fling that decelerates along a curve.
+    const size_t touch_tick = tick % 240;
+    if (touch_tick >= kTouchStart && touch_tick <= kTouchStart + kTouchLength) {
+      const size_t step = touch_tick - kTouchStart;
+      const double progress = static_cast<double>(step) / kTouchLength;
+      const double eased = 1 - (1 - progress) * (1 - progress);
+      const int32_t event = step == 0              ? kPointerDown
+                            : step == kTouchLength ? kPointerUp
+                                                   : kPointerUpdate;
+      append(timestamp, "setPointerUpdate",
+             flutter::EncodableValue(flutter::EncodableList{
+                 flutter::EncodableValue(next_pointer),
+                 flutter::EncodableValue(event),
+                 flutter::EncodableValue(300 + 600 * eased +
+                                         touch_noise(random)),
+                 flutter::EncodableValue(500 - 250 * eased +
+                                         40 * std::sin(progress * 3.14159) +
+                                         touch_noise(random)),
+                 flutter::EncodableValue(1.0), flutter::EncodableValue(0.5),
+                 flutter::EncodableValue(static_cast<int64_t>(
+                     timestamp.count() - touch_delay_us(random)))}));
+      next_pointer += event == kPointerUp ? 1 : 0;
+    }
+    // A resize drag during the second second.
+    if (tick >= 120 && tick < 180) {
+      append(timestamp, "setSize",
+             flutter::EncodableValue(flutter::EncodableList{
+                 flutter::EncodableValue(1280.0 + (tick - 120) * 4),
+                 flutter::EncodableValue(720.0 + (tick - 120) * 2),
+                 flutter::EncodableValue(1.5)}));
+    }
+  }
+  return writer.TakeData();
+}
+
+int64_t Percentile(const std::vector<int64_t>& sorted, double fraction) {
+  if (sorted.empty()) {
+    return 0;
+  }
+  const auto index = static_cast<size_t>(fraction * (sorted.size() - 1));
+  return sorted[index];
+}
+
+int Replay(const std::string& data, double speed, int repeat) {
+  std::map<std::string, MethodStats> stats;
+  std::vector<int64_t> lateness_ns;
+  std::unordered_map<int64_t, std::unique_ptr<bench::ReplayBridge>> bridges;
+  size_t operations = 0;
+
+  for (int i = 0; i < repeat; ++i) {
+    MethodCallLogReader reader(data);
+    const auto start = Clock::now();
+    while (auto call = reader.Next()) {
+      const auto scheduled =
+          start + (speed > 0 ? std::chrono::duration_cast<Clock::duration>(
+                                   call->timestamp / speed)
+                             : Clock::duration::zero());
+      if (speed > 0) {
+        std::this_thread::sleep_until(scheduled);
+      }
+
+      auto& bridge = bridges[call->instance_id];
+      if (!bridge) {
+        bridge = std::make_unique<bench::ReplayBridge>();
+      }
+      const flutter::MethodCall<flutter::EncodableValue> method_call(
+          call->method_name, std::make_unique<flutter::EncodableValue>(
+                                 std::move(call->arguments)));
+
+      const auto begin = Clock::now();
+      const auto outcome = bridge->HandleMethodCall(method_call);
+      const auto end = Clock::now();
+
+      auto& method_stats = stats[call->method_name];
+      method_stats.handling_ns.push_back(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin)
+              .count());
+      method_stats.errors +=
+          outcome == bench::ReplayBridge::Outcome::kError ? 1 : 0;
+      method_stats.not_implemented +=
+          outcome == bench::ReplayBridge::Outcome::kNotImplemented ? 1 : 0;
+      if (speed > 0) {
+        lateness_ns.push_back(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(begin -
+                                                                 scheduled)
+                .count());
+      }
+    }
+    if (reader.failed()) {
+      std::fprintf(stderr, "The log is invalid or truncated.\n");
+      return 1;
+    }
+  }
+
+  std::printf("%-40s %8s %6s %10s %10s %10s %10s\n", "method", "calls",
+              "errors", "p50 ns", "p95 ns", "p99 ns", "max ns");
+  for (auto& [name, method_stats] : stats) {
+    auto& samples = method_stats.handling_ns;
+    std::sort(samples.begin(), samples.end());
+    std::printf("%-40s %8zu %6zu %10lld %10lld %10lld %10lld%s\n",
+                name.c_str(), samples.size(), method_stats.errors,
+                static_cast<long long>(Percentile(samples, 0.5)),
+                static_cast<long long>(Percentile(samples, 0.95)),
+                static_cast<long long>(Percentile(samples, 0.99)),
+                static_cast<long long>(samples.back()),
+                method_stats.not_implemented ? " (not implemented)" : "");
+  }
+  for (const auto& [id, bridge] : bridges) {
+    operations += bridge->webview().operation_count();
+  }
+  std::printf("%zu webview(s), %zu webview operations\n", bridges.size(),
+              operations);
+
+  if (!lateness_ns.empty()) {
+    std::sort(lateness_ns.begin(), lateness_ns.end());
+    std::printf("dispatch lateness: p50 %.1f us, p99 %.1f us, max %.1f us\n",
+                Percentile(lateness_ns, 0.5) / 1000.0,
+                Percentile(lateness_ns, 0.99) / 1000.0,
+                lateness_ns.back() / 1000.0);
+  }
+  return 0;
+}
+
+struct TouchSample {
+  PointerPredictor::Phase phase;
+  int64_t timestamp_us;
+  double x;
+  double y;
+};
+
+// Returns the touches of a log, each from its down to its up. Samples are
+// timed by their event timestamp if they have one.
+bool GetTouches(const std::string& data,
+                std::vector<std::vector<TouchSample>>& touches) {
+  std::map<std::pair<int64_t, int32_t>, size_t> active_touches;
+  MethodCallLogReader reader(data);
+  while (const auto call = reader.Next()) {
+    const auto list = std::get_if<flutter::EncodableList>(&call->arguments);
+    if (call->method_name != "setPointerUpdate" || !list ||
+        list->size() < 6) {
+      continue;
+    }
+    const auto pointer = std::get_if<int32_t>(&(*list)[0]);
+    const auto event = std::get_if<int32_t>(&(*list)[1]);
+    const auto x = std::get_if<double>(&(*list)[2]);
+    const auto y = std::get_if<double>(&(*list)[3]);
+    const auto phase = event ? bench::GetPointerPhase(*event) : std::nullopt;
+    if (!pointer || !phase || !x || !y) {
+      continue;
+    }
+    const auto timestamp_us =
+        list->size() == 7 ? GetIntegerValue((*list)[6]) : std::nullopt;
+
+    const auto key = std::make_pair(call->instance_id, *pointer);
+    auto it = active_touches.find(key);
+    if (*phase == PointerPredictor::Phase::kDown) {
+      it = active_touches.insert_or_assign(key, touches.size()).first;
+      touches.emplace_back();
+    } else if (it == active_touches.end()) {
+      continue;
+    }
+    touches[it->second].push_back(
+        {*phase, timestamp_us.value_or(call->timestamp.count()), *x, *y});
+    if (*phase == PointerPredictor::Phase::kUp) {
+      active_touches.erase(it);
+    }
+  }
+  return !reader.failed();
+}
+
+// Returns the position of |touch| at |timestamp_us|, interpolated between its
+// samples, or nothing if the touch ended before.
+std::optional<std::pair<double, double>> GetTouchPosition(
+    const std::vector<TouchSample>& touch, int64_t timestamp_us) {
+  for (size_t i = 1; i < touch.size(); ++i) {
+    const auto& before = touch[i - 1];
+    const auto& after = touch[i];
+    if (after.timestamp_us < timestamp_us) {
+      continue;
+    }
+    const auto interval = after.timestamp_us - before.timestamp_us;
+    const double fraction =
+        interval > 0
+            ? static_cast<double>(timestamp_us - before.timestamp_us) / interval
+            : 1.0;
+    return std::make_pair(before.x + (after.x - before.x) * fraction,
+                          before.y + (after.y - before.y) * fraction);
+  }
+  return std::nullopt;
+}
+
+void PrintErrors(const char* name, std::vector<double>& errors) {
+  std::sort(errors.begin(), errors.end());
+  double sum = 0;
+  for (const auto error : errors) {
+    sum += error;
+  }
+  const auto percentile = [&errors](double fraction) {
+    return errors[static_cast<size_t>(fraction * (errors.size() - 1))];
+  };
+  std::printf("  %-12s mean %7.2f  p50 %7.2f  p95 %7.2f  max %7.2f\n", name,
+              sum / errors.size(), percentile(0.5), percentile(0.95),
+              errors.back());
+}
+
+// Predicts every touch update of the log |lookahead_ms| ahead and compares
+// the prediction, and the unpredicted position, with where the touch really
+// was by then.
+int EvaluatePrediction(const std::string& data,
+                       const std::vector<double>& lookahead_ms,
+                       double max_distance) {
+  std::vector<std::vector<TouchSample>> touches;
+  if (!GetTouches(data, touches)) {
+    std::fprintf(stderr, "The log is invalid or truncated.\n");
+    return 1;
+  }
+  std::printf("%zu touch(es)\n", touches.size());
+
+  for (const auto lookahead : lookahead_ms) {
+    PointerPredictor predictor;
+    PointerPredictor::Options options;
+    options.lookahead = std::chrono::microseconds(
+        static_cast<int64_t>(lookahead * 1000));
+    options.max_distance = max_distance;
+    predictor.SetOptions(options);
+
+    std::vector<double> unpredicted_errors;
+    std::vector<double> predicted_errors;
+    for (const auto& touch : touches) {
+      for (const auto& sample : touch) {
+        const auto predicted = predictor.Update(
+            0, sample.phase, sample.timestamp_us, sample.x, sample.y);
+        if (sample.phase != PointerPredictor::Phase::kMove) {
+          continue;
+        }
+        const auto actual = GetTouchPosition(
+            touch, sample.timestamp_us + options.lookahead.count());
+        if (!actual) {
+          continue;
+        }
+        unpredicted_errors.push_back(
+            std::hypot(sample.x - actual->first, sample.y - actual->second));
+        predicted_errors.push_back(
+            std::hypot(predicted.first - actual->first,
+                       predicted.second - actual->second));
+      }
+    }
+
+    std::printf("lookahead %.1f ms, %zu update(s)\n", lookahead,
+                predicted_errors.size());
+    if (predicted_errors.empty()) {
+      continue;
+    }
+    PrintErrors("unpredicted", unpredicted_errors);
+    PrintErrors("predicted", predicted_errors);
+  }
+  return 0;
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+  double speed = 1;
+  int repeat = 1;
+  bool dump = false;
+  bool generate = false;
+  std::chrono::milliseconds duration(10000);
+  std::vector<double> lookahead_ms;
+  double max_distance = PointerPredictor::Options().max_distance;
+  std::string path;
+
+  for (int i = 1; i < argc; ++i) {
+    const std::string_view arg = argv[i];
+    std::string value;
+    if (GetFlag(arg, "--speed=", value)) {
+      speed = std::atof(value.c_str());
+    } else if (GetFlag(arg, "--repeat=", value)) {
+      repeat = std::max(std::atoi(value.c_str()), 1);
+    } else if (arg == "--dump") {
+      dump = true;
+    } else if (arg == "--generate") {
+      generate = true;
+    } else if (GetFlag(arg, "--duration-ms=", value)) {
+      duration = std::chrono::milliseconds(std::atoi(value.c_str()));
+    } else if (GetFlag(arg, "--predict-ms=", value)) {
+      std::istringstream values(value);
+      for (std::string lookahead; std::getline(values, lookahead, ',');) {
+        lookahead_ms.push_back(std::atof(lookahead.c_str()));
+      }
+    } else if (GetFlag(arg, "--max-distance=", value)) {
+      max_distance = std::atof(value.c_str());
+    } else if (path.empty() && arg.substr(0, 2) != "--") {
+      path = std::string(arg);
+    } else {
+      std::fputs(kUsage, stderr);
+      return 2;
+    }
+  }
+  if (path.empty()) {
+    std::fputs(kUsage, stderr);
+    return 2;
+  }
+
+  if (generate) {
+    std::ofstream out(path, std::ios::binary);
+    out << GenerateSession(duration);
+    if (!out) {
+      std::fprintf(stderr, "Failed to write %s.\n", path.c_str());
+      return 1;
+    }
+    return 0;
+  }
+
+  std::string data;
+  if (!ReadFile(path, data)) {
+    std::fprintf(stderr, "Failed to read %s.\n", path.c_str());
+    return 1;
+  }
+  if (!lookahead_ms.empty()) {
+    return EvaluatePrediction(data, lookahead_ms, max_distance);
+  }
+  return dump ? Dump(data) : Replay(data, speed, repeat);
+}
@@ -0,0 +1,135 @@
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "benchmark.h"
+#include "util/scratch_buffer.h"
+#include "util/utf_transcoder.h"
+
+#ifdef _WIN32
+#include "util/string_converter.h"
+#endif
+
+namespace bench {
+
+namespace {
+struct Payload {
+  const char* name;
+  std::string utf8;
+};
+
+std::string Repeat(const std::string& text, size_t min_size) {
+  std::string result;
+  while (result.size() < min_size) {
+    result += text;
+  }
+  return result;
+}
+
+std::vector<Payload> MakePayloads() {
+  return {
+      {"url", "https://example.com/some/path/to/a/page?query=value#fragment"},
+      {"json",
+       Repeat("{\"id\":12345,\"name\":\"Some item\",\"tags\":[\"a\",\"b\"],"
+              "\"price\":9.99,\"available\":true},",
+              4096)},
+      {"cjk", Repeat("\xe6\x97\xa5\xe6\x9c\xac\xe8\xaa\x9e\xe3\x81\xae"
+                     "\xe3\x83\x86\xe3\x82\xad\xe3\x82\xb9\xe3\x83\x88 "
+                     "\xe4\xb8\xad\xe6\x96\x87\xe6\x96\x87\xe6\x9c\xac ",
+                     4096)},
+      {"emoji", Repeat("Hello \xf0\x9f\x98\x80 world \xf0\x9f\x8e\x89 "
+                       "\xf0\x9f\x91\x8d\xf0\x9f\x8f\xbd ok ",
+                       4096)},
+  };
+}
+
+std::u16string ToUtf16(const std::string& utf8) {
+  std::u16string utf16(util::MaxUtf16LengthForUtf8(utf8.size()), u'\0');
+  utf16.resize(*util::TranscodeUtf8ToUtf16(utf8, utf16.data()));
+  return utf16;
+}
+}  // namespace
+
+void RegisterStringBenchmarks(Registry& registry) {
+  for (auto& payload : MakePayloads()) {
+    const std::string suffix = payload.name;
+    const auto utf8 = payload.utf8;
+    const auto utf16 = ToUtf16(utf8);
+
+    // Transcoding into a preallocated buffer.
+    registry.Add(
+        "utf/utf8_to_utf16/" + suffix,
+        [utf8](size_t iterations) {
+          std::u16string buffer(util::MaxUtf16LengthForUtf8(utf8.size()),
+                                u'\0');
+          for (size_t i = 0; i < iterations; ++i) {
+            DoNotOptimize(util::TranscodeUtf8ToUtf16(utf8, buffer.data()));
+          }
+        },
+        utf8.size());
+
+    registry.Add(
+        "utf/utf16_to_utf8/" + suffix,
+        [utf16](size_t iterations) {
+          std::string buffer(util::MaxUtf8LengthForUtf16(utf16.size()), '\0');
+          for (size_t i = 0; i < iterations; ++i) {
+            DoNotOptimize(util::TranscodeUtf16ToUtf8(utf16, buffer.data()));
+          }
+        },
+        utf8.size());
+
+    // Converting into a new string per call, like Utf16FromUtf8.
+    registry.Add(
+        "utf/utf8_to_utf16_string/" + suffix,
+        [utf8](size_t iterations) {
+          for (size_t i = 0; i < iterations; ++i) {
+            std::u16string result(util::MaxUtf16LengthForUtf8(utf8.size()),
+                                  u'\0');
+            result.resize(
+                util::TranscodeUtf8ToUtf16(utf8, result.data()).value_or(0));
+            DoNotOptimize(result);
+          }
+        },
+        utf8.size());
+
+    // Converting into a reused scratch buffer, like ScratchUtf16.
+    registry.Add(
+        "utf/utf8_to_utf16_scratch/" + suffix,
+        [utf8](size_t iterations) {
+          util::ScratchBuffer<char16_t> scratch;
+          for (size_t i = 0; i < iterations; ++i) {
+            auto* data =
+                scratch.Acquire(util::MaxUtf16LengthForUtf8(utf8.size()) + 1);
+            const auto length =
+                util::TranscodeUtf8ToUtf16(utf8, data).value_or(0);
+            data[length] = u'\0';
+            DoNotOptimize(data);
+            scratch.Release();
+          }
+        },
+        utf8.size());
+
+#ifdef _WIN32
+    registry.Add(
+        "string_converter/Utf16FromUtf8/" + suffix,
+        [utf8](size_t iterations) {
+          for (size_t i = 0; i < iterations; ++i) {
+            DoNotOptimize(util::Utf16FromUtf8(utf8));
+          }
+        },
+        utf8.size());
+
+    registry.Add(
+        "string_converter/ScratchUtf16/" + suffix,
+        [utf8](size_t iterations) {
+          for (size_t i = 0; i < iterations; ++i) {
+            const util::ScratchUtf16 converted(utf8);
+            DoNotOptimize(converted.c_str());
+          }
+        },
+        utf8.size());
+#endif
+  }
+}
+
+}  // namespace bench
@@ -0,0 +1,131 @@
+#include "synthetic_frame_source.h"
+
+#include <algorithm>
+
+namespace bench {
+
+SyntheticFrameSource::SyntheticFrameSource(const Options& options)
+    : options_(options),
+      interval_(std::chrono::duration_cast<Clock::duration>(
+          std::chrono::duration<double>(1.0 / options.frames_per_second))),
+      content_size_(options.size),
+      frame_size_(options.size),
+      random_(options.seed),
+      thread_([this]() { Run(); }) {
+  Recreate();
+}
+
+SyntheticFrameSource::~SyntheticFrameSource() {
+  {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    shutdown_ = true;
+  }
+  wakeup_.notify_all();
+  thread_.join();
+}
+
+bool SyntheticFrameSource::Start(FrameArrivedCallback on_frame_arrived) {
+  {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    if (producing_) {
+      return false;
+    }
+    producing_ = true;
+    on_frame_arrived_ = std::move(on_frame_arrived);
+  }
+  wakeup_.notify_all();
+  return true;
+}
+
+void SyntheticFrameSource::Stop() {
+  {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    producing_ = false;
+  }
+  wakeup_.notify_all();
+}
+
+std::optional<SyntheticFrame> SyntheticFrameSource::TryGetNextFrame() {
+  const std::lock_guard<std::mutex> lock(mutex_);
+  std::optional<SyntheticFrame> frame;
+  frame.swap(pending_frame_);
+  stats_.taken += frame ? 1 : 0;
+  return frame;
+}
+
+void SyntheticFrameSource::Recreate() {
+  const std::lock_guard<std::mutex> lock(mutex_);
+  frame_size_ = content_size_;
+  pixels_ = options_.allocate_pixels
+                ? std::make_shared<const std::vector<uint8_t>>(
+                      frame_size_.width * frame_size_.height * 4)
+                : nullptr;
+  ++stats_.recreated;
+}
+
+void SyntheticFrameSource::SetContentSize(Size size) {
+  const std::lock_guard<std::mutex> lock(mutex_);
+  content_size_ = size;
+}
+
+SyntheticFrameSource::Stats SyntheticFrameSource::GetStats() {
+  const std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+void SyntheticFrameSource::Run() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    wakeup_.wait(lock, [this]() { return producing_ || shutdown_; });
+    if (shutdown_) {
+      return;
+    }
+
+    // Every start begins a new schedule.
+    auto scheduled = Clock::now();
+    while (producing_ && !shutdown_) {
+      scheduled += interval_;
+      const auto stopped = wakeup_.wait_until(
+          lock, scheduled + NextJitter(),
+          [this]() { return !producing_ || shutdown_; });
+      if (stopped) {
+        break;
+      }
+
+      stats_.overwritten += pending_frame_ ? 1 : 0;
+      ++stats_.produced;
+      pending_frame_ =
+          SyntheticFrame{++sequence_, frame_size_, Clock::now(), pixels_};
+
+      // The callback takes the consumer's lock, which may be held while it
+      // calls into the source.
+      const auto callback = on_frame_arrived_;
+      lock.unlock();
+      callback();
+      lock.lock();
+    }
+  }
+}
+
+SyntheticFrameSource::Clock::duration SyntheticFrameSource::NextJitter() {
+  const auto amount = std::clamp(options_.jitter_amount, 0.0, 1.0);
+  switch (options_.jitter) {
+    case Jitter::kNone:
+      break;
+    case Jitter::kUniform: {
+      std::uniform_real_distribution<double> deviation(-amount, amount);
+      return std::chrono::duration_cast<Clock::duration>(interval_ *
+                                                         deviation(random_));
+    }
+    case Jitter::kBursty: {
+      std::bernoulli_distribution stall(amount);
+      if (stall(random_)) {
+        return interval_ * kBurstLength;
+      }
+      break;
+    }
+  }
+  return Clock::duration::zero();
+}
+
+}  // namespace bench
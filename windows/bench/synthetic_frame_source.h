@@ -0,0 +1,100 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "frame_source.h"
+
+namespace bench {
+
+struct SyntheticFrame {
+  uint64_t sequence;
+  Size size;
+  std::chrono::steady_clock::time_point produced_at;
+  // 4 bytes per pixel. Shared by all frames of the same size, like the
+  // buffers of a capture frame pool. Null unless pixels are allocated.
+  std::shared_ptr<const std::vector<uint8_t>> pixels;
+};
+
+// Emits frames from its own thread at a configurable rate and jitter,
+// standing in for a WebView2 visual captured by CaptureFrameSource.
+//
+// Like a capture frame pool with a single buffer, a frame that hasn't been
+// taken when the next one is produced is overwritten.
+class SyntheticFrameSource : public FrameSource<SyntheticFrame> {
+ public:
+  typedef std::chrono::steady_clock Clock;
+
+  enum class Jitter {
+    kNone,
+    // Each frame is produced up to |jitter_amount| intervals early or late.
+    kUniform,
+    // With a probability of |jitter_amount|, production stalls for
+    // kBurstLength intervals and then catches up with back-to-back frames.
+    kBursty,
+  };
+
+  static constexpr int kBurstLength = 3;
+
+  struct Options {
+    double frames_per_second = 60;
+    Jitter jitter = Jitter::kNone;
+    double jitter_amount = 0.25;
+    Size size = {1280, 720};
+    bool allocate_pixels = true;
+    uint32_t seed = 1;
+  };
+
+  struct Stats {
+    uint64_t produced = 0;
+    uint64_t taken = 0;
+    uint64_t overwritten = 0;
+    uint64_t recreated = 0;
+  };
+
+  explicit SyntheticFrameSource(const Options& options);
+  ~SyntheticFrameSource() override;
+
+  bool Start(FrameArrivedCallback on_frame_arrived) override;
+  void Stop() override;
+  std::optional<SyntheticFrame> TryGetNextFrame() override;
+  void Recreate() override;
+
+  // Changes the size of the content, e.g. during a resize. Frames keep the
+  // previous size until Recreate is called.
+  void SetContentSize(Size size);
+
+  Stats GetStats();
+
+ private:
+  const Options options_;
+  const Clock::duration interval_;
+
+  std::mutex mutex_;
+  std::condition_variable wakeup_;
+  bool producing_ = false;
+  bool shutdown_ = false;
+  FrameArrivedCallback on_frame_arrived_;
+  std::optional<SyntheticFrame> pending_frame_;
+  Size content_size_;
+  Size frame_size_;
+  std::shared_ptr<const std::vector<uint8_t>> pixels_;
+  uint64_t sequence_ = 0;
+  Stats stats_;
+  std::mt19937 random_;
+
+  // Declared last, so that it starts after everything it uses.
+  std::thread thread_;
+
+  void Run();
+  Clock::duration NextJitter();
+};
+
+}  // namespace bench
@@ -0,0 +1,144 @@
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "benchmark.h"
+#include "url_filter.h"
+
+namespace bench {
+
+namespace {
+// The size of EasyList and EasyPrivacy together.
+constexpr size_t kRuleCount = 50000;
+constexpr size_t kUrlCount = 1024;
+
+constexpr const char* kWords[] = {
+    "ad",         "ads",        "advert",     "banner",     "track",
+    "pixel",      "beacon",     "analytics",  "stats",      "sponsor",
+    "promo",      "popunder",   "metrics",    "collect",    "count",
+    "tag",        "click",      "impression",
+};
+constexpr const char* kTopLevelDomains[] = {"com", "net", "org", "io",
+                                            "co.uk", "de"};
+
+std::string GetWord(std::mt19937& random) {
+  return kWords[random() % std::size(kWords)] +
+         std::to_string(random() % 5000);
+}
+
+std::string GetDomain(std::mt19937& random) {
+  return GetWord(random) + "." +
+         kTopLevelDomains[random() % std::size(kTopLevelDomains)];
+}
+
+struct RuleList {
+  std::string rules;
+  // URLs that rules of the list block, three in four of them by domain.
+  std::vector<std::string> blocked_urls;
+};
+
+// A list shaped like EasyList: mostly blocked domains, then path and query
+// patterns, some with options, exceptions and element hiding rules.
+const RuleList& GetRuleList() {
+  static const auto list = []() {
+    std::mt19937 random(48);
+    RuleList list;
+    auto& rules = list.rules;
+    rules = "[Adblock Plus 2.0]\n! Title: Synthetic list\n";
+    for (size_t i = 0; i < kRuleCount; ++i) {
+      const auto kind = random() % 100;
+      if (kind < 55) {
+        const auto domain = GetDomain(random);
+        rules += "||" + domain + "^";
+        list.blocked_urls.push_back("https://cdn." + domain + "/lib.js?v=3");
+      } else if (kind < 62) {
+        rules += "||" + GetDomain(random) + "^$third-party";
+      } else if (kind < 72) {
+        const auto directory = GetWord(random);
+        const auto name = GetWord(random);
+        rules += "/" + directory + "/*/" + name + "_*.js";
+        list.blocked_urls.push_back("https://www.example.com/" + directory +
+                                    "/2024/" + name + "_main.js");
+      } else if (kind < 80) {
+        const auto word = GetWord(random);
+        rules += "-" + word + "-";
+        list.blocked_urls.push_back("https://www.example.com/img/top-" +
+                                    word + "-300x250.gif");
+      } else if (kind < 86) {
+        rules += "&" + GetWord(random) + "=";
+      } else if (kind < 90) {
+        rules += "||" + GetDomain(random) + "/" + GetWord(random) + "/";
+      } else if (kind < 93) {
+        rules += "/" + GetWord(random) + ".$script,domain=" +
+                 GetDomain(random) + "|~" + GetDomain(random);
+      } else if (kind < 96) {
+        rules += "@@||" + GetDomain(random) + "/" + GetWord(random) + "^";
+      } else {
+        rules += GetDomain(random) + "##." + GetWord(random);
+      }
+      rules += '\n';
+    }
+    list.blocked_urls.resize(kUrlCount);
+    return list;
+  }();
+  return list;
+}
+
+UrlFilter* GetFilter() {
+  static const auto filter = UrlFilter::Compile(GetRuleList().rules);
+  return filter.get();
+}
+
+// Image requests of a news page to its own static hosts.
+std::vector<std::string> GetAllowedUrls() {
+  std::mt19937 random(1);
+  std::vector<std::string> urls;
+  for (size_t i = 0; i < kUrlCount; ++i) {
+    urls.push_back("https://static" + std::to_string(random() % 8) +
+                   ".news-site.example.com/assets/2024/article-" +
+                   std::to_string(random()) + "/image_" +
+                   std::to_string(random() % 100) +
+                   ".jpg?width=640&format=webp");
+  }
+  return urls;
+}
+
+}  // namespace
+
+void RegisterUrlFilterBenchmarks(Registry& registry) {
+  registry.Add("url_filter/compile_50k", [](size_t iterations) {
+    const auto& rules = GetRuleList().rules;
+    for (size_t i = 0; i < iterations; ++i) {
+      DoNotOptimize(UrlFilter::Compile(rules));
+    }
+  });
+
+  registry.Add("url_filter/allowed_50k", [](size_t iterations) {
+    const auto filter = GetFilter();
+    static const auto urls = GetAllowedUrls();
+    UrlFilter::Request request;
+    request.document_host = "www.news-site.example.com";
+    request.type = UrlFilter::kImage;
+    for (size_t i = 0; i < iterations; ++i) {
+      request.url = urls[i % urls.size()];
+      DoNotOptimize(filter->ShouldBlock(request));
+    }
+  });
+
+  registry.Add("url_filter/blocked_50k", [](size_t iterations) {
+    const auto filter = GetFilter();
+    const auto& urls = GetRuleList().blocked_urls;
+    UrlFilter::Request request;
+    request.document_host = "www.news-site.example.com";
+    request.type = UrlFilter::kScript;
+    for (size_t i = 0; i < iterations; ++i) {
+      request.url = urls[i % urls.size()];
+      DoNotOptimize(filter->ShouldBlock(request));
+    }
+  });
+}
+
+}  // namespace bench
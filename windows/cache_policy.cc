@@ -0,0 +1,253 @@
+#include "cache_policy.h"
+
+#include <algorithm>
+#include <iterator>
+
+#include "util/http_headers.h"
+
+namespace {
+// Lifetime of responses cached by a kAlways rule without a max age.
+constexpr std::chrono::seconds kDefaultAlwaysMaxAge = std::chrono::hours(1);
+// Upper bound of lifetimes derived from Last-Modified.
+constexpr int64_t kMaxHeuristicLifetime = 24 * 60 * 60;
+
+// Headers that describe the transfer rather than the stored response.
+constexpr std::string_view kDroppedHeaders[] = {
+    "Connection",        "Content-Encoding", "Content-Length",
+    "Keep-Alive",        "Set-Cookie",       "Set-Cookie2",
+    "Transfer-Encoding", "Age",              "Proxy-Connection",
+};
+
+struct CacheControl {
+  bool no_store = false;
+  bool no_cache = false;
+  std::optional<int64_t> max_age;
+};
+
+// Calls |callback(element)| for each trimmed element of a comma-separated
+// header value.
+template <typename Callback>
+void ForEachElement(std::string_view value, Callback callback) {
+  while (!value.empty()) {
+    const auto comma = value.find(',');
+    const auto element = util::Trim(value.substr(0, comma));
+    value = comma == std::string_view::npos ? std::string_view()
+                                            : value.substr(comma + 1);
+    if (!element.empty()) {
+      callback(element);
+    }
+  }
+}
+
+CacheControl ParseCacheControl(std::string_view value) {
+  CacheControl cache_control;
+  ForEachElement(value, [&cache_control](std::string_view directive) {
+    const auto equals = directive.find('=');
+    const auto name = util::Trim(directive.substr(0, equals));
+    if (util::EqualsIgnoreCase(name, "no-store")) {
+      cache_control.no_store = true;
+    } else if (util::EqualsIgnoreCase(name, "no-cache")) {
+      // Also when qualified with field names, which would require
+      // revalidation just as well.
+      cache_control.no_cache = true;
+    } else if (util::EqualsIgnoreCase(name, "max-age") &&
+               equals != std::string_view::npos) {
+      auto argument = util::Trim(directive.substr(equals + 1));
+      if (argument.size() >= 2 && argument.front() == '"' &&
+          argument.back() == '"') {
+        argument = argument.substr(1, argument.size() - 2);
+      }
+      uint64_t max_age = 0;
+      // Invalid max ages make the response stale.
+      cache_control.max_age =
+          util::ParseNumber(argument, max_age) ? static_cast<int64_t>(max_age)
+                                               : 0;
+    }
+  });
+  return cache_control;
+}
+
+bool ContainsToken(std::string_view value, std::string_view token) {
+  bool found = false;
+  ForEachElement(value, [&](std::string_view element) {
+    found = found || util::EqualsIgnoreCase(element, token);
+  });
+  return found;
+}
+
+// Whether a response varies on request headers other than Accept-Encoding.
+// The stored body is decoded, so the encoding doesn't matter, but entries
+// are only keyed by URL.
+bool VariesOnRequest(std::string_view vary) {
+  bool varies = false;
+  ForEachElement(vary, [&varies](std::string_view element) {
+    varies = varies || !util::EqualsIgnoreCase(element, "Accept-Encoding");
+  });
+  return varies;
+}
+
+// Returns how long a response is fresh from the time it was generated, or
+// std::nullopt if its headers don't say.
+std::optional<int64_t> GetFreshnessLifetime(std::string_view headers,
+                                            const CacheControl& cache_control,
+                                            int64_t date) {
+  if (cache_control.max_age) {
+    return *cache_control.max_age;
+  }
+  if (const auto expires = util::FindHeader(headers, "Expires")) {
+    // Invalid dates, such as "0", mean the response has expired.
+    const auto expiry = util::ParseHttpDate(*expires);
+    return expiry ? *expiry - date : 0;
+  }
+  return std::nullopt;
+}
+}  // namespace
+
+void CachePolicy::SetRules(std::vector<Rule> rules) {
+  rules_ = std::move(rules);
+  literal_prefix_lengths_.clear();
+  for (const auto& rule : rules_) {
+    literal_prefix_lengths_.push_back(
+        std::min(rule.url_pattern.find_first_of("*?"),
+                 rule.url_pattern.size()));
+  }
+}
+
+const CachePolicy::Rule* CachePolicy::Match(std::string_view url) const {
+  for (size_t i = 0; i < rules_.size(); ++i) {
+    const std::string_view pattern = rules_[i].url_pattern;
+    const auto prefix_length = literal_prefix_lengths_[i];
+    if (url.substr(0, prefix_length) != pattern.substr(0, prefix_length) ||
+        !MatchesPattern(pattern.substr(prefix_length),
+                        url.substr(prefix_length))) {
+      continue;
+    }
+    return rules_[i].mode == Mode::kNever ? nullptr : &rules_[i];
+  }
+  return nullptr;
+}
+
+// static
+bool CachePolicy::CanServe(const Rule& rule, const Request& request) {
+  if (rule.mode == Mode::kNever || request.method != "GET" ||
+      !request.range.empty()) {
+    return false;
+  }
+  if (rule.mode == Mode::kAlways) {
+    return true;
+  }
+
+  // Reloads ask to bypass caches, and authorized responses are private to
+  // a user, who may change.
+  const auto cache_control = ParseCacheControl(request.cache_control);
+  return request.authorization.empty() && !cache_control.no_store &&
+         !cache_control.no_cache && cache_control.max_age.value_or(1) != 0 &&
+         !ContainsToken(request.pragma, "no-cache");
+}
+
+// static
+std::optional<int64_t> CachePolicy::GetExpiry(const Rule& rule,
+                                              const Request& request,
+                                              int status,
+                                              std::string_view headers,
+                                              int64_t now) {
+  if (status != 200 || !CanServe(rule, request)) {
+    return std::nullopt;
+  }
+  if (rule.mode == Mode::kAlways) {
+    return now + rule.max_age.value_or(kDefaultAlwaysMaxAge).count();
+  }
+
+  const auto cache_control_header = util::FindHeader(headers, "Cache-Control");
+  const auto cache_control =
+      ParseCacheControl(cache_control_header.value_or(std::string_view()));
+  if (cache_control.no_store || cache_control.no_cache ||
+      (!cache_control_header &&
+       ContainsToken(util::FindHeader(headers, "Pragma").value_or(""),
+                     "no-cache")) ||
+      VariesOnRequest(util::FindHeader(headers, "Vary").value_or(""))) {
+    return std::nullopt;
+  }
+
+  // Responses generated in the future are taken to be generated now.
+  auto date = now;
+  if (const auto date_header = util::FindHeader(headers, "Date")) {
+    date = std::min(util::ParseHttpDate(*date_header).value_or(now), now);
+  }
+
+  auto lifetime = GetFreshnessLifetime(headers, cache_control, date);
+  if (!lifetime && rule.max_age) {
+    lifetime = rule.max_age->count();
+  }
+  if (!lifetime) {
+    // The heuristic of RFC 9111: a tenth of the time since the last
+    // modification.
+    const auto last_modified = util::FindHeader(headers, "Last-Modified");
+    const auto modified =
+        last_modified ? util::ParseHttpDate(*last_modified) : std::nullopt;
+    if (!modified || *modified >= date) {
+      return std::nullopt;
+    }
+    lifetime = std::min((date - *modified) / 10, kMaxHeuristicLifetime);
+  }
+
+  uint64_t age = 0;
+  if (const auto age_header = util::FindHeader(headers, "Age")) {
+    util::ParseNumber(*age_header, age);
+  }
+  // ParseNumber reads at most 18 digits, so neither sum overflows.
+  const auto current_age = std::max(now - date, static_cast<int64_t>(age));
+  const auto expiry = now + *lifetime - current_age;
+  if (expiry <= now) {
+    return std::nullopt;
+  }
+  return expiry;
+}
+
+// static
+std::string CachePolicy::GetStoredHeaders(std::string_view headers) {
+  std::string stored;
+  stored.reserve(headers.size());
+  util::ForEachHeader(headers, [&stored](std::string_view name,
+                                         std::string_view value) {
+    const bool dropped =
+        std::any_of(std::begin(kDroppedHeaders), std::end(kDroppedHeaders),
+                    [name](std::string_view dropped_name) {
+                      return util::EqualsIgnoreCase(name, dropped_name);
+                    });
+    if (!dropped) {
+      util::AddHeader(stored, name, value);
+    }
+    return true;
+  });
+  return stored;
+}
+
+// static
+bool CachePolicy::MatchesPattern(std::string_view pattern,
+                                 std::string_view url) {
+  // Greedy matching that backtracks to the last star only, which is enough
+  // since a star matches any sequence.
+  size_t p = 0;
+  size_t u = 0;
+  size_t star = std::string_view::npos;
+  size_t star_u = 0;
+  while (u < url.size()) {
+    if (p < pattern.size() && (pattern[p] == '?' || pattern[p] == url[u])) {
+      ++p;
+      ++u;
+    } else if (p < pattern.size() && pattern[p] == '*') {
+      star = p++;
+      star_u = u;
+    } else if (star != std::string_view::npos) {
+      p = star + 1;
+      u = ++star_u;
+    } else {
+      return false;
+    }
+  }
+  while (p < pattern.size() && pattern[p] == '*') {
+    ++p;
+  }
+  return p == pattern.size();
+}
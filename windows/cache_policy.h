@@ -0,0 +1,81 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Decides which intercepted requests the response cache answers and how long
+// responses stay fresh, from rules set per URL pattern and the caching
+// headers of the responses, which are honored like a private cache does
+// (RFC 9111).
+//
+// Stale responses are not revalidated but fetched again, since a request
+// that is passed on to the network can't be answered from the cache anymore.
+class CachePolicy {
+ public:
+  enum class Mode {
+    // Caches responses as far as their headers allow.
+    kHeaders,
+    // Caches every successful response for the max age of the rule,
+    // whatever its headers say.
+    kAlways,
+    // Never caches, e.g. to exclude some URLs from a broader rule.
+    kNever,
+  };
+
+  struct Rule {
+    // In the syntax of WebView2 resource filters: "*" matches any sequence
+    // of characters and "?" any single character.
+    std::string url_pattern;
+    Mode mode = Mode::kHeaders;
+    // For kHeaders, the lifetime of responses that don't specify one; for
+    // kAlways, the lifetime of all responses.
+    std::optional<std::chrono::seconds> max_age;
+  };
+
+  struct Request {
+    std::string_view method = "GET";
+    // Values of request headers, empty if absent.
+    std::string_view range;
+    std::string_view cache_control;
+    std::string_view pragma;
+    std::string_view authorization;
+  };
+
+  void SetRules(std::vector<Rule> rules);
+  const std::vector<Rule>& rules() const { return rules_; }
+  bool empty() const { return rules_.empty(); }
+
+  // Returns the first rule that matches |url|, or nullptr if there is none
+  // or it is a kNever rule.
+  const Rule* Match(std::string_view url) const;
+
+  // Whether |request| may be answered from the cache under |rule|.
+  static bool CanServe(const Rule& rule, const Request& request);
+
+  // Returns the time in seconds since the Unix epoch at which the response
+  // to |request| stops being fresh, or std::nullopt if it must not be
+  // stored. |headers| are "Name: value" lines separated by CRLF.
+  static std::optional<int64_t> GetExpiry(const Rule& rule,
+                                          const Request& request, int status,
+                                          std::string_view headers,
+                                          int64_t now);
+
+  // Returns the headers of a response to store. Headers that only describe
+  // the transfer are dropped, since the stored body is decoded, and so is
+  // Set-Cookie, which must not be replayed.
+  static std::string GetStoredHeaders(std::string_view headers);
+
+  static bool MatchesPattern(std::string_view pattern, std::string_view url);
+
+ private:
+  std::vector<Rule> rules_;
+  // Length of the part of each pattern before the first wildcard, which is
+  // compared first since most rules differ from a URL early on.
+  std::vector<size_t> literal_prefix_lengths_;
+};
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <windows.graphics.capture.h>
+#include <wrl.h>
+
+#include "frame_source.h"
+#include "graphics_context.h"
+
+// Captures the frames of a composition visual with
+// Windows.Graphics.Capture.
+class CaptureFrameSource
+    : public FrameSource<winrt::com_ptr<ID3D11Texture2D>> {
+ public:
+  CaptureFrameSource(GraphicsContext* graphics_context,
+                     ABI::Windows::UI::Composition::IVisual* visual);
+  ~CaptureFrameSource() override;
+
+  bool Start(FrameArrivedCallback on_frame_arrived) override;
+  void Stop() override;
+  std::optional<winrt::com_ptr<ID3D11Texture2D>> TryGetNextFrame() override;
+  void Recreate() override;
+
+  // corresponds to DXGI_FORMAT_B8G8R8A8_UNORM
+  static constexpr auto kPixelFormat = ABI::Windows::Graphics::DirectX::
+      DirectXPixelFormat::DirectXPixelFormat_B8G8R8A8UIntNormalized;
+
+ private:
+  const GraphicsContext* graphics_context_;
+  bool is_capturing_ = false;
+
+  winrt::com_ptr<ABI::Windows::Graphics::Capture::IGraphicsCaptureItem>
+      capture_item_;
+  winrt::com_ptr<ABI::Windows::Graphics::Capture::IDirect3D11CaptureFramePool>
+      frame_pool_;
+  winrt::com_ptr<ABI::Windows::Graphics::Capture::IGraphicsCaptureSession>
+      capture_session_;
+
+  EventRegistrationToken on_closed_token_ = {};
+  EventRegistrationToken on_frame_arrived_token_ = {};
+};
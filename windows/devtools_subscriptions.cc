@@ -0,0 +1,153 @@
+#include "devtools_subscriptions.h"
+
+#include <algorithm>
+#include <charconv>
+#include <optional>
+
+#include "util/json_path.h"
+
+namespace {
+
+std::optional<double> ParseNumber(std::string_view text) {
+  double value;
+  const auto [ptr, ec] =
+      std::from_chars(text.data(), text.data() + text.size(), value);
+  if (ec != std::errc() || ptr != text.data() + text.size()) {
+    return std::nullopt;
+  }
+  return value;
+}
+
+// Returns the contents of the JSON string |text|, decoded into |storage| if
+// it has escapes.
+std::optional<std::string_view> GetString(std::string_view text,
+                                          std::string& storage) {
+  if (text.size() < 2 || text.front() != '"') {
+    return std::nullopt;
+  }
+  const auto raw = text.substr(1, text.size() - 2);
+  if (raw.find('\\') == std::string_view::npos) {
+    return raw;
+  }
+  auto decoded = util::DecodeJsonString(text);
+  if (!decoded) {
+    return std::nullopt;
+  }
+  storage = std::move(*decoded);
+  return std::string_view(storage);
+}
+
+bool Equals(std::string_view text, const DevToolsEventFilter::Value& value) {
+  if (std::holds_alternative<std::monostate>(value)) {
+    return text == "null";
+  }
+  if (const auto boolean = std::get_if<bool>(&value)) {
+    return text == (*boolean ? "true" : "false");
+  }
+  if (const auto number = std::get_if<double>(&value)) {
+    const auto parsed = ParseNumber(text);
+    return parsed && *parsed == *number;
+  }
+  std::string storage;
+  const auto string = GetString(text, storage);
+  return string && *string == std::get<std::string>(value);
+}
+
+bool MatchesCondition(const DevToolsEventFilter::Condition& condition,
+                      std::string_view params) {
+  using Operator = DevToolsEventFilter::Operator;
+
+  const auto text = util::FindJsonValue(params, condition.path);
+  switch (condition.op) {
+    case Operator::kExists:
+      return text.has_value();
+    case Operator::kNotExists:
+      return !text;
+    case Operator::kEquals:
+      return text && Equals(*text, condition.value);
+    case Operator::kNotEquals:
+      return !text || !Equals(*text, condition.value);
+    case Operator::kContains:
+    case Operator::kStartsWith: {
+      const auto expected = std::get_if<std::string>(&condition.value);
+      if (!text || !expected) {
+        return false;
+      }
+      std::string storage;
+      const auto string = GetString(*text, storage);
+      if (!string) {
+        return false;
+      }
+      return condition.op == Operator::kContains
+                 ? string->find(*expected) != std::string_view::npos
+                 : string->substr(0, expected->size()) == *expected;
+    }
+    case Operator::kLessThan:
+    case Operator::kGreaterThan: {
+      const auto expected = std::get_if<double>(&condition.value);
+      if (!text || !expected) {
+        return false;
+      }
+      const auto number = ParseNumber(*text);
+      if (!number) {
+        return false;
+      }
+      return condition.op == Operator::kLessThan ? *number < *expected
+                                                 : *number > *expected;
+    }
+  }
+  return false;
+}
+
+}  // namespace
+
+bool DevToolsEventFilter::Matches(std::string_view params) const {
+  for (const auto& condition : conditions_) {
+    if (!MatchesCondition(condition, params)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+DevToolsSubscriptions::Id DevToolsSubscriptions::Subscribe(
+    const std::string& event, DevToolsEventFilter filter) {
+  auto it = events_.find(event);
+  if (it == events_.end()) {
+    if (!add_receiver_(event)) {
+      return kNoSubscription;
+    }
+    it = events_.emplace(event, std::vector<Subscription>()).first;
+  }
+  const auto id = next_id_++;
+  it->second.push_back({id, std::move(filter)});
+  events_of_.emplace(id, event);
+  return id;
+}
+
+bool DevToolsSubscriptions::Unsubscribe(Id id) {
+  const auto it = events_of_.find(id);
+  if (it == events_of_.end()) {
+    return false;
+  }
+  const auto event = events_.find(it->second);
+  auto& subscriptions = event->second;
+  subscriptions.erase(std::find_if(subscriptions.begin(), subscriptions.end(),
+                                   [id](const Subscription& subscription) {
+                                     return subscription.id == id;
+                                   }));
+  if (subscriptions.empty()) {
+    remove_receiver_(event->first);
+    events_.erase(event);
+  }
+  events_of_.erase(it);
+  return true;
+}
+
+void DevToolsSubscriptions::Clear() {
+  for (const auto& [event, subscriptions] : events_) {
+    remove_receiver_(event);
+  }
+  events_.clear();
+  events_of_.clear();
+}
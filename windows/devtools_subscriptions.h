@@ -0,0 +1,130 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <variant>
+#include <vector>
+
+// Conditions on the params of a DevTools protocol event, so that the events
+// a subscriber doesn't want are dropped before they are sent to Dart.
+//
+// Conditions are evaluated on the JSON text of the params, which is only
+// parsed along the paths that the conditions look at.
+class DevToolsEventFilter {
+ public:
+  // Order must match DevToolsEventOperator in lib/src/enums.dart.
+  enum class Operator {
+    kEquals,
+    kNotEquals,
+    kContains,
+    kStartsWith,
+    kLessThan,
+    kGreaterThan,
+    kExists,
+    kNotExists,
+  };
+
+  // null, a boolean, a number or a string.
+  typedef std::variant<std::monostate, bool, double, std::string> Value;
+
+  struct Condition {
+    // Member names and array indices separated by dots, as in
+    // "response.status" or "args.0.value".
+    std::string path;
+    Operator op = Operator::kExists;
+    // Ignored by kExists and kNotExists.
+    Value value;
+  };
+
+  // A filter without conditions, which matches all params.
+  DevToolsEventFilter() = default;
+  explicit DevToolsEventFilter(std::vector<Condition> conditions)
+      : conditions_(std::move(conditions)) {}
+
+  // Returns whether |params| meet all the conditions.
+  //
+  // kContains and kStartsWith only match strings and kLessThan and
+  // kGreaterThan only numbers. kNotEquals also matches params without a
+  // value at the path.
+  bool Matches(std::string_view params) const;
+
+  bool empty() const { return conditions_.empty(); }
+
+ private:
+  std::vector<Condition> conditions_;
+};
+
+// Subscriptions to DevTools protocol events.
+//
+// WebView2 delivers the events of one name through a receiver, which is
+// added with the first subscription to the event and removed with the last
+// one, so that subscribers share a receiver.
+class DevToolsSubscriptions {
+ public:
+  typedef uint64_t Id;
+  static constexpr Id kNoSubscription = 0;
+
+  // Returns false if the receiver couldn't be added.
+  typedef std::function<bool(const std::string& event)> AddReceiverAction;
+  typedef std::function<void(const std::string& event)> RemoveReceiverAction;
+
+  DevToolsSubscriptions(AddReceiverAction add_receiver,
+                        RemoveReceiverAction remove_receiver)
+      : add_receiver_(std::move(add_receiver)),
+        remove_receiver_(std::move(remove_receiver)) {}
+  DevToolsSubscriptions(const DevToolsSubscriptions&) = delete;
+  DevToolsSubscriptions& operator=(const DevToolsSubscriptions&) = delete;
+
+  // Subscribes to |event| with params that match |filter|. Returns
+  // kNoSubscription if the receiver of the event couldn't be added.
+  Id Subscribe(const std::string& event, DevToolsEventFilter filter);
+
+  // Returns false if there is no subscription |id|.
+  bool Unsubscribe(Id id);
+
+  // Removes all subscriptions and receivers.
+  void Clear();
+
+  // Calls |callback(id)| for each subscription to |event| whose filter
+  // matches |params|, in the order of subscription. The callback must not
+  // subscribe or unsubscribe.
+  template <typename Callback>
+  void Dispatch(const std::string& event, std::string_view params,
+                Callback callback) const;
+
+  size_t receiver_count() const { return events_.size(); }
+  size_t subscription_count() const { return events_of_.size(); }
+
+ private:
+  struct Subscription {
+    Id id;
+    DevToolsEventFilter filter;
+  };
+
+  AddReceiverAction add_receiver_;
+  RemoveReceiverAction remove_receiver_;
+  // Subscriptions by event, only for events that have a receiver.
+  std::unordered_map<std::string, std::vector<Subscription>> events_;
+  std::unordered_map<Id, std::string> events_of_;
+  Id next_id_ = kNoSubscription + 1;
+};
+
+template <typename Callback>
+void DevToolsSubscriptions::Dispatch(const std::string& event,
+                                     std::string_view params,
+                                     Callback callback) const {
+  const auto it = events_.find(event);
+  if (it == events_.end()) {
+    return;
+  }
+  for (const auto& subscription : it->second) {
+    if (subscription.filter.Matches(params)) {
+      callback(subscription.id);
+    }
+  }
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <utility>
+#include <vector>
+
+// Tears objects down in stages spread over several idle slices, so that
+// releasing many objects at once doesn't block the calling thread for long.
+//
+// The stages of an object run in order; objects are torn down in the order
+// they were queued.
+class StagedDisposeQueue {
+ public:
+  typedef std::chrono::steady_clock Clock;
+  typedef std::function<void()> Stage;
+  typedef std::function<Clock::time_point()> NowFunction;
+
+  explicit StagedDisposeQueue(NowFunction now = &Clock::now)
+      : now_(std::move(now)) {}
+
+  // Queues the teardown stages of one object.
+  void Enqueue(std::vector<Stage> stages) {
+    if (!stages.empty()) {
+      objects_.emplace_back(std::make_move_iterator(stages.begin()),
+                            std::make_move_iterator(stages.end()));
+      pending_stages_ += stages.size();
+    }
+  }
+
+  // Runs queued stages until |budget| is used up, but at least one. Returns
+  // the number of stages that ran.
+  size_t RunSlice(Clock::duration budget) {
+    const auto deadline = now_() + budget;
+    size_t count = 0;
+    do {
+      if (!RunNextStage()) {
+        break;
+      }
+      ++count;
+    } while (now_() < deadline);
+    return count;
+  }
+
+  // Runs all remaining stages.
+  void Flush() {
+    while (RunNextStage()) {
+    }
+  }
+
+  bool empty() const { return objects_.empty(); }
+  size_t pending_stages() const { return pending_stages_; }
+
+ private:
+  NowFunction now_;
+  std::deque<std::deque<Stage>> objects_;
+  size_t pending_stages_ = 0;
+
+  bool RunNextStage() {
+    if (objects_.empty()) {
+      return false;
+    }
+
+    // Dequeue first: the stage may release the last reference to the
+    // object, and may queue further objects.
+    auto stage = std::move(objects_.front().front());
+    objects_.front().pop_front();
+    if (objects_.front().empty()) {
+      objects_.pop_front();
+    }
+    --pending_stages_;
+    stage();
+    return true;
+  }
+};
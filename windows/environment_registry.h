@@ -0,0 +1,140 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <tuple>
+
+// Identifies a WebView2 environment. Webviews created with equal keys share
+// one environment (and thus one browser process tree).
+struct EnvironmentKey {
+  std::wstring user_data_directory;
+  std::wstring browser_exe_path;
+  std::string arguments;
+
+  bool operator<(const EnvironmentKey& other) const {
+    return std::tie(user_data_directory, browser_exe_path, arguments) <
+           std::tie(other.user_data_directory, other.browser_exe_path,
+                    other.arguments);
+  }
+
+  bool operator==(const EnvironmentKey& other) const {
+    return std::tie(user_data_directory, browser_exe_path, arguments) ==
+           std::tie(other.user_data_directory, other.browser_exe_path,
+                    other.arguments);
+  }
+};
+
+// Owns reference-counted values by key. Values that are no longer referenced
+// are kept for a grace period so that they can be reused cheaply, and are
+// removed by |Collect| once the grace period has elapsed.
+template <typename Key, typename Value>
+class RefCountedRegistry {
+ public:
+  typedef std::chrono::steady_clock Clock;
+  typedef std::function<std::unique_ptr<Value>()> Factory;
+
+  explicit RefCountedRegistry(Clock::duration grace_period)
+      : grace_period_(grace_period) {}
+
+  // Returns the value for |key|, creating it through |factory| if needed.
+  // Does not add a reference; a new value starts out unreferenced.
+  Value& GetOrCreate(const Key& key, const Factory& factory,
+                     Clock::time_point now) {
+    auto it = entries_.find(key);
+    if (it == entries_.end()) {
+      it = entries_.emplace(key, Entry{factory(), 0, now}).first;
+    }
+    return *it->second.value;
+  }
+
+  Value* Find(const Key& key) const {
+    const auto it = entries_.find(key);
+    return it != entries_.end() ? it->second.value.get() : nullptr;
+  }
+
+  // Adds a reference to an existing value. Returns false if there is none.
+  bool AddRef(const Key& key) {
+    const auto it = entries_.find(key);
+    if (it == entries_.end()) {
+      return false;
+    }
+    ++it->second.ref_count;
+    return true;
+  }
+
+  // Drops a reference. The value becomes eligible for collection once the
+  // grace period has elapsed after its last reference was dropped.
+  void Release(const Key& key, Clock::time_point now) {
+    const auto it = entries_.find(key);
+    if (it != entries_.end() && it->second.ref_count > 0 &&
+        --it->second.ref_count == 0) {
+      it->second.unused_since = now;
+    }
+  }
+
+  // Removes unreferenced values whose grace period has elapsed. Returns the
+  // number of removed values.
+  size_t Collect(Clock::time_point now) {
+    size_t count = 0;
+    for (auto it = entries_.begin(); it != entries_.end();) {
+      if (it->second.ref_count == 0 &&
+          it->second.unused_since + grace_period_ <= now) {
+        it = entries_.erase(it);
+        ++count;
+      } else {
+        ++it;
+      }
+    }
+    return count;
+  }
+
+  // Returns the earliest time at which |Collect| will remove a value.
+  std::optional<Clock::time_point> NextCollection() const {
+    std::optional<Clock::time_point> next;
+    for (const auto& [key, entry] : entries_) {
+      if (entry.ref_count == 0) {
+        const auto at = entry.unused_since + grace_period_;
+        if (!next.has_value() || at < *next) {
+          next = at;
+        }
+      }
+    }
+    return next;
+  }
+
+  void SetGracePeriod(Clock::duration grace_period) {
+    grace_period_ = grace_period;
+  }
+
+  size_t ref_count(const Key& key) const {
+    const auto it = entries_.find(key);
+    return it != entries_.end() ? it->second.ref_count : 0;
+  }
+
+  // Calls |callback| with each key and value, referenced or not.
+  template <typename Callback>
+  void ForEach(Callback callback) const {
+    for (const auto& [key, entry] : entries_) {
+      callback(key, *entry.value);
+    }
+  }
+
+  size_t size() const { return entries_.size(); }
+
+  void Clear() { entries_.clear(); }
+
+ private:
+  struct Entry {
+    std::unique_ptr<Value> value;
+    size_t ref_count;
+    Clock::time_point unused_since;
+  };
+
+  Clock::duration grace_period_;
+  std::map<Key, Entry> entries_;
+};
@@ -0,0 +1,97 @@
+#include "frame_pacer.h"
+
+#include <algorithm>
+#include <utility>
+
+FramePacer::~FramePacer() { SetFrameScheduler(nullptr); }
+
+void FramePacer::SetFpsLimit(std::optional<int> max_fps) {
+  auto value = max_fps.value_or(0);
+  if (value != 0) {
+    frame_duration_ = FrameDuration(1000.0 / value);
+  } else {
+    frame_duration_.reset();
+    last_frame_timestamp_.reset();
+  }
+}
+
+void FramePacer::SetFrameScheduler(FrameScheduler* frame_scheduler) {
+  if (frame_scheduler_) {
+    frame_scheduler_->Unregister(frame_scheduler_client_);
+  }
+  frame_scheduler_ = frame_scheduler;
+  if (frame_scheduler_) {
+    frame_scheduler_client_ = frame_scheduler_->Register();
+  }
+}
+
+void FramePacer::SetFrameSchedulingHints(const FrameScheduler::Hints& hints) {
+  if (frame_scheduler_) {
+    frame_scheduler_->SetHints(frame_scheduler_client_, hints);
+  }
+}
+
+FramePacer::Decision FramePacer::OnFrameArrived(size_t bytes,
+                                                Clock::time_point now) {
+  ++frame_counts_.arrived;
+  if (last_arrival_.has_value()) {
+    frame_counts_.longest_interval =
+        std::max(frame_counts_.longest_interval,
+                 FrameDuration(now - last_arrival_.value()));
+  }
+  last_arrival_ = now;
+
+  const auto decision = Decide(bytes, now);
+  if (decision == Decision::kPublish) {
+    ++frame_counts_.published;
+  }
+  return decision;
+}
+
+bool FramePacer::PublishDeferredFrame(Clock::time_point now) {
+  if (!frame_scheduler_ ||
+      !frame_scheduler_->RetryDeferredFrame(frame_scheduler_client_, now)) {
+    return false;
+  }
+  ++frame_counts_.published;
+  return true;
+}
+
+void FramePacer::DiscardDeferredFrame() {
+  if (frame_scheduler_) {
+    frame_scheduler_->DiscardDeferredFrame(frame_scheduler_client_);
+  }
+}
+
+FramePacer::FrameCounts FramePacer::TakeFrameCounts() {
+  return std::exchange(frame_counts_, FrameCounts());
+}
+
+FramePacer::Decision FramePacer::Decide(size_t bytes, Clock::time_point now) {
+  if (ShouldDropFrame(now)) {
+    return Decision::kDroppedByFpsLimit;
+  }
+  if (frame_scheduler_ &&
+      !frame_scheduler_->MayPublish(frame_scheduler_client_, bytes, now)) {
+    return Decision::kDeferredByScheduler;
+  }
+  return Decision::kPublish;
+}
+
+bool FramePacer::ShouldDropFrame(Clock::time_point now) {
+  if (!frame_duration_.has_value()) {
+    return false;
+  }
+
+  bool should_drop_frame = false;
+  if (last_frame_timestamp_.has_value()) {
+    auto diff = std::chrono::duration_cast<std::chrono::milliseconds>(
+        now - last_frame_timestamp_.value());
+    should_drop_frame = diff < frame_duration_.value();
+  }
+
+  if (!should_drop_frame) {
+    last_frame_timestamp_ = now;
+  }
+  return should_drop_frame;
+}
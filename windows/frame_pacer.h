@@ -0,0 +1,70 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+#include "frame_scheduler.h"
+
+// Decides which of the frames arriving at a texture bridge are published,
+// by applying the bridge's FPS limit and asking the plugin-wide frame
+// scheduler.
+//
+// Not thread-safe; texture bridges call it while holding their lock.
+class FramePacer {
+ public:
+  typedef std::chrono::steady_clock Clock;
+  typedef std::chrono::duration<double, std::milli> FrameDuration;
+
+  // The values of dropped frames match the kFrameDropped flight recorder
+  // event.
+  enum class Decision : uint64_t {
+    kPublish = 0,
+    kDroppedByFpsLimit = 1,
+    kDeferredByScheduler = 2,
+  };
+
+  // Frames that arrived since the previous call to TakeFrameCounts.
+  struct FrameCounts {
+    uint64_t arrived = 0;
+    uint64_t published = 0;
+    // Longest time between two arrivals.
+    FrameDuration longest_interval{0};
+  };
+
+  FramePacer() = default;
+  ~FramePacer();
+
+  FramePacer(const FramePacer&) = delete;
+  FramePacer& operator=(const FramePacer&) = delete;
+
+  void SetFpsLimit(std::optional<int> max_fps);
+
+  // Registers with |frame_scheduler|, or unregisters if it's nullptr.
+  void SetFrameScheduler(FrameScheduler* frame_scheduler);
+  void SetFrameSchedulingHints(const FrameScheduler::Hints& hints);
+
+  // Decides about a frame that requires copying |bytes| to be published.
+  Decision OnFrameArrived(size_t bytes, Clock::time_point now);
+
+  // Returns whether the frame deferred by the scheduler last may be
+  // published now. Counts it as published if so.
+  bool PublishDeferredFrame(Clock::time_point now);
+  void DiscardDeferredFrame();
+
+  FrameCounts TakeFrameCounts();
+
+ private:
+  std::optional<FrameDuration> frame_duration_;
+  std::optional<Clock::time_point> last_frame_timestamp_;
+
+  FrameCounts frame_counts_;
+  std::optional<Clock::time_point> last_arrival_;
+
+  FrameScheduler* frame_scheduler_ = nullptr;
+  FrameScheduler::ClientId frame_scheduler_client_ = 0;
+
+  bool ShouldDropFrame(Clock::time_point now);
+  Decision Decide(size_t bytes, Clock::time_point now);
+};
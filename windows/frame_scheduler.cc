@@ -0,0 +1,244 @@
+#include "frame_scheduler.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace {
+// Focused clients get this many times the share of other visible clients.
+constexpr double kFocusedWeight = 4.0;
+
+// Clients that haven't asked to publish for this long don't take part in
+// the split.
+constexpr auto kActiveWindow = std::chrono::seconds(1);
+
+// Upper bound of the budget a client may accumulate while idle.
+constexpr double kBurstSeconds = 0.1;
+}  // namespace
+
+FrameScheduler::ClientId FrameScheduler::Register() {
+  const std::lock_guard<std::mutex> lock(mutex_);
+  const auto id = next_id_++;
+  clients_[id] = Client();
+  return id;
+}
+
+void FrameScheduler::Unregister(ClientId client) {
+  const std::lock_guard<std::mutex> lock(mutex_);
+  clients_.erase(client);
+}
+
+void FrameScheduler::SetHints(ClientId client, const Hints& hints) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  const auto it = clients_.find(client);
+  if (it == clients_.end()) {
+    return;
+  }
+  it->second.hints = hints;
+  if (it->second.deferred_bytes.has_value() && deferred_frame_callback_) {
+    const auto callback = deferred_frame_callback_;
+    lock.unlock();
+    callback();
+  }
+}
+
+void FrameScheduler::SetBudget(const Budget& budget) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  budget_ = budget;
+  const auto waiting =
+      std::any_of(clients_.begin(), clients_.end(), [](const auto& entry) {
+        return entry.second.deferred_bytes.has_value();
+      });
+  if (waiting && deferred_frame_callback_) {
+    const auto callback = deferred_frame_callback_;
+    lock.unlock();
+    callback();
+  }
+}
+
+void FrameScheduler::SetDeferredFrameCallback(DeferredFrameCallback callback) {
+  const std::lock_guard<std::mutex> lock(mutex_);
+  deferred_frame_callback_ = std::move(callback);
+}
+
+FrameScheduler::Stats FrameScheduler::GetStats(ClientId client) {
+  const std::lock_guard<std::mutex> lock(mutex_);
+  const auto it = clients_.find(client);
+  return it != clients_.end() ? it->second.stats : Stats();
+}
+
+bool FrameScheduler::MayPublish(ClientId client, size_t bytes,
+                                Clock::time_point now) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  const auto it = clients_.find(client);
+  if (it == clients_.end()) {
+    return true;
+  }
+
+  auto& state = it->second;
+  state.last_request = now;
+
+  if (TryCharge(client, state, bytes, now)) {
+    state.deferred_bytes.reset();
+    ++state.stats.published;
+    return true;
+  }
+
+  ++state.stats.deferred;
+  const auto was_waiting = state.deferred_bytes.has_value();
+  state.deferred_bytes = bytes;
+  if (!was_waiting && deferred_frame_callback_) {
+    const auto callback = deferred_frame_callback_;
+    lock.unlock();
+    callback();
+  }
+  return false;
+}
+
+bool FrameScheduler::RetryDeferredFrame(ClientId client,
+                                        Clock::time_point now) {
+  const std::lock_guard<std::mutex> lock(mutex_);
+  const auto it = clients_.find(client);
+  if (it == clients_.end() || !it->second.deferred_bytes.has_value()) {
+    return false;
+  }
+
+  auto& state = it->second;
+  state.last_request = now;
+  if (!TryCharge(client, state, *state.deferred_bytes, now)) {
+    return false;
+  }
+  state.deferred_bytes.reset();
+  ++state.stats.published;
+  return true;
+}
+
+void FrameScheduler::DiscardDeferredFrame(ClientId client) {
+  const std::lock_guard<std::mutex> lock(mutex_);
+  const auto it = clients_.find(client);
+  if (it != clients_.end()) {
+    it->second.deferred_bytes.reset();
+  }
+}
+
+std::optional<FrameScheduler::Clock::time_point>
+FrameScheduler::NextDeferredFrameRetry(Clock::time_point now) {
+  const std::lock_guard<std::mutex> lock(mutex_);
+  const auto has_budget = budget_.frames_per_second.has_value() ||
+                          budget_.copy_bytes_per_second.has_value();
+  std::optional<double> next;
+  for (const auto& [id, state] : clients_) {
+    if (!state.deferred_bytes.has_value()) {
+      continue;
+    }
+    const auto share = Share(id, now);
+    const auto frame_rate = budget_.frames_per_second.value_or(1.0) * share;
+    const auto byte_rate = budget_.copy_bytes_per_second.value_or(1.0) * share;
+    if (has_budget && (frame_rate <= 0.0 || byte_rate <= 0.0)) {
+      // Waits for the hints or the budget to change.
+      continue;
+    }
+
+    // Mirrors the refill in TryCharge.
+    const auto elapsed =
+        state.last_refill.has_value()
+            ? std::chrono::duration<double>(now - *state.last_refill).count()
+            : kBurstSeconds;
+    double wait = 0.0;
+    if (budget_.frames_per_second.has_value()) {
+      const auto tokens = std::min(state.frame_tokens + frame_rate * elapsed,
+                                   std::max(1.0, frame_rate * kBurstSeconds));
+      if (tokens < 1.0) {
+        wait = std::max(wait, (1.0 - tokens) / frame_rate);
+      }
+    }
+    if (budget_.copy_bytes_per_second.has_value()) {
+      const auto bytes = static_cast<double>(*state.deferred_bytes);
+      const auto tokens = std::min(state.byte_tokens + byte_rate * elapsed,
+                                   std::max(bytes, byte_rate * kBurstSeconds));
+      if (tokens < bytes) {
+        wait = std::max(wait, (bytes - tokens) / byte_rate);
+      }
+    }
+    if (!next.has_value() || wait < *next) {
+      next = wait;
+    }
+  }
+
+  if (!next.has_value()) {
+    return std::nullopt;
+  }
+  return now + std::chrono::ceil<Clock::duration>(
+                   std::chrono::duration<double>(*next));
+}
+
+bool FrameScheduler::TryCharge(ClientId client, Client& state, size_t bytes,
+                               Clock::time_point now) {
+  if (!budget_.frames_per_second.has_value() &&
+      !budget_.copy_bytes_per_second.has_value()) {
+    return true;
+  }
+
+  const auto share = Share(client, now);
+  const auto elapsed =
+      state.last_refill.has_value()
+          ? std::chrono::duration<double>(now - *state.last_refill).count()
+          : kBurstSeconds;
+  state.last_refill = now;
+
+  bool allowed = share > 0.0;
+
+  if (budget_.frames_per_second.has_value()) {
+    const auto rate = *budget_.frames_per_second * share;
+    state.frame_tokens = std::min(state.frame_tokens + rate * elapsed,
+                                  std::max(1.0, rate * kBurstSeconds));
+    allowed = allowed && state.frame_tokens >= 1.0;
+  }
+
+  if (budget_.copy_bytes_per_second.has_value()) {
+    // A single frame may always be saved up for, however large it is.
+    const auto rate = *budget_.copy_bytes_per_second * share;
+    state.byte_tokens =
+        std::min(state.byte_tokens + rate * elapsed,
+                 std::max(static_cast<double>(bytes), rate * kBurstSeconds));
+    allowed = allowed && state.byte_tokens >= static_cast<double>(bytes);
+  }
+
+  if (!allowed) {
+    return false;
+  }
+
+  if (budget_.frames_per_second.has_value()) {
+    state.frame_tokens -= 1.0;
+  }
+  if (budget_.copy_bytes_per_second.has_value()) {
+    state.byte_tokens -= static_cast<double>(bytes);
+  }
+  return true;
+}
+
+double FrameScheduler::Share(ClientId client, Clock::time_point now) const {
+  double total = 0.0;
+  double own = 0.0;
+  for (const auto& [id, state] : clients_) {
+    // Clients waiting to publish a deferred frame stay active.
+    if (!state.deferred_bytes.has_value() &&
+        (!state.last_request.has_value() ||
+         now - *state.last_request > kActiveWindow)) {
+      continue;
+    }
+    const auto weight = Weight(state.hints);
+    total += weight;
+    if (id == client) {
+      own = weight;
+    }
+  }
+  return total > 0.0 ? own / total : 0.0;
+}
+
+// static
+double FrameScheduler::Weight(const Hints& hints) {
+  if (!hints.visible) {
+    return 0.0;
+  }
+  return (hints.focused ? kFocusedWeight : 1.0) * std::max(0.0, hints.priority);
+}
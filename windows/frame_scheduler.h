@@ -0,0 +1,99 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+
+// Distributes a plugin-wide frame budget between all texture bridges.
+//
+// Each client gets a weighted fair share of the total frames per second and
+// copy bytes per second. Weights are derived from focus, visibility and
+// priority, and only clients that have recently asked to publish take part
+// in the split so that idle clients don't waste budget. Each share is
+// enforced with a token bucket.
+//
+// Without a budget every frame may be published.
+//
+// A deferred frame is remembered per client so that it can be published
+// later with RetryDeferredFrame once the client's share allows it.
+class FrameScheduler {
+ public:
+  typedef uint64_t ClientId;
+  typedef std::chrono::steady_clock Clock;
+
+  struct Hints {
+    bool focused = false;
+    bool visible = true;
+    // Multiplies the client's weight. 0 blocks publishing while a budget is
+    // active.
+    double priority = 1.0;
+  };
+
+  struct Budget {
+    std::optional<double> frames_per_second;
+    std::optional<double> copy_bytes_per_second;
+  };
+
+  struct Stats {
+    uint64_t published = 0;
+    uint64_t deferred = 0;
+  };
+
+  // Called when a deferred frame may have become publishable, i.e. when a
+  // client starts waiting or the hints or budget change while one waits.
+  // May be called on any thread, without the scheduler's lock held.
+  typedef std::function<void()> DeferredFrameCallback;
+
+  ClientId Register();
+  void Unregister(ClientId client);
+
+  void SetHints(ClientId client, const Hints& hints);
+  void SetBudget(const Budget& budget);
+  void SetDeferredFrameCallback(DeferredFrameCallback callback);
+
+  // Returns whether |client| may publish a frame requiring a copy of |bytes|
+  // now, and charges its share if so.
+  bool MayPublish(ClientId client, size_t bytes, Clock::time_point now);
+
+  // Returns whether the frame |client| deferred last may be published now,
+  // and charges its share if so. Returns false if nothing is deferred.
+  bool RetryDeferredFrame(ClientId client, Clock::time_point now);
+  // Forgets the frame |client| deferred last, e.g. when it stopped.
+  void DiscardDeferredFrame(ClientId client);
+
+  // Returns when RetryDeferredFrame is expected to succeed for the first
+  // waiting client, or nothing if no client can publish a deferred frame.
+  std::optional<Clock::time_point> NextDeferredFrameRetry(
+      Clock::time_point now);
+
+  Stats GetStats(ClientId client);
+
+ private:
+  struct Client {
+    Hints hints;
+    Stats stats;
+    double frame_tokens = 1.0;
+    double byte_tokens = 0.0;
+    std::optional<Clock::time_point> last_refill;
+    std::optional<Clock::time_point> last_request;
+    // Size of the frame deferred last, until it or a newer one is published.
+    std::optional<size_t> deferred_bytes;
+  };
+
+  std::mutex mutex_;
+  Budget budget_;
+  ClientId next_id_ = 1;
+  std::unordered_map<ClientId, Client> clients_;
+  DeferredFrameCallback deferred_frame_callback_;
+
+  // Refills |state|'s tokens and charges them if they suffice for a frame
+  // of |bytes|.
+  bool TryCharge(ClientId client, Client& state, size_t bytes,
+                 Clock::time_point now);
+  double Share(ClientId client, Clock::time_point now) const;
+  static double Weight(const Hints& hints);
+};
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <optional>
+
+typedef struct {
+  size_t width;
+  size_t height;
+} Size;
+
+// Produces the frames a texture bridge publishes, e.g. the
+// Windows.Graphics.Capture frame pool of a webview's visual.
+//
+// |Frame| is the handle of a produced frame, such as a D3D11 texture.
+template <typename Frame>
+class FrameSource {
+ public:
+  typedef std::function<void()> FrameArrivedCallback;
+
+  virtual ~FrameSource() = default;
+
+  // Starts producing frames. |on_frame_arrived| is called on the source's
+  // thread whenever TryGetNextFrame has a new frame.
+  virtual bool Start(FrameArrivedCallback on_frame_arrived) = 0;
+  virtual void Stop() = 0;
+
+  // Takes the most recent frame, if there is one that hasn't been taken.
+  virtual std::optional<Frame> TryGetNextFrame() = 0;
+
+  // Reallocates the source's buffers after the size of the content changed.
+  // Frames produced afterwards have the new size.
+  virtual void Recreate() = 0;
+};
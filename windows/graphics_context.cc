@@ -21,18 +21,9 @@ GraphicsContext::GraphicsContext(rx::RoHelper* rohelper) : rohelper_(rohelper) {
 
 winrt::com_ptr<ABI::Windows::UI::Composition::ICompositor>
 GraphicsContext::CreateCompositor() {
-  HSTRING className;
-  HSTRING_HEADER classNameHeader;
-
-  if (FAILED(rohelper_->GetStringReference(
-          RuntimeClass_Windows_UI_Composition_Compositor, &className,
-          &classNameHeader))) {
-    return nullptr;
-  }
-
-  winrt::com_ptr<IActivationFactory> af;
-  if (FAILED(rohelper_->GetActivationFactory(
-          className, __uuidof(IActivationFactory), af.put_void()))) {
+  const auto af = rohelper_->GetActivationFactory<IActivationFactory>(
+      RuntimeClass_Windows_UI_Composition_Compositor);
+  if (!af) {
     return nullptr;
   }
 
@@ -48,22 +39,10 @@ GraphicsContext::CreateCompositor() {
 winrt::com_ptr<ABI::Windows::Graphics::Capture::IGraphicsCaptureItem>
 GraphicsContext::CreateGraphicsCaptureItemFromVisual(
     ABI::Windows::UI::Composition::IVisual* visual) const {
-  HSTRING className;
-  HSTRING_HEADER classNameHeader;
-
-  if (FAILED(rohelper_->GetStringReference(
-          RuntimeClass_Windows_Graphics_Capture_GraphicsCaptureItem, &className,
-          &classNameHeader))) {
-    return nullptr;
-  }
-
-  ABI::Windows::Graphics::Capture::IGraphicsCaptureItemStatics*
-      capture_item_statics;
-  if (FAILED(rohelper_->GetActivationFactory(
-          className,
-          __uuidof(
-              ABI::Windows::Graphics::Capture::IGraphicsCaptureItemStatics),
-          (void**)&capture_item_statics))) {
+  const auto capture_item_statics = rohelper_->GetActivationFactory<
+      ABI::Windows::Graphics::Capture::IGraphicsCaptureItemStatics>(
+      RuntimeClass_Windows_Graphics_Capture_GraphicsCaptureItem);
+  if (!capture_item_statics) {
     return nullptr;
   }
 
@@ -82,22 +61,10 @@ GraphicsContext::CreateCaptureFramePool(
     ABI::Windows::Graphics::DirectX::Direct3D11::IDirect3DDevice* device,
     ABI::Windows::Graphics::DirectX::DirectXPixelFormat pixelFormat,
     INT32 numberOfBuffers, ABI::Windows::Graphics::SizeInt32 size) const {
-  HSTRING className;
-  HSTRING_HEADER classNameHeader;
-
-  if (FAILED(rohelper_->GetStringReference(
-          RuntimeClass_Windows_Graphics_Capture_Direct3D11CaptureFramePool,
-          &className, &classNameHeader))) {
-    return nullptr;
-  }
-
-  ABI::Windows::Graphics::Capture::IDirect3D11CaptureFramePoolStatics*
-      capture_frame_pool_statics;
-  if (FAILED(rohelper_->GetActivationFactory(
-          className,
-          __uuidof(ABI::Windows::Graphics::Capture::
-                       IDirect3D11CaptureFramePoolStatics),
-          (void**)&capture_frame_pool_statics))) {
+  const auto capture_frame_pool_statics = rohelper_->GetActivationFactory<
+      ABI::Windows::Graphics::Capture::IDirect3D11CaptureFramePoolStatics>(
+      RuntimeClass_Windows_Graphics_Capture_Direct3D11CaptureFramePool);
+  if (!capture_frame_pool_statics) {
     return nullptr;
   }
 
@@ -118,22 +85,10 @@ GraphicsContext::CreateFreeThreadedCaptureFramePool(
     ABI::Windows::Graphics::DirectX::Direct3D11::IDirect3DDevice* device,
     ABI::Windows::Graphics::DirectX::DirectXPixelFormat pixelFormat,
     INT32 numberOfBuffers, ABI::Windows::Graphics::SizeInt32 size) const {
-  HSTRING className;
-  HSTRING_HEADER classNameHeader;
-
-  if (FAILED(rohelper_->GetStringReference(
-          RuntimeClass_Windows_Graphics_Capture_Direct3D11CaptureFramePool,
-          &className, &classNameHeader))) {
-    return nullptr;
-  }
-
-  ABI::Windows::Graphics::Capture::IDirect3D11CaptureFramePoolStatics2*
-      capture_frame_pool_statics;
-  if (FAILED(rohelper_->GetActivationFactory(
-          className,
-          __uuidof(ABI::Windows::Graphics::Capture::
-                       IDirect3D11CaptureFramePoolStatics2),
-          (void**)&capture_frame_pool_statics))) {
+  const auto capture_frame_pool_statics = rohelper_->GetActivationFactory<
+      ABI::Windows::Graphics::Capture::IDirect3D11CaptureFramePoolStatics2>(
+      RuntimeClass_Windows_Graphics_Capture_Direct3D11CaptureFramePool);
+  if (!capture_frame_pool_statics) {
     return nullptr;
   }
 
@@ -0,0 +1,163 @@
+#pragma once
+
+#include <flutter/encodable_value.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "cache_policy.h"
+#include "devtools_subscriptions.h"
+
+// Parsers for method call arguments. Kept free of platform dependencies so
+// that they can be benchmarked on any host.
+
+inline std::optional<std::pair<double, double>> GetPointFromArgs(
+    const flutter::EncodableValue* args) {
+  const flutter::EncodableList* list =
+      std::get_if<flutter::EncodableList>(args);
+  if (!list || list->size() != 2) {
+    return std::nullopt;
+  }
+  const auto x = std::get_if<double>(&(*list)[0]);
+  const auto y = std::get_if<double>(&(*list)[1]);
+  if (!x || !y) {
+    return std::nullopt;
+  }
+  return std::make_pair(*x, *y);
+}
+
+inline std::optional<std::tuple<double, double, double>>
+GetPointAndScaleFactorFromArgs(const flutter::EncodableValue* args) {
+  const flutter::EncodableList* list =
+      std::get_if<flutter::EncodableList>(args);
+  if (!list || list->size() != 3) {
+    return std::nullopt;
+  }
+  const auto x = std::get_if<double>(&(*list)[0]);
+  const auto y = std::get_if<double>(&(*list)[1]);
+  const auto z = std::get_if<double>(&(*list)[2]);
+  if (!x || !y || !z) {
+    return std::nullopt;
+  }
+  return std::make_tuple(*x, *y, *z);
+}
+
+// Dart ints arrive as int32 or, if they don't fit 32 bits, as int64.
+inline std::optional<int64_t> GetIntegerValue(
+    const flutter::EncodableValue& value) {
+  if (const auto value32 = std::get_if<int32_t>(&value)) {
+    return *value32;
+  }
+  if (const auto value64 = std::get_if<int64_t>(&value)) {
+    return *value64;
+  }
+  return std::nullopt;
+}
+
+template <typename T>
+std::optional<T> GetOptionalValue(const flutter::EncodableMap& map,
+                                  const std::string& key) {
+  const auto it = map.find(flutter::EncodableValue(key));
+  if (it != map.end()) {
+    const auto val = std::get_if<T>(&it->second);
+    if (val) {
+      return *val;
+    }
+  }
+  return std::nullopt;
+}
+
+// Like GetOptionalValue, for Dart ints of either width.
+inline std::optional<int64_t> GetOptionalInteger(
+    const flutter::EncodableMap& map, const std::string& key) {
+  const auto it = map.find(flutter::EncodableValue(key));
+  if (it != map.end()) {
+    return GetIntegerValue(it->second);
+  }
+  return std::nullopt;
+}
+
+// Parses a list of {"urlPattern": string, "mode": int, "maxAgeSeconds": int?}
+// maps, where mode is the index of a CachePolicy::Mode.
+inline std::optional<std::vector<CachePolicy::Rule>> GetCacheRulesFromArgs(
+    const flutter::EncodableValue* args) {
+  const auto list = std::get_if<flutter::EncodableList>(args);
+  if (!list) {
+    return std::nullopt;
+  }
+  std::vector<CachePolicy::Rule> rules;
+  rules.reserve(list->size());
+  for (const auto& value : *list) {
+    const auto map = std::get_if<flutter::EncodableMap>(&value);
+    if (!map) {
+      return std::nullopt;
+    }
+    const auto pattern = GetOptionalValue<std::string>(*map, "urlPattern");
+    const auto mode = GetOptionalValue<int32_t>(*map, "mode");
+    if (!pattern || !mode || *mode < 0 ||
+        *mode > static_cast<int32_t>(CachePolicy::Mode::kNever)) {
+      return std::nullopt;
+    }
+    CachePolicy::Rule rule;
+    rule.url_pattern = *pattern;
+    rule.mode = static_cast<CachePolicy::Mode>(*mode);
+    if (const auto max_age = GetOptionalInteger(*map, "maxAgeSeconds")) {
+      rule.max_age = std::chrono::seconds(std::max<int64_t>(*max_age, 0));
+    }
+    rules.push_back(std::move(rule));
+  }
+  return rules;
+}
+
+// Parses a list of {"path": string, "op": int, "value": null, bool, number
+// or string} maps, where op is the index of a DevToolsEventFilter::Operator.
+// A missing list is a filter without conditions.
+inline std::optional<DevToolsEventFilter> GetDevToolsEventFilterFromArgs(
+    const flutter::EncodableValue* args) {
+  if (!args || std::holds_alternative<std::monostate>(*args)) {
+    return DevToolsEventFilter();
+  }
+  const auto list = std::get_if<flutter::EncodableList>(args);
+  if (!list) {
+    return std::nullopt;
+  }
+  std::vector<DevToolsEventFilter::Condition> conditions;
+  conditions.reserve(list->size());
+  for (const auto& item : *list) {
+    const auto map = std::get_if<flutter::EncodableMap>(&item);
+    if (!map) {
+      return std::nullopt;
+    }
+    const auto path = GetOptionalValue<std::string>(*map, "path");
+    const auto op = GetOptionalValue<int32_t>(*map, "op");
+    if (!path || !op || *op < 0 ||
+        *op > static_cast<int32_t>(DevToolsEventFilter::Operator::kNotExists)) {
+      return std::nullopt;
+    }
+    DevToolsEventFilter::Condition condition;
+    condition.path = *path;
+    condition.op = static_cast<DevToolsEventFilter::Operator>(*op);
+    const auto it = map->find(flutter::EncodableValue("value"));
+    if (it != map->end()) {
+      const auto& value = it->second;
+      if (const auto boolean = std::get_if<bool>(&value)) {
+        condition.value = *boolean;
+      } else if (const auto integer = GetIntegerValue(value)) {
+        condition.value = static_cast<double>(*integer);
+      } else if (const auto number = std::get_if<double>(&value)) {
+        condition.value = *number;
+      } else if (const auto string = std::get_if<std::string>(&value)) {
+        condition.value = *string;
+      } else if (!std::holds_alternative<std::monostate>(value)) {
+        return std::nullopt;
+      }
+    }
+    conditions.push_back(std::move(condition));
+  }
+  return DevToolsEventFilter(std::move(conditions));
+}
@@ -0,0 +1,432 @@
+#include "method_call_log.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+constexpr char kMagic[4] = {'W', 'V', 'M', 'C'};
+constexpr uint32_t kVersion = 1;
+constexpr size_t kHeaderSize = 8;
+
+// Pending records are written to the file once they exceed this size.
+constexpr size_t kFlushThreshold = 64 * 1024;
+
+// Maximum nesting depth of decoded lists and maps.
+constexpr int kMaxDepth = 512;
+
+enum class ValueTag : uint8_t {
+  kNull = 0,
+  kFalse = 1,
+  kTrue = 2,
+  kInt32 = 3,
+  kInt64 = 4,
+  kDouble = 5,
+  kString = 6,
+  kUint8List = 7,
+  kInt32List = 8,
+  kInt64List = 9,
+  kFloat64List = 10,
+  kList = 11,
+  kMap = 12,
+  kFloat32List = 13,
+};
+
+void PutVarint(std::string& out, uint64_t value) {
+  while (value >= 0x80) {
+    out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  out.push_back(static_cast<char>(value));
+}
+
+void PutSignedVarint(std::string& out, int64_t value) {
+  // Zigzag encoding, so that small negative values stay short.
+  PutVarint(out, (static_cast<uint64_t>(value) << 1) ^
+                     static_cast<uint64_t>(value >> 63));
+}
+
+template <typename T>
+void PutFixed(std::string& out, T value) {
+  uint64_t bits = 0;
+  std::memcpy(&bits, &value, sizeof(T));
+  for (size_t i = 0; i < sizeof(T); ++i) {
+    out.push_back(static_cast<char>((bits >> (8 * i)) & 0xff));
+  }
+}
+
+void PutTag(std::string& out, ValueTag tag) {
+  out.push_back(static_cast<char>(tag));
+}
+
+template <typename T>
+void PutFixedList(std::string& out, ValueTag tag, const std::vector<T>& list) {
+  PutTag(out, tag);
+  PutVarint(out, list.size());
+  for (const auto value : list) {
+    PutFixed(out, value);
+  }
+}
+
+void PutValue(std::string& out, const flutter::EncodableValue& value) {
+  if (const auto boolean = std::get_if<bool>(&value)) {
+    PutTag(out, *boolean ? ValueTag::kTrue : ValueTag::kFalse);
+  } else if (const auto int32 = std::get_if<int32_t>(&value)) {
+    PutTag(out, ValueTag::kInt32);
+    PutSignedVarint(out, *int32);
+  } else if (const auto int64 = std::get_if<int64_t>(&value)) {
+    PutTag(out, ValueTag::kInt64);
+    PutSignedVarint(out, *int64);
+  } else if (const auto number = std::get_if<double>(&value)) {
+    PutTag(out, ValueTag::kDouble);
+    PutFixed(out, *number);
+  } else if (const auto string = std::get_if<std::string>(&value)) {
+    PutTag(out, ValueTag::kString);
+    PutVarint(out, string->size());
+    out.append(*string);
+  } else if (const auto bytes = std::get_if<std::vector<uint8_t>>(&value)) {
+    PutTag(out, ValueTag::kUint8List);
+    PutVarint(out, bytes->size());
+    out.append(reinterpret_cast<const char*>(bytes->data()), bytes->size());
+  } else if (const auto list = std::get_if<std::vector<int32_t>>(&value)) {
+    PutFixedList(out, ValueTag::kInt32List, *list);
+  } else if (const auto list = std::get_if<std::vector<int64_t>>(&value)) {
+    PutFixedList(out, ValueTag::kInt64List, *list);
+  } else if (const auto list = std::get_if<std::vector<double>>(&value)) {
+    PutFixedList(out, ValueTag::kFloat64List, *list);
+  } else if (const auto list = std::get_if<std::vector<float>>(&value)) {
+    PutFixedList(out, ValueTag::kFloat32List, *list);
+  } else if (const auto list = std::get_if<flutter::EncodableList>(&value)) {
+    PutTag(out, ValueTag::kList);
+    PutVarint(out, list->size());
+    for (const auto& element : *list) {
+      PutValue(out, element);
+    }
+  } else if (const auto map = std::get_if<flutter::EncodableMap>(&value)) {
+    PutTag(out, ValueTag::kMap);
+    PutVarint(out, map->size());
+    for (const auto& [key, element] : *map) {
+      PutValue(out, key);
+      PutValue(out, element);
+    }
+  } else {
+    // Null and custom values.
+    PutTag(out, ValueTag::kNull);
+  }
+}
+
+// Reads from a log, failing on reads past the end.
+class Input {
+ public:
+  Input(std::string_view data, size_t& offset)
+      : data_(data), offset_(offset) {}
+
+  bool GetVarint(uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      if (offset_ >= data_.size()) {
+        return false;
+      }
+      const auto byte = static_cast<uint8_t>(data_[offset_++]);
+      value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+      if (!(byte & 0x80)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool GetSignedVarint(int64_t& value) {
+    uint64_t encoded;
+    if (!GetVarint(encoded)) {
+      return false;
+    }
+    value = static_cast<int64_t>(encoded >> 1) ^
+            -static_cast<int64_t>(encoded & 1);
+    return true;
+  }
+
+  template <typename T>
+  bool GetFixed(T& value) {
+    if (data_.size() - offset_ < sizeof(T)) {
+      return false;
+    }
+    uint64_t bits = 0;
+    for (size_t i = 0; i < sizeof(T); ++i) {
+      bits |= static_cast<uint64_t>(static_cast<uint8_t>(data_[offset_++]))
+              << (8 * i);
+    }
+    std::memcpy(&value, &bits, sizeof(T));
+    return true;
+  }
+
+  // Reads a varint count of elements that take at least |min_element_size|
+  // bytes each, so that corrupt counts don't cause huge allocations.
+  bool GetCount(size_t min_element_size, size_t& count) {
+    uint64_t value;
+    if (!GetVarint(value) ||
+        value > (data_.size() - offset_) / min_element_size) {
+      return false;
+    }
+    count = static_cast<size_t>(value);
+    return true;
+  }
+
+  bool GetBytes(size_t size, std::string_view& bytes) {
+    if (data_.size() - offset_ < size) {
+      return false;
+    }
+    bytes = data_.substr(offset_, size);
+    offset_ += size;
+    return true;
+  }
+
+  template <typename T>
+  bool GetFixedList(flutter::EncodableValue& value) {
+    size_t count;
+    if (!GetCount(sizeof(T), count)) {
+      return false;
+    }
+    std::vector<T> list(count);
+    for (auto& element : list) {
+      GetFixed(element);
+    }
+    value = flutter::EncodableValue(std::move(list));
+    return true;
+  }
+
+  bool GetValue(flutter::EncodableValue& value, int depth = 0) {
+    if (offset_ >= data_.size() || depth > kMaxDepth) {
+      return false;
+    }
+    switch (static_cast<ValueTag>(data_[offset_++])) {
+      case ValueTag::kNull:
+        value = flutter::EncodableValue();
+        return true;
+      case ValueTag::kFalse:
+        value = flutter::EncodableValue(false);
+        return true;
+      case ValueTag::kTrue:
+        value = flutter::EncodableValue(true);
+        return true;
+      case ValueTag::kInt32: {
+        int64_t number;
+        if (!GetSignedVarint(number)) {
+          return false;
+        }
+        value = flutter::EncodableValue(static_cast<int32_t>(number));
+        return true;
+      }
+      case ValueTag::kInt64: {
+        int64_t number;
+        if (!GetSignedVarint(number)) {
+          return false;
+        }
+        value = flutter::EncodableValue(number);
+        return true;
+      }
+      case ValueTag::kDouble: {
+        double number;
+        if (!GetFixed(number)) {
+          return false;
+        }
+        value = flutter::EncodableValue(number);
+        return true;
+      }
+      case ValueTag::kString: {
+        uint64_t size;
+        std::string_view bytes;
+        if (!GetVarint(size) || !GetBytes(size, bytes)) {
+          return false;
+        }
+        value = flutter::EncodableValue(std::string(bytes));
+        return true;
+      }
+      case ValueTag::kUint8List: {
+        uint64_t size;
+        std::string_view bytes;
+        if (!GetVarint(size) || !GetBytes(size, bytes)) {
+          return false;
+        }
+        value = flutter::EncodableValue(
+            std::vector<uint8_t>(bytes.begin(), bytes.end()));
+        return true;
+      }
+      case ValueTag::kInt32List:
+        return GetFixedList<int32_t>(value);
+      case ValueTag::kInt64List:
+        return GetFixedList<int64_t>(value);
+      case ValueTag::kFloat64List:
+        return GetFixedList<double>(value);
+      case ValueTag::kFloat32List:
+        return GetFixedList<float>(value);
+      case ValueTag::kList: {
+        size_t count;
+        if (!GetCount(1, count)) {
+          return false;
+        }
+        flutter::EncodableList list(count);
+        for (auto& element : list) {
+          if (!GetValue(element, depth + 1)) {
+            return false;
+          }
+        }
+        value = flutter::EncodableValue(std::move(list));
+        return true;
+      }
+      case ValueTag::kMap: {
+        size_t count;
+        if (!GetCount(2, count)) {
+          return false;
+        }
+        flutter::EncodableMap map;
+        for (size_t i = 0; i < count; ++i) {
+          flutter::EncodableValue key;
+          flutter::EncodableValue element;
+          if (!GetValue(key, depth + 1) || !GetValue(element, depth + 1)) {
+            return false;
+          }
+          map.insert_or_assign(std::move(key), std::move(element));
+        }
+        value = flutter::EncodableValue(std::move(map));
+        return true;
+      }
+    }
+    return false;
+  }
+
+ private:
+  std::string_view data_;
+  size_t& offset_;
+};
+}  // namespace
+
+MethodCallLogWriter::MethodCallLogWriter() {
+  data_.append(kMagic, sizeof(kMagic));
+  PutFixed(data_, kVersion);
+}
+
+void MethodCallLogWriter::Append(std::chrono::microseconds timestamp,
+                                 int64_t instance_id,
+                                 const std::string& method_name,
+                                 const flutter::EncodableValue* arguments) {
+  // Clock adjustments must not produce negative deltas.
+  const auto delta = std::max(timestamp - last_timestamp_,
+                              std::chrono::microseconds::zero());
+  last_timestamp_ += delta;
+  PutVarint(data_, static_cast<uint64_t>(delta.count()));
+  PutSignedVarint(data_, instance_id);
+
+  // New names are stored inline the first time they are used.
+  const auto [it, inserted] =
+      name_indices_.try_emplace(method_name, name_indices_.size());
+  PutVarint(data_, it->second);
+  if (inserted) {
+    PutVarint(data_, method_name.size());
+    data_.append(method_name);
+  }
+
+  if (arguments) {
+    PutValue(data_, *arguments);
+  } else {
+    PutTag(data_, ValueTag::kNull);
+  }
+}
+
+std::string MethodCallLogWriter::TakeData() {
+  std::string data;
+  data.swap(data_);
+  return data;
+}
+
+MethodCallLogReader::MethodCallLogReader(std::string_view data) : data_(data) {
+  uint32_t version = 0;
+  offset_ = sizeof(kMagic);
+  failed_ = data.size() < kHeaderSize ||
+            data.substr(0, sizeof(kMagic)) !=
+                std::string_view(kMagic, sizeof(kMagic)) ||
+            !Input(data_, offset_).GetFixed(version) || version != kVersion;
+}
+
+std::optional<RecordedMethodCall> MethodCallLogReader::Next() {
+  if (failed_ || offset_ >= data_.size()) {
+    return std::nullopt;
+  }
+
+  Input input(data_, offset_);
+  uint64_t delta;
+  RecordedMethodCall call;
+  uint64_t name_index;
+  if (!input.GetVarint(delta) || !input.GetSignedVarint(call.instance_id) ||
+      !input.GetVarint(name_index) || name_index > names_.size()) {
+    failed_ = true;
+    return std::nullopt;
+  }
+
+  if (name_index == names_.size()) {
+    uint64_t size;
+    std::string_view name;
+    if (!input.GetVarint(size) || !input.GetBytes(size, name)) {
+      failed_ = true;
+      return std::nullopt;
+    }
+    names_.emplace_back(name);
+  }
+
+  if (!input.GetValue(call.arguments)) {
+    failed_ = true;
+    return std::nullopt;
+  }
+
+  last_timestamp_ += std::chrono::microseconds(delta);
+  call.timestamp = last_timestamp_;
+  call.method_name = names_[name_index];
+  return call;
+}
+
+// static
+MethodCallRecorder& MethodCallRecorder::Global() {
+  static MethodCallRecorder recorder;
+  return recorder;
+}
+
+bool MethodCallRecorder::Start(const std::filesystem::path& path) {
+  Stop();
+
+  std::lock_guard lock(mutex_);
+  file_.open(path, std::ios::binary | std::ios::trunc);
+  if (!file_) {
+    file_.close();
+    file_.clear();
+    return false;
+  }
+  writer_ = MethodCallLogWriter();
+  start_time_ = Clock::now();
+  recording_.store(true, std::memory_order_relaxed);
+  return true;
+}
+
+void MethodCallRecorder::Stop() {
+  std::lock_guard lock(mutex_);
+  if (!recording_.load(std::memory_order_relaxed)) {
+    return;
+  }
+  recording_.store(false, std::memory_order_relaxed);
+  file_ << writer_.TakeData();
+  file_.close();
+}
+
+void MethodCallRecorder::Record(int64_t instance_id,
+                                const std::string& method_name,
+                                const flutter::EncodableValue* arguments,
+                                Clock::time_point now) {
+  std::lock_guard lock(mutex_);
+  if (!recording_.load(std::memory_order_relaxed)) {
+    return;
+  }
+  writer_.Append(
+      std::chrono::duration_cast<std::chrono::microseconds>(now - start_time_),
+      instance_id, method_name, arguments);
+  if (writer_.pending_size() >= kFlushThreshold) {
+    file_ << writer_.TakeData();
+  }
+}
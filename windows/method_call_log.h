@@ -0,0 +1,103 @@
+#pragma once
+
+#include <flutter/encodable_value.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+struct RecordedMethodCall {
+  // Time since the start of the recording.
+  std::chrono::microseconds timestamp;
+  // Texture id of the webview the call was sent to.
+  int64_t instance_id;
+  std::string method_name;
+  flutter::EncodableValue arguments;
+};
+
+// Encodes method calls into a compact binary log: an 8 byte header ("WVMC",
+// version) followed by one record per call. Records store the timestamp as
+// a delta to the previous record, method names as an index into the names
+// seen so far and arguments in a tagged encoding with varint lengths, all
+// little endian.
+//
+// Custom encodable values can't be serialized and are recorded as null.
+class MethodCallLogWriter {
+ public:
+  MethodCallLogWriter();
+
+  void Append(std::chrono::microseconds timestamp, int64_t instance_id,
+              const std::string& method_name,
+              const flutter::EncodableValue* arguments);
+
+  // Returns the data appended since the last call, starting with the header
+  // on the first call.
+  std::string TakeData();
+
+  size_t pending_size() const { return data_.size(); }
+
+ private:
+  std::string data_;
+  std::chrono::microseconds last_timestamp_{0};
+  std::unordered_map<std::string, uint64_t> name_indices_;
+};
+
+// Decodes the records of a log written by MethodCallLogWriter.
+class MethodCallLogReader {
+ public:
+  explicit MethodCallLogReader(std::string_view data);
+
+  // Returns the next record, or std::nullopt at the end of the log or if
+  // the log is invalid.
+  std::optional<RecordedMethodCall> Next();
+
+  // Whether the header or a record couldn't be decoded. Logs of recordings
+  // that were not stopped properly may end with a truncated record.
+  bool failed() const { return failed_; }
+
+ private:
+  std::string_view data_;
+  size_t offset_ = 0;
+  bool failed_ = false;
+  std::chrono::microseconds last_timestamp_{0};
+  std::vector<std::string> names_;
+};
+
+// Records the method calls received by all webviews into a file.
+class MethodCallRecorder {
+ public:
+  typedef std::chrono::steady_clock Clock;
+
+  // The process-wide recorder WebviewBridge writes to.
+  static MethodCallRecorder& Global();
+
+  // Starts a new recording, replacing the current one. Returns false if
+  // |path| can't be opened.
+  bool Start(const std::filesystem::path& path);
+
+  // Writes the pending records and closes the file.
+  void Stop();
+
+  bool recording() const {
+    return recording_.load(std::memory_order_relaxed);
+  }
+
+  void Record(int64_t instance_id, const std::string& method_name,
+              const flutter::EncodableValue* arguments,
+              Clock::time_point now = Clock::now());
+
+ private:
+  std::atomic<bool> recording_{false};
+  std::mutex mutex_;
+  std::ofstream file_;
+  MethodCallLogWriter writer_;
+  Clock::time_point start_time_;
+};
@@ -0,0 +1,153 @@
+#include "performance_sampler.h"
+
+#include <charconv>
+#include <cmath>
+#include <iterator>
+#include <limits>
+#include <utility>
+
+#include "util/json_path.h"
+
+namespace {
+constexpr double kNotAvailable = std::numeric_limits<double>::quiet_NaN();
+
+// Names of the metrics in Performance.getMetrics results, in the order of
+// PerformanceSampler::Metric. Durations and times are in seconds.
+constexpr std::string_view kMetricNames[] = {
+    "Timestamp",
+    "ProcessTime",
+    "ThreadTime",
+    "TaskDuration",
+    "ScriptDuration",
+    "LayoutDuration",
+    "RecalcStyleDuration",
+    "LayoutCount",
+    "RecalcStyleCount",
+    "JSHeapUsedSize",
+    "JSHeapTotalSize",
+    "Nodes",
+    "Documents",
+    "Frames",
+    "JSEventListeners",
+    "LayoutObjects",
+};
+
+double ParseNumber(std::optional<std::string_view> text) {
+  double value;
+  if (!text || std::from_chars(text->data(), text->data() + text->size(),
+                               value)
+                       .ec != std::errc()) {
+    return kNotAvailable;
+  }
+  return value;
+}
+}  // namespace
+
+bool PerformanceSampler::BeginSample(Clock::time_point now) {
+  if (!next_sample_.has_value() || now < *next_sample_) {
+    return false;
+  }
+  next_sample_.reset();
+  return true;
+}
+
+std::optional<PerformanceSampler::Record> PerformanceSampler::EndSample(
+    std::string_view metrics, std::string_view heap_usage,
+    const FramePacer::FrameCounts& frames, Clock::time_point now) {
+  static_assert(std::size(kMetricNames) == kMetricCount);
+  ScheduleNext(now);
+
+  Sample sample;
+  sample.metrics.fill(kNotAvailable);
+  sample.time = now;
+  const auto list = util::FindJsonValue(metrics, "metrics");
+  if (!list ||
+      !util::ForEachJsonElement(*list, [&sample](std::string_view element) {
+        const auto name = util::FindJsonValue(element, "name");
+        if (!name || name->size() < 2) {
+          return;
+        }
+        // Metric names have nothing to escape.
+        const auto raw_name = name->substr(1, name->size() - 2);
+        for (size_t i = 0; i < kMetricCount; ++i) {
+          if (kMetricNames[i] == raw_name) {
+            sample.metrics[i] =
+                ParseNumber(util::FindJsonValue(element, "value"));
+            break;
+          }
+        }
+      }) ||
+      std::isnan(sample.metrics[kTimestamp])) {
+    return std::nullopt;
+  }
+
+  const auto previous = std::exchange(previous_, sample);
+  if (!previous) {
+    return std::nullopt;
+  }
+  const auto& before = previous->metrics;
+  const auto& after = sample.metrics;
+  for (const auto metric :
+       {kTimestamp, kProcessTime, kThreadTime, kTaskDuration, kScriptDuration,
+        kLayoutDuration, kRecalcStyleDuration, kLayoutCountMetric,
+        kRecalcStyleCountMetric}) {
+    if (after[metric] < before[metric]) {
+      return std::nullopt;
+    }
+  }
+  const double seconds = after[kTimestamp] - before[kTimestamp];
+  if (!(seconds > 0)) {
+    return std::nullopt;
+  }
+  const auto delta = [&before, &after](Metric metric) {
+    return after[metric] - before[metric];
+  };
+
+  Record record;
+  record.fill(kNotAvailable);
+  record[kIntervalMs] = seconds * 1000;
+  record[kCpuUsage] = delta(kProcessTime) / seconds;
+  record[kMainThreadUsage] = delta(kThreadTime) / seconds;
+  record[kTaskMs] = delta(kTaskDuration) * 1000;
+  record[kScriptMs] = delta(kScriptDuration) * 1000;
+  record[kLayoutMs] = delta(kLayoutDuration) * 1000;
+  record[kRecalcStyleMs] = delta(kRecalcStyleDuration) * 1000;
+  record[kLayoutCount] = delta(kLayoutCountMetric);
+  record[kRecalcStyleCount] = delta(kRecalcStyleCountMetric);
+  record[kLayoutsPerSecond] = record[kLayoutCount] / seconds;
+  record[kRecalcStylesPerSecond] = record[kRecalcStyleCount] / seconds;
+  record[kJsHeapUsedBytes] = after[kJsHeapUsedSize];
+  record[kJsHeapTotalBytes] = after[kJsHeapTotalSize];
+  record[kJsHeapGrowthBytesPerSecond] = delta(kJsHeapUsedSize) / seconds;
+  record[kNodes] = after[kNodesMetric];
+  record[kDocuments] = after[kDocumentsMetric];
+  record[kFrames] = after[kFramesMetric];
+  record[kJsEventListeners] = after[kJsEventListenersMetric];
+  record[kLayoutObjects] = after[kLayoutObjectsMetric];
+
+  // Frames are counted in real time rather than page time.
+  const double wall_seconds =
+      std::chrono::duration<double>(now - previous->time).count();
+  if (wall_seconds > 0) {
+    record[kRenderedFramesPerSecond] = frames.arrived / wall_seconds;
+    record[kPublishedFramesPerSecond] = frames.published / wall_seconds;
+  }
+  record[kLongestFrameIntervalMs] = frames.longest_interval.count();
+
+  if (include_memory_ && !heap_usage.empty()) {
+    record[kEmbedderHeapUsedBytes] =
+        ParseNumber(util::FindJsonValue(heap_usage, "embedderHeapUsedSize"));
+    record[kBackingStorageBytes] =
+        ParseNumber(util::FindJsonValue(heap_usage, "backingStorageSize"));
+  }
+  return record;
+}
+
+void PerformanceSampler::AbortSample(Clock::time_point now) {
+  previous_.reset();
+  ScheduleNext(now);
+}
+
+void PerformanceSampler::ScheduleNext(Clock::time_point now) {
+  next_sample_ = now + interval_;
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <optional>
+#include <string_view>
+
+#include "frame_pacer.h"
+
+// Samples the DevTools protocol performance metrics of a page at an interval
+// and turns each pair of consecutive samples into a record of what the page
+// did in between, so that Dart receives a few numbers instead of the JSON of
+// the metrics.
+//
+// A sample is taken in two steps, since the metrics are fetched
+// asynchronously: BeginSample when it is due, then EndSample with the
+// results of Performance.getMetrics and, if memory is included,
+// Runtime.getHeapUsage.
+class PerformanceSampler {
+ public:
+  typedef std::chrono::steady_clock Clock;
+
+  // Values of a record, in the order of the list that Dart receives.
+  // Order must match PerformanceMetrics in lib/src/webview.dart.
+  enum Field {
+    // Page time between the samples.
+    kIntervalMs,
+    // Share of a CPU core used by the renderer process and by its main
+    // thread.
+    kCpuUsage,
+    kMainThreadUsage,
+    // Time spent in tasks, scripts, layouts and style recalculations.
+    kTaskMs,
+    kScriptMs,
+    kLayoutMs,
+    kRecalcStyleMs,
+    kLayoutCount,
+    kRecalcStyleCount,
+    kLayoutsPerSecond,
+    kRecalcStylesPerSecond,
+    kJsHeapUsedBytes,
+    kJsHeapTotalBytes,
+    kJsHeapGrowthBytesPerSecond,
+    kNodes,
+    kDocuments,
+    // Frames of the page, including the main frame.
+    kFrames,
+    kJsEventListeners,
+    kLayoutObjects,
+    // Frames rendered by the page and published to the texture.
+    kRenderedFramesPerSecond,
+    kPublishedFramesPerSecond,
+    kLongestFrameIntervalMs,
+    // Only with memory included.
+    kEmbedderHeapUsedBytes,
+    kBackingStorageBytes,
+    kFieldCount,
+  };
+
+  // Values that are not available are NaN.
+  typedef std::array<double, kFieldCount> Record;
+
+  PerformanceSampler(Clock::duration interval, bool include_memory)
+      : interval_(interval), include_memory_(include_memory) {}
+
+  bool include_memory() const { return include_memory_; }
+
+  // Returns when the next sample is due, or std::nullopt while a sample is
+  // being taken.
+  std::optional<Clock::time_point> next_sample() const {
+    return next_sample_;
+  }
+
+  // Starts the sample that is due at |now|. Returns false if none is.
+  bool BeginSample(Clock::time_point now);
+
+  // Ends the sample with the JSON results of Performance.getMetrics and
+  // Runtime.getHeapUsage, which is empty if memory is not included, and the
+  // frames counted since the previous sample. Returns the record of the
+  // interval since the previous sample, or std::nullopt if there is none,
+  // or if the metrics restarted, as they do when the renderer process is
+  // replaced.
+  std::optional<Record> EndSample(std::string_view metrics,
+                                  std::string_view heap_usage,
+                                  const FramePacer::FrameCounts& frames,
+                                  Clock::time_point now);
+
+  // Ends a sample whose metrics couldn't be fetched, or skips the one that
+  // is due, for example while the webview is suspended. The next sample
+  // then only restarts the interval.
+  void AbortSample(Clock::time_point now);
+
+ private:
+  // The metrics that records are computed from.
+  enum Metric {
+    kTimestamp,
+    kProcessTime,
+    kThreadTime,
+    kTaskDuration,
+    kScriptDuration,
+    kLayoutDuration,
+    kRecalcStyleDuration,
+    kLayoutCountMetric,
+    kRecalcStyleCountMetric,
+    kJsHeapUsedSize,
+    kJsHeapTotalSize,
+    kNodesMetric,
+    kDocumentsMetric,
+    kFramesMetric,
+    kJsEventListenersMetric,
+    kLayoutObjectsMetric,
+    kMetricCount,
+  };
+
+  struct Sample {
+    std::array<double, kMetricCount> metrics;
+    Clock::time_point time;
+  };
+
+  Clock::duration interval_;
+  bool include_memory_;
+  std::optional<Clock::time_point> next_sample_ = Clock::time_point();
+  std::optional<Sample> previous_;
+
+  void ScheduleNext(Clock::time_point now);
+};
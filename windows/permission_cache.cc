@@ -0,0 +1,131 @@
+#include "permission_cache.h"
+
+#include <algorithm>
+#include <cctype>
+
+namespace {
+
+std::string ToLower(std::string_view value) {
+  std::string result(value);
+  std::transform(result.begin(), result.end(), result.begin(),
+                 [](unsigned char c) { return std::tolower(c); });
+  return result;
+}
+
+std::string_view DefaultPort(std::string_view scheme) {
+  if (scheme == "http" || scheme == "ws") {
+    return "80";
+  }
+  if (scheme == "https" || scheme == "wss") {
+    return "443";
+  }
+  return {};
+}
+
+}  // namespace
+
+// static
+std::string PermissionCache::NormalizeOrigin(std::string_view url) {
+  const auto scheme_end = url.find("://");
+  if (scheme_end == std::string_view::npos || scheme_end == 0) {
+    // Opaque origins (about:, data:, ...) are never cached.
+    return {};
+  }
+
+  const auto scheme = ToLower(url.substr(0, scheme_end));
+  if (!std::all_of(scheme.begin(), scheme.end(), [](unsigned char c) {
+        return std::isalnum(c) || c == '+' || c == '-' || c == '.';
+      })) {
+    return {};
+  }
+
+  auto authority = url.substr(scheme_end + 3);
+  authority = authority.substr(0, authority.find_first_of("/?#"));
+
+  const auto at = authority.rfind('@');
+  if (at != std::string_view::npos) {
+    authority = authority.substr(at + 1);
+  }
+
+  std::string_view host = authority;
+  std::string_view port;
+  const auto ipv6_end = authority.find(']');
+  const auto colon = authority.find(
+      ':', ipv6_end == std::string_view::npos ? 0 : ipv6_end);
+  if (colon != std::string_view::npos) {
+    host = authority.substr(0, colon);
+    port = authority.substr(colon + 1);
+  }
+
+  if (host.empty()) {
+    return scheme == "file" ? scheme + "://" : std::string();
+  }
+
+  auto origin = scheme + "://" + ToLower(host);
+  if (!port.empty() && port != DefaultPort(scheme)) {
+    origin += ':';
+    origin += port;
+  }
+  return origin;
+}
+
+std::optional<bool> PermissionCache::Lookup(std::string_view url, int32_t kind,
+                                            bool is_user_initiated,
+                                            Clock::time_point now) {
+  auto origin = NormalizeOrigin(url);
+  if (origin.empty()) {
+    return std::nullopt;
+  }
+
+  const auto it =
+      entries_.find(Key(std::move(origin), kind, is_user_initiated));
+  if (it == entries_.end()) {
+    return std::nullopt;
+  }
+
+  if (it->second.expires_at.has_value() && *it->second.expires_at <= now) {
+    entries_.erase(it);
+    return std::nullopt;
+  }
+  return it->second.allow;
+}
+
+void PermissionCache::Set(std::string_view url, int32_t kind,
+                          std::optional<bool> is_user_initiated, bool allow,
+                          std::optional<Clock::duration> ttl,
+                          Clock::time_point now) {
+  const auto origin = NormalizeOrigin(url);
+  if (origin.empty()) {
+    return;
+  }
+
+  Entry entry{allow, std::nullopt};
+  if (ttl.has_value()) {
+    entry.expires_at = now + *ttl;
+  }
+
+  if (!is_user_initiated.has_value() || *is_user_initiated) {
+    entries_[Key(origin, kind, true)] = entry;
+  }
+  if (!is_user_initiated.has_value() || !*is_user_initiated) {
+    entries_[Key(origin, kind, false)] = entry;
+  }
+}
+
+void PermissionCache::Invalidate(std::optional<std::string_view> url,
+                                 std::optional<int32_t> kind) {
+  std::optional<std::string> origin;
+  if (url.has_value()) {
+    origin = NormalizeOrigin(*url);
+  }
+
+  for (auto it = entries_.begin(); it != entries_.end();) {
+    const auto& [entry_origin, entry_kind, _] = it->first;
+    if ((!origin.has_value() || *origin == entry_origin) &&
+        (!kind.has_value() || *kind == entry_kind)) {
+      it = entries_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
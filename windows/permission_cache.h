@@ -0,0 +1,54 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+
+// Caches permission decisions keyed by (origin, permission kind,
+// user-initiated) so that repeated requests can be answered natively without
+// a round trip to Dart.
+//
+// Entries either expire after a TTL or are sticky until they are
+// invalidated explicitly.
+class PermissionCache {
+ public:
+  typedef std::chrono::steady_clock Clock;
+
+  // Returns the cached decision (true = allow, false = deny) for the origin
+  // of |url|, or std::nullopt if there is no valid entry.
+  std::optional<bool> Lookup(std::string_view url, int32_t kind,
+                             bool is_user_initiated, Clock::time_point now);
+
+  // Stores a decision for the origin of |url|. If |is_user_initiated| is
+  // empty, the decision applies to both user-initiated and other requests.
+  // An empty |ttl| makes the decision sticky.
+  void Set(std::string_view url, int32_t kind,
+           std::optional<bool> is_user_initiated, bool allow,
+           std::optional<Clock::duration> ttl, Clock::time_point now);
+
+  // Removes all entries matching the given origin and/or kind. Passing
+  // neither clears the whole cache.
+  void Invalidate(std::optional<std::string_view> url,
+                  std::optional<int32_t> kind);
+
+  size_t size() const { return entries_.size(); }
+
+  // Reduces a URL to its origin ("scheme://host[:port]"), lowercasing the
+  // scheme and host and dropping user info and default ports. Returns an
+  // empty string if no origin can be derived.
+  static std::string NormalizeOrigin(std::string_view url);
+
+ private:
+  typedef std::tuple<std::string, int32_t, bool> Key;
+
+  struct Entry {
+    bool allow;
+    std::optional<Clock::time_point> expires_at;
+  };
+
+  std::map<Key, Entry> entries_;
+};
@@ -0,0 +1,112 @@
+#include "pointer_predictor.h"
+
+#include <algorithm>
+#include <cmath>
+
+void PointerPredictor::SetOptions(const Options& options) {
+  options_ = options;
+  if (!enabled()) {
+    Clear();
+  }
+}
+
+std::pair<double, double> PointerPredictor::Update(int32_t pointer, Phase phase,
+                                                   int64_t timestamp_us,
+                                                   double x, double y) {
+  if (phase == Phase::kUp) {
+    RemoveTrack(pointer);
+    return {x, y};
+  }
+  if (phase == Phase::kDown) {
+    RemoveTrack(pointer);
+  }
+
+  auto& track = GetTrack(pointer);
+  track.samples[track.next] = {timestamp_us, x, y};
+  track.next = (track.next + 1) % kMaxSamples;
+  track.count = std::min(track.count + 1, kMaxSamples);
+
+  if (phase == Phase::kDown || !enabled()) {
+    return {x, y};
+  }
+  return Predict(track);
+}
+
+PointerPredictor::Track& PointerPredictor::GetTrack(int32_t pointer) {
+  for (auto& track : tracks_) {
+    if (track.pointer == pointer) {
+      return track;
+    }
+  }
+
+  if (tracks_.size() >= kMaxPointers) {
+    const auto latest_timestamp = [](const Track& track) {
+      return track.samples[(track.next + kMaxSamples - 1) % kMaxSamples]
+          .timestamp_us;
+    };
+    tracks_.erase(std::min_element(tracks_.begin(), tracks_.end(),
+                                   [&](const Track& a, const Track& b) {
+                                     return latest_timestamp(a) <
+                                            latest_timestamp(b);
+                                   }));
+  }
+  tracks_.push_back(Track{pointer});
+  return tracks_.back();
+}
+
+void PointerPredictor::RemoveTrack(int32_t pointer) {
+  tracks_.erase(std::remove_if(tracks_.begin(), tracks_.end(),
+                               [pointer](const Track& track) {
+                                 return track.pointer == pointer;
+                               }),
+                tracks_.end());
+}
+
+std::pair<double, double> PointerPredictor::Predict(const Track& track) const {
+  const auto& latest =
+      track.samples[(track.next + kMaxSamples - 1) % kMaxSamples];
+
+  // Fits x(t) and y(t) to lines over the samples in the window, with times
+  // relative to the latest sample to keep the sums small.
+  size_t n = 0;
+  double sum_t = 0, sum_x = 0, sum_y = 0;
+  double sum_tt = 0, sum_tx = 0, sum_ty = 0;
+  for (size_t i = 0; i < track.count; ++i) {
+    const auto& sample =
+        track.samples[(track.next + kMaxSamples - 1 - i) % kMaxSamples];
+    const auto age_us = latest.timestamp_us - sample.timestamp_us;
+    if (age_us < 0 || age_us > options_.window.count()) {
+      break;
+    }
+    const double t = -static_cast<double>(age_us);
+    const double dx = sample.x - latest.x;
+    const double dy = sample.y - latest.y;
+    ++n;
+    sum_t += t;
+    sum_x += dx;
+    sum_y += dy;
+    sum_tt += t * t;
+    sum_tx += t * dx;
+    sum_ty += t * dy;
+  }
+
+  const double denominator = n * sum_tt - sum_t * sum_t;
+  if (n < 2 || denominator <= 0) {
+    return {latest.x, latest.y};
+  }
+
+  // Velocities in units per microsecond.
+  const double velocity_x = (n * sum_tx - sum_t * sum_x) / denominator;
+  const double velocity_y = (n * sum_ty - sum_t * sum_y) / denominator;
+  const double lookahead = static_cast<double>(options_.lookahead.count());
+  double offset_x = velocity_x * lookahead;
+  double offset_y = velocity_y * lookahead;
+
+  const double distance = std::hypot(offset_x, offset_y);
+  if (distance > options_.max_distance) {
+    const double scale = options_.max_distance / distance;
+    offset_x *= scale;
+    offset_y *= scale;
+  }
+  return {latest.x + offset_x, latest.y + offset_y};
+}
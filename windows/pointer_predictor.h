@@ -0,0 +1,70 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Extrapolates touch pointers a short time ahead, to hide the latency
+// between Flutter receiving a touch and the page seeing it.
+//
+// The velocity of each pointer is a least-squares fit over its recent
+// samples; the prediction moves the latest position along it by the
+// lookahead. Predictions never cross a down or up: a pointer is only
+// predicted once it has moved since going down, and the position of an up
+// is passed through unchanged.
+class PointerPredictor {
+ public:
+  enum class Phase { kDown, kMove, kUp };
+
+  struct Options {
+    // How far ahead to predict. Zero disables prediction.
+    std::chrono::microseconds lookahead{0};
+    // Only samples this recent take part in the fit.
+    std::chrono::microseconds window{std::chrono::milliseconds(50)};
+    // Upper bound of the distance between the latest and the predicted
+    // position, in the units of the positions.
+    double max_distance = 32;
+  };
+
+  // Maximum number of samples per pointer used for the fit.
+  static constexpr size_t kMaxSamples = 8;
+  // Maximum number of pointers tracked at once. Touches that are cancelled
+  // never send an up, so the least recently updated pointer is dropped.
+  static constexpr size_t kMaxPointers = 10;
+
+  void SetOptions(const Options& options);
+  const Options& options() const { return options_; }
+  bool enabled() const { return options_.lookahead.count() > 0; }
+
+  // Records a sample of |pointer| taken at |timestamp_us| and returns the
+  // position to dispatch instead of (|x|, |y|).
+  std::pair<double, double> Update(int32_t pointer, Phase phase,
+                                   int64_t timestamp_us, double x, double y);
+
+  // Forgets all pointers.
+  void Clear() { tracks_.clear(); }
+
+ private:
+  struct Sample {
+    int64_t timestamp_us = 0;
+    double x = 0.0;
+    double y = 0.0;
+  };
+
+  struct Track {
+    int32_t pointer = 0;
+    std::array<Sample, kMaxSamples> samples = {};
+    size_t count = 0;
+    size_t next = 0;
+  };
+
+  Options options_;
+  std::vector<Track> tracks_;
+
+  Track& GetTrack(int32_t pointer);
+  void RemoveTrack(int32_t pointer);
+  std::pair<double, double> Predict(const Track& track) const;
+};
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <optional>
+
+// Keeps a number of pre-created, idle instances around so that they can be
+// handed out immediately instead of being created on demand.
+//
+// Instances are created asynchronously through the factory. Idle instances
+// that are not taken within the idle timeout are released and only replaced
+// once the pool is used again.
+template <typename T>
+class PrewarmPool {
+ public:
+  typedef std::chrono::steady_clock Clock;
+  typedef std::function<void(std::unique_ptr<T>)> CreatedCallback;
+  typedef std::function<void(CreatedCallback)> Factory;
+
+  explicit PrewarmPool(Factory factory)
+      : factory_(std::move(factory)), state_(std::make_shared<State>()) {}
+
+  // Sets the number of idle instances to keep and the time after which an
+  // idle instance gets released. Excess idle instances are released
+  // immediately.
+  void SetLimits(size_t size, std::optional<Clock::duration> idle_timeout) {
+    state_->size = size;
+    state_->idle_timeout = idle_timeout;
+    while (state_->idle.size() > size) {
+      state_->idle.pop_front();
+    }
+  }
+
+  // Returns the most recently created idle instance or nullptr if the pool
+  // is empty. Call |Refill| afterwards to replace it.
+  std::unique_ptr<T> Take() {
+    if (state_->idle.empty()) {
+      return nullptr;
+    }
+    auto instance = std::move(state_->idle.back().instance);
+    state_->idle.pop_back();
+    return instance;
+  }
+
+  // Starts as many creations as needed to reach the configured size. The
+  // count is decided up front, since creations may complete, or fail,
+  // before the factory returns; failed ones are retried by the next call.
+  void Refill() {
+    const auto filled = state_->idle.size() + state_->pending;
+    const auto missing = state_->size > filled ? state_->size - filled : 0;
+    for (size_t i = 0; i < missing; ++i) {
+      ++state_->pending;
+      factory_([weak_state = std::weak_ptr<State>(state_)](
+                   std::unique_ptr<T> instance) {
+        auto state = weak_state.lock();
+        if (!state) {
+          return;
+        }
+        --state->pending;
+        if (instance && state->idle.size() < state->size) {
+          state->idle.push_back({std::move(instance), Clock::now()});
+        }
+      });
+    }
+  }
+
+  // Releases idle instances that exceeded the idle timeout. Returns the
+  // number of released instances.
+  size_t Trim(Clock::time_point now) {
+    if (!state_->idle_timeout.has_value()) {
+      return 0;
+    }
+    const auto deadline = now - *state_->idle_timeout;
+    const auto it = std::find_if(
+        state_->idle.begin(), state_->idle.end(),
+        [deadline](const Entry& entry) { return entry.created_at > deadline; });
+    const auto count = static_cast<size_t>(it - state_->idle.begin());
+    state_->idle.erase(state_->idle.begin(), it);
+    return count;
+  }
+
+  // Returns the time at which the oldest idle instance expires, if any.
+  std::optional<Clock::time_point> NextExpiry() const {
+    if (!state_->idle_timeout.has_value() || state_->idle.empty()) {
+      return std::nullopt;
+    }
+    return state_->idle.front().created_at + *state_->idle_timeout;
+  }
+
+  // Releases all idle instances and discards the creations that are still
+  // pending once they complete, but keeps the limits. Used when the
+  // instances the factory creates change, so that the pool is refilled
+  // with new ones only.
+  void Drain() {
+    auto state = std::make_shared<State>();
+    state->size = state_->size;
+    state->idle_timeout = state_->idle_timeout;
+    state_ = std::move(state);
+  }
+
+  // Releases all idle instances. Creations that are still pending are
+  // discarded once they complete.
+  void Clear() {
+    state_->idle.clear();
+    state_->size = 0;
+  }
+
+  size_t size() const { return state_->size; }
+  size_t idle_count() const { return state_->idle.size(); }
+  size_t pending_count() const { return state_->pending; }
+
+ private:
+  struct Entry {
+    std::unique_ptr<T> instance;
+    Clock::time_point created_at;
+  };
+
+  // Shared with pending factory callbacks so that completions arriving after
+  // the pool has been destroyed are dropped safely.
+  struct State {
+    std::deque<Entry> idle;
+    size_t pending = 0;
+    size_t size = 0;
+    std::optional<Clock::duration> idle_timeout;
+  };
+
+  Factory factory_;
+  std::shared_ptr<State> state_;
+};
@@ -0,0 +1,541 @@
+#include "response_cache.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include "util/hash.h"
+
+namespace {
+constexpr char kEntryDirectory[] = "entries";
+constexpr char kBodyDirectory[] = "bodies";
+constexpr char kTemporarySuffix[] = ".tmp";
+// First line of entry files, to be changed along with their format.
+constexpr std::string_view kEntryFileHeader = "webview_windows cache 1";
+
+// Entries larger than this fraction of a limit aren't kept at that level,
+// so that one entry can't push out all others.
+constexpr uint64_t kMaxEntryFraction = 8;
+// Trimming the disk removes files until this fraction of its limit is used,
+// so that it doesn't have to list the files on every store.
+constexpr double kDiskTrimTarget = 0.75;
+
+std::string ToHex(uint64_t value) {
+  constexpr char kDigits[] = "0123456789abcdef";
+  std::string hex(16, '0');
+  for (size_t i = hex.size(); i-- > 0; value >>= 4) {
+    hex[i] = kDigits[value & 0xf];
+  }
+  return hex;
+}
+
+uint64_t GetMemorySize(const ResponseCache::Entry& entry) {
+  return sizeof(entry) + entry.url.size() + entry.headers.size() +
+         entry.body.size();
+}
+
+bool ReadFile(const std::filesystem::path& path, std::string& contents) {
+  std::ifstream in(path, std::ios::binary);
+  if (!in) {
+    return false;
+  }
+  in.seekg(0, std::ios::end);
+  const auto size = in.tellg();
+  if (size < 0) {
+    return false;
+  }
+  contents.resize(static_cast<size_t>(size));
+  in.seekg(0);
+  return static_cast<bool>(in.read(contents.data(), size));
+}
+
+// Writes a temporary file and moves it into place, so that readers never
+// see a partial file.
+bool WriteFile(const std::filesystem::path& path, std::string_view contents) {
+  auto temporary_path = path;
+  temporary_path += kTemporarySuffix;
+  {
+    std::ofstream out(temporary_path, std::ios::binary | std::ios::trunc);
+    if (!out ||
+        !out.write(contents.data(),
+                   static_cast<std::streamsize>(contents.size()))) {
+      return false;
+    }
+  }
+  std::error_code error;
+  std::filesystem::rename(temporary_path, path, error);
+  if (error) {
+    std::filesystem::remove(temporary_path, error);
+    return false;
+  }
+  return true;
+}
+
+void Touch(const std::filesystem::path& path) {
+  std::error_code error;
+  std::filesystem::last_write_time(
+      path, std::filesystem::file_time_type::clock::now(), error);
+}
+
+uint64_t GetFileSize(const std::filesystem::path& path) {
+  std::error_code error;
+  const auto size = std::filesystem::file_size(path, error);
+  return error ? 0 : size;
+}
+
+// An entry file without the body, which is stored separately.
+struct EntryFile {
+  std::string_view url;
+  int64_t expires_at = 0;
+  std::string_view body_name;
+  std::string_view headers;
+};
+
+std::string FormatEntryFile(const ResponseCache::Entry& entry,
+                            const std::string& body_name) {
+  std::string contents;
+  contents.reserve(kEntryFileHeader.size() + entry.url.size() +
+                   body_name.size() + entry.headers.size() + 32);
+  contents += kEntryFileHeader;
+  contents += '\n';
+  contents += entry.url;
+  contents += '\n';
+  contents += std::to_string(entry.expires_at);
+  contents += '\n';
+  contents += body_name;
+  contents += '\n';
+  contents += entry.headers;
+  return contents;
+}
+
+bool ParseEntryFile(std::string_view contents, EntryFile& file) {
+  std::string_view lines[4];
+  for (auto& line : lines) {
+    const auto end = contents.find('\n');
+    if (end == std::string_view::npos) {
+      return false;
+    }
+    line = contents.substr(0, end);
+    contents.remove_prefix(end + 1);
+  }
+  if (lines[0] != kEntryFileHeader) {
+    return false;
+  }
+  const std::string expires_at(lines[2]);
+  char* end = nullptr;
+  file.url = lines[1];
+  file.expires_at = std::strtoll(expires_at.c_str(), &end, 10);
+  file.body_name = lines[3];
+  file.headers = contents;
+  // Body names are made of hex digits and a dash, never a path.
+  return end && *end == '\0' && !file.body_name.empty() &&
+         file.body_name.find_first_not_of("0123456789abcdef-") ==
+             std::string_view::npos;
+}
+}  // namespace
+
+// static
+std::shared_ptr<ResponseCache> ResponseCache::Open(
+    const std::filesystem::path& directory, std::string& error) {
+  std::shared_ptr<ResponseCache> cache(new ResponseCache(directory));
+  std::error_code error_code;
+  std::filesystem::create_directories(cache->entry_directory_, error_code);
+  if (!error_code) {
+    std::filesystem::create_directories(cache->body_directory_, error_code);
+  }
+  if (error_code) {
+    error = "Failed to create the cache directory: " + error_code.message();
+    return nullptr;
+  }
+
+  // Files left behind by interrupted writes are removed, the others count
+  // towards the limit. Entry files are small, and are read to index the
+  // entries.
+  std::string contents;
+  for (const auto& subdirectory :
+       {cache->entry_directory_, cache->body_directory_}) {
+    for (const auto& file :
+         std::filesystem::directory_iterator(subdirectory, error_code)) {
+      if (file.path().extension() == kTemporarySuffix) {
+        std::filesystem::remove(file.path(), error_code);
+        continue;
+      }
+      cache->stats_.disk_bytes += GetFileSize(file.path());
+      EntryFile entry_file;
+      if (subdirectory == cache->entry_directory_ &&
+          ReadFile(file.path(), contents) &&
+          ParseEntryFile(contents, entry_file)) {
+        cache->disk_index_[util::Hash64(entry_file.url)] =
+            entry_file.expires_at;
+      }
+    }
+  }
+  cache->disk_thread_ = std::thread(&ResponseCache::RunDiskTasks, cache.get());
+  return cache;
+}
+
+// static
+std::shared_ptr<ResponseCache> ResponseCache::OpenShared(
+    const std::filesystem::path& directory, std::string& error) {
+  static std::mutex mutex;
+  static std::map<std::filesystem::path, std::weak_ptr<ResponseCache>> caches;
+
+  // Spellings of the same directory, e.g. with a trailing separator, share
+  // the cache.
+  auto key = directory.lexically_normal();
+  if (!key.has_filename()) {
+    key = key.parent_path();
+  }
+
+  const std::lock_guard<std::mutex> lock(mutex);
+  auto& shared_cache = caches[key];
+  if (auto cache = shared_cache.lock()) {
+    return cache;
+  }
+  auto cache = Open(directory, error);
+  shared_cache = cache;
+  return cache;
+}
+
+ResponseCache::ResponseCache(const std::filesystem::path& directory)
+    : entry_directory_(directory / kEntryDirectory),
+      body_directory_(directory / kBodyDirectory) {}
+
+ResponseCache::~ResponseCache() {
+  {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  disk_tasks_changed_.notify_all();
+  if (disk_thread_.joinable()) {
+    disk_thread_.join();
+  }
+}
+
+void ResponseCache::SetLimits(const Limits& limits) {
+  const std::lock_guard<std::mutex> lock(mutex_);
+  limits_ = limits;
+  TrimMemory();
+  PostDiskTask([this]() { TrimDisk(); });
+}
+
+uint64_t ResponseCache::max_body_size() const {
+  const std::lock_guard<std::mutex> lock(mutex_);
+  return limits_.max_disk_bytes / kMaxEntryFraction;
+}
+
+std::shared_ptr<const ResponseCache::Entry> ResponseCache::Lookup(
+    std::string_view url, int64_t now) {
+  const std::lock_guard<std::mutex> lock(mutex_);
+  const auto it = memory_index_.find(util::Hash64(url));
+  if (it != memory_index_.end() && (*it->second)->url == url) {
+    const auto entry = *it->second;
+    if (entry->expires_at > now) {
+      memory_entries_.splice(memory_entries_.begin(), memory_entries_,
+                             it->second);
+      ++stats_.memory_hits;
+      return entry;
+    }
+    RemoveFromMemory(url);
+  }
+
+  const auto hash = util::Hash64(url);
+  const auto unwritten = unwritten_.find(hash);
+  if (unwritten != unwritten_.end() && unwritten->second->url == url &&
+      unwritten->second->expires_at > now) {
+    ++stats_.memory_hits;
+    return unwritten->second;
+  }
+  const auto indexed = disk_index_.find(hash);
+  if (indexed == disk_index_.end()) {
+    ++stats_.misses;
+    return nullptr;
+  }
+  if (indexed->second <= now) {
+    disk_index_.erase(indexed);
+    PostDiskTask([this, path = GetEntryPath(url)]() { RemoveFile(path); });
+    ++stats_.misses;
+    return nullptr;
+  }
+
+  auto entry = ReadEntry(url, now);
+  if (!entry) {
+    ++stats_.misses;
+    return nullptr;
+  }
+  ++stats_.disk_hits;
+  AddToMemory(entry);
+  return entry;
+}
+
+bool ResponseCache::Contains(std::string_view url, int64_t now) {
+  const std::lock_guard<std::mutex> lock(mutex_);
+  const auto hash = util::Hash64(url);
+  const auto it = memory_index_.find(hash);
+  if (it != memory_index_.end() && (*it->second)->url == url) {
+    return (*it->second)->expires_at > now;
+  }
+  const auto indexed = disk_index_.find(hash);
+  return indexed != disk_index_.end() && indexed->second > now;
+}
+
+bool ResponseCache::Store(Entry entry) {
+  const std::lock_guard<std::mutex> lock(mutex_);
+  if (entry.body.size() > limits_.max_disk_bytes / kMaxEntryFraction) {
+    return false;
+  }
+
+  const auto hash = util::Hash64(entry.url);
+  const auto stored = std::make_shared<const Entry>(std::move(entry));
+  disk_index_[hash] = stored->expires_at;
+  unwritten_[hash] = stored;
+  AddToMemory(stored);
+  PostDiskTask([this, stored]() { WriteEntry(stored); });
+  return true;
+}
+
+void ResponseCache::Clear() {
+  const std::lock_guard<std::mutex> lock(mutex_);
+  memory_entries_.clear();
+  memory_index_.clear();
+  stats_.memory_bytes = 0;
+  disk_index_.clear();
+  unwritten_.clear();
+
+  // Queued work is moot, and the files of a write that is running are
+  // removed after it.
+  disk_tasks_.clear();
+  PostDiskTask([this]() { ClearDisk(); });
+}
+
+void ResponseCache::Flush() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  disk_tasks_changed_.wait(lock, [this]() {
+    return disk_tasks_.empty() && !running_disk_task_;
+  });
+}
+
+ResponseCache::Stats ResponseCache::stats() const {
+  const std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+std::filesystem::path ResponseCache::GetEntryPath(std::string_view url) const {
+  return entry_directory_ / ToHex(util::Hash64(url));
+}
+
+std::shared_ptr<const ResponseCache::Entry> ResponseCache::ReadEntry(
+    std::string_view url, int64_t now) {
+  const auto path = GetEntryPath(url);
+  std::string contents;
+  EntryFile file;
+  if (!ReadFile(path, contents) || !ParseEntryFile(contents, file) ||
+      file.url != url) {
+    return nullptr;
+  }
+
+  auto body_path = body_directory_ / std::string(file.body_name);
+  auto entry = std::make_shared<Entry>();
+  if (file.expires_at <= now || !ReadFile(body_path, entry->body)) {
+    // Stale, or its body has been trimmed.
+    disk_index_.erase(util::Hash64(url));
+    PostDiskTask([this, path]() { RemoveFile(path); });
+    return nullptr;
+  }
+  entry->url = url;
+  entry->headers = file.headers;
+  entry->expires_at = file.expires_at;
+  // Marks the files as recently used for trimming.
+  PostDiskTask([path, body_path = std::move(body_path)]() {
+    Touch(path);
+    Touch(body_path);
+  });
+  return entry;
+}
+
+void ResponseCache::AddToMemory(std::shared_ptr<const Entry> entry) {
+  const auto hash = util::Hash64(entry->url);
+  const auto it = memory_index_.find(hash);
+  if (it != memory_index_.end()) {
+    stats_.memory_bytes -= GetMemorySize(**it->second);
+    memory_entries_.erase(it->second);
+    memory_index_.erase(it);
+  }
+
+  const auto size = GetMemorySize(*entry);
+  if (size > limits_.max_memory_bytes / kMaxEntryFraction) {
+    return;
+  }
+  memory_entries_.push_front(std::move(entry));
+  memory_index_[hash] = memory_entries_.begin();
+  stats_.memory_bytes += size;
+  TrimMemory();
+}
+
+void ResponseCache::RemoveFromMemory(std::string_view url) {
+  const auto it = memory_index_.find(util::Hash64(url));
+  if (it == memory_index_.end()) {
+    return;
+  }
+  stats_.memory_bytes -= GetMemorySize(**it->second);
+  memory_entries_.erase(it->second);
+  memory_index_.erase(it);
+}
+
+void ResponseCache::TrimMemory() {
+  while (stats_.memory_bytes > limits_.max_memory_bytes &&
+         !memory_entries_.empty()) {
+    RemoveFromMemory(memory_entries_.back()->url);
+  }
+}
+
+void ResponseCache::PostDiskTask(std::function<void()> task) {
+  disk_tasks_.push_back(std::move(task));
+  disk_tasks_changed_.notify_all();
+}
+
+void ResponseCache::RunDiskTasks() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    disk_tasks_changed_.wait(
+        lock, [this]() { return stopping_ || !disk_tasks_.empty(); });
+    // Queued work is finished before stopping.
+    if (disk_tasks_.empty()) {
+      return;
+    }
+    const auto task = std::move(disk_tasks_.front());
+    disk_tasks_.pop_front();
+    running_disk_task_ = true;
+    lock.unlock();
+    task();
+    lock.lock();
+    running_disk_task_ = false;
+    disk_tasks_changed_.notify_all();
+  }
+}
+
+void ResponseCache::WriteEntry(const std::shared_ptr<const Entry>& entry) {
+  const auto path = GetEntryPath(entry->url);
+  const auto replaced_size = GetFileSize(path);
+  std::string body_name;
+  uint64_t written_bytes = 0;
+  bool written = WriteBody(entry->body, body_name, written_bytes);
+  if (written) {
+    const auto contents = FormatEntryFile(*entry, body_name);
+    written = WriteFile(path, contents);
+    written_bytes += written ? contents.size() : 0;
+  }
+
+  {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    stats_.disk_bytes += written_bytes;
+    if (written) {
+      stats_.disk_bytes -= std::min(replaced_size, stats_.disk_bytes);
+    }
+    const auto hash = util::Hash64(entry->url);
+    const auto unwritten = unwritten_.find(hash);
+    // Unless the entry has been replaced or cleared since it was queued.
+    if (unwritten != unwritten_.end() && unwritten->second == entry) {
+      unwritten_.erase(unwritten);
+      if (!written) {
+        disk_index_.erase(hash);
+      }
+    }
+    if (!written) {
+      return;
+    }
+    ++stats_.stores;
+  }
+  TrimDisk();
+}
+
+bool ResponseCache::WriteBody(const std::string& body, std::string& body_name,
+                              uint64_t& written_bytes) {
+  body_name = ToHex(util::Hash64(body)) + "-" + std::to_string(body.size());
+  const auto path = body_directory_ / body_name;
+  std::error_code error;
+  if (std::filesystem::exists(path, error)) {
+    // The hash isn't collision-free, so the contents are compared.
+    std::string stored_body;
+    if (!ReadFile(path, stored_body) || stored_body != body) {
+      return false;
+    }
+    Touch(path);
+    return true;
+  }
+  if (!WriteFile(path, body)) {
+    return false;
+  }
+  written_bytes = body.size();
+  return true;
+}
+
+void ResponseCache::TrimDisk() {
+  uint64_t max_disk_bytes;
+  {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    max_disk_bytes = limits_.max_disk_bytes;
+  }
+  if (stats_.disk_bytes <= max_disk_bytes) {
+    return;
+  }
+
+  struct File {
+    std::filesystem::file_time_type last_write_time;
+    std::filesystem::path path;
+  };
+  std::vector<File> files;
+  std::error_code error;
+  for (const auto& subdirectory : {entry_directory_, body_directory_}) {
+    for (const auto& file :
+         std::filesystem::directory_iterator(subdirectory, error)) {
+      files.push_back({file.last_write_time(error), file.path()});
+    }
+  }
+  std::sort(files.begin(), files.end(), [](const File& a, const File& b) {
+    return a.last_write_time < b.last_write_time;
+  });
+
+  // Entries whose body is removed become misses when they are read next.
+  const auto target = static_cast<uint64_t>(max_disk_bytes * kDiskTrimTarget);
+  for (const auto& file : files) {
+    if (stats_.disk_bytes <= target) {
+      break;
+    }
+    RemoveFile(file.path);
+  }
+}
+
+void ResponseCache::ClearDisk() {
+  std::error_code error;
+  for (const auto& subdirectory : {entry_directory_, body_directory_}) {
+    for (const auto& file :
+         std::filesystem::directory_iterator(subdirectory, error)) {
+      RemoveFile(file.path());
+    }
+  }
+}
+
+void ResponseCache::RemoveFile(const std::filesystem::path& path) {
+  const auto size = GetFileSize(path);
+  std::error_code error;
+  if (!std::filesystem::remove(path, error)) {
+    return;
+  }
+
+  const std::lock_guard<std::mutex> lock(mutex_);
+  stats_.disk_bytes -= std::min(size, stats_.disk_bytes);
+  // Entry files are named by the hash of their URL. Entries queued to be
+  // written are rewritten, so they stay indexed.
+  if (path.parent_path() == entry_directory_) {
+    const auto hash = std::strtoull(path.filename().string().c_str(),
+                                    nullptr, 16);
+    if (unwritten_.count(hash) == 0) {
+      disk_index_.erase(hash);
+    }
+  }
+}
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+
+// Responses to intercepted requests, kept on disk across sessions and
+// shared by all webviews that use the same directory.
+//
+// Bodies are stored by the hash of their content, so a body served under
+// many URLs is stored once. A small file per URL holds the headers, the
+// expiry and the name of the body. Recently used entries are also kept in
+// memory so that hits don't touch the disk.
+//
+// Both levels are bounded. Memory evicts the least recently used entries,
+// and the disk the least recently used files once it is over its limit.
+//
+// Files are written, removed and trimmed on a thread of the cache, so that
+// storing a response costs its caller no disk access. The expiry of every
+// entry on disk is indexed in memory, so misses and Contains don't touch the
+// disk either; only lookups of entries that aren't in memory read it.
+// Thread-safe.
+class ResponseCache {
+ public:
+  struct Entry {
+    std::string url;
+    // "Name: value" lines separated by CRLF.
+    std::string headers;
+    std::string body;
+    // In seconds since the Unix epoch.
+    int64_t expires_at = 0;
+  };
+
+  struct Limits {
+    uint64_t max_memory_bytes = 32 << 20;
+    uint64_t max_disk_bytes = 256 << 20;
+  };
+
+  struct Stats {
+    uint64_t memory_hits = 0;
+    uint64_t disk_hits = 0;
+    uint64_t misses = 0;
+    uint64_t stores = 0;
+    uint64_t memory_bytes = 0;
+    uint64_t disk_bytes = 0;
+  };
+
+  // Opens the cache in |directory|, creating it if needed. Returns nullptr
+  // and sets |error| if it can't be created.
+  static std::shared_ptr<ResponseCache> Open(
+      const std::filesystem::path& directory, std::string& error);
+
+  // Like Open, but shares the cache with the other callers that have opened
+  // |directory| and still hold it.
+  static std::shared_ptr<ResponseCache> OpenShared(
+      const std::filesystem::path& directory, std::string& error);
+
+  // Waits for the pending disk work to finish.
+  ~ResponseCache();
+
+  ResponseCache(const ResponseCache&) = delete;
+  ResponseCache& operator=(const ResponseCache&) = delete;
+
+  void SetLimits(const Limits& limits);
+  // Bodies larger than this aren't stored.
+  uint64_t max_body_size() const;
+
+  // Returns the entry stored for |url| if it is still fresh at |now|, in
+  // seconds since the Unix epoch.
+  std::shared_ptr<const Entry> Lookup(std::string_view url, int64_t now);
+
+  // Whether a fresh entry is stored for |url|. Doesn't access the disk, and
+  // may be wrong for URLs whose hashes collide.
+  bool Contains(std::string_view url, int64_t now);
+
+  // Stores |entry|, replacing the one for the same URL, and writes it to
+  // disk later. Returns false if it is too large for the limits. An entry
+  // that can't be written is dropped from the disk index.
+  bool Store(Entry entry);
+
+  // Removes all entries from memory and disk.
+  void Clear();
+
+  // Waits until the disk work queued so far is done.
+  void Flush();
+
+  Stats stats() const;
+
+ private:
+  typedef std::list<std::shared_ptr<const Entry>> EntryList;
+
+  const std::filesystem::path entry_directory_;
+  const std::filesystem::path body_directory_;
+
+  mutable std::mutex mutex_;
+  Limits limits_;
+  // |disk_bytes| is only changed by |disk_thread_|.
+  Stats stats_;
+  // Most recently used first.
+  EntryList memory_entries_;
+  // By hash of the URL. A colliding URL replaces the entry.
+  std::unordered_map<uint64_t, EntryList::iterator> memory_index_;
+  // Expiry of the entries on disk or queued to be written, by hash of the
+  // URL.
+  std::unordered_map<uint64_t, int64_t> disk_index_;
+  // Entries queued to be written, by hash of the URL, so that they are
+  // served even if memory evicts them before they are written.
+  std::unordered_map<uint64_t, std::shared_ptr<const Entry>> unwritten_;
+
+  // Disk work, run in order by |disk_thread_|.
+  std::deque<std::function<void()>> disk_tasks_;
+  bool running_disk_task_ = false;
+  bool stopping_ = false;
+  std::condition_variable disk_tasks_changed_;
+  std::thread disk_thread_;
+
+  explicit ResponseCache(const std::filesystem::path& directory);
+
+  std::filesystem::path GetEntryPath(std::string_view url) const;
+  std::shared_ptr<const Entry> ReadEntry(std::string_view url, int64_t now);
+  void AddToMemory(std::shared_ptr<const Entry> entry);
+  void RemoveFromMemory(std::string_view url);
+  void TrimMemory();
+
+  // Called with |mutex_| held.
+  void PostDiskTask(std::function<void()> task);
+  void RunDiskTasks();
+
+  // Disk tasks, called without |mutex_| held.
+  void WriteEntry(const std::shared_ptr<const Entry>& entry);
+  bool WriteBody(const std::string& body, std::string& body_name,
+                 uint64_t& written_bytes);
+  void TrimDisk();
+  void ClearDisk();
+  void RemoveFile(const std::filesystem::path& path);
+};
@@ -0,0 +1,66 @@
+#include "suspend_policy.h"
+
+#include <algorithm>
+#include <utility>
+
+void SuspendPolicy::Add(InstanceId id, Clock::time_point now) {
+  entries_[id] = {now, false};
+}
+
+void SuspendPolicy::Remove(InstanceId id) { entries_.erase(id); }
+
+bool SuspendPolicy::Touch(InstanceId id, Clock::time_point now) {
+  const auto it = entries_.find(id);
+  if (it == entries_.end()) {
+    return false;
+  }
+  it->second.last_interaction = now;
+  return std::exchange(it->second.suspended, false);
+}
+
+std::vector<SuspendPolicy::InstanceId> SuspendPolicy::Evaluate(
+    std::optional<uint64_t> memory_usage) {
+  std::vector<std::pair<Clock::time_point, InstanceId>> active;
+  for (const auto& [id, entry] : entries_) {
+    if (!entry.suspended) {
+      active.emplace_back(entry.last_interaction, id);
+    }
+  }
+  if (active.size() < 2) {
+    return {};
+  }
+
+  size_t count = 0;
+  if (budget_.max_active.has_value() && active.size() > *budget_.max_active) {
+    count = active.size() - *budget_.max_active;
+  }
+  if (budget_.max_memory_bytes.has_value() && memory_usage.has_value() &&
+      *memory_usage > *budget_.max_memory_bytes) {
+    count = std::max<size_t>(count, 1);
+  }
+  count = std::min(count, active.size() - 1);
+  if (count == 0) {
+    return {};
+  }
+
+  std::partial_sort(active.begin(), active.begin() + count, active.end());
+
+  std::vector<InstanceId> result;
+  result.reserve(count);
+  for (size_t i = 0; i < count; ++i) {
+    entries_[active[i].second].suspended = true;
+    result.push_back(active[i].second);
+  }
+  return result;
+}
+
+bool SuspendPolicy::IsSuspended(InstanceId id) const {
+  const auto it = entries_.find(id);
+  return it != entries_.end() && it->second.suspended;
+}
+
+size_t SuspendPolicy::active_count() const {
+  return std::count_if(entries_.begin(), entries_.end(), [](const auto& it) {
+    return !it.second.suspended;
+  });
+}
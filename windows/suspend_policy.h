@@ -0,0 +1,59 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+// Decides which webviews to suspend when too many of them are active or
+// their processes use too much memory. The least recently used webviews are
+// suspended first and are resumed on their next interaction.
+//
+// The policy neither reads the clock nor memory counters itself; both are
+// passed in by the caller.
+class SuspendPolicy {
+ public:
+  typedef int64_t InstanceId;
+  typedef std::chrono::steady_clock Clock;
+
+  struct Budget {
+    // Maximum number of webviews that are not suspended.
+    std::optional<size_t> max_active;
+    // Maximum memory used by all webview processes combined.
+    std::optional<uint64_t> max_memory_bytes;
+  };
+
+  void SetBudget(const Budget& budget) { budget_ = budget; }
+  const Budget& budget() const { return budget_; }
+
+  void Add(InstanceId id, Clock::time_point now);
+  void Remove(InstanceId id);
+
+  // Records an interaction with |id|. Returns true if the policy had
+  // suspended it and it has to be resumed.
+  bool Touch(InstanceId id, Clock::time_point now);
+
+  // Returns the instances that have to be suspended to stay within the
+  // budget, coldest first, and marks them as suspended. |memory_usage| is
+  // the current memory usage, if known.
+  //
+  // The most recently used instance is never suspended. While the memory
+  // budget is exceeded, one instance is suspended per call so that the
+  // memory readings can catch up in between.
+  std::vector<InstanceId> Evaluate(std::optional<uint64_t> memory_usage);
+
+  bool IsSuspended(InstanceId id) const;
+  size_t active_count() const;
+  size_t size() const { return entries_.size(); }
+
+ private:
+  struct Entry {
+    Clock::time_point last_interaction;
+    bool suspended = false;
+  };
+
+  Budget budget_;
+  std::unordered_map<InstanceId, Entry> entries_;
+};
@@ -0,0 +1,389 @@
+#include "asset_archive.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "asset_server.h"
+#include "test.h"
+#include "util/http_headers.h"
+
+namespace test {
+
+namespace {
+struct ZipEntry {
+  std::string path;
+  std::string contents;
+  // Path written to the local header, if it differs from |path|.
+  std::string local_path = {};
+};
+
+void AppendU16(std::string& out, uint16_t value) {
+  out.push_back(static_cast<char>(value & 0xff));
+  out.push_back(static_cast<char>(value >> 8));
+}
+
+void AppendU32(std::string& out, uint32_t value) {
+  AppendU16(out, static_cast<uint16_t>(value & 0xffff));
+  AppendU16(out, static_cast<uint16_t>(value >> 16));
+}
+
+// Writes a zip archive of stored entries to a temporary file and opens it.
+std::shared_ptr<const AssetArchive> OpenZip(
+    const std::vector<ZipEntry>& entries) {
+  std::string zip;
+  std::string directory;
+  for (const auto& entry : entries) {
+    const auto& local_path =
+        entry.local_path.empty() ? entry.path : entry.local_path;
+    const auto offset = static_cast<uint32_t>(zip.size());
+    const auto size = static_cast<uint32_t>(entry.contents.size());
+    // CRCs aren't checked, so the size stands in for them.
+    AppendU32(zip, 0x04034b50);
+    AppendU16(zip, 10);  // Version needed.
+    AppendU16(zip, 0);   // Flags.
+    AppendU16(zip, 0);   // Stored.
+    AppendU32(zip, 0);   // Modification time and date.
+    AppendU32(zip, size);
+    AppendU32(zip, size);
+    AppendU32(zip, size);
+    AppendU16(zip, static_cast<uint16_t>(local_path.size()));
+    AppendU16(zip, 0);  // Extra field.
+    zip += local_path;
+    zip += entry.contents;
+
+    AppendU32(directory, 0x02014b50);
+    AppendU16(directory, 20);  // Version made by.
+    AppendU16(directory, 10);  // Version needed.
+    AppendU16(directory, 0);   // Flags.
+    AppendU16(directory, 0);   // Stored.
+    AppendU32(directory, 0);   // Modification time and date.
+    AppendU32(directory, size);
+    AppendU32(directory, size);
+    AppendU32(directory, size);
+    AppendU16(directory, static_cast<uint16_t>(entry.path.size()));
+    AppendU16(directory, 0);  // Extra field.
+    AppendU16(directory, 0);  // Comment.
+    AppendU16(directory, 0);  // Disk.
+    AppendU16(directory, 0);  // Internal attributes.
+    AppendU32(directory, 0);  // External attributes.
+    AppendU32(directory, offset);
+    directory += entry.path;
+  }
+
+  const auto directory_offset = static_cast<uint32_t>(zip.size());
+  zip += directory;
+  AppendU32(zip, 0x06054b50);
+  AppendU16(zip, 0);
+  AppendU16(zip, 0);
+  AppendU16(zip, static_cast<uint16_t>(entries.size()));
+  AppendU16(zip, static_cast<uint16_t>(entries.size()));
+  AppendU32(zip, static_cast<uint32_t>(directory.size()));
+  AppendU32(zip, directory_offset);
+  AppendU16(zip, 0);
+
+  const auto path = (std::filesystem::temp_directory_path() /
+                     "webview_windows_asset_archive_test.zip")
+                        .string();
+  std::ofstream(path, std::ios::binary) << zip;
+  std::string error;
+  return AssetArchive::Open(path, error);
+}
+
+std::string Contents(const std::optional<AssetArchive::Entry>& entry) {
+  return entry.has_value()
+             ? std::string(reinterpret_cast<const char*>(entry->data),
+                           entry->size)
+             : std::string("<none>");
+}
+
+// Serves a small app, with precompressed variants of some assets, from
+// app.test.
+struct TestServer {
+  AssetServer server;
+
+  TestServer() {
+    server.SetMapping("app.test",
+                      OpenZip({{"index.html", "<html>"},
+                               {"app.js", "0123456789"},
+                               {"app.js.br", "BR"},
+                               {"app.js.gz", "GZIP"},
+                               {"style.css", "css"},
+                               {"style.css.gz", "gz"},
+                               {"docs/index.html", "docs"},
+                               {"empty.txt", ""}}),
+                      "");
+  }
+
+  // Returns the response to |request| for |uri|, or one with a status of 0
+  // if the server doesn't handle it.
+  AssetServer::Response Get(std::string_view uri,
+                            AssetServer::Request request = {}) const {
+    request.uri = uri;
+    auto response = server.Handle(request);
+    if (response) {
+      return std::move(*response);
+    }
+    AssetServer::Response unhandled;
+    unhandled.status = 0;
+    return unhandled;
+  }
+};
+
+std::string Body(const AssetServer::Response& response) {
+  return std::string(reinterpret_cast<const char*>(response.body),
+                     response.body_size);
+}
+
+std::string Header(const AssetServer::Response& response,
+                   std::string_view name) {
+  const auto value = util::FindHeader(response.headers, name);
+  return value ? std::string(*value) : std::string("<none>");
+}
+
+AssetServer::Request Range(std::string_view range) {
+  AssetServer::Request request;
+  request.range = range;
+  return request;
+}
+
+AssetServer::Request AcceptEncoding(std::string_view accept_encoding) {
+  AssetServer::Request request;
+  request.accept_encoding = accept_encoding;
+  return request;
+}
+}  // namespace
+
+void RegisterAssetArchiveTests(Registry& registry) {
+  registry.Add("asset_archive/find", []() {
+    std::vector<ZipEntry> entries;
+    for (int i = 0; i < 1000; ++i) {
+      const auto name = std::to_string(i);
+      entries.push_back({"static/chunk-" + name + ".js", "script " + name});
+    }
+    entries.push_back({"static/", ""});
+    const auto archive = OpenZip(entries);
+    EXPECT_TRUE(archive != nullptr);
+    if (!archive) {
+      return;
+    }
+
+    // Directories aren't served.
+    EXPECT_EQ(1000u, archive->size());
+    bool all_found = true;
+    for (int i = 0; i < 1000; ++i) {
+      const auto name = std::to_string(i);
+      const auto entry = archive->Find("static/chunk-" + name + ".js");
+      all_found = all_found && Contents(entry) == "script " + name &&
+                  entry->path == "static/chunk-" + name + ".js";
+    }
+    EXPECT_TRUE(all_found);
+
+    // Misses, including paths as long as existing ones.
+    bool none_found = true;
+    for (int i = 1000; i < 2000; ++i) {
+      none_found = none_found &&
+                   !archive->Find("static/chunk-" + std::to_string(i) + ".js")
+                        .has_value();
+    }
+    EXPECT_TRUE(none_found);
+    EXPECT_FALSE(archive->Find("").has_value());
+    EXPECT_FALSE(archive->Find("static/").has_value());
+  });
+
+  registry.Add("asset_archive/later_entries_replace_earlier", []() {
+    const auto archive =
+        OpenZip({{"a.js", "old"}, {"b.js", "b"}, {"a.js", "new"}});
+    EXPECT_TRUE(archive && archive->size() == 2);
+    EXPECT_EQ(std::string("new"), Contents(archive->Find("a.js")));
+    EXPECT_EQ(std::string("b"), Contents(archive->Find("b.js")));
+  });
+
+  registry.Add("asset_archive/local_path_differs", []() {
+    // Paths are compared with the local header first, and with the central
+    // directory if that doesn't match.
+    const auto archive = OpenZip({{"a.js", "a", "A.JS"}});
+    EXPECT_EQ(std::string("a"), Contents(archive->Find("a.js")));
+    EXPECT_FALSE(archive->Find("b.js").has_value());
+  });
+
+  registry.Add("asset_archive/empty", []() {
+    const auto archive = OpenZip({});
+    EXPECT_TRUE(archive && archive->size() == 0);
+    EXPECT_FALSE(archive->Find("index.html").has_value());
+  });
+
+  registry.Add("asset_server/get", []() {
+    const TestServer test_server;
+    auto response = test_server.Get("https://app.test/app.js");
+    EXPECT_EQ(200, response.status);
+    EXPECT_EQ(std::string("0123456789"), Body(response));
+    EXPECT_EQ(std::string("text/javascript; charset=utf-8"),
+              Header(response, "Content-Type"));
+    EXPECT_EQ(std::string("10"), Header(response, "Content-Length"));
+    EXPECT_EQ(std::string("bytes"), Header(response, "Accept-Ranges"));
+    EXPECT_EQ(std::string("<none>"), Header(response, "Content-Encoding"));
+    EXPECT_TRUE(response.archive != nullptr);
+
+    // Hosts are compared without case, user info and port, and paths
+    // without query and fragment, after percent-decoding.
+    EXPECT_EQ(std::string("0123456789"),
+              Body(test_server.Get("https://u@APP.test:8443/%61pp.js?v=1#x")));
+    EXPECT_EQ(0, test_server.Get("https://other.test/app.js").status);
+    EXPECT_EQ(400, test_server.Get("https://app.test/app%2.js").status);
+    EXPECT_EQ(404, test_server.Get("https://app.test/missing.js").status);
+
+    // Directories serve their index document.
+    EXPECT_EQ(std::string("<html>"), Body(test_server.Get("https://app.test")));
+    EXPECT_EQ(std::string("docs"),
+              Body(test_server.Get("https://app.test/docs/")));
+  });
+
+  registry.Add("asset_server/methods", []() {
+    const TestServer test_server;
+    AssetServer::Request request;
+    request.method = "HEAD";
+    const auto head = test_server.Get("https://app.test/app.js", request);
+    EXPECT_EQ(200, head.status);
+    EXPECT_EQ(std::string("10"), Header(head, "Content-Length"));
+    EXPECT_TRUE(head.body == nullptr && head.body_size == 0);
+
+    request.method = "POST";
+    const auto post = test_server.Get("https://app.test/app.js", request);
+    EXPECT_EQ(405, post.status);
+    EXPECT_EQ(std::string("GET, HEAD"), Header(post, "Allow"));
+  });
+
+  registry.Add("asset_server/fallback", []() {
+    AssetServer server;
+    server.SetMapping("spa.test", OpenZip({{"index.html", "<app>"}}),
+                      "index.html");
+    AssetServer::Request request;
+    request.uri = "https://spa.test/users/42";
+    const auto response = server.Handle(request);
+    EXPECT_TRUE(response && response->status == 200 &&
+                Body(*response) == "<app>");
+    EXPECT_TRUE(server.ClearMapping("SPA.test"));
+    EXPECT_FALSE(server.Handle(request).has_value());
+  });
+
+  registry.Add("asset_server/ranges", []() {
+    const TestServer test_server;
+    const auto get = [&test_server](std::string_view range) {
+      return test_server.Get("https://app.test/app.js", Range(range));
+    };
+    auto response = get("bytes=2-5");
+    EXPECT_EQ(206, response.status);
+    EXPECT_EQ(std::string("2345"), Body(response));
+    EXPECT_EQ(std::string("bytes 2-5/10"), Header(response, "Content-Range"));
+    EXPECT_EQ(std::string("4"), Header(response, "Content-Length"));
+
+    EXPECT_EQ(std::string("789"), Body(get("bytes=7-")));
+    EXPECT_EQ(std::string("789"), Body(get("bytes=-3")));
+    EXPECT_EQ(std::string("56789"), Body(get("bytes=5-100")));
+    response = get("Bytes=-20");
+    EXPECT_EQ(206, response.status);
+    EXPECT_EQ(std::string("bytes 0-9/10"), Header(response, "Content-Range"));
+
+    // Ranges that can't be parsed, and multiple ranges, get the whole body.
+    for (const auto range :
+         {"bytes=5-2", "bytes=0-1,3-4", "items=0-1", "bytes=a-b", "bytes"}) {
+      response = get(range);
+      EXPECT_TRUE(response.status == 200 && Body(response) == "0123456789");
+    }
+
+    // Ranges refer to the identity encoding.
+    AssetServer::Request request = Range("bytes=0-1");
+    request.accept_encoding = "br";
+    response = test_server.Get("https://app.test/app.js", request);
+    EXPECT_EQ(std::string("01"), Body(response));
+    EXPECT_EQ(std::string("<none>"), Header(response, "Content-Encoding"));
+  });
+
+  registry.Add("asset_server/unsatisfiable_ranges", []() {
+    const TestServer test_server;
+    for (const auto range : {"bytes=10-", "bytes=10-20", "bytes=-0"}) {
+      const auto response =
+          test_server.Get("https://app.test/app.js", Range(range));
+      EXPECT_EQ(416, response.status);
+      EXPECT_EQ(std::string("bytes */10"), Header(response, "Content-Range"));
+      EXPECT_EQ(0u, response.body_size);
+    }
+    EXPECT_EQ(416, test_server.Get("https://app.test/empty.txt",
+                                   Range("bytes=-5"))
+                       .status);
+    // Without a range, empty assets are served.
+    const auto response = test_server.Get("https://app.test/empty.txt");
+    EXPECT_EQ(200, response.status);
+    EXPECT_EQ(std::string("0"), Header(response, "Content-Length"));
+  });
+
+  registry.Add("asset_server/etags", []() {
+    const TestServer test_server;
+    const auto plain = test_server.Get("https://app.test/app.js");
+    const auto etag = Header(plain, "ETag");
+    EXPECT_TRUE(etag.size() > 2 && etag.front() == '"' && etag.back() == '"');
+    EXPECT_EQ(std::string("no-cache"), Header(plain, "Cache-Control"));
+
+    const auto get = [&test_server](std::string_view if_none_match,
+                                    std::string_view accept_encoding = "") {
+      AssetServer::Request request;
+      request.if_none_match = if_none_match;
+      request.accept_encoding = accept_encoding;
+      return test_server.Get("https://app.test/app.js", request);
+    };
+    for (const auto& if_none_match :
+         {etag, "W/" + etag, std::string("*"), "\"other\", " + etag}) {
+      const auto response = get(if_none_match);
+      EXPECT_EQ(304, response.status);
+      EXPECT_EQ(etag, Header(response, "ETag"));
+      EXPECT_EQ(0u, response.body_size);
+    }
+    EXPECT_EQ(200, get("\"other\"").status);
+
+    // Each variant has its own tag.
+    const auto br = get("", "br");
+    EXPECT_TRUE(Header(br, "ETag") != etag);
+    EXPECT_EQ(200, get(etag, "br").status);
+    EXPECT_EQ(304, get(Header(br, "ETag"), "br").status);
+  });
+
+  registry.Add("asset_server/variants", []() {
+    const TestServer test_server;
+    const auto get = [&test_server](std::string_view uri,
+                                    std::string_view accept_encoding) {
+      return test_server.Get(uri, AcceptEncoding(accept_encoding));
+    };
+    // Brotli is preferred over gzip, whatever the client's order.
+    auto response = get("https://app.test/app.js", "gzip, deflate, br");
+    EXPECT_EQ(std::string("BR"), Body(response));
+    EXPECT_EQ(std::string("br"), Header(response, "Content-Encoding"));
+    EXPECT_EQ(std::string("Accept-Encoding"), Header(response, "Vary"));
+    EXPECT_EQ(std::string("text/javascript; charset=utf-8"),
+              Header(response, "Content-Type"));
+    EXPECT_EQ(std::string("2"), Header(response, "Content-Length"));
+
+    response = get("https://app.test/app.js", "gzip");
+    EXPECT_EQ(std::string("GZIP"), Body(response));
+    EXPECT_EQ(std::string("gzip"), Header(response, "Content-Encoding"));
+    EXPECT_EQ(std::string("GZIP"),
+              Body(get("https://app.test/app.js", "BR;q=0, GZip")));
+    EXPECT_EQ(std::string("BR"),
+              Body(get("https://app.test/app.js", "br;q=0.5")));
+    EXPECT_EQ(std::string("0123456789"),
+              Body(get("https://app.test/app.js", "br;q=0.0, identity")));
+
+    // Assets with variants vary even when served without one.
+    response = get("https://app.test/style.css", "br");
+    EXPECT_EQ(std::string("css"), Body(response));
+    EXPECT_EQ(std::string("Accept-Encoding"), Header(response, "Vary"));
+    EXPECT_EQ(std::string("<none>"),
+              Header(get("https://app.test/", "br"), "Vary"));
+  });
+}
+
+}  // namespace test
@@ -0,0 +1,151 @@
+#include "async_resource.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "test.h"
+
+namespace test {
+
+namespace {
+typedef AsyncResource<int, std::string> Resource;
+
+// Records what waiters were called with.
+struct Results {
+  std::vector<int> values;
+  std::vector<std::string> errors;
+  int failures_without_error = 0;
+
+  Resource::Waiter Waiter() {
+    return [this](int* value, const std::string* error) {
+      if (value) {
+        values.push_back(*value);
+      } else if (error) {
+        errors.push_back(*error);
+      } else {
+        ++failures_without_error;
+      }
+    };
+  }
+};
+}  // namespace
+
+void RegisterAsyncResourceTests(Registry& registry) {
+  registry.Add("async_resource/queues_until_ready", []() {
+    Resource resource;
+    Resource::CompletionCallback complete;
+    Results results;
+    resource.Await(results.Waiter());
+    EXPECT_TRUE(resource.Start([&complete](Resource::CompletionCallback done) {
+      complete = std::move(done);
+    }));
+    EXPECT_TRUE(resource.state() == Resource::State::kCreating);
+    resource.Await(results.Waiter());
+    EXPECT_EQ(2u, resource.pending_count());
+    EXPECT_TRUE(results.values.empty());
+
+    complete(std::make_unique<int>(7), nullptr);
+    EXPECT_TRUE(resource.state() == Resource::State::kReady);
+    EXPECT_TRUE(static_cast<bool>(resource));
+    EXPECT_EQ(2u, results.values.size());
+    EXPECT_EQ(0u, resource.pending_count());
+
+    // Later waiters are called immediately.
+    resource.Await(results.Waiter());
+    EXPECT_EQ(3u, results.values.size());
+    EXPECT_EQ(7, *resource.get());
+  });
+
+  registry.Add("async_resource/start_only_once", []() {
+    Resource resource;
+    int starts = 0;
+    Resource::CompletionCallback complete;
+    const auto factory = [&](Resource::CompletionCallback done) {
+      ++starts;
+      complete = std::move(done);
+    };
+    EXPECT_TRUE(resource.Start(factory));
+    EXPECT_FALSE(resource.Start(factory));
+    complete(std::make_unique<int>(1), nullptr);
+    EXPECT_FALSE(resource.Start(factory));
+    EXPECT_EQ(1, starts);
+  });
+
+  registry.Add("async_resource/failure_and_retry", []() {
+    Resource resource;
+    Results results;
+    Resource::CompletionCallback complete;
+    const auto factory = [&complete](Resource::CompletionCallback done) {
+      complete = std::move(done);
+    };
+    resource.Start(factory);
+    resource.Await(results.Waiter());
+    complete(nullptr, std::make_unique<std::string>("no runtime"));
+    EXPECT_TRUE(resource.state() == Resource::State::kFailed);
+    EXPECT_EQ(1u, results.errors.size());
+    resource.Await(results.Waiter());
+    EXPECT_EQ(2u, results.errors.size());
+
+    // A failed creation can be retried.
+    EXPECT_TRUE(resource.Start(factory));
+    resource.Await(results.Waiter());
+    complete(std::make_unique<int>(3), nullptr);
+    EXPECT_EQ(1u, results.values.size());
+  });
+
+  registry.Add("async_resource/reset_drops_late_completion", []() {
+    Resource resource;
+    Results results;
+    Resource::CompletionCallback complete;
+    resource.Start([&complete](Resource::CompletionCallback done) {
+      complete = std::move(done);
+    });
+    resource.Await(results.Waiter());
+    resource.Reset();
+    EXPECT_EQ(1, results.failures_without_error);
+    EXPECT_TRUE(resource.state() == Resource::State::kIdle);
+
+    complete(std::make_unique<int>(1), nullptr);
+    EXPECT_TRUE(resource.state() == Resource::State::kIdle);
+    EXPECT_TRUE(resource.get() == nullptr);
+  });
+
+  registry.Add("async_resource/completion_after_destruction", []() {
+    Resource::CompletionCallback complete;
+    {
+      Resource resource;
+      resource.Start([&complete](Resource::CompletionCallback done) {
+        complete = std::move(done);
+      });
+    }
+    // Must not touch the destroyed resource.
+    complete(std::make_unique<int>(1), nullptr);
+    EXPECT_TRUE(static_cast<bool>(complete));
+  });
+
+  registry.Add("async_resource/synchronous_factory", []() {
+    Resource resource;
+    Results results;
+    resource.Start([](Resource::CompletionCallback done) {
+      done(std::make_unique<int>(5), nullptr);
+    });
+    resource.Await(results.Waiter());
+    EXPECT_EQ(1u, results.values.size());
+  });
+
+  registry.Add("async_resource/waiter_may_reset", []() {
+    Resource resource;
+    Results results;
+    Resource::CompletionCallback complete;
+    resource.Start([&complete](Resource::CompletionCallback done) {
+      complete = std::move(done);
+    });
+    resource.Await([&resource](int*, const std::string*) { resource.Reset(); });
+    resource.Await(results.Waiter());
+    complete(std::make_unique<int>(1), nullptr);
+    EXPECT_TRUE(resource.state() == Resource::State::kIdle);
+  });
+}
+
+}  // namespace test
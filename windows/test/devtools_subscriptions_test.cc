@@ -0,0 +1,211 @@
+#include "devtools_subscriptions.h"
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "test.h"
+#include "util/json_path.h"
+
+namespace test {
+
+namespace {
+typedef DevToolsEventFilter::Condition Condition;
+typedef DevToolsEventFilter::Operator Operator;
+
+constexpr char kParams[] =
+    "{\"requestId\": \"1.2\", \"type\": \"Script\",\n"
+    " \"response\": {\"url\": \"https://a.test/app.js\", \"status\": 200,\n"
+    "  \"headers\": {\"content-type\": \"text/javascript\"},\n"
+    "  \"fromCache\": false, \"timing\": null,\n"
+    "  \"note\": \"say \\\"hi\\\" \\u00e9\",\n"
+    "  \"ranges\": [[0, 10], {\"start\": 20}, \"}]\"]}}";
+
+std::optional<std::string> Find(std::string_view path) {
+  const auto value = util::FindJsonValue(kParams, path);
+  return value ? std::optional<std::string>(*value) : std::nullopt;
+}
+
+bool Matches(const std::vector<Condition>& conditions) {
+  return DevToolsEventFilter(conditions).Matches(kParams);
+}
+
+// Subscriptions that log the receivers they add and remove.
+struct LoggingSubscriptions {
+  std::vector<std::string> log;
+  bool fail_to_add = false;
+  DevToolsSubscriptions subscriptions{
+      [this](const std::string& event) {
+        log.push_back("+" + event);
+        return !fail_to_add;
+      },
+      [this](const std::string& event) { log.push_back("-" + event); }};
+};
+}  // namespace
+
+void RegisterDevToolsSubscriptionsTests(Registry& registry) {
+  registry.Add("json_path/find_value", []() {
+    EXPECT_EQ(std::optional<std::string>("\"1.2\""), Find("requestId"));
+    EXPECT_EQ(std::optional<std::string>("200"), Find("response.status"));
+    EXPECT_EQ(std::optional<std::string>("\"text/javascript\""),
+              Find("response.headers.content-type"));
+    EXPECT_EQ(std::optional<std::string>("false"), Find("response.fromCache"));
+    EXPECT_EQ(std::optional<std::string>("null"), Find("response.timing"));
+    EXPECT_EQ(std::optional<std::string>("[0, 10]"),
+              Find("response.ranges.0"));
+    EXPECT_EQ(std::optional<std::string>("10"), Find("response.ranges.0.1"));
+    EXPECT_EQ(std::optional<std::string>("20"),
+              Find("response.ranges.1.start"));
+    // Brackets in strings don't end the skipped values.
+    EXPECT_EQ(std::optional<std::string>("\"}]\""), Find("response.ranges.2"));
+    EXPECT_EQ(std::optional<std::string>(kParams), Find(""));
+  });
+
+  registry.Add("json_path/missing_values", []() {
+    EXPECT_EQ(std::nullopt, Find("missing"));
+    EXPECT_EQ(std::nullopt, Find("response.ranges.3"));
+    EXPECT_EQ(std::nullopt, Find("response.ranges.first"));
+    EXPECT_EQ(std::nullopt, Find("response.status.value"));
+    EXPECT_EQ(std::nullopt, Find("response.url.0"));
+    EXPECT_EQ(std::nullopt, util::FindJsonValue("", "a"));
+    EXPECT_EQ(std::nullopt, util::FindJsonValue("{\"a\": ", "a"));
+  });
+
+  registry.Add("json_path/elements", []() {
+    std::vector<std::string> elements;
+    EXPECT_TRUE(util::ForEachJsonElement(
+        " [1, \"a,b\", {\"c\": [2]}, null] ",
+        [&elements](std::string_view element) {
+          elements.emplace_back(element);
+        }));
+    EXPECT_TRUE(elements ==
+                std::vector<std::string>({"1", "\"a,b\"", "{\"c\": [2]}",
+                                          "null"}));
+    EXPECT_TRUE(util::ForEachJsonElement("[]", [](std::string_view) {}));
+    EXPECT_FALSE(util::ForEachJsonElement("{}", [](std::string_view) {}));
+  });
+
+  registry.Add("json_path/decode_string", []() {
+    EXPECT_EQ(std::optional<std::string>("plain"),
+              util::DecodeJsonString("\"plain\""));
+    EXPECT_EQ(std::optional<std::string>("a\"b\\c/d\n\t"),
+              util::DecodeJsonString("\"a\\\"b\\\\c\\/d\\n\\t\""));
+    EXPECT_EQ(std::optional<std::string>("\xc3\xa9"),
+              util::DecodeJsonString("\"\\u00e9\""));
+    // Surrogate pairs.
+    EXPECT_EQ(std::optional<std::string>("\xf0\x9f\x98\x80"),
+              util::DecodeJsonString("\"\\ud83d\\ude00\""));
+    EXPECT_EQ(std::nullopt, util::DecodeJsonString("plain"));
+    EXPECT_EQ(std::nullopt, util::DecodeJsonString("\"\\x\""));
+    EXPECT_EQ(std::nullopt, util::DecodeJsonString("\"\\u00g0\""));
+  });
+
+  registry.Add("devtools_event_filter/operators", []() {
+    EXPECT_TRUE(DevToolsEventFilter().Matches(kParams));
+    EXPECT_TRUE(Matches({{"response.status", Operator::kEquals, 200.0}}));
+    EXPECT_FALSE(Matches({{"response.status", Operator::kEquals, 404.0}}));
+    EXPECT_TRUE(Matches({{"type", Operator::kEquals, std::string("Script")}}));
+    EXPECT_TRUE(Matches({{"response.fromCache", Operator::kEquals, false}}));
+    EXPECT_TRUE(Matches({{"response.timing", Operator::kEquals, {}}}));
+    // Escaped strings are decoded before they are compared.
+    EXPECT_TRUE(Matches({{"response.note", Operator::kEquals,
+                          std::string("say \"hi\" \xc3\xa9")}}));
+
+    EXPECT_TRUE(Matches({{"response.status", Operator::kNotEquals, 404.0}}));
+    EXPECT_TRUE(Matches({{"missing", Operator::kNotEquals, 404.0}}));
+    EXPECT_TRUE(Matches({{"response.url", Operator::kContains,
+                          std::string("a.test")}}));
+    EXPECT_TRUE(Matches({{"response.url", Operator::kStartsWith,
+                          std::string("https://")}}));
+    EXPECT_FALSE(Matches({{"response.url", Operator::kStartsWith,
+                           std::string("a.test")}}));
+    // Numbers aren't strings.
+    EXPECT_FALSE(Matches({{"response.status", Operator::kContains,
+                           std::string("20")}}));
+    EXPECT_TRUE(Matches({{"response.status", Operator::kLessThan, 300.0}}));
+    EXPECT_FALSE(
+        Matches({{"response.status", Operator::kGreaterThan, 300.0}}));
+    EXPECT_FALSE(Matches({{"requestId", Operator::kLessThan, 2.0}}));
+    EXPECT_TRUE(Matches({{"response.headers", Operator::kExists, {}}}));
+    EXPECT_TRUE(Matches({{"response.body", Operator::kNotExists, {}}}));
+  });
+
+  registry.Add("devtools_event_filter/all_conditions", []() {
+    EXPECT_TRUE(Matches({{"type", Operator::kEquals, std::string("Script")},
+                         {"response.status", Operator::kLessThan, 400.0}}));
+    EXPECT_FALSE(Matches({{"type", Operator::kEquals, std::string("Script")},
+                          {"response.status", Operator::kLessThan, 100.0}}));
+  });
+
+  registry.Add("devtools_subscriptions/shared_receivers", []() {
+    LoggingSubscriptions logging;
+    auto& subscriptions = logging.subscriptions;
+    const auto first = subscriptions.Subscribe("Network.responseReceived", {});
+    const auto second =
+        subscriptions.Subscribe("Network.responseReceived", {});
+    const auto third = subscriptions.Subscribe("Log.entryAdded", {});
+    EXPECT_TRUE(first != DevToolsSubscriptions::kNoSubscription &&
+                first != second);
+    EXPECT_EQ(2u, subscriptions.receiver_count());
+    EXPECT_EQ(3u, subscriptions.subscription_count());
+
+    // The receiver stays until its last subscription is removed.
+    EXPECT_TRUE(subscriptions.Unsubscribe(first));
+    EXPECT_FALSE(subscriptions.Unsubscribe(first));
+    EXPECT_TRUE(subscriptions.Unsubscribe(second));
+    EXPECT_TRUE(logging.log ==
+                std::vector<std::string>({"+Network.responseReceived",
+                                          "+Log.entryAdded",
+                                          "-Network.responseReceived"}));
+
+    subscriptions.Clear();
+    EXPECT_EQ(0u, subscriptions.receiver_count());
+    EXPECT_EQ(0u, subscriptions.subscription_count());
+    EXPECT_EQ(std::string("-Log.entryAdded"), logging.log.back());
+    EXPECT_FALSE(subscriptions.Unsubscribe(third));
+  });
+
+  registry.Add("devtools_subscriptions/failed_receiver", []() {
+    LoggingSubscriptions logging;
+    logging.fail_to_add = true;
+    EXPECT_EQ(DevToolsSubscriptions::kNoSubscription,
+              logging.subscriptions.Subscribe("Log.entryAdded", {}));
+    EXPECT_EQ(0u, logging.subscriptions.receiver_count());
+    // The next subscription tries again.
+    logging.fail_to_add = false;
+    EXPECT_TRUE(logging.subscriptions.Subscribe("Log.entryAdded", {}) !=
+                DevToolsSubscriptions::kNoSubscription);
+    EXPECT_TRUE(logging.log ==
+                std::vector<std::string>(
+                    {"+Log.entryAdded", "+Log.entryAdded"}));
+  });
+
+  registry.Add("devtools_subscriptions/dispatch", []() {
+    LoggingSubscriptions logging;
+    auto& subscriptions = logging.subscriptions;
+    const std::string event = "Network.responseReceived";
+    const auto all = subscriptions.Subscribe(event, {});
+    subscriptions.Subscribe(
+        event, DevToolsEventFilter(
+                   {{"response.status", Operator::kGreaterThan, 399.0}}));
+    const auto scripts = subscriptions.Subscribe(
+        event, DevToolsEventFilter(
+                   {{"type", Operator::kEquals, std::string("Script")}}));
+    subscriptions.Subscribe("Log.entryAdded", {});
+
+    std::vector<DevToolsSubscriptions::Id> delivered;
+    const auto deliver = [&delivered](DevToolsSubscriptions::Id id) {
+      delivered.push_back(id);
+    };
+    subscriptions.Dispatch(event, kParams, deliver);
+    EXPECT_TRUE(delivered ==
+                std::vector<DevToolsSubscriptions::Id>({all, scripts}));
+
+    delivered.clear();
+    subscriptions.Dispatch("Page.loadEventFired", kParams, deliver);
+    EXPECT_TRUE(delivered.empty());
+  });
+}
+
+}  // namespace test
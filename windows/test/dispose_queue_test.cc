@@ -0,0 +1,86 @@
+#include "dispose_queue.h"
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "test.h"
+
+namespace test {
+
+namespace {
+typedef StagedDisposeQueue::Clock Clock;
+
+// A clock that only advances while stages run.
+struct FakeClock {
+  Clock::time_point now;
+
+  StagedDisposeQueue::NowFunction Get() {
+    return [this]() { return now; };
+  }
+};
+
+// Returns stages that append "<name><index>" to |log| and advance |clock|
+// by |cost| each.
+std::vector<StagedDisposeQueue::Stage> MakeStages(
+    const std::string& name, size_t count, std::vector<std::string>& log,
+    FakeClock& clock, Clock::duration cost) {
+  std::vector<StagedDisposeQueue::Stage> stages;
+  for (size_t i = 0; i < count; ++i) {
+    stages.push_back([name, i, &log, &clock, cost]() {
+      log.push_back(name + std::to_string(i));
+      clock.now += cost;
+    });
+  }
+  return stages;
+}
+}  // namespace
+
+void RegisterDisposeQueueTests(Registry& registry) {
+  registry.Add("dispose_queue/runs_stages_in_order", []() {
+    FakeClock clock;
+    StagedDisposeQueue queue(clock.Get());
+    std::vector<std::string> log;
+    queue.Enqueue(MakeStages("a", 2, log, clock, {}));
+    queue.Enqueue({});
+    queue.Enqueue(MakeStages("b", 2, log, clock, {}));
+    EXPECT_EQ(4u, queue.pending_stages());
+
+    queue.Flush();
+    EXPECT_TRUE(log == std::vector<std::string>({"a0", "a1", "b0", "b1"}));
+    EXPECT_TRUE(queue.empty());
+    EXPECT_EQ(0u, queue.pending_stages());
+  });
+
+  registry.Add("dispose_queue/slices_respect_budget", []() {
+    FakeClock clock;
+    StagedDisposeQueue queue(clock.Get());
+    std::vector<std::string> log;
+    queue.Enqueue(
+        MakeStages("a", 5, log, clock, std::chrono::milliseconds(2)));
+
+    EXPECT_EQ(2u, queue.RunSlice(std::chrono::milliseconds(4)));
+    EXPECT_EQ(3u, queue.pending_stages());
+    // A stage longer than the budget still runs, one per slice.
+    EXPECT_EQ(1u, queue.RunSlice(std::chrono::milliseconds(1)));
+    EXPECT_EQ(2u, queue.RunSlice(std::chrono::milliseconds(100)));
+    EXPECT_TRUE(queue.empty());
+    EXPECT_EQ(0u, queue.RunSlice(std::chrono::milliseconds(100)));
+    EXPECT_EQ(5u, log.size());
+  });
+
+  registry.Add("dispose_queue/stages_may_enqueue", []() {
+    FakeClock clock;
+    StagedDisposeQueue queue(clock.Get());
+    std::vector<std::string> log;
+    queue.Enqueue({[&]() {
+      log.push_back("outer");
+      queue.Enqueue(MakeStages("inner", 1, log, clock, {}));
+    }});
+    queue.Flush();
+    EXPECT_TRUE(log == std::vector<std::string>({"outer", "inner0"}));
+    EXPECT_TRUE(queue.empty());
+  });
+}
+
+}  // namespace test
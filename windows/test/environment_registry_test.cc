@@ -0,0 +1,112 @@
+#include "environment_registry.h"
+
+#include <chrono>
+#include <memory>
+#include <string>
+
+#include "test.h"
+
+namespace test {
+
+namespace {
+typedef RefCountedRegistry<std::string, int> IntRegistry;
+typedef IntRegistry::Clock Clock;
+
+constexpr auto kGracePeriod = std::chrono::seconds(10);
+
+IntRegistry::Factory MakeValue(int value, int* creations) {
+  return [value, creations]() {
+    ++*creations;
+    return std::make_unique<int>(value);
+  };
+}
+}  // namespace
+
+void RegisterEnvironmentRegistryTests(Registry& registry) {
+  registry.Add("environment_registry/get_or_create_shares_values", []() {
+    IntRegistry values(kGracePeriod);
+    const auto now = Clock::time_point();
+    int creations = 0;
+    auto& first = values.GetOrCreate("a", MakeValue(1, &creations), now);
+    auto& second = values.GetOrCreate("a", MakeValue(2, &creations), now);
+    EXPECT_EQ(&first, &second);
+    EXPECT_EQ(1, creations);
+    EXPECT_EQ(1, *values.Find("a"));
+    EXPECT_TRUE(values.Find("b") == nullptr);
+    // New values start out unreferenced.
+    EXPECT_EQ(0u, values.ref_count("a"));
+  });
+
+  registry.Add("environment_registry/add_ref_and_release", []() {
+    IntRegistry values(kGracePeriod);
+    const auto now = Clock::time_point() + std::chrono::hours(1);
+    int creations = 0;
+    EXPECT_FALSE(values.AddRef("a"));
+    values.GetOrCreate("a", MakeValue(1, &creations), now);
+    EXPECT_TRUE(values.AddRef("a"));
+    EXPECT_TRUE(values.AddRef("a"));
+    EXPECT_EQ(2u, values.ref_count("a"));
+
+    values.Release("a", now);
+    EXPECT_FALSE(values.NextCollection().has_value());
+    EXPECT_EQ(0u, values.Collect(now + kGracePeriod * 2));
+
+    values.Release("a", now);
+    EXPECT_TRUE(values.NextCollection() == now + kGracePeriod);
+    // Extra releases and releases of unknown keys are ignored.
+    values.Release("a", now + std::chrono::seconds(5));
+    values.Release("b", now);
+    EXPECT_TRUE(values.NextCollection() == now + kGracePeriod);
+  });
+
+  registry.Add("environment_registry/collect_after_grace_period", []() {
+    IntRegistry values(kGracePeriod);
+    const auto now = Clock::time_point() + std::chrono::hours(1);
+    int creations = 0;
+    values.GetOrCreate("a", MakeValue(1, &creations), now);
+    values.AddRef("a");
+    values.Release("a", now);
+
+    EXPECT_EQ(0u, values.Collect(now + kGracePeriod / 2));
+    // Reused within the grace period.
+    values.AddRef("a");
+    EXPECT_EQ(0u, values.Collect(now + kGracePeriod * 2));
+    values.Release("a", now + kGracePeriod * 2);
+    EXPECT_EQ(1u, values.Collect(now + kGracePeriod * 3));
+    EXPECT_EQ(0u, values.size());
+    EXPECT_FALSE(values.NextCollection().has_value());
+
+    values.GetOrCreate("a", MakeValue(2, &creations), now);
+    EXPECT_EQ(2, creations);
+  });
+
+  registry.Add("environment_registry/grace_period_change", []() {
+    IntRegistry values(kGracePeriod);
+    const auto now = Clock::time_point() + std::chrono::hours(1);
+    int creations = 0;
+    values.GetOrCreate("a", MakeValue(1, &creations), now);
+    values.SetGracePeriod(std::chrono::seconds(0));
+    EXPECT_EQ(1u, values.Collect(now));
+  });
+
+  registry.Add("environment_registry/environment_keys", []() {
+    const EnvironmentKey a{L"C:\\data", L"", ""};
+    const EnvironmentKey b{L"C:\\data", L"", "--flag"};
+    EXPECT_TRUE(a == EnvironmentKey({L"C:\\data", L"", ""}));
+    EXPECT_FALSE(a == b);
+    EXPECT_TRUE(a < b || b < a);
+
+    RefCountedRegistry<EnvironmentKey, int> values(kGracePeriod);
+    int creations = 0;
+    const auto factory = [&creations]() {
+      ++creations;
+      return std::make_unique<int>(0);
+    };
+    values.GetOrCreate(a, factory, Clock::time_point());
+    values.GetOrCreate(b, factory, Clock::time_point());
+    values.GetOrCreate(a, factory, Clock::time_point());
+    EXPECT_EQ(2, creations);
+  });
+}
+
+}  // namespace test
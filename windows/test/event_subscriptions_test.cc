@@ -0,0 +1,84 @@
+#include "util/event_subscriptions.h"
+
+#include <string>
+#include <vector>
+
+#include "test.h"
+
+namespace test {
+
+namespace {
+constexpr uint32_t kUrl = 1 << 0;
+constexpr uint32_t kTitle = 1 << 1;
+constexpr uint32_t kHistory = 1 << 2;
+
+// Adds a handler for |mask| that logs "+name" and "-name" when it is
+// registered and unregistered.
+void AddLoggingHandler(util::EventSubscriptions& subscriptions, uint32_t mask,
+                       const std::string& name,
+                       std::vector<std::string>& log) {
+  subscriptions.AddHandler(
+      mask, [&log, name]() { log.push_back("+" + name); },
+      [&log, name]() { log.push_back("-" + name); });
+}
+}  // namespace
+
+void RegisterEventSubscriptionsTests(Registry& registry) {
+  registry.Add("event_subscriptions/register_on_update", []() {
+    util::EventSubscriptions subscriptions;
+    std::vector<std::string> log;
+    AddLoggingHandler(subscriptions, kUrl, "url", log);
+    AddLoggingHandler(subscriptions, kTitle, "title", log);
+    // Handlers take effect with the next update.
+    EXPECT_TRUE(log.empty());
+    EXPECT_EQ(0u, subscriptions.registered_count());
+
+    subscriptions.Update(kUrl);
+    EXPECT_TRUE(log == std::vector<std::string>({"+url"}));
+    EXPECT_TRUE(subscriptions.IsSubscribed(kUrl));
+    EXPECT_FALSE(subscriptions.IsSubscribed(kTitle));
+
+    subscriptions.Update(kTitle);
+    EXPECT_TRUE(log == std::vector<std::string>({"+url", "-url", "+title"}));
+    EXPECT_EQ(kTitle, subscriptions.subscriptions());
+    EXPECT_EQ(1u, subscriptions.registered_count());
+  });
+
+  registry.Add("event_subscriptions/unchanged_bits_are_noops", []() {
+    util::EventSubscriptions subscriptions;
+    std::vector<std::string> log;
+    AddLoggingHandler(subscriptions, kUrl, "url", log);
+    subscriptions.Update(kUrl);
+    subscriptions.Update(kUrl);
+    subscriptions.Update(kUrl | kHistory);
+    EXPECT_TRUE(log == std::vector<std::string>({"+url"}));
+  });
+
+  registry.Add("event_subscriptions/shared_handlers", []() {
+    util::EventSubscriptions subscriptions;
+    std::vector<std::string> log;
+    // A handler serving two events stays registered while either is.
+    AddLoggingHandler(subscriptions, kUrl | kHistory, "navigation", log);
+    subscriptions.Update(kUrl);
+    subscriptions.Update(kHistory);
+    EXPECT_TRUE(log == std::vector<std::string>({"+navigation"}));
+    subscriptions.Update(kTitle);
+    EXPECT_TRUE(log ==
+                std::vector<std::string>({"+navigation", "-navigation"}));
+  });
+
+  registry.Add("event_subscriptions/clear", []() {
+    util::EventSubscriptions subscriptions;
+    std::vector<std::string> log;
+    AddLoggingHandler(subscriptions, kUrl, "url", log);
+    AddLoggingHandler(subscriptions, kTitle, "title", log);
+    subscriptions.Update(kUrl | kTitle);
+    subscriptions.Clear();
+    EXPECT_EQ(0u, subscriptions.registered_count());
+    EXPECT_EQ(0u, subscriptions.subscriptions());
+    EXPECT_TRUE(log == std::vector<std::string>(
+                           {"+url", "+title", "-url", "-title"}));
+  });
+}
+
+}  // namespace test
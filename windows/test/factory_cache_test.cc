@@ -0,0 +1,94 @@
+#include "util/factory_cache.h"
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "test.h"
+
+namespace test {
+
+namespace {
+typedef util::FactoryCache<std::string, std::shared_ptr<int>> Cache;
+
+// Resolves keys to their length and counts the calls. Keys starting with
+// '!' fail to resolve.
+struct FakeResolver {
+  std::atomic<int> calls = 0;
+
+  Cache::Resolver Get() {
+    return [this](const std::string& key) -> std::shared_ptr<int> {
+      ++calls;
+      if (!key.empty() && key[0] == '!') {
+        return nullptr;
+      }
+      return std::make_shared<int>(static_cast<int>(key.size()));
+    };
+  }
+};
+}  // namespace
+
+void RegisterFactoryCacheTests(Registry& registry) {
+  registry.Add("factory_cache/resolves_once", []() {
+    FakeResolver resolver;
+    Cache cache(resolver.Get());
+    const auto first = cache.Get("abc");
+    const auto second = cache.Get("abc");
+    EXPECT_TRUE(first && *first == 3);
+    EXPECT_TRUE(first == second);
+    EXPECT_EQ(1, resolver.calls.load());
+    EXPECT_EQ(1u, cache.size());
+
+    EXPECT_TRUE(*cache.Get("abcd") == 4);
+    EXPECT_EQ(2, resolver.calls.load());
+  });
+
+  registry.Add("factory_cache/failures_are_retried", []() {
+    FakeResolver resolver;
+    Cache cache(resolver.Get());
+    EXPECT_TRUE(cache.Get("!missing") == nullptr);
+    EXPECT_TRUE(cache.Get("!missing") == nullptr);
+    EXPECT_EQ(2, resolver.calls.load());
+    EXPECT_EQ(0u, cache.size());
+  });
+
+  registry.Add("factory_cache/clear", []() {
+    FakeResolver resolver;
+    Cache cache(resolver.Get());
+    const auto before = cache.Get("abc");
+    cache.Clear();
+    EXPECT_EQ(0u, cache.size());
+    const auto after = cache.Get("abc");
+    EXPECT_EQ(2, resolver.calls.load());
+    EXPECT_TRUE(before != after);
+  });
+
+  registry.Add("factory_cache/concurrent_lookups", []() {
+    FakeResolver resolver;
+    Cache cache(resolver.Get());
+    std::vector<std::thread> threads;
+    std::atomic<int> mismatches = 0;
+    for (int i = 0; i < 8; ++i) {
+      threads.emplace_back([&cache, &mismatches]() {
+        for (int j = 0; j < 1000; ++j) {
+          const auto key = std::string(j % 10 + 1, 'x');
+          const auto value = cache.Get(key);
+          if (!value || *value != static_cast<int>(key.size())) {
+            ++mismatches;
+          }
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    EXPECT_EQ(0, mismatches.load());
+    // Each key was resolved exactly once.
+    EXPECT_EQ(10, resolver.calls.load());
+    EXPECT_EQ(10u, cache.size());
+  });
+}
+
+}  // namespace test
@@ -0,0 +1,150 @@
+#include "util/flight_recorder.h"
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "test.h"
+
+namespace test {
+
+namespace {
+using util::FlightEventType;
+using util::FlightRecord;
+using util::FlightRecorder;
+
+bool Equal(const FlightRecord& a, const FlightRecord& b) {
+  return a.timestamp_ns == b.timestamp_ns && a.instance_id == b.instance_id &&
+         a.type == b.type && a.value == b.value;
+}
+
+bool Equal(const std::vector<FlightRecord>& a,
+           const std::vector<FlightRecord>& b) {
+  if (a.size() != b.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < a.size(); ++i) {
+    if (!Equal(a[i], b[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+FlightRecorder::Clock::time_point At(int64_t ns) {
+  return FlightRecorder::Clock::time_point(std::chrono::nanoseconds(ns));
+}
+
+const std::vector<FlightRecord> kRecords = {
+    {1000, 1, FlightEventType::kFrameArrived, 0},
+    {2500, 1, FlightEventType::kFrameDropped, 2},
+    {0xfedcba9876543210, 0xffffffff, FlightEventType::kResize,
+     0x0123456789abcdef},
+};
+}  // namespace
+
+void RegisterFlightRecorderTests(Registry& registry) {
+  registry.Add("flight_recorder/capacity_is_power_of_two", []() {
+    EXPECT_EQ(1u, FlightRecorder(1).capacity());
+    EXPECT_EQ(8u, FlightRecorder(5).capacity());
+    EXPECT_EQ(16u, FlightRecorder(16).capacity());
+  });
+
+  registry.Add("flight_recorder/snapshot_keeps_newest", []() {
+    FlightRecorder recorder(4);
+    EXPECT_TRUE(recorder.Snapshot().empty());
+    for (uint64_t i = 0; i < 6; ++i) {
+      recorder.Record(7, FlightEventType::kFrameCopied, i, At(100 * i));
+    }
+    const auto records = recorder.Snapshot();
+    EXPECT_EQ(4u, records.size());
+    for (size_t i = 0; i < records.size(); ++i) {
+      EXPECT_EQ(i + 2, records[i].value);
+      EXPECT_EQ(100 * (i + 2), records[i].timestamp_ns);
+      EXPECT_EQ(7u, records[i].instance_id);
+      EXPECT_TRUE(records[i].type == FlightEventType::kFrameCopied);
+    }
+  });
+
+  registry.Add("flight_recorder/encode_decode", []() {
+    const auto data = FlightRecorder::Encode(kRecords);
+    EXPECT_EQ(16u + 3 * 24u, data.size());
+    // The header is little endian: magic, version 1, record size 24, count 3.
+    EXPECT_EQ(std::string("WVFR\x01\0\0\0\x18\0\0\0\x03\0\0\0", 16),
+              data.substr(0, 16));
+    EXPECT_EQ(std::string("\xe8\x03\0\0\0\0\0\0", 8), data.substr(16, 8));
+
+    const auto decoded = FlightRecorder::Decode(data);
+    EXPECT_TRUE(decoded.has_value() && Equal(kRecords, *decoded));
+
+    const auto empty = FlightRecorder::Decode(FlightRecorder::Encode({}));
+    EXPECT_TRUE(empty.has_value() && empty->empty());
+  });
+
+  registry.Add("flight_recorder/decode_rejects_invalid_data", []() {
+    const auto data = FlightRecorder::Encode(kRecords);
+    EXPECT_FALSE(FlightRecorder::Decode("").has_value());
+    EXPECT_FALSE(FlightRecorder::Decode(data.substr(0, 15)).has_value());
+    // Truncated records.
+    EXPECT_FALSE(
+        FlightRecorder::Decode(data.substr(0, data.size() - 1)).has_value());
+
+    auto bad_magic = data;
+    bad_magic[0] = 'X';
+    EXPECT_FALSE(FlightRecorder::Decode(bad_magic).has_value());
+
+    auto bad_version = data;
+    bad_version[4] = 2;
+    EXPECT_FALSE(FlightRecorder::Decode(bad_version).has_value());
+
+    auto short_records = data;
+    short_records[8] = 16;
+    EXPECT_FALSE(FlightRecorder::Decode(short_records).has_value());
+  });
+
+  registry.Add("flight_recorder/decode_skips_appended_fields", []() {
+    // A newer writer that appends 8 bytes to each record.
+    const auto data = FlightRecorder::Encode(kRecords);
+    std::string extended = data.substr(0, 16);
+    extended[8] = 32;
+    for (size_t i = 0; i < kRecords.size(); ++i) {
+      extended += data.substr(16 + i * 24, 24);
+      extended += std::string(8, '\x55');
+    }
+    const auto decoded = FlightRecorder::Decode(extended);
+    EXPECT_TRUE(decoded.has_value() && Equal(kRecords, *decoded));
+  });
+
+  registry.Add("flight_recorder/chrome_trace", []() {
+    const auto trace = FlightRecorder::ToChromeTrace(
+        {kRecords[0], kRecords[1]}, 42);
+    EXPECT_EQ(
+        std::string("{\"displayTimeUnit\":\"ms\",\"traceEvents\":["
+                    "{\"name\":\"FrameArrived\",\"ph\":\"i\",\"s\":\"t\","
+                    "\"ts\":1.000,\"pid\":42,\"tid\":1,"
+                    "\"args\":{\"value\":0}},"
+                    "{\"name\":\"FrameDropped\",\"ph\":\"i\",\"s\":\"t\","
+                    "\"ts\":2.500,\"pid\":42,\"tid\":1,"
+                    "\"args\":{\"value\":2}}]}"),
+        trace);
+  });
+
+  registry.Add("flight_recorder/hitch_handler_rate_limit", []() {
+    FlightRecorder recorder(4);
+    int hitches = 0;
+    recorder.ReportHitch(At(0));
+    recorder.SetHitchHandler([&hitches]() { ++hitches; },
+                             std::chrono::seconds(10));
+    recorder.ReportHitch(At(0));
+    recorder.ReportHitch(At(5'000'000'000));
+    EXPECT_EQ(1, hitches);
+    recorder.ReportHitch(At(10'000'000'000));
+    EXPECT_EQ(2, hitches);
+
+    recorder.SetHitchHandler(nullptr, {});
+    recorder.ReportHitch(At(30'000'000'000));
+    EXPECT_EQ(2, hitches);
+  });
+}
+
+}  // namespace test
@@ -0,0 +1,248 @@
+#include "frame_scheduler.h"
+
+#include <chrono>
+#include <vector>
+
+#include "frame_pacer.h"
+#include "test.h"
+
+namespace test {
+
+namespace {
+typedef FrameScheduler::Clock Clock;
+
+constexpr size_t kFrameBytes = 100;
+
+// Lets every client ask to publish a frame each |interval| for |duration|
+// and returns how many frames each client published.
+std::vector<int> Simulate(FrameScheduler& scheduler,
+                          const std::vector<FrameScheduler::ClientId>& clients,
+                          Clock::time_point& now, Clock::duration duration,
+                          Clock::duration interval) {
+  std::vector<int> published(clients.size());
+  for (const auto end = now + duration; now < end; now += interval) {
+    for (size_t i = 0; i < clients.size(); ++i) {
+      if (scheduler.MayPublish(clients[i], kFrameBytes, now)) {
+        ++published[i];
+      }
+    }
+  }
+  return published;
+}
+
+bool InRange(int value, int low, int high) {
+  return value >= low && value <= high;
+}
+}  // namespace
+
+void RegisterFrameSchedulerTests(Registry& registry) {
+  registry.Add("frame_scheduler/no_budget", []() {
+    FrameScheduler scheduler;
+    const auto client = scheduler.Register();
+    auto now = Clock::time_point();
+    const auto published = Simulate(scheduler, {client}, now,
+                                    std::chrono::milliseconds(100),
+                                    std::chrono::milliseconds(1));
+    EXPECT_EQ(100, published[0]);
+    EXPECT_EQ(0u, scheduler.GetStats(client).deferred);
+    EXPECT_FALSE(scheduler.NextDeferredFrameRetry(now).has_value());
+  });
+
+  registry.Add("frame_scheduler/fair_shares", []() {
+    FrameScheduler scheduler;
+    scheduler.SetBudget({60.0, std::nullopt});
+    const std::vector<FrameScheduler::ClientId> clients = {
+        scheduler.Register(), scheduler.Register()};
+    auto now = Clock::time_point();
+    const auto published = Simulate(scheduler, clients, now,
+                                    std::chrono::seconds(1),
+                                    std::chrono::milliseconds(1));
+    EXPECT_TRUE(InRange(published[0], 28, 34));
+    EXPECT_TRUE(InRange(published[1], 28, 34));
+    EXPECT_EQ(static_cast<uint64_t>(published[0]),
+              scheduler.GetStats(clients[0]).published);
+  });
+
+  registry.Add("frame_scheduler/focus_weight", []() {
+    FrameScheduler scheduler;
+    scheduler.SetBudget({50.0, std::nullopt});
+    const std::vector<FrameScheduler::ClientId> clients = {
+        scheduler.Register(), scheduler.Register()};
+    FrameScheduler::Hints focused;
+    focused.focused = true;
+    scheduler.SetHints(clients[0], focused);
+    auto now = Clock::time_point();
+    const auto published = Simulate(scheduler, clients, now,
+                                    std::chrono::seconds(1),
+                                    std::chrono::milliseconds(1));
+    // Focused clients get four times the share of the others.
+    EXPECT_TRUE(InRange(published[0], 38, 44));
+    EXPECT_TRUE(InRange(published[1], 9, 12));
+  });
+
+  registry.Add("frame_scheduler/zero_weight", []() {
+    FrameScheduler scheduler;
+    scheduler.SetBudget({60.0, std::nullopt});
+    const std::vector<FrameScheduler::ClientId> clients = {
+        scheduler.Register(), scheduler.Register()};
+    FrameScheduler::Hints hidden;
+    hidden.visible = false;
+    scheduler.SetHints(clients[1], hidden);
+    auto now = Clock::time_point();
+    const auto published = Simulate(scheduler, clients, now,
+                                    std::chrono::seconds(1),
+                                    std::chrono::milliseconds(1));
+    // Hidden clients don't take a share away from the visible ones.
+    EXPECT_TRUE(InRange(published[0], 58, 66));
+    EXPECT_EQ(0, published[1]);
+  });
+
+  registry.Add("frame_scheduler/copy_budget", []() {
+    FrameScheduler scheduler;
+    scheduler.SetBudget({std::nullopt, 10.0 * kFrameBytes});
+    const auto client = scheduler.Register();
+    auto now = Clock::time_point();
+    const auto published = Simulate(scheduler, {client}, now,
+                                    std::chrono::seconds(1),
+                                    std::chrono::milliseconds(1));
+    EXPECT_TRUE(InRange(published[0], 10, 12));
+  });
+
+  registry.Add("frame_scheduler/idle_clients_release_share", []() {
+    FrameScheduler scheduler;
+    scheduler.SetBudget({60.0, std::nullopt});
+    const auto idle = scheduler.Register();
+    const auto busy = scheduler.Register();
+    auto now = Clock::time_point();
+    scheduler.MayPublish(idle, kFrameBytes, now);
+    // Once |idle| hasn't asked for a while, |busy| gets the whole budget.
+    now += std::chrono::seconds(2);
+    const auto published = Simulate(scheduler, {busy}, now,
+                                    std::chrono::seconds(1),
+                                    std::chrono::milliseconds(1));
+    EXPECT_TRUE(InRange(published[0], 58, 66));
+  });
+
+  registry.Add("frame_scheduler/deferred_frame_retry", []() {
+    FrameScheduler scheduler;
+    int notifications = 0;
+    scheduler.SetDeferredFrameCallback([&notifications]() { ++notifications; });
+    scheduler.SetBudget({10.0, std::nullopt});
+    const auto client = scheduler.Register();
+    auto now = Clock::time_point();
+
+    EXPECT_TRUE(scheduler.MayPublish(client, kFrameBytes, now));
+    EXPECT_FALSE(scheduler.RetryDeferredFrame(client, now));
+    EXPECT_FALSE(scheduler.MayPublish(client, kFrameBytes, now));
+    EXPECT_EQ(1, notifications);
+    // Only the first deferral notifies.
+    EXPECT_FALSE(scheduler.MayPublish(client, kFrameBytes, now));
+    EXPECT_EQ(1, notifications);
+
+    const auto retry = scheduler.NextDeferredFrameRetry(now);
+    EXPECT_TRUE(retry.has_value() &&
+                *retry - now >= std::chrono::milliseconds(99) &&
+                *retry - now <= std::chrono::milliseconds(101));
+    EXPECT_FALSE(scheduler.RetryDeferredFrame(
+        client, now + std::chrono::milliseconds(50)));
+    EXPECT_TRUE(scheduler.RetryDeferredFrame(client, *retry));
+    EXPECT_FALSE(scheduler.NextDeferredFrameRetry(*retry).has_value());
+    EXPECT_FALSE(scheduler.RetryDeferredFrame(client, *retry));
+
+    const auto stats = scheduler.GetStats(client);
+    EXPECT_EQ(2u, stats.published);
+    EXPECT_EQ(2u, stats.deferred);
+  });
+
+  registry.Add("frame_scheduler/published_frame_clears_deferral", []() {
+    FrameScheduler scheduler;
+    scheduler.SetBudget({10.0, std::nullopt});
+    const auto client = scheduler.Register();
+    auto now = Clock::time_point();
+    scheduler.MayPublish(client, kFrameBytes, now);
+    EXPECT_FALSE(scheduler.MayPublish(client, kFrameBytes, now));
+    now += std::chrono::milliseconds(100);
+    EXPECT_TRUE(scheduler.MayPublish(client, kFrameBytes, now));
+    EXPECT_FALSE(scheduler.NextDeferredFrameRetry(now).has_value());
+  });
+
+  registry.Add("frame_scheduler/hints_wake_deferred_frames", []() {
+    FrameScheduler scheduler;
+    int notifications = 0;
+    scheduler.SetDeferredFrameCallback([&notifications]() { ++notifications; });
+    scheduler.SetBudget({60.0, std::nullopt});
+    const auto client = scheduler.Register();
+    FrameScheduler::Hints hints;
+    hints.priority = 0.0;
+    scheduler.SetHints(client, hints);
+    EXPECT_EQ(0, notifications);
+
+    auto now = Clock::time_point();
+    EXPECT_FALSE(scheduler.MayPublish(client, kFrameBytes, now));
+    EXPECT_EQ(1, notifications);
+    // Blocked clients wait for a change instead of being polled.
+    EXPECT_FALSE(scheduler.NextDeferredFrameRetry(now).has_value());
+
+    now += std::chrono::seconds(5);
+    hints.priority = 1.0;
+    scheduler.SetHints(client, hints);
+    EXPECT_EQ(2, notifications);
+    EXPECT_TRUE(scheduler.NextDeferredFrameRetry(now) == now);
+    EXPECT_TRUE(scheduler.RetryDeferredFrame(client, now));
+  });
+
+  registry.Add("frame_scheduler/budget_change_wakes_deferred_frames", []() {
+    FrameScheduler scheduler;
+    int notifications = 0;
+    scheduler.SetDeferredFrameCallback([&notifications]() { ++notifications; });
+    scheduler.SetBudget({1.0, std::nullopt});
+    EXPECT_EQ(0, notifications);
+    const auto client = scheduler.Register();
+    auto now = Clock::time_point();
+    scheduler.MayPublish(client, kFrameBytes, now);
+    EXPECT_FALSE(scheduler.MayPublish(client, kFrameBytes, now));
+
+    scheduler.SetBudget({});
+    EXPECT_EQ(2, notifications);
+    EXPECT_TRUE(scheduler.NextDeferredFrameRetry(now) == now);
+    EXPECT_TRUE(scheduler.RetryDeferredFrame(client, now));
+  });
+
+  registry.Add("frame_scheduler/discard_deferred_frame", []() {
+    FrameScheduler scheduler;
+    scheduler.SetBudget({10.0, std::nullopt});
+    const auto client = scheduler.Register();
+    auto now = Clock::time_point();
+    scheduler.MayPublish(client, kFrameBytes, now);
+    scheduler.MayPublish(client, kFrameBytes, now);
+    scheduler.DiscardDeferredFrame(client);
+    EXPECT_FALSE(scheduler.NextDeferredFrameRetry(now).has_value());
+    EXPECT_FALSE(
+        scheduler.RetryDeferredFrame(client, now + std::chrono::seconds(1)));
+  });
+
+  registry.Add("frame_pacer/publish_deferred_frame", []() {
+    FrameScheduler scheduler;
+    scheduler.SetBudget({10.0, std::nullopt});
+    FramePacer pacer;
+    pacer.SetFrameScheduler(&scheduler);
+    auto now = Clock::time_point();
+
+    EXPECT_TRUE(pacer.OnFrameArrived(kFrameBytes, now) ==
+                FramePacer::Decision::kPublish);
+    EXPECT_TRUE(pacer.OnFrameArrived(kFrameBytes, now) ==
+                FramePacer::Decision::kDeferredByScheduler);
+    EXPECT_FALSE(pacer.PublishDeferredFrame(now));
+    EXPECT_TRUE(pacer.PublishDeferredFrame(now + std::chrono::seconds(1)));
+
+    const auto counts = pacer.TakeFrameCounts();
+    EXPECT_EQ(2u, counts.arrived);
+    EXPECT_EQ(2u, counts.published);
+
+    // Frames aren't deferred after unregistering.
+    pacer.SetFrameScheduler(nullptr);
+    EXPECT_FALSE(pacer.PublishDeferredFrame(now + std::chrono::seconds(2)));
+  });
+}
+
+}  // namespace test
@@ -0,0 +1,215 @@
+#include "util/json_decoder.h"
+
+#include <flutter/encodable_value.h>
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "test.h"
+#include "util/json_path.h"
+#include "util/json_string.h"
+
+namespace test {
+
+namespace {
+typedef flutter::EncodableValue Value;
+typedef util::JsonDecoder<Value, flutter::EncodableList, flutter::EncodableMap>
+    Decoder;
+
+std::optional<Value> Decode(std::string_view json) {
+  return Decoder::Decode(json);
+}
+
+// Whether |json| decodes to exactly |expected|, including its type.
+bool DecodesTo(std::string_view json, const Value& expected) {
+  const auto value = Decode(json);
+  return value && *value == expected;
+}
+
+// Decodes the string literal |json| with both decoders, which must agree.
+std::optional<std::string> DecodeString(std::string_view json) {
+  const auto value = Decode(json);
+  const auto string = util::DecodeJsonString(json);
+  if (value.has_value() != string.has_value() ||
+      (value && std::get<std::string>(*value) != *string)) {
+    return "decoders disagree";
+  }
+  return string;
+}
+
+// Returns |depth| arrays or objects nested in each other.
+std::string Nested(int depth, bool objects) {
+  std::string json;
+  for (int i = 0; i < depth; ++i) {
+    json += objects ? "{\"a\":" : "[";
+  }
+  json += "1";
+  for (int i = 0; i < depth; ++i) {
+    json += objects ? "}" : "]";
+  }
+  return json;
+}
+}  // namespace
+
+void RegisterJsonDecoderTests(Registry& registry) {
+  registry.Add("json_decoder/values", []() {
+    EXPECT_TRUE(DecodesTo("null", Value()));
+    EXPECT_TRUE(DecodesTo("true", Value(true)));
+    EXPECT_TRUE(DecodesTo(" false ", Value(false)));
+    EXPECT_TRUE(DecodesTo("\"a\"", Value("a")));
+    EXPECT_TRUE(DecodesTo(
+        " {\"a\" : [1, {\"b\": null}, []], \"c\": {}, \"a\": \"last\"}\r\n",
+        Value(flutter::EncodableMap{
+            {Value("a"), Value("last")},
+            {Value("c"), Value(flutter::EncodableMap{})}})));
+    EXPECT_TRUE(DecodesTo(
+        "[1, [true], {\"b\": null}]",
+        Value(flutter::EncodableList{
+            Value(1), Value(flutter::EncodableList{Value(true)}),
+            Value(flutter::EncodableMap{{Value("b"), Value()}})})));
+  });
+
+  registry.Add("json_decoder/integers", []() {
+    EXPECT_TRUE(DecodesTo("0", Value(0)));
+    EXPECT_TRUE(DecodesTo("2147483647", Value(int32_t{2147483647})));
+    EXPECT_TRUE(DecodesTo("-2147483648", Value(int32_t{-2147483647 - 1})));
+    EXPECT_TRUE(DecodesTo("2147483648", Value(int64_t{2147483648})));
+    EXPECT_TRUE(DecodesTo("-2147483649", Value(int64_t{-2147483649})));
+    EXPECT_TRUE(DecodesTo("9223372036854775807",
+                          Value(std::numeric_limits<int64_t>::max())));
+    EXPECT_TRUE(DecodesTo("-9223372036854775808",
+                          Value(std::numeric_limits<int64_t>::min())));
+    // Integers too large for 64 bits become doubles.
+    EXPECT_TRUE(DecodesTo("9223372036854775808", Value(9223372036854775808.0)));
+    EXPECT_TRUE(
+        DecodesTo("-9223372036854775809", Value(-9223372036854775808.0)));
+    EXPECT_TRUE(DecodesTo("100000000000000000000000", Value(1e23)));
+  });
+
+  registry.Add("json_decoder/doubles", []() {
+    EXPECT_TRUE(DecodesTo("1.5", Value(1.5)));
+    EXPECT_TRUE(DecodesTo("-0.25", Value(-0.25)));
+    EXPECT_TRUE(DecodesTo("1e2", Value(100.0)));
+    EXPECT_TRUE(DecodesTo("1E+2", Value(100.0)));
+    EXPECT_TRUE(DecodesTo("25e-2", Value(0.25)));
+    EXPECT_TRUE(DecodesTo("1.0", Value(1.0)));
+    // -0 keeps its sign, so it is a double.
+    const auto zero = Decode("-0");
+    EXPECT_TRUE(zero && std::holds_alternative<double>(*zero) &&
+                std::signbit(std::get<double>(*zero)));
+    EXPECT_TRUE(DecodesTo("-0.0", Value(-0.0)));
+    // Out of range doubles overflow and underflow.
+    EXPECT_TRUE(
+        DecodesTo("1e400", Value(std::numeric_limits<double>::infinity())));
+    EXPECT_TRUE(DecodesTo("1e-400", Value(0.0)));
+  });
+
+  registry.Add("json_decoder/invalid_numbers", []() {
+    for (const auto json : {"01", "-01", "1.", ".5", "-", "+1", "1e", "1e+",
+                            "0x10", "1.e2", "Infinity", "NaN", "--1"}) {
+      EXPECT_EQ(std::nullopt, Decode(json));
+    }
+  });
+
+  registry.Add("json_decoder/strings", []() {
+    EXPECT_EQ(std::optional<std::string>("a\"b\\c/d\b\f\n\r\t"),
+              DecodeString("\"a\\\"b\\\\c\\/d\\b\\f\\n\\r\\t\""));
+    EXPECT_EQ(std::optional<std::string>("\xc3\xa9\xe2\x82\xac\x7f"),
+              DecodeString("\"\\u00e9\\u20AC\x7f\""));
+    EXPECT_EQ(std::optional<std::string>("\xc3\xa9"),
+              DecodeString("\"\xc3\xa9\""));
+    // Surrogate pairs.
+    EXPECT_EQ(std::optional<std::string>("\xf0\x9f\x98\x80"),
+              DecodeString("\"\\ud83d\\ude00\""));
+    EXPECT_EQ(std::optional<std::string>("\xf4\x8f\xbf\xbf"),
+              DecodeString("\"\\udbff\\udfff\""));
+  });
+
+  registry.Add("json_decoder/unpaired_surrogates", []() {
+    const std::string replacement = "\xef\xbf\xbd";
+    EXPECT_EQ(std::optional<std::string>(replacement),
+              DecodeString("\"\\ud83d\""));
+    EXPECT_EQ(std::optional<std::string>(replacement),
+              DecodeString("\"\\ude00\""));
+    EXPECT_EQ(std::optional<std::string>(replacement + "x"),
+              DecodeString("\"\\ud83dx\""));
+    EXPECT_EQ(std::optional<std::string>(replacement + "A"),
+              DecodeString("\"\\ud83d\\u0041\""));
+    EXPECT_EQ(std::optional<std::string>(replacement + replacement),
+              DecodeString("\"\\ude00\\ud83d\""));
+    // The second high surrogate still pairs with the low one after it.
+    EXPECT_EQ(std::optional<std::string>(replacement + "\xf0\x9f\x98\x80"),
+              DecodeString("\"\\ud83d\\ud83d\\ude00\""));
+  });
+
+  registry.Add("json_decoder/invalid_strings", []() {
+    const std::string_view invalid[] = {
+        // Control characters.
+        "\"\x01\"", "\"a\nb\"", "\"\t\"", "\"\x1f\"",
+        std::string_view("\"\0\"", 3),
+        // Invalid escapes.
+        "\"\\x\"", "\"\\u12\"", "\"\\u00g0\"", "\"\\ud83d\\u12\"",
+        // Unterminated strings.
+        "\"\\\"", "\"abc", "\"", "\"\\"};
+    for (const auto json : invalid) {
+      EXPECT_EQ(std::nullopt, DecodeString(json));
+    }
+  });
+
+  registry.Add("json_decoder/trailing_garbage", []() {
+    for (const auto json : {"1 2", "{} x", "[1]]", "true false", "nullx",
+                            "\"a\"\"b\"", "1,", "[1,]", "{\"a\":1,}", "",
+                            " ", "[1 2]", "{\"a\" 1}", "{1: 2}", "tru"}) {
+      EXPECT_EQ(std::nullopt, Decode(json));
+    }
+  });
+
+  registry.Add("json_decoder/max_depth", []() {
+    for (const bool objects : {false, true}) {
+      EXPECT_TRUE(Decode(Nested(Decoder::kMaxDepth, objects)).has_value());
+      EXPECT_EQ(std::nullopt, Decode(Nested(Decoder::kMaxDepth + 1, objects)));
+    }
+    // Siblings don't add up.
+    std::string siblings = "[";
+    for (int i = 0; i < 2 * Decoder::kMaxDepth; ++i) {
+      siblings += "[],";
+    }
+    siblings += "[]]";
+    EXPECT_TRUE(Decode(siblings).has_value());
+  });
+
+  registry.Add("json_decoder/scan_plain_run", []() {
+    // Plain text, including bytes with the high bit set, DEL and spaces.
+    const std::string plain = "ab \x7f\xc3\xa9\xff\x80wxyz0123";
+    EXPECT_EQ(plain.size(), util::JsonStringDecoder::ScanPlainRun(
+                                plain.data(), plain.data() + plain.size()));
+
+    // A special character at each position of the first and second word.
+    size_t mismatches = 0;
+    for (const char special : {'"', '\\', '\0', '\x01', '\x1f'}) {
+      for (size_t position = 0; position < plain.size(); ++position) {
+        std::string text = plain;
+        text[position] = special;
+        mismatches += util::JsonStringDecoder::ScanPlainRun(
+                          text.data(), text.data() + text.size()) != position;
+      }
+    }
+    EXPECT_EQ(0u, mismatches);
+
+    // And escapes at each position of a string decode the same.
+    for (size_t position = 0; position < 17; ++position) {
+      std::string json = "\"" + std::string(16, 'a') + "\"";
+      json.insert(1 + position, "\\n");
+      std::string expected(16, 'a');
+      expected.insert(position, "\n");
+      mismatches += DecodeString(json) != expected;
+    }
+    EXPECT_EQ(0u, mismatches);
+  });
+}
+
+}  // namespace test
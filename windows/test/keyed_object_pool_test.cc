@@ -0,0 +1,131 @@
+#include "util/keyed_object_pool.h"
+
+#include <cstdint>
+#include <memory>
+
+#include "test.h"
+
+namespace test {
+
+namespace {
+// Stands in for a COM object that keeps the state callers set on it.
+struct Object {
+  int id;
+  int state = 0;
+};
+
+typedef std::shared_ptr<Object> ObjectPtr;
+
+// A pool of objects numbered in creation order, as large as the plugin's
+// pool of pointer infos.
+struct TestPool {
+  int created = 0;
+  bool fail = false;
+  util::KeyedObjectPool<int32_t, ObjectPtr> pool{
+      [this]() {
+        return fail ? nullptr : std::make_shared<Object>(Object{++created});
+      },
+      [](ObjectPtr& object) { object->state = 0; }, 10};
+};
+}  // namespace
+
+void RegisterKeyedObjectPoolTests(Registry& registry) {
+  registry.Add("keyed_object_pool/reset_on_reuse", []() {
+    TestPool test_pool;
+    auto& pool = test_pool.pool;
+    auto object = pool.Acquire(1);
+    object->state = 42;
+    // The same key gets its object back, reset.
+    const auto again = pool.Acquire(1);
+    EXPECT_TRUE(again == object);
+    EXPECT_EQ(0, again->state);
+
+    again->state = 7;
+    pool.Release(1);
+    EXPECT_EQ(1u, pool.idle_size());
+    const auto reused = pool.Acquire(2);
+    EXPECT_TRUE(reused == object);
+    EXPECT_EQ(0, reused->state);
+    EXPECT_EQ(1u, pool.created_count());
+    EXPECT_EQ(2u, pool.reused_count());
+  });
+
+  registry.Add("keyed_object_pool/idle_objects_serve_new_keys", []() {
+    TestPool test_pool;
+    auto& pool = test_pool.pool;
+    for (int32_t key = 0; key < 3; ++key) {
+      pool.Acquire(key);
+    }
+    pool.Release(0);
+    pool.Release(2);
+    // Releasing a key that holds nothing does nothing.
+    pool.Release(5);
+    EXPECT_EQ(2u, pool.idle_size());
+
+    // New keys take the idle objects before any is created.
+    EXPECT_EQ(3, pool.Acquire(3)->id);
+    EXPECT_EQ(1, pool.Acquire(4)->id);
+    EXPECT_EQ(4, pool.Acquire(5)->id);
+    EXPECT_EQ(0u, pool.idle_size());
+    EXPECT_EQ(4u, pool.created_count());
+    EXPECT_EQ(4u, pool.size());
+  });
+
+  registry.Add("keyed_object_pool/bounded_size", []() {
+    TestPool test_pool;
+    auto& pool = test_pool.pool;
+    // Keys that are released as pointers go up share a few objects.
+    for (int32_t key = 0; key < 100; ++key) {
+      pool.Acquire(key);
+      pool.Acquire(key + 1000);
+      pool.Release(key);
+      pool.Release(key + 1000);
+    }
+    EXPECT_EQ(2u, pool.created_count());
+    EXPECT_EQ(2u, pool.size());
+
+    // Keys that never release can't grow the pool beyond its bound.
+    for (int32_t key = 0; key < 100; ++key) {
+      pool.Acquire(key);
+    }
+    EXPECT_EQ(10u, pool.size());
+    EXPECT_EQ(0u, pool.idle_size());
+  });
+
+  registry.Add("keyed_object_pool/evicts_least_recently_used", []() {
+    TestPool test_pool;
+    auto& pool = test_pool.pool;
+    for (int32_t key = 0; key < 10; ++key) {
+      pool.Acquire(key);
+    }
+    // Key 0 is used again, so key 1 is now the least recently used.
+    const auto first = pool.Acquire(0);
+    const auto eleventh = pool.Acquire(10);
+    EXPECT_EQ(11, eleventh->id);
+    EXPECT_EQ(10u, pool.size());
+
+    // Key 0 kept its object, while key 1 lost its own and gets a new one.
+    EXPECT_TRUE(pool.Acquire(0) == first);
+    EXPECT_EQ(12, pool.Acquire(1)->id);
+    EXPECT_EQ(10u, pool.size());
+    // Releasing an evicted key does nothing.
+    pool.Release(2);
+    EXPECT_EQ(0u, pool.idle_size());
+  });
+
+  registry.Add("keyed_object_pool/failed_creation", []() {
+    TestPool test_pool;
+    auto& pool = test_pool.pool;
+    test_pool.fail = true;
+    EXPECT_FALSE(pool.Acquire(1));
+    EXPECT_EQ(0u, pool.size());
+    EXPECT_EQ(0u, pool.created_count());
+
+    // A failed key holds nothing, so the next acquisition tries again.
+    test_pool.fail = false;
+    EXPECT_TRUE(pool.Acquire(1) != nullptr);
+    EXPECT_EQ(1u, pool.size());
+  });
+}
+
+}  // namespace test
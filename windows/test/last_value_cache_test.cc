@@ -0,0 +1,41 @@
+#include "util/last_value_cache.h"
+
+#include <string>
+#include <utility>
+
+#include "test.h"
+
+namespace test {
+
+void RegisterLastValueCacheTests(Registry& registry) {
+  registry.Add("last_value_cache/suppresses_duplicates", []() {
+    util::LastValueCache<std::string> cache;
+    EXPECT_TRUE(cache.Update("a"));
+    EXPECT_FALSE(cache.Update("a"));
+    EXPECT_FALSE(cache.Update("a"));
+    EXPECT_TRUE(cache.Update("b"));
+    EXPECT_TRUE(cache.Update("a"));
+    EXPECT_EQ(2u, cache.suppressed_count());
+    EXPECT_TRUE(cache.value() == std::string("a"));
+  });
+
+  registry.Add("last_value_cache/reset_reports_next_value", []() {
+    util::LastValueCache<std::string> cache;
+    EXPECT_TRUE(cache.Update("a"));
+    EXPECT_FALSE(cache.Update("a"));
+    cache.Reset();
+    EXPECT_FALSE(cache.value().has_value());
+    EXPECT_TRUE(cache.Update("a"));
+    // The counter survives resets.
+    EXPECT_EQ(1u, cache.suppressed_count());
+  });
+
+  registry.Add("last_value_cache/compares_pairs", []() {
+    util::LastValueCache<std::pair<bool, bool>> cache;
+    EXPECT_TRUE(cache.Update({true, false}));
+    EXPECT_FALSE(cache.Update({true, false}));
+    EXPECT_TRUE(cache.Update({true, true}));
+  });
+}
+
+}  // namespace test
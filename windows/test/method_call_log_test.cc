@@ -0,0 +1,282 @@
+#include "method_call_log.h"
+
+#include <flutter/encodable_value.h>
+
+#include <algorithm>
+#include <any>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "test.h"
+
+namespace test {
+
+namespace {
+typedef flutter::EncodableValue Value;
+using std::chrono::microseconds;
+
+// The header of a version 1 log.
+const std::string kHeader("WVMC\x01\0\0\0", 8);
+
+// Values of every type the log encodes.
+Value AllTypes() {
+  return Value(flutter::EncodableMap{
+      {Value("null"), Value()},
+      {Value("bools"),
+       Value(flutter::EncodableList{Value(false), Value(true)})},
+      {Value("int32"),
+       Value(flutter::EncodableList{
+           Value(int32_t{0}), Value(int32_t{-1}),
+           Value(std::numeric_limits<int32_t>::min()),
+           Value(std::numeric_limits<int32_t>::max())})},
+      {Value("int64"),
+       Value(flutter::EncodableList{
+           Value(int64_t{1} << 40),
+           Value(std::numeric_limits<int64_t>::min()),
+           Value(std::numeric_limits<int64_t>::max())})},
+      {Value("double"),
+       Value(flutter::EncodableList{Value(-0.5), Value(1e300)})},
+      {Value("string"), Value(std::string("a\0\xc3\xa9", 4))},
+      {Value("bytes"), Value(std::vector<uint8_t>{0, 1, 0xff})},
+      {Value("int32s"), Value(std::vector<int32_t>{-1, 0, 1 << 30})},
+      {Value("int64s"), Value(std::vector<int64_t>{-(int64_t{1} << 50), 3})},
+      {Value("doubles"), Value(std::vector<double>{0.25, -1e-300})},
+      {Value("floats"), Value(std::vector<float>{1.5f, -2.0f})},
+      {Value("empty"), Value(flutter::EncodableList{})},
+      {Value(int32_t{7}),
+       Value(flutter::EncodableMap{
+           {Value(), Value(flutter::EncodableList{
+                         Value(flutter::EncodableMap{})})}})},
+  });
+}
+
+bool Equal(const RecordedMethodCall& a, const RecordedMethodCall& b) {
+  return a.timestamp == b.timestamp && a.instance_id == b.instance_id &&
+         a.method_name == b.method_name && a.arguments == b.arguments;
+}
+
+// Whether |a| holds the first calls of |b|.
+bool IsPrefix(const std::vector<RecordedMethodCall>& a,
+              const std::vector<RecordedMethodCall>& b) {
+  return a.size() <= b.size() &&
+         std::equal(a.begin(), a.end(), b.begin(), Equal);
+}
+
+bool Equal(const std::vector<RecordedMethodCall>& a,
+           const std::vector<RecordedMethodCall>& b) {
+  return a.size() == b.size() && IsPrefix(a, b);
+}
+
+// Calls with repeated names, equal and large timestamps and extreme ids.
+std::vector<RecordedMethodCall> Calls() {
+  const microseconds later(int64_t{1} << 40);
+  return {{microseconds(0), 1, "loadUrl", Value("https://a.test/")},
+          {microseconds(250), 1, "setSize", AllTypes()},
+          {microseconds(250), -2, "loadUrl", Value()},
+          {later, std::numeric_limits<int64_t>::min(), "executeScript",
+           Value(std::string(300, 'x'))},
+          {later + microseconds(1), 0, "setSize",
+           Value(flutter::EncodableList{Value(1.0), Value(2.0)})}};
+}
+
+// Writes |calls| and returns the log, and in |ends| the size of the log
+// after each record.
+std::string Write(const std::vector<RecordedMethodCall>& calls,
+                  std::vector<size_t>* ends = nullptr) {
+  MethodCallLogWriter writer;
+  std::string data;
+  for (const auto& call : calls) {
+    writer.Append(call.timestamp, call.instance_id, call.method_name,
+                  &call.arguments);
+    data += writer.TakeData();
+    if (ends) {
+      ends->push_back(data.size());
+    }
+  }
+  return data;
+}
+
+std::vector<RecordedMethodCall> ReadAll(MethodCallLogReader& reader) {
+  std::vector<RecordedMethodCall> calls;
+  while (const auto call = reader.Next()) {
+    calls.push_back(*call);
+  }
+  return calls;
+}
+
+// Whether |data| fails to decode, after any records before the failure.
+bool Fails(const std::string& data) {
+  MethodCallLogReader reader(data);
+  ReadAll(reader);
+  return reader.failed();
+}
+
+// Returns a log of a single "m" call to instance 1 with the encoded
+// arguments |value|.
+std::string Record(const std::string& value) {
+  return kHeader + std::string("\x00\x02\x00\x01m", 5) + value;
+}
+}  // namespace
+
+void RegisterMethodCallLogTests(Registry& registry) {
+  registry.Add("method_call_log/round_trip", []() {
+    const auto calls = Calls();
+    const auto data = Write(calls);
+    EXPECT_TRUE(data.compare(0, kHeader.size(), kHeader) == 0);
+    MethodCallLogReader reader(data);
+    EXPECT_TRUE(Equal(ReadAll(reader), calls));
+    EXPECT_FALSE(reader.failed());
+    // The end of the log stays the end.
+    EXPECT_FALSE(reader.Next().has_value());
+  });
+
+  registry.Add("method_call_log/writer", []() {
+    MethodCallLogWriter writer;
+    EXPECT_EQ(kHeader.size(), writer.pending_size());
+    const Value custom(flutter::CustomEncodableValue(std::any(1)));
+    writer.Append(microseconds(100), 3, "a", nullptr);
+    writer.Append(microseconds(200), 3, "b", &custom);
+    const auto first = writer.TakeData();
+    EXPECT_EQ(0u, writer.pending_size());
+    // Time that goes backwards is recorded as no time passing.
+    writer.Append(microseconds(50), 3, "a", nullptr);
+    const auto second = writer.TakeData();
+    // Names are only stored the first time they are used.
+    EXPECT_TRUE(second.find('a') == std::string::npos);
+
+    const auto data = first + second;
+    MethodCallLogReader reader(data);
+    const std::vector<RecordedMethodCall> expected = {
+        {microseconds(100), 3, "a", Value()},
+        {microseconds(200), 3, "b", Value()},
+        {microseconds(200), 3, "a", Value()}};
+    EXPECT_TRUE(Equal(ReadAll(reader), expected));
+    EXPECT_FALSE(reader.failed());
+  });
+
+  registry.Add("method_call_log/headers", []() {
+    EXPECT_FALSE(Fails(kHeader));
+    EXPECT_TRUE(Fails(""));
+    EXPECT_TRUE(Fails("WVMC"));
+    EXPECT_TRUE(Fails(kHeader.substr(0, 7)));
+    EXPECT_TRUE(Fails(std::string("WVMX\x01\0\0\0", 8)));
+    EXPECT_TRUE(Fails(std::string("WVMC\x02\0\0\0", 8)));
+    EXPECT_TRUE(Fails(std::string("WVMC\x01\0\0\x01", 8)));
+  });
+
+  registry.Add("method_call_log/truncated", []() {
+    // Every prefix of a log decodes to the records it holds completely, and
+    // fails unless it ends after one of them.
+    const auto calls = Calls();
+    std::vector<size_t> ends;
+    const auto data = Write(calls, &ends);
+    size_t mismatches = 0;
+    for (size_t size = kHeader.size(); size < data.size(); ++size) {
+      MethodCallLogReader reader(std::string_view(data).substr(0, size));
+      const auto decoded = ReadAll(reader);
+      const auto complete = static_cast<size_t>(
+          std::upper_bound(ends.begin(), ends.end(), size) - ends.begin());
+      const bool at_end = size == kHeader.size() ||
+                          (complete > 0 && ends[complete - 1] == size);
+      mismatches += decoded.size() != complete || !IsPrefix(decoded, calls) ||
+                    reader.failed() == at_end;
+    }
+    EXPECT_EQ(0u, mismatches);
+  });
+
+  registry.Add("method_call_log/corrupt", []() {
+    EXPECT_FALSE(Fails(Record("\x02")));
+    // Unknown value tags.
+    EXPECT_TRUE(Fails(Record("\x0e")));
+    EXPECT_TRUE(Fails(Record("\xff")));
+    // A name index past the names seen so far.
+    EXPECT_TRUE(Fails(kHeader + std::string("\x00\x02\x01\x00", 4)));
+    // A varint longer than 64 bits.
+    EXPECT_TRUE(Fails(kHeader + std::string(10, '\x80') + "\x01"));
+    // Counts larger than the rest of the log fail without allocating them.
+    for (const char tag : {'\x06', '\x07', '\x08', '\x09', '\x0a', '\x0b',
+                           '\x0c', '\x0d'}) {
+      EXPECT_TRUE(Fails(Record(std::string(1, tag) +
+                               "\xff\xff\xff\xff\xff\xff\xff\xff\x7f")));
+    }
+    // A list of int64s that is one byte short.
+    EXPECT_TRUE(Fails(Record("\x09\x01" + std::string(7, '\0'))));
+    EXPECT_FALSE(Fails(Record("\x09\x01" + std::string(8, '\0'))));
+  });
+
+  registry.Add("method_call_log/max_depth", []() {
+    // Lists of one list, nested up to the limit of 512 and beyond it.
+    for (const int depth : {512, 513}) {
+      std::string nested;
+      for (int i = 0; i < depth; ++i) {
+        nested += "\x0b\x01";
+      }
+      EXPECT_EQ(depth > 512, Fails(Record(nested + '\0')));
+    }
+  });
+
+  registry.Add("method_call_log/flipped_bytes", []() {
+    // Corrupt logs decode without crashing, and stay ended once they fail.
+    const auto data = Write(Calls());
+    size_t mismatches = 0;
+    for (size_t position = kHeader.size(); position < data.size();
+         ++position) {
+      for (const uint8_t mask : {0x01, 0x80, 0xff}) {
+        std::string corrupt = data;
+        corrupt[position] = static_cast<char>(corrupt[position] ^ mask);
+        MethodCallLogReader reader(corrupt);
+        ReadAll(reader);
+        mismatches += reader.Next().has_value();
+      }
+    }
+    EXPECT_EQ(0u, mismatches);
+  });
+
+  registry.Add("method_call_recorder/file", []() {
+    const auto path = std::filesystem::temp_directory_path() /
+                      "webview_windows_method_call_log_test.wvmc";
+    MethodCallRecorder recorder;
+    EXPECT_FALSE(recorder.recording());
+    EXPECT_FALSE(recorder.Start(path.parent_path() / "missing" / "log"));
+    EXPECT_FALSE(recorder.recording());
+
+    const auto start = MethodCallRecorder::Clock::now();
+    EXPECT_TRUE(recorder.Start(path));
+    EXPECT_TRUE(recorder.recording());
+    const Value arguments(std::string(100000, 'x'));
+    recorder.Record(1, "a", &arguments, start + std::chrono::seconds(1));
+    recorder.Record(2, "b", nullptr, start + std::chrono::seconds(2));
+    recorder.Stop();
+    EXPECT_FALSE(recorder.recording());
+    // Calls after stopping are dropped.
+    recorder.Record(3, "c", nullptr);
+
+    std::ifstream file(path, std::ios::binary);
+    const std::string data((std::istreambuf_iterator<char>(file)),
+                           std::istreambuf_iterator<char>());
+    file.close();
+    std::filesystem::remove(path);
+    MethodCallLogReader reader(data);
+    const auto calls = ReadAll(reader);
+    EXPECT_FALSE(reader.failed());
+    EXPECT_EQ(2u, calls.size());
+    if (calls.size() == 2) {
+      EXPECT_TRUE(calls[0].method_name == "a" &&
+                  calls[0].arguments == arguments);
+      EXPECT_TRUE(calls[1].instance_id == 2 && calls[1].method_name == "b");
+      // The recording starts when Start is called.
+      EXPECT_TRUE(calls[1].timestamp - calls[0].timestamp ==
+                  std::chrono::seconds(1));
+      EXPECT_TRUE(calls[0].timestamp <= std::chrono::seconds(1));
+    }
+  });
+}
+
+}  // namespace test
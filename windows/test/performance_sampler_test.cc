@@ -0,0 +1,157 @@
+#include "performance_sampler.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <string>
+
+#include "test.h"
+
+namespace test {
+
+namespace {
+typedef PerformanceSampler::Clock Clock;
+
+// Returns Performance.getMetrics results with the given metrics, among
+// others that records don't use. Times are in seconds.
+std::string GetMetrics(double timestamp, double process_time,
+                       double layout_count, double js_heap_used_size) {
+  char metrics[512];
+  std::snprintf(metrics, sizeof(metrics),
+                "{\"metrics\":["
+                "{\"name\":\"Timestamp\",\"value\":%g},"
+                "{\"name\":\"AudioHandlers\",\"value\":0},"
+                "{\"name\":\"ProcessTime\",\"value\":%g},"
+                "{\"name\":\"LayoutCount\",\"value\":%g},"
+                "{\"name\":\"JSHeapUsedSize\",\"value\":%g},"
+                "{\"name\":\"Nodes\",\"value\":120}, "
+                "{\"name\":\"TaskDuration\",\"value\":%g} ]}",
+                timestamp, process_time, layout_count, js_heap_used_size,
+                process_time / 2);
+  return metrics;
+}
+
+bool Near(double expected, double actual) {
+  return std::abs(expected - actual) < 1e-6;
+}
+
+// Takes the sample due at |now|, which must be due, and returns whether it
+// produced a record.
+bool TakeSample(PerformanceSampler& sampler, const std::string& metrics,
+                Clock::time_point now) {
+  EXPECT_TRUE(sampler.BeginSample(now));
+  return sampler.EndSample(metrics, "", {}, now).has_value();
+}
+}  // namespace
+
+void RegisterPerformanceSamplerTests(Registry& registry) {
+  registry.Add("performance_sampler/schedule", []() {
+    PerformanceSampler sampler(std::chrono::seconds(1), false);
+    const auto start = Clock::time_point() + std::chrono::seconds(5);
+    EXPECT_TRUE(sampler.BeginSample(start));
+    // No other sample starts while one is taken.
+    EXPECT_FALSE(sampler.next_sample().has_value());
+    EXPECT_FALSE(sampler.BeginSample(start));
+
+    // The first sample has nothing to compare with.
+    EXPECT_FALSE(sampler.EndSample(GetMetrics(100, 1, 10, 1e6), "", {}, start)
+                     .has_value());
+    EXPECT_TRUE(sampler.next_sample() == start + std::chrono::seconds(1));
+    EXPECT_FALSE(sampler.BeginSample(start + std::chrono::milliseconds(999)));
+    EXPECT_TRUE(sampler.BeginSample(start + std::chrono::seconds(1)));
+  });
+
+  registry.Add("performance_sampler/record", []() {
+    PerformanceSampler sampler(std::chrono::seconds(1), true);
+    auto now = Clock::time_point() + std::chrono::seconds(5);
+    TakeSample(sampler, GetMetrics(100, 1, 10, 1e6), now);
+
+    now += std::chrono::seconds(2);
+    EXPECT_TRUE(sampler.BeginSample(now));
+    FramePacer::FrameCounts frames;
+    frames.arrived = 120;
+    frames.published = 60;
+    frames.longest_interval = FramePacer::FrameDuration(33.5);
+    const auto record = sampler.EndSample(
+        GetMetrics(102, 1.5, 30, 3e6),
+        "{\"usedSize\":1,\"embedderHeapUsedSize\":4096,"
+        "\"backingStorageSize\":77}",
+        frames, now);
+    EXPECT_TRUE(record.has_value());
+    if (!record) {
+      return;
+    }
+
+    typedef PerformanceSampler S;
+    const auto& values = *record;
+    EXPECT_TRUE(Near(2000, values[S::kIntervalMs]));
+    EXPECT_TRUE(Near(0.25, values[S::kCpuUsage]));
+    EXPECT_TRUE(Near(250, values[S::kTaskMs]));
+    EXPECT_EQ(20.0, values[S::kLayoutCount]);
+    EXPECT_EQ(10.0, values[S::kLayoutsPerSecond]);
+    EXPECT_EQ(3e6, values[S::kJsHeapUsedBytes]);
+    EXPECT_EQ(1e6, values[S::kJsHeapGrowthBytesPerSecond]);
+    EXPECT_EQ(120.0, values[S::kNodes]);
+    EXPECT_EQ(60.0, values[S::kRenderedFramesPerSecond]);
+    EXPECT_EQ(30.0, values[S::kPublishedFramesPerSecond]);
+    EXPECT_EQ(33.5, values[S::kLongestFrameIntervalMs]);
+    EXPECT_EQ(4096.0, values[S::kEmbedderHeapUsedBytes]);
+    EXPECT_EQ(77.0, values[S::kBackingStorageBytes]);
+    // Metrics missing from the results aren't available.
+    EXPECT_TRUE(std::isnan(values[S::kMainThreadUsage]));
+    EXPECT_TRUE(std::isnan(values[S::kJsHeapTotalBytes]));
+    EXPECT_TRUE(std::isnan(values[S::kDocuments]));
+  });
+
+  registry.Add("performance_sampler/memory_excluded", []() {
+    PerformanceSampler sampler(std::chrono::seconds(1), false);
+    auto now = Clock::time_point();
+    TakeSample(sampler, GetMetrics(1, 0, 0, 0), now);
+    now += std::chrono::seconds(1);
+    EXPECT_TRUE(sampler.BeginSample(now));
+    const auto record =
+        sampler.EndSample(GetMetrics(2, 0, 0, 0),
+                          "{\"embedderHeapUsedSize\":4096}", {}, now);
+    EXPECT_TRUE(
+        record &&
+        std::isnan((*record)[PerformanceSampler::kEmbedderHeapUsedBytes]));
+  });
+
+  registry.Add("performance_sampler/restarted_metrics", []() {
+    PerformanceSampler sampler(std::chrono::seconds(1), false);
+    auto now = Clock::time_point();
+    const auto next = [&now]() { return now += std::chrono::seconds(1); };
+    TakeSample(sampler, GetMetrics(100, 1, 10, 1e6), next());
+    // A new renderer process starts its metrics over.
+    EXPECT_FALSE(TakeSample(sampler, GetMetrics(5, 0.1, 1, 1e6), next()));
+    EXPECT_TRUE(TakeSample(sampler, GetMetrics(6, 0.2, 2, 1e6), next()));
+    // Time that doesn't advance.
+    EXPECT_FALSE(TakeSample(sampler, GetMetrics(6, 0.2, 2, 1e6), next()));
+  });
+
+  registry.Add("performance_sampler/aborted_samples", []() {
+    PerformanceSampler sampler(std::chrono::seconds(1), false);
+    auto now = Clock::time_point();
+    const auto next = [&now]() { return now += std::chrono::seconds(1); };
+    TakeSample(sampler, GetMetrics(5, 0.1, 1, 1e6), next());
+
+    // Invalid results are no sample, so the next one is compared with the
+    // last valid one.
+    EXPECT_FALSE(TakeSample(sampler, "garbage", next()));
+    EXPECT_FALSE(TakeSample(sampler, "{\"metrics\":[]}", next()));
+    EXPECT_TRUE(TakeSample(sampler, GetMetrics(6, 0.2, 2, 1e6), next()));
+
+    // After an abort, the next sample only restarts the interval.
+    EXPECT_TRUE(sampler.BeginSample(next()));
+    sampler.AbortSample(now);
+    EXPECT_TRUE(sampler.next_sample() == now + std::chrono::seconds(1));
+    EXPECT_FALSE(TakeSample(sampler, GetMetrics(7, 0.3, 3, 1e6), next()));
+    EXPECT_TRUE(TakeSample(sampler, GetMetrics(8, 0.4, 4, 1e6), next()));
+
+    // So does skipping a sample that is due.
+    sampler.AbortSample(next());
+    EXPECT_FALSE(TakeSample(sampler, GetMetrics(9, 0.5, 5, 1e6), next()));
+  });
+}
+
+}  // namespace test
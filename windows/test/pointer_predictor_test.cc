@@ -0,0 +1,145 @@
+#include "pointer_predictor.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <utility>
+
+#include "test.h"
+
+namespace test {
+
+namespace {
+typedef PointerPredictor::Phase Phase;
+
+constexpr auto kLookahead = std::chrono::milliseconds(16);
+
+PointerPredictor MakePredictor(double max_distance = 1000) {
+  PointerPredictor predictor;
+  PointerPredictor::Options options;
+  options.lookahead = kLookahead;
+  options.max_distance = max_distance;
+  predictor.SetOptions(options);
+  return predictor;
+}
+
+bool Equal(std::pair<double, double> expected,
+           std::pair<double, double> actual) {
+  return std::abs(expected.first - actual.first) < 1e-9 &&
+         std::abs(expected.second - actual.second) < 1e-9;
+}
+
+// A fling along a diagonal that starts at 3 units per millisecond and
+// decelerates, as a finger releasing a scroll does.
+std::pair<double, double> FlingPosition(int64_t time_us) {
+  const double ms = time_us / 1000.0;
+  const double distance = 3 * ms - 0.004 * ms * ms;
+  return {100 + distance * 0.6, 200 + distance * 0.8};
+}
+}  // namespace
+
+void RegisterPointerPredictorTests(Registry& registry) {
+  registry.Add("pointer_predictor/fling_error", []() {
+    auto predictor = MakePredictor();
+    const int64_t lookahead_us = kLookahead.count() * 1000;
+    // Samples at 120 Hz for 300 ms, each compared with where the finger
+    // really is one lookahead later.
+    double predicted_error = 0;
+    double unpredicted_error = 0;
+    double max_error = 0;
+    size_t count = 0;
+    for (int64_t time_us = 0; time_us <= 300000; time_us += 8333) {
+      const auto [x, y] = FlingPosition(time_us);
+      const auto phase = time_us == 0 ? Phase::kDown : Phase::kMove;
+      const auto predicted = predictor.Update(1, phase, time_us, x, y);
+      // The fit needs a few samples to settle.
+      if (time_us < 30000) {
+        continue;
+      }
+      const auto [future_x, future_y] = FlingPosition(time_us + lookahead_us);
+      const double error = std::hypot(predicted.first - future_x,
+                                      predicted.second - future_y);
+      predicted_error += error;
+      unpredicted_error += std::hypot(x - future_x, y - future_y);
+      max_error = std::max(max_error, error);
+      ++count;
+    }
+    predicted_error /= count;
+    unpredicted_error /= count;
+    // Without prediction the page lags by about 25 units on average. A line
+    // fit trails the deceleration by a few units, but no more.
+    EXPECT_TRUE(unpredicted_error > 20);
+    EXPECT_TRUE(predicted_error < unpredicted_error / 5);
+    EXPECT_TRUE(max_error < 5);
+  });
+
+  registry.Add("pointer_predictor/disabled_passes_through", []() {
+    PointerPredictor predictor;
+    EXPECT_FALSE(predictor.enabled());
+    predictor.Update(1, Phase::kDown, 0, 0, 0);
+    EXPECT_TRUE(Equal({10, 0}, predictor.Update(1, Phase::kMove, 8000, 10, 0)));
+  });
+
+  registry.Add("pointer_predictor/down_and_up", []() {
+    auto predictor = MakePredictor();
+    // Downs pass through, and so does the first move, which has nothing to
+    // fit but the down.
+    EXPECT_TRUE(Equal({0, 0}, predictor.Update(1, Phase::kDown, 0, 0, 0)));
+    const auto moved = predictor.Update(1, Phase::kMove, 8000, 8, 0);
+    EXPECT_TRUE(Equal({24, 0}, moved));
+    // Ups pass through.
+    EXPECT_TRUE(Equal({16, 0}, predictor.Update(1, Phase::kUp, 16000, 16, 0)));
+
+    // A new down doesn't continue the previous touch, even right after it.
+    EXPECT_TRUE(
+        Equal({500, 500}, predictor.Update(1, Phase::kDown, 17000, 500, 500)));
+    EXPECT_TRUE(Equal({500, 524},
+                      predictor.Update(1, Phase::kMove, 25000, 500, 508)));
+    // Nor does a down without an up before it.
+    predictor.Update(1, Phase::kDown, 26000, 0, 0);
+    EXPECT_TRUE(Equal({0, 0}, predictor.Update(1, Phase::kMove, 26000, 0, 0)));
+  });
+
+  registry.Add("pointer_predictor/max_distance", []() {
+    auto predictor = MakePredictor(10);
+    predictor.Update(1, Phase::kDown, 0, 0, 0);
+    // 3 units per millisecond would predict 48 units along each axis.
+    const auto predicted = predictor.Update(1, Phase::kMove, 1000, 3, 4);
+    EXPECT_TRUE(Equal({9, 12}, predicted));
+  });
+
+  registry.Add("pointer_predictor/window", []() {
+    auto predictor = MakePredictor();
+    predictor.Update(1, Phase::kDown, 0, 0, 0);
+    // Samples older than the window don't take part in the fit.
+    EXPECT_TRUE(
+        Equal({10, 0}, predictor.Update(1, Phase::kMove, 100000, 10, 0)));
+  });
+
+  registry.Add("pointer_predictor/evicts_least_recent_pointer", []() {
+    auto predictor = MakePredictor();
+    for (int32_t pointer = 0; pointer < 10; ++pointer) {
+      predictor.Update(pointer, Phase::kDown, pointer * 1000, 0, 0);
+    }
+    // An eleventh pointer drops pointer 0, whose touch was cancelled.
+    predictor.Update(10, Phase::kDown, 20000, 0, 0);
+
+    // Pointer 1 is still tracked: 10 units in 20 ms predict 8 more.
+    EXPECT_TRUE(
+        Equal({18, 0}, predictor.Update(1, Phase::kMove, 21000, 10, 0)));
+    // Pointer 0 starts over, so its move has nothing to fit.
+    EXPECT_TRUE(
+        Equal({10, 0}, predictor.Update(0, Phase::kMove, 21000, 10, 0)));
+  });
+
+  registry.Add("pointer_predictor/disabling_forgets_pointers", []() {
+    auto predictor = MakePredictor();
+    predictor.Update(1, Phase::kDown, 0, 0, 0);
+    predictor.SetOptions({});
+    predictor.SetOptions(MakePredictor().options());
+    EXPECT_TRUE(Equal({8, 0}, predictor.Update(1, Phase::kMove, 8000, 8, 0)));
+  });
+}
+
+}  // namespace test
@@ -0,0 +1,189 @@
+#include "prewarm_pool.h"
+
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include "test.h"
+
+namespace test {
+
+namespace {
+// A factory whose creations complete when the test says so.
+struct ManualFactory {
+  std::vector<PrewarmPool<int>::CreatedCallback> pending;
+  int next_value = 0;
+
+  PrewarmPool<int>::Factory Get() {
+    return [this](PrewarmPool<int>::CreatedCallback done) {
+      pending.push_back(std::move(done));
+    };
+  }
+
+  void CompleteAll() {
+    auto callbacks = std::move(pending);
+    pending.clear();
+    for (auto& done : callbacks) {
+      done(std::make_unique<int>(next_value++));
+    }
+  }
+};
+}  // namespace
+
+void RegisterPrewarmPoolTests(Registry& registry) {
+  registry.Add("prewarm_pool/refill_and_take", []() {
+    ManualFactory factory;
+    PrewarmPool<int> pool(factory.Get());
+    EXPECT_TRUE(pool.Take() == nullptr);
+
+    pool.SetLimits(2, std::nullopt);
+    pool.Refill();
+    EXPECT_EQ(2u, factory.pending.size());
+    EXPECT_EQ(2u, pool.pending_count());
+    // Pending creations count towards the size.
+    pool.Refill();
+    EXPECT_EQ(2u, factory.pending.size());
+
+    factory.CompleteAll();
+    EXPECT_EQ(2u, pool.idle_count());
+    EXPECT_EQ(0u, pool.pending_count());
+
+    // The most recently created instance is handed out first.
+    const auto instance = pool.Take();
+    EXPECT_TRUE(instance != nullptr && *instance == 1);
+    EXPECT_EQ(1u, pool.idle_count());
+    pool.Refill();
+    EXPECT_EQ(1u, factory.pending.size());
+  });
+
+  registry.Add("prewarm_pool/failed_creation", []() {
+    PrewarmPool<int>::CreatedCallback pending;
+    PrewarmPool<int> pool([&pending](PrewarmPool<int>::CreatedCallback done) {
+      pending = std::move(done);
+    });
+    pool.SetLimits(1, std::nullopt);
+    pool.Refill();
+    pending(nullptr);
+    EXPECT_EQ(0u, pool.idle_count());
+    EXPECT_EQ(0u, pool.pending_count());
+  });
+
+  registry.Add("prewarm_pool/synchronous_failure", []() {
+    // A factory that fails before it returns, e.g. without an environment.
+    size_t calls = 0;
+    PrewarmPool<int> pool([&calls](PrewarmPool<int>::CreatedCallback done) {
+      ++calls;
+      done(nullptr);
+    });
+    pool.SetLimits(2, std::nullopt);
+    pool.Refill();
+    EXPECT_EQ(2u, calls);
+    EXPECT_EQ(0u, pool.idle_count());
+    EXPECT_EQ(0u, pool.pending_count());
+    // The next refill tries again.
+    pool.Refill();
+    EXPECT_EQ(4u, calls);
+  });
+
+  registry.Add("prewarm_pool/synchronous_success", []() {
+    int next_value = 0;
+    PrewarmPool<int> pool(
+        [&next_value](PrewarmPool<int>::CreatedCallback done) {
+          done(std::make_unique<int>(next_value++));
+        });
+    pool.SetLimits(2, std::nullopt);
+    pool.Refill();
+    EXPECT_EQ(2, next_value);
+    EXPECT_EQ(2u, pool.idle_count());
+  });
+
+  registry.Add("prewarm_pool/shrink_releases_idle", []() {
+    ManualFactory factory;
+    PrewarmPool<int> pool(factory.Get());
+    pool.SetLimits(3, std::nullopt);
+    pool.Refill();
+    factory.CompleteAll();
+    pool.SetLimits(1, std::nullopt);
+    EXPECT_EQ(1u, pool.idle_count());
+    // The newest instance is kept.
+    const auto instance = pool.Take();
+    EXPECT_TRUE(instance != nullptr && *instance == 2);
+  });
+
+  registry.Add("prewarm_pool/late_completions_after_clear", []() {
+    ManualFactory factory;
+    PrewarmPool<int> pool(factory.Get());
+    pool.SetLimits(2, std::nullopt);
+    pool.Refill();
+    pool.Clear();
+    factory.CompleteAll();
+    EXPECT_EQ(0u, pool.idle_count());
+    EXPECT_EQ(0u, pool.size());
+  });
+
+  registry.Add("prewarm_pool/completion_after_destruction", []() {
+    ManualFactory factory;
+    {
+      PrewarmPool<int> pool(factory.Get());
+      pool.SetLimits(1, std::nullopt);
+      pool.Refill();
+    }
+    // Must not touch the destroyed pool.
+    factory.CompleteAll();
+    EXPECT_TRUE(factory.pending.empty());
+  });
+
+  registry.Add("prewarm_pool/drain_keeps_limits", []() {
+    ManualFactory factory;
+    PrewarmPool<int> pool(factory.Get());
+    pool.SetLimits(2, std::nullopt);
+    pool.Refill();
+    factory.CompleteAll();
+    pool.Take();
+    pool.Refill();
+
+    pool.Drain();
+    EXPECT_EQ(0u, pool.idle_count());
+    EXPECT_EQ(0u, pool.pending_count());
+    EXPECT_EQ(2u, pool.size());
+    // The creation started before draining is discarded.
+    factory.CompleteAll();
+    EXPECT_EQ(0u, pool.idle_count());
+
+    pool.Refill();
+    EXPECT_EQ(2u, factory.pending.size());
+    factory.CompleteAll();
+    EXPECT_EQ(2u, pool.idle_count());
+  });
+
+  registry.Add("prewarm_pool/idle_timeout", []() {
+    ManualFactory factory;
+    PrewarmPool<int> pool(factory.Get());
+    pool.SetLimits(2, std::chrono::seconds(30));
+    EXPECT_FALSE(pool.NextExpiry().has_value());
+    const auto start = PrewarmPool<int>::Clock::now();
+    pool.Refill();
+    factory.CompleteAll();
+
+    const auto expiry = pool.NextExpiry();
+    EXPECT_TRUE(expiry.has_value() &&
+                *expiry >= start + std::chrono::seconds(30));
+    EXPECT_EQ(0u, pool.Trim(start));
+    EXPECT_EQ(2u, pool.Trim(*expiry + std::chrono::seconds(1)));
+    EXPECT_EQ(0u, pool.idle_count());
+    EXPECT_FALSE(pool.NextExpiry().has_value());
+  });
+
+  registry.Add("prewarm_pool/no_timeout_never_trims", []() {
+    ManualFactory factory;
+    PrewarmPool<int> pool(factory.Get());
+    pool.SetLimits(1, std::nullopt);
+    pool.Refill();
+    factory.CompleteAll();
+    EXPECT_EQ(0u, pool.Trim(PrewarmPool<int>::Clock::now() +
+                            std::chrono::hours(24)));
+    EXPECT_EQ(1u, pool.idle_count());
+  });
+}
+
+}  // namespace test
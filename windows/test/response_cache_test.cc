@@ -0,0 +1,351 @@
+#include "response_cache.h"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "cache_policy.h"
+#include "test.h"
+
+namespace test {
+
+namespace {
+typedef CachePolicy::Mode Mode;
+typedef CachePolicy::Request Request;
+typedef CachePolicy::Rule Rule;
+
+// "Sun, 06 Nov 1994 08:49:37 GMT".
+constexpr int64_t kNow = 784111777;
+constexpr char kDate[] = "Date: Sun, 06 Nov 1994 08:49:37 GMT";
+
+const Rule kHeadersRule = {"*", Mode::kHeaders, std::nullopt};
+
+std::optional<int64_t> GetExpiry(const std::string& headers,
+                                 const Rule& rule = kHeadersRule) {
+  return CachePolicy::GetExpiry(rule, {}, 200, headers, kNow);
+}
+
+// Returns an empty cache directory.
+std::filesystem::path MakeCacheDirectory() {
+  const auto directory = std::filesystem::temp_directory_path() /
+                         "webview_windows_response_cache_test";
+  std::filesystem::remove_all(directory);
+  return directory;
+}
+
+std::shared_ptr<ResponseCache> OpenCache(
+    const std::filesystem::path& directory) {
+  std::string error;
+  auto cache = ResponseCache::Open(directory, error);
+  EXPECT_TRUE(cache != nullptr);
+  return cache;
+}
+
+std::string Body(const std::shared_ptr<const ResponseCache::Entry>& entry) {
+  return entry ? entry->body : std::string("<none>");
+}
+}  // namespace
+
+void RegisterResponseCacheTests(Registry& registry) {
+  registry.Add("cache_policy/matches_pattern", []() {
+    EXPECT_TRUE(CachePolicy::MatchesPattern("*", ""));
+    EXPECT_TRUE(CachePolicy::MatchesPattern("https://a.test/*",
+                                            "https://a.test/x/y.js"));
+    EXPECT_TRUE(CachePolicy::MatchesPattern("*.js", "https://a.test/a.js"));
+    EXPECT_TRUE(CachePolicy::MatchesPattern("*/a?.js*", "x/ab.js?v=1"));
+    EXPECT_TRUE(CachePolicy::MatchesPattern("*a*a*b", "aaaab"));
+    EXPECT_FALSE(CachePolicy::MatchesPattern("*.js", "https://a.test/a.css"));
+    EXPECT_FALSE(CachePolicy::MatchesPattern("a?", "a"));
+    EXPECT_FALSE(CachePolicy::MatchesPattern("https://a.test/*",
+                                             "https://b.test/"));
+  });
+
+  registry.Add("cache_policy/match_first_rule", []() {
+    CachePolicy policy;
+    EXPECT_TRUE(policy.empty());
+    policy.SetRules({{"https://a.test/api/*", Mode::kNever, std::nullopt},
+                     {"https://a.test/*", Mode::kAlways, std::nullopt},
+                     {"*", Mode::kHeaders, std::nullopt}});
+    // A kNever rule excludes the URL from later rules.
+    EXPECT_TRUE(policy.Match("https://a.test/api/user") == nullptr);
+    const auto* rule = policy.Match("https://a.test/app.js");
+    EXPECT_TRUE(rule && rule->mode == Mode::kAlways);
+    rule = policy.Match("https://b.test/app.js");
+    EXPECT_TRUE(rule && rule->mode == Mode::kHeaders);
+
+    policy.SetRules({});
+    EXPECT_TRUE(policy.Match("https://a.test/app.js") == nullptr);
+  });
+
+  registry.Add("cache_policy/can_serve", []() {
+    const Rule always = {"*", Mode::kAlways, std::nullopt};
+    const Rule never = {"*", Mode::kNever, std::nullopt};
+    EXPECT_TRUE(CachePolicy::CanServe(kHeadersRule, {}));
+    EXPECT_FALSE(CachePolicy::CanServe(never, {}));
+
+    Request request;
+    request.method = "POST";
+    EXPECT_FALSE(CachePolicy::CanServe(always, request));
+    request = {};
+    request.range = "bytes=0-99";
+    EXPECT_FALSE(CachePolicy::CanServe(always, request));
+
+    // Only kHeaders rules honor the request headers.
+    std::vector<Request> bypassing(5);
+    bypassing[0].cache_control = "no-cache";
+    bypassing[1].cache_control = "no-store";
+    bypassing[2].cache_control = "max-age=0";
+    bypassing[3].pragma = "no-cache";
+    bypassing[4].authorization = "Bearer token";
+    for (const auto& bypassing_request : bypassing) {
+      EXPECT_FALSE(CachePolicy::CanServe(kHeadersRule, bypassing_request));
+      EXPECT_TRUE(CachePolicy::CanServe(always, bypassing_request));
+    }
+    request = {};
+    request.cache_control = "max-age=60";
+    EXPECT_TRUE(CachePolicy::CanServe(kHeadersRule, request));
+  });
+
+  registry.Add("cache_policy/expiry_from_headers", []() {
+    const std::string date = kDate;
+    EXPECT_EQ(std::optional<int64_t>(kNow + 60),
+              GetExpiry(date + "\r\nCache-Control: public, max-age=60"));
+    EXPECT_EQ(std::optional<int64_t>(kNow + 60),
+              GetExpiry(date + "\r\nCache-Control: max-age=\"60\""));
+    // Max age takes precedence over Expires.
+    EXPECT_EQ(std::optional<int64_t>(kNow + 60),
+              GetExpiry(date +
+                        "\r\nCache-Control: max-age=60"
+                        "\r\nExpires: Sun, 06 Nov 1994 09:49:37 GMT"));
+    EXPECT_EQ(std::optional<int64_t>(kNow + 3600),
+              GetExpiry(date + "\r\nExpires: Sun, 06 Nov 1994 09:49:37 GMT"));
+    EXPECT_EQ(std::nullopt, GetExpiry(date + "\r\nExpires: 0"));
+    // Age is subtracted from the lifetime.
+    EXPECT_EQ(std::optional<int64_t>(kNow + 40),
+              GetExpiry(date + "\r\nCache-Control: max-age=60\r\nAge: 20"));
+    EXPECT_EQ(std::nullopt,
+              GetExpiry(date + "\r\nCache-Control: max-age=60\r\nAge: 60"));
+    // So is the time since the Date.
+    EXPECT_EQ(std::optional<int64_t>(kNow + 50),
+              GetExpiry("Date: Sun, 06 Nov 1994 08:49:27 GMT\r\n"
+                        "Cache-Control: max-age=60"));
+  });
+
+  registry.Add("cache_policy/expiry_fallbacks", []() {
+    const std::string date = kDate;
+    // The rule's max age applies to responses that don't specify one.
+    const Rule rule = {"*", Mode::kHeaders, std::chrono::seconds(30)};
+    EXPECT_EQ(std::optional<int64_t>(kNow + 30), GetExpiry(date, rule));
+    EXPECT_EQ(std::optional<int64_t>(kNow + 60),
+              GetExpiry(date + "\r\nCache-Control: max-age=60", rule));
+
+    // Otherwise a tenth of the time since the last modification, at most a
+    // day.
+    EXPECT_EQ(std::nullopt, GetExpiry(date));
+    EXPECT_EQ(std::optional<int64_t>(kNow + 360),
+              GetExpiry(date +
+                        "\r\nLast-Modified: Sun, 06 Nov 1994 07:49:37 GMT"));
+    EXPECT_EQ(std::optional<int64_t>(kNow + 24 * 60 * 60),
+              GetExpiry(date +
+                        "\r\nLast-Modified: Sun, 06 Nov 1983 08:49:37 GMT"));
+
+    // kAlways rules ignore the headers.
+    const Rule always = {"*", Mode::kAlways, std::nullopt};
+    EXPECT_EQ(std::optional<int64_t>(kNow + 3600),
+              GetExpiry(date + "\r\nCache-Control: no-store", always));
+    const Rule always_short = {"*", Mode::kAlways, std::chrono::seconds(5)};
+    EXPECT_EQ(std::optional<int64_t>(kNow + 5), GetExpiry("", always_short));
+  });
+
+  registry.Add("cache_policy/not_stored", []() {
+    const std::string fresh =
+        std::string(kDate) + "\r\nCache-Control: max-age=60";
+    EXPECT_EQ(std::nullopt,
+              CachePolicy::GetExpiry(kHeadersRule, {}, 404, fresh, kNow));
+    EXPECT_EQ(std::nullopt,
+              CachePolicy::GetExpiry(kHeadersRule, {}, 206, fresh, kNow));
+    EXPECT_EQ(std::nullopt, GetExpiry("Cache-Control: no-store"));
+    EXPECT_EQ(std::nullopt, GetExpiry("Cache-Control: no-cache, max-age=60"));
+    EXPECT_EQ(std::nullopt,
+              GetExpiry("Cache-Control: no-cache=\"Set-Cookie\""));
+    EXPECT_EQ(std::nullopt,
+              GetExpiry("Pragma: no-cache\r\n"
+                        "Expires: Mon, 07 Nov 1994 08:49:37 GMT"));
+    // Cache-Control overrides Pragma.
+    EXPECT_EQ(std::optional<int64_t>(kNow + 60),
+              GetExpiry("Pragma: no-cache\r\nCache-Control: max-age=60"));
+    EXPECT_EQ(std::nullopt, GetExpiry(fresh + "\r\nVary: Cookie"));
+    EXPECT_EQ(std::optional<int64_t>(kNow + 60),
+              GetExpiry(fresh + "\r\nVary: accept-encoding"));
+  });
+
+  registry.Add("cache_policy/stored_headers", []() {
+    EXPECT_EQ(std::string("Content-Type: text/html\r\nETag: \"1\""),
+              CachePolicy::GetStoredHeaders(
+                  "Content-Type: text/html\r\nContent-Length: 10\r\n"
+                  "set-cookie: a=b\r\nTransfer-Encoding: chunked\r\n"
+                  "ETag: \"1\"\r\nContent-Encoding: gzip\r\nAge: 5"));
+    EXPECT_EQ(std::string(), CachePolicy::GetStoredHeaders(""));
+  });
+
+  registry.Add("response_cache/store_and_lookup", []() {
+    const auto cache = OpenCache(MakeCacheDirectory());
+    if (!cache) {
+      return;
+    }
+    EXPECT_TRUE(cache->Lookup("https://a.test/", 0) == nullptr);
+    EXPECT_TRUE(cache->Store({"https://a.test/", "ETag: 1", "body", 100}));
+    EXPECT_TRUE(cache->Contains("https://a.test/", 99));
+    const auto entry = cache->Lookup("https://a.test/", 99);
+    EXPECT_EQ(std::string("body"), Body(entry));
+    EXPECT_EQ(std::string("ETag: 1"), entry ? entry->headers : "");
+
+    // Expired entries are misses.
+    EXPECT_FALSE(cache->Contains("https://a.test/", 100));
+    EXPECT_TRUE(cache->Lookup("https://a.test/", 100) == nullptr);
+
+    // Entries are written to disk in the background.
+    cache->Flush();
+    const auto stats = cache->stats();
+    EXPECT_EQ(1u, stats.stores);
+    EXPECT_EQ(1u, stats.memory_hits);
+    EXPECT_EQ(2u, stats.misses);
+  });
+
+  registry.Add("response_cache/replace", []() {
+    const auto cache = OpenCache(MakeCacheDirectory());
+    if (!cache) {
+      return;
+    }
+    cache->Store({"https://a.test/", "", "old", 100});
+    cache->Store({"https://a.test/", "", "new", 200});
+    EXPECT_EQ(std::string("new"), Body(cache->Lookup("https://a.test/", 150)));
+  });
+
+  registry.Add("response_cache/reopen_reads_disk", []() {
+    const auto directory = MakeCacheDirectory();
+    {
+      const auto cache = OpenCache(directory);
+      if (!cache) {
+        return;
+      }
+      cache->Store({"https://a.test/a", "", "a", 100});
+      cache->Store({"https://a.test/b", "", "b", 100});
+    }
+
+    const auto cache = OpenCache(directory);
+    if (!cache) {
+      return;
+    }
+    EXPECT_TRUE(cache->stats().disk_bytes > 0);
+    // The entries on disk are indexed on open.
+    EXPECT_TRUE(cache->Contains("https://a.test/a", 99));
+    EXPECT_FALSE(cache->Contains("https://a.test/a", 100));
+    EXPECT_FALSE(cache->Contains("https://a.test/c", 0));
+    EXPECT_TRUE(cache->Lookup("https://a.test/c", 0) == nullptr);
+    EXPECT_EQ(std::string("a"), Body(cache->Lookup("https://a.test/a", 0)));
+    // Disk hits are kept in memory.
+    EXPECT_EQ(std::string("a"), Body(cache->Lookup("https://a.test/a", 0)));
+    const auto stats = cache->stats();
+    EXPECT_EQ(1u, stats.disk_hits);
+    EXPECT_EQ(1u, stats.memory_hits);
+
+    // Stale entries are removed from the disk when they are read.
+    const auto disk_bytes = stats.disk_bytes;
+    EXPECT_TRUE(cache->Lookup("https://a.test/b", 100) == nullptr);
+    cache->Flush();
+    EXPECT_TRUE(cache->stats().disk_bytes < disk_bytes);
+    EXPECT_FALSE(cache->Contains("https://a.test/b", 0));
+  });
+
+  registry.Add("response_cache/clear", []() {
+    const auto directory = MakeCacheDirectory();
+    const auto cache = OpenCache(directory);
+    if (!cache) {
+      return;
+    }
+    cache->Store({"https://a.test/", "", "body", 100});
+    cache->Flush();
+    cache->Store({"https://a.test/queued", "", "queued", 100});
+    cache->Clear();
+    EXPECT_FALSE(cache->Contains("https://a.test/", 0));
+    EXPECT_TRUE(cache->Lookup("https://a.test/queued", 0) == nullptr);
+    EXPECT_EQ(0u, cache->stats().memory_bytes);
+    cache->Flush();
+    EXPECT_EQ(0u, cache->stats().disk_bytes);
+    const auto reopened = OpenCache(directory);
+    EXPECT_TRUE(reopened &&
+                reopened->Lookup("https://a.test/", 0) == nullptr);
+  });
+
+  registry.Add("response_cache/limits", []() {
+    const auto cache = OpenCache(MakeCacheDirectory());
+    if (!cache) {
+      return;
+    }
+    cache->SetLimits({1 << 20, 8 << 10});
+    EXPECT_EQ(1024u, cache->max_body_size());
+    // Bodies over an eighth of the disk limit aren't stored.
+    EXPECT_FALSE(cache->Store({"https://a.test/large", "",
+                               std::string(1025, 'x'), 100}));
+    EXPECT_TRUE(cache->Store({"https://a.test/small", "",
+                              std::string(1024, 'x'), 100}));
+
+    // Nor are they kept in memory, but they are still served from disk.
+    cache->SetLimits({1 << 10, 1 << 20});
+    EXPECT_EQ(0u, cache->stats().memory_bytes);
+    EXPECT_TRUE(cache->Store({"https://a.test/medium", "",
+                              std::string(4096, 'x'), 100}));
+    EXPECT_EQ(0u, cache->stats().memory_bytes);
+    cache->Flush();
+    EXPECT_EQ(4096u, Body(cache->Lookup("https://a.test/medium", 0)).size());
+    EXPECT_EQ(1u, cache->stats().disk_hits);
+
+    // Trimming the disk drops the least recently used files.
+    cache->SetLimits({1 << 20, 1 << 10});
+    cache->Flush();
+    EXPECT_TRUE(cache->stats().disk_bytes <= 1 << 10);
+  });
+
+  registry.Add("response_cache/unwritten_entries", []() {
+    const auto cache = OpenCache(MakeCacheDirectory());
+    if (!cache) {
+      return;
+    }
+    // Entries too large for memory are served while they are written.
+    cache->SetLimits({1 << 10, 1 << 20});
+    for (int i = 0; i < 20; ++i) {
+      cache->Store({"https://a.test/" + std::to_string(i), "",
+                    std::string(4096, 'a' + i), 100});
+    }
+    size_t misses = 0;
+    for (int i = 0; i < 20; ++i) {
+      const auto url = "https://a.test/" + std::to_string(i);
+      misses += !cache->Contains(url, 0) ||
+                Body(cache->Lookup(url, 0)) != std::string(4096, 'a' + i);
+    }
+    EXPECT_EQ(0u, misses);
+    cache->Flush();
+    EXPECT_EQ(20u, cache->stats().stores);
+  });
+
+  registry.Add("response_cache/failed_writes", []() {
+    const auto directory = MakeCacheDirectory();
+    const auto cache = OpenCache(directory);
+    if (!cache) {
+      return;
+    }
+    // A file in place of the body directory makes writes fail.
+    std::filesystem::remove(directory / "bodies");
+    std::ofstream(directory / "bodies") << "";
+    cache->SetLimits({0, 1 << 20});
+    EXPECT_TRUE(cache->Store({"https://a.test/", "", "body", 100}));
+    cache->Flush();
+    EXPECT_FALSE(cache->Contains("https://a.test/", 0));
+    EXPECT_TRUE(cache->Lookup("https://a.test/", 0) == nullptr);
+    EXPECT_EQ(0u, cache->stats().stores);
+  });
+}
+
+}  // namespace test
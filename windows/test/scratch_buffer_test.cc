@@ -0,0 +1,100 @@
+#include "util/scratch_buffer.h"
+
+#include <cstddef>
+#include <string_view>
+
+#include "test.h"
+
+#if defined(_WIN32)
+#include "util/string_converter.h"
+#endif
+
+namespace test {
+
+namespace {
+typedef util::ScratchBuffer<char16_t> Buffer;
+
+// Acquires and releases |size| characters |count| times.
+void Use(Buffer& buffer, size_t size, size_t count = 1) {
+  for (size_t i = 0; i < count; ++i) {
+    buffer.Acquire(size);
+    buffer.Release();
+  }
+}
+}  // namespace
+
+void RegisterScratchBufferTests(Registry& registry) {
+  registry.Add("scratch_buffer/reuse", []() {
+    Buffer buffer;
+    EXPECT_EQ(0u, buffer.capacity());
+    const auto data = buffer.Acquire(10);
+    buffer.Release();
+    EXPECT_EQ(256u, buffer.capacity());
+    // Smaller and equal sizes reuse the storage.
+    EXPECT_TRUE(buffer.Acquire(256) == data);
+    buffer.Release();
+    EXPECT_TRUE(buffer.Acquire(1) == data);
+    buffer.Release();
+
+    // Larger ones grow it by doubling.
+    buffer.Acquire(1000);
+    EXPECT_EQ(1024u, buffer.capacity());
+    buffer.Release();
+    EXPECT_EQ(1000u, buffer.high_water_mark());
+  });
+
+  registry.Add("scratch_buffer/shrinks_when_mostly_unused", []() {
+    Buffer buffer;
+    Use(buffer, 100000);
+    EXPECT_EQ(131072u, buffer.capacity());
+    // The window that used the whole buffer keeps it.
+    Use(buffer, 10, Buffer::kShrinkWindow - 1);
+    EXPECT_EQ(131072u, buffer.capacity());
+    EXPECT_EQ(0u, buffer.high_water_mark());
+
+    // A window of small uses releases it.
+    Use(buffer, 10, Buffer::kShrinkWindow - 1);
+    EXPECT_EQ(131072u, buffer.capacity());
+    Use(buffer, 10);
+    EXPECT_EQ(0u, buffer.capacity());
+
+    // And the next use starts small again.
+    Use(buffer, 10);
+    EXPECT_EQ(256u, buffer.capacity());
+  });
+
+  registry.Add("scratch_buffer/keeps_used_capacity", []() {
+    Buffer buffer;
+    // Uses of a quarter of the capacity or more keep it.
+    Use(buffer, 40000);
+    Use(buffer, 16384, 2 * Buffer::kShrinkWindow);
+    EXPECT_EQ(65536u, buffer.capacity());
+
+    // Buffers up to the retained capacity are never released.
+    Buffer small;
+    Use(small, Buffer::kRetainedCapacity);
+    Use(small, 1, 2 * Buffer::kShrinkWindow);
+    EXPECT_EQ(Buffer::kRetainedCapacity, small.capacity());
+  });
+
+#if defined(_WIN32)
+  registry.Add("scratch_utf16/conversions", []() {
+    const util::ScratchUtf16 converted("caf\xc3\xa9");
+    EXPECT_TRUE(converted.view() == std::wstring_view(L"caf\u00e9"));
+    EXPECT_EQ(L'\0', converted.c_str()[4]);
+    // Invalid input converts to an empty string.
+    const util::ScratchUtf16 invalid("\xc3");
+    EXPECT_TRUE(invalid.view().empty() && invalid.c_str()[0] == L'\0');
+  });
+
+  registry.Add("scratch_utf16/nesting", []() {
+    // Instances beyond the thread's buffers fall back to allocating, and
+    // each keeps its own result.
+    const util::ScratchUtf16 a("a"), b("b"), c("c"), d("d"), e("e"), f("f");
+    EXPECT_TRUE(a.view() == L"a" && b.view() == L"b" && c.view() == L"c" &&
+                d.view() == L"d" && e.view() == L"e" && f.view() == L"f");
+  });
+#endif
+}
+
+}  // namespace test
@@ -0,0 +1,101 @@
+#include "suspend_policy.h"
+
+#include <chrono>
+#include <vector>
+
+#include "test.h"
+
+namespace test {
+
+namespace {
+typedef SuspendPolicy::Clock Clock;
+typedef std::vector<SuspendPolicy::InstanceId> Instances;
+
+// A clock that only advances when told to.
+struct FakeClock {
+  Clock::time_point now;
+
+  Clock::time_point Advance() {
+    now += std::chrono::seconds(1);
+    return now;
+  }
+};
+}  // namespace
+
+void RegisterSuspendPolicyTests(Registry& registry) {
+  registry.Add("suspend_policy/no_budget", []() {
+    FakeClock clock;
+    SuspendPolicy policy;
+    for (SuspendPolicy::InstanceId id = 1; id <= 5; ++id) {
+      policy.Add(id, clock.Advance());
+    }
+    EXPECT_TRUE(policy.Evaluate(1ull << 40).empty());
+    EXPECT_EQ(5u, policy.active_count());
+  });
+
+  registry.Add("suspend_policy/max_active_suspends_coldest", []() {
+    FakeClock clock;
+    SuspendPolicy policy;
+    for (SuspendPolicy::InstanceId id = 1; id <= 4; ++id) {
+      policy.Add(id, clock.Advance());
+    }
+    // 1 was added first but used last.
+    policy.Touch(1, clock.Advance());
+    policy.SetBudget({2, std::nullopt});
+
+    EXPECT_TRUE(policy.Evaluate(std::nullopt) == Instances({2, 3}));
+    EXPECT_TRUE(policy.IsSuspended(2));
+    EXPECT_TRUE(policy.IsSuspended(3));
+    EXPECT_FALSE(policy.IsSuspended(1));
+    EXPECT_EQ(2u, policy.active_count());
+    // Within budget now.
+    EXPECT_TRUE(policy.Evaluate(std::nullopt).empty());
+  });
+
+  registry.Add("suspend_policy/touch_resumes", []() {
+    FakeClock clock;
+    SuspendPolicy policy;
+    policy.Add(1, clock.Advance());
+    policy.Add(2, clock.Advance());
+    policy.SetBudget({1, std::nullopt});
+    EXPECT_TRUE(policy.Evaluate(std::nullopt) == Instances({1}));
+
+    EXPECT_TRUE(policy.Touch(1, clock.Advance()));
+    EXPECT_FALSE(policy.Touch(1, clock.Advance()));
+    EXPECT_FALSE(policy.Touch(42, clock.Advance()));
+    // 2 is the coldest now.
+    EXPECT_TRUE(policy.Evaluate(std::nullopt) == Instances({2}));
+  });
+
+  registry.Add("suspend_policy/memory_budget_one_per_call", []() {
+    FakeClock clock;
+    SuspendPolicy policy;
+    for (SuspendPolicy::InstanceId id = 1; id <= 3; ++id) {
+      policy.Add(id, clock.Advance());
+    }
+    policy.SetBudget({std::nullopt, 1000});
+
+    EXPECT_TRUE(policy.Evaluate(std::nullopt).empty());
+    EXPECT_TRUE(policy.Evaluate(1000).empty());
+    EXPECT_TRUE(policy.Evaluate(1001) == Instances({1}));
+    EXPECT_TRUE(policy.Evaluate(1001) == Instances({2}));
+    // The most recently used instance is never suspended.
+    EXPECT_TRUE(policy.Evaluate(1001).empty());
+    EXPECT_EQ(1u, policy.active_count());
+    EXPECT_FALSE(policy.IsSuspended(3));
+  });
+
+  registry.Add("suspend_policy/remove", []() {
+    FakeClock clock;
+    SuspendPolicy policy;
+    policy.Add(1, clock.Advance());
+    policy.Add(2, clock.Advance());
+    policy.SetBudget({1, std::nullopt});
+    policy.Remove(1);
+    EXPECT_EQ(1u, policy.size());
+    EXPECT_TRUE(policy.Evaluate(std::nullopt).empty());
+    EXPECT_FALSE(policy.IsSuspended(1));
+  });
+}
+
+}  // namespace test
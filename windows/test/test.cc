@@ -0,0 +1,38 @@
+#include "test.h"
+
+#include <cstdio>
+
+namespace test {
+
+namespace {
+int failed_checks = 0;
+}  // namespace
+
+void Check(bool passed, const char* expression, const char* file, int line) {
+  if (!passed) {
+    ++failed_checks;
+    std::printf("  %s:%d: expected %s\n", file, line, expression);
+  }
+}
+
+int Run(const Registry& registry, const std::string& filter) {
+  int failed = 0;
+  int run = 0;
+  for (const auto& test : registry.tests()) {
+    if (test.name.find(filter) == std::string::npos) {
+      continue;
+    }
+    ++run;
+    failed_checks = 0;
+    test.function();
+    std::printf("[%s] %s\n", failed_checks == 0 ? "  OK  " : "FAILED",
+                test.name.c_str());
+    if (failed_checks != 0) {
+      ++failed;
+    }
+  }
+  std::printf("%d of %d tests passed.\n", run - failed, run);
+  return failed;
+}
+
+}  // namespace test
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace test {
+
+// Fails the running test, but lets it continue, if |condition| is false.
+#define EXPECT_TRUE(condition) \
+  ::test::Check(static_cast<bool>(condition), #condition, __FILE__, __LINE__)
+#define EXPECT_FALSE(condition) \
+  ::test::Check(!(condition), "!(" #condition ")", __FILE__, __LINE__)
+#define EXPECT_EQ(expected, actual)                                    \
+  ::test::Check((expected) == (actual), #expected " == " #actual, __FILE__, \
+                __LINE__)
+
+typedef std::function<void()> TestFunction;
+
+struct Test {
+  std::string name;
+  TestFunction function;
+};
+
+class Registry {
+ public:
+  void Add(std::string name, TestFunction function) {
+    tests_.push_back({std::move(name), std::move(function)});
+  }
+
+  const std::vector<Test>& tests() const { return tests_; }
+
+ private:
+  std::vector<Test> tests_;
+};
+
+// Records a failure of the running test if |passed| is false.
+void Check(bool passed, const char* expression, const char* file, int line);
+
+// Runs the tests whose name contains |filter|. Returns the number of tests
+// that failed.
+int Run(const Registry& registry, const std::string& filter);
+
+// Test suites.
+void RegisterLastValueCacheTests(Registry& registry);
+void RegisterPermissionCacheTests(Registry& registry);
+void RegisterPrewarmPoolTests(Registry& registry);
+void RegisterAsyncResourceTests(Registry& registry);
+void RegisterEnvironmentRegistryTests(Registry& registry);
+void RegisterFrameSchedulerTests(Registry& registry);
+void RegisterSuspendPolicyTests(Registry& registry);
+void RegisterFactoryCacheTests(Registry& registry);
+void RegisterTraceTests(Registry& registry);
+void RegisterFlightRecorderTests(Registry& registry);
+void RegisterDisposeQueueTests(Registry& registry);
+void RegisterEventSubscriptionsTests(Registry& registry);
+void RegisterAssetArchiveTests(Registry& registry);
+void RegisterResponseCacheTests(Registry& registry);
+void RegisterUrlFilterTests(Registry& registry);
+void RegisterDevToolsSubscriptionsTests(Registry& registry);
+void RegisterPerformanceSamplerTests(Registry& registry);
+void RegisterPointerPredictorTests(Registry& registry);
+void RegisterKeyedObjectPoolTests(Registry& registry);
+void RegisterUtfTranscoderTests(Registry& registry);
+void RegisterScratchBufferTests(Registry& registry);
+void RegisterJsonDecoderTests(Registry& registry);
+void RegisterMethodCallLogTests(Registry& registry);
+
+}  // namespace test
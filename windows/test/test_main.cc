@@ -0,0 +1,45 @@
+#include <cstdio>
+#include <string>
+#include <string_view>
+
+#include "test.h"
+
+int main(int argc, char** argv) {
+  std::string filter;
+  for (int i = 1; i < argc; ++i) {
+    const std::string_view arg = argv[i];
+    if (arg.substr(0, 9) == "--filter=") {
+      filter = std::string(arg.substr(9));
+    } else {
+      std::fprintf(stderr,
+                   "Usage: webview_windows_tests [--filter=<text>]\n");
+      return 2;
+    }
+  }
+
+  test::Registry registry;
+  test::RegisterLastValueCacheTests(registry);
+  test::RegisterPermissionCacheTests(registry);
+  test::RegisterPrewarmPoolTests(registry);
+  test::RegisterAsyncResourceTests(registry);
+  test::RegisterEnvironmentRegistryTests(registry);
+  test::RegisterFrameSchedulerTests(registry);
+  test::RegisterSuspendPolicyTests(registry);
+  test::RegisterFactoryCacheTests(registry);
+  test::RegisterTraceTests(registry);
+  test::RegisterFlightRecorderTests(registry);
+  test::RegisterDisposeQueueTests(registry);
+  test::RegisterEventSubscriptionsTests(registry);
+  test::RegisterAssetArchiveTests(registry);
+  test::RegisterResponseCacheTests(registry);
+  test::RegisterUrlFilterTests(registry);
+  test::RegisterDevToolsSubscriptionsTests(registry);
+  test::RegisterPerformanceSamplerTests(registry);
+  test::RegisterPointerPredictorTests(registry);
+  test::RegisterKeyedObjectPoolTests(registry);
+  test::RegisterUtfTranscoderTests(registry);
+  test::RegisterScratchBufferTests(registry);
+  test::RegisterJsonDecoderTests(registry);
+  test::RegisterMethodCallLogTests(registry);
+  return test::Run(registry, filter) == 0 ? 0 : 1;
+}
@@ -0,0 +1,100 @@
+#include "util/trace.h"
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "test.h"
+
+namespace test {
+
+namespace {
+// Returns the exported spans named |name| as (ts, dur) pairs.
+std::vector<std::pair<double, double>> FindSpans(const std::string& trace,
+                                                 const std::string& name) {
+  std::vector<std::pair<double, double>> spans;
+  const auto prefix = "{\"name\":\"" + name + "\",\"ph\":\"X\",\"ts\":";
+  for (auto pos = trace.find(prefix); pos != std::string::npos;
+       pos = trace.find(prefix, pos + 1)) {
+    char* end = nullptr;
+    const auto ts = std::strtod(trace.c_str() + pos + prefix.size(), &end);
+    const auto dur_pos = trace.find("\"dur\":", pos) + 6;
+    const auto dur = std::strtod(trace.c_str() + dur_pos, &end);
+    spans.emplace_back(ts, dur);
+  }
+  return spans;
+}
+
+// Records spans whose start and duration are derived from the same value,
+// so that torn reads show up as mismatches.
+void RecordNumberedSpan(const char* name, int64_t value) {
+  const auto start =
+      util::TraceClock::time_point(std::chrono::microseconds(value));
+  util::RecordTraceSpan(name, start, start + std::chrono::nanoseconds(value));
+}
+}  // namespace
+
+void RegisterTraceTests(Registry& registry) {
+  registry.Add("trace/export", []() {
+    RecordNumberedSpan("trace_test/export", 1500);
+    const auto spans =
+        FindSpans(util::ExportChromeTrace(1), "trace_test/export");
+    EXPECT_EQ(1u, spans.size());
+    EXPECT_TRUE(!spans.empty() && spans[0].first == 1500.0 &&
+                spans[0].second == 1.5);
+  });
+
+  registry.Add("trace/exited_threads_are_pruned", []() {
+    const auto count_exported = []() {
+      return FindSpans(util::ExportChromeTrace(1), "trace_test/exited").size();
+    };
+    std::thread([]() { RecordNumberedSpan("trace_test/exited", 1); }).join();
+    EXPECT_EQ(1u, count_exported());
+    // The ring of the exited thread is dropped once exported.
+    EXPECT_EQ(0u, count_exported());
+  });
+
+  registry.Add("trace/export_while_recording", []() {
+    constexpr int kWriters = 4;
+    std::atomic<bool> stop = false;
+    std::atomic<int> started = 0;
+    std::vector<std::thread> writers;
+    for (int i = 0; i < kWriters; ++i) {
+      writers.emplace_back([&stop, &started]() {
+        RecordNumberedSpan("trace_test/concurrent", 1);
+        ++started;
+        for (int64_t value = 2; !stop; value = value % 100000 + 1) {
+          RecordNumberedSpan("trace_test/concurrent", value);
+        }
+      });
+    }
+    while (started < kWriters) {
+      std::this_thread::yield();
+    }
+
+    size_t torn = 0;
+    size_t exported = 0;
+    for (int i = 0; i < 50; ++i) {
+      for (const auto& [ts, dur] : FindSpans(util::ExportChromeTrace(1),
+                                             "trace_test/concurrent")) {
+        ++exported;
+        if (std::llround(ts) != std::llround(dur * 1000.0)) {
+          ++torn;
+        }
+      }
+    }
+    stop = true;
+    for (auto& writer : writers) {
+      writer.join();
+    }
+
+    EXPECT_TRUE(exported > 0);
+    EXPECT_EQ(0u, torn);
+  });
+}
+
+}  // namespace test
@@ -0,0 +1,186 @@
+#include "util/utf_transcoder.h"
+
+#include <cstdint>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "test.h"
+
+namespace test {
+
+namespace {
+std::optional<std::u16string> ToUtf16(std::string_view input) {
+  std::u16string output(util::MaxUtf16LengthForUtf8(input.size()), u'\0');
+  const auto length = util::TranscodeUtf8ToUtf16(input, output.data());
+  if (!length) {
+    return std::nullopt;
+  }
+  output.resize(*length);
+  return output;
+}
+
+std::optional<std::string> ToUtf8(std::u16string_view input) {
+  std::string output(util::MaxUtf8LengthForUtf16(input.size()), '\0');
+  const auto length = util::TranscodeUtf16ToUtf8(input, output.data());
+  if (!length) {
+    return std::nullopt;
+  }
+  output.resize(*length);
+  return output;
+}
+
+// Straightforward encoders of single code points to compare with.
+void AppendUtf8(uint32_t code_point, std::string& output) {
+  if (code_point < 0x80) {
+    output += static_cast<char>(code_point);
+  } else if (code_point < 0x800) {
+    output += static_cast<char>(0xc0 | code_point >> 6);
+    output += static_cast<char>(0x80 | (code_point & 0x3f));
+  } else if (code_point < 0x10000) {
+    output += static_cast<char>(0xe0 | code_point >> 12);
+    output += static_cast<char>(0x80 | (code_point >> 6 & 0x3f));
+    output += static_cast<char>(0x80 | (code_point & 0x3f));
+  } else {
+    output += static_cast<char>(0xf0 | code_point >> 18);
+    output += static_cast<char>(0x80 | (code_point >> 12 & 0x3f));
+    output += static_cast<char>(0x80 | (code_point >> 6 & 0x3f));
+    output += static_cast<char>(0x80 | (code_point & 0x3f));
+  }
+}
+
+void AppendUtf16(uint32_t code_point, std::u16string& output) {
+  if (code_point < 0x10000) {
+    output += static_cast<char16_t>(code_point);
+  } else {
+    output += static_cast<char16_t>(0xd800 | (code_point - 0x10000) >> 10);
+    output += static_cast<char16_t>(0xdc00 | (code_point & 0x3ff));
+  }
+}
+
+// Text with both encodings of the same code points.
+struct Text {
+  std::string utf8;
+  std::u16string utf16;
+
+  Text& Append(uint32_t code_point) {
+    AppendUtf8(code_point, utf8);
+    AppendUtf16(code_point, utf16);
+    return *this;
+  }
+
+  // Appends |length| ASCII letters.
+  Text& AppendAscii(size_t length) {
+    for (size_t i = 0; i < length; ++i) {
+      Append('a' + i % 26);
+    }
+    return *this;
+  }
+};
+
+// Whether |text| converts to each of its encodings from the other.
+bool Converts(const Text& text) {
+  return ToUtf16(text.utf8) == text.utf16 && ToUtf8(text.utf16) == text.utf8;
+}
+
+// Non-ASCII code points of each encoded length.
+constexpr uint32_t kNonAscii[] = {0xe9, 0x20ac, 0x1f600};
+
+// Lengths of ASCII runs at, and on either side of, the block sizes of the
+// scalar, SSE2, NEON and AVX2 kernels and pairs of their blocks.
+constexpr size_t kRunLengths[] = {0,  1,  7,  8,  9,  15, 16, 17,
+                                  31, 32, 33, 63, 64, 65, 95};
+}  // namespace
+
+void RegisterUtfTranscoderTests(Registry& registry) {
+  registry.Add("utf_transcoder/code_point_boundaries", []() {
+    for (const uint32_t code_point :
+         {0x0u, 0x7fu, 0x80u, 0x7ffu, 0x800u, 0xd7ffu, 0xe000u, 0xfffdu,
+          0xffffu, 0x10000u, 0x10ffffu}) {
+      Text text;
+      text.Append(code_point);
+      EXPECT_TRUE(Converts(text));
+    }
+    EXPECT_TRUE(Converts(Text()));
+  });
+
+  registry.Add("utf_transcoder/invalid_utf8", []() {
+    const std::string_view invalid[] = {
+        // Overlong encodings.
+        "\xc0\x80", "\xc1\xbf", "\xe0\x80\xaf", "\xe0\x9f\xbf",
+        "\xf0\x80\x80\xaf", "\xf0\x8f\xbf\xbf",
+        // Encoded surrogates.
+        "\xed\xa0\x80", "\xed\xbf\xbf", "\xed\xa0\xbd\xed\xb8\x80",
+        // Code points above U+10FFFF.
+        "\xf4\x90\x80\x80", "\xf5\x80\x80\x80", "\xf7\xbf\xbf\xbf",
+        "\xf8\x88\x80\x80\x80", "\xff",
+        // Truncated sequences.
+        "\xc3", "\xe2\x82", "\xf0\x9f\x98", "\xe2\x82" "a", "\xf0\x9f" "ab",
+        // Stray and missing continuation bytes.
+        "\x80", "\xbf", "\xc3\x28", "\xe2\x28\xac", "\xe2\x82\x28",
+        "\xf0\x9f\x28\x80", "\xf0\x9f\x98\x28"};
+    // Each on its own, and after and before ASCII runs that fill blocks.
+    const std::string ascii(40, 'a');
+    for (const auto sequence : invalid) {
+      const std::string text(sequence);
+      EXPECT_EQ(std::nullopt, ToUtf16(text));
+      EXPECT_EQ(std::nullopt, ToUtf16(ascii + text));
+      EXPECT_EQ(std::nullopt, ToUtf16(ascii + text + ascii));
+    }
+  });
+
+  registry.Add("utf_transcoder/unpaired_surrogates", []() {
+    const std::u16string invalid[] = {
+        {char16_t(0xd800)},
+        {char16_t(0xdbff), u'a'},
+        {char16_t(0xdc00)},
+        {char16_t(0xdfff), char16_t(0xd800)},
+        {char16_t(0xd83d), char16_t(0xd83d), char16_t(0xde00)},
+        {u'a', char16_t(0xd83d), char16_t(0xe000)}};
+    const std::u16string ascii(40, u'a');
+    for (const auto& text : invalid) {
+      EXPECT_EQ(std::nullopt, ToUtf8(text));
+      EXPECT_EQ(std::nullopt, ToUtf8(ascii + text));
+      EXPECT_EQ(std::nullopt, ToUtf8(ascii + text + ascii));
+    }
+  });
+
+  registry.Add("utf_transcoder/ascii_block_boundaries", []() {
+    for (const auto length : kRunLengths) {
+      // Runs that end the input.
+      EXPECT_TRUE(Converts(Text().AppendAscii(length)));
+      // Runs that end at non-ASCII characters, followed by another run.
+      for (const auto code_point : kNonAscii) {
+        EXPECT_TRUE(Converts(
+            Text().AppendAscii(length).Append(code_point).AppendAscii(40)));
+      }
+      // Runs that end at invalid input.
+      std::string utf8 = Text().AppendAscii(length).utf8;
+      EXPECT_EQ(std::nullopt, ToUtf16(utf8 + "\x80" + utf8));
+      std::u16string utf16 = Text().AppendAscii(length).utf16;
+      EXPECT_EQ(std::nullopt, ToUtf8(utf16 + char16_t(0xdc00) + utf16));
+    }
+  });
+
+  registry.Add("utf_transcoder/mixed_round_trips", []() {
+    // Non-ASCII characters scattered through long ASCII runs, so that each
+    // lands at many positions within the blocks.
+    std::mt19937 random(7);
+    size_t mismatches = 0;
+    for (int round = 0; round < 200; ++round) {
+      Text text;
+      while (text.utf8.size() < 300) {
+        text.AppendAscii(random() % 70);
+        for (auto count = random() % 3; count > 0; --count) {
+          text.Append(kNonAscii[random() % 3]);
+        }
+      }
+      mismatches += !Converts(text);
+    }
+    EXPECT_EQ(0u, mismatches);
+  });
+}
+
+}  // namespace test
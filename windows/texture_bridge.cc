@@ -1,87 +1,36 @@
 #include "texture_bridge.h"
 
-#include <windows.foundation.h>
-
 #include <algorithm>
 #include <atomic>
 #include <cassert>
-#include <iostream>
-
-#include "util/direct3d11.interop.h"
-
-namespace {
-const int kNumBuffers = 1;
-}  // namespace
 
 TextureBridge::TextureBridge(GraphicsContext* graphics_context,
                              ABI::Windows::UI::Composition::IVisual* visual)
-    : graphics_context_(graphics_context) {
-  capture_item_ =
-      graphics_context_->CreateGraphicsCaptureItemFromVisual(visual);
-  assert(capture_item_);
-
-  capture_item_->add_Closed(
-      Microsoft::WRL::Callback<ABI::Windows::Foundation::ITypedEventHandler<
-          ABI::Windows::Graphics::Capture::GraphicsCaptureItem*,
-          IInspectable*>>(
-          [](ABI::Windows::Graphics::Capture::IGraphicsCaptureItem* item,
-             IInspectable* args) -> HRESULT {
-            std::cerr << "Capture item was closed." << std::endl;
-            return S_OK;
-          })
-          .Get(),
-      &on_closed_token_);
+    : TextureBridge(graphics_context, std::make_unique<CaptureFrameSource>(
+                                          graphics_context, visual)) {}
+
+TextureBridge::TextureBridge(GraphicsContext* graphics_context,
+                             std::unique_ptr<TextureFrameSource> frame_source)
+    : graphics_context_(graphics_context),
+      frame_source_(std::move(frame_source)) {
+  assert(frame_source_);
 }
 
 TextureBridge::~TextureBridge() {
   const std::lock_guard<std::mutex> lock(mutex_);
   StopInternal();
-  if (capture_item_) {
-    capture_item_->remove_Closed(on_closed_token_);
-  }
 }
 
 bool TextureBridge::Start() {
   const std::lock_guard<std::mutex> lock(mutex_);
-  if (is_running_ || !capture_item_) {
-    return false;
-  }
-
-  ABI::Windows::Graphics::SizeInt32 size;
-  capture_item_->get_Size(&size);
-
-  frame_pool_ = graphics_context_->CreateCaptureFramePool(
-      graphics_context_->device(),
-      static_cast<ABI::Windows::Graphics::DirectX::DirectXPixelFormat>(
-          kPixelFormat),
-      kNumBuffers, size);
-  assert(frame_pool_);
-
-  frame_pool_->add_FrameArrived(
-      Microsoft::WRL::Callback<ABI::Windows::Foundation::ITypedEventHandler<
-          ABI::Windows::Graphics::Capture::Direct3D11CaptureFramePool*,
-          IInspectable*>>(
-          [this](ABI::Windows::Graphics::Capture::IDirect3D11CaptureFramePool*
-                     pool,
-                 IInspectable* args) -> HRESULT {
-            OnFrameArrived();
-            return S_OK;
-          })
-          .Get(),
-      &on_frame_arrived_token_);
-
-  if (FAILED(frame_pool_->CreateCaptureSession(capture_item_.get(),
-                                               capture_session_.put()))) {
-    std::cerr << "Creating capture session failed." << std::endl;
+  if (is_running_ || !frame_source_->Start([this]() { OnFrameArrived(); })) {
     return false;
   }
 
-  if (SUCCEEDED(capture_session_->StartCapture())) {
-    is_running_ = true;
-    return true;
-  }
-
-  return false;
+  is_running_ = true;
+  started_at_ = util::TraceClock::now();
+  first_frame_traced_ = first_surface_traced_ = false;
+  return true;
 }
 
 void TextureBridge::Stop() {
@@ -92,13 +41,9 @@ void TextureBridge::Stop() {
 void TextureBridge::StopInternal() {
   if (is_running_) {
     is_running_ = false;
-    frame_pool_->remove_FrameArrived(on_frame_arrived_token_);
-    auto closable =
-        capture_session_.try_as<ABI::Windows::Foundation::IClosable>();
-    assert(closable);
-    closable->Close();
-    capture_session_ = nullptr;
+    frame_source_->Stop();
   }
+  frame_pacer_.DiscardDeferredFrame();
 }
 
 void TextureBridge::OnFrameArrived() {
@@ -109,29 +54,31 @@ void TextureBridge::OnFrameArrived() {
 
   bool has_frame = false;
 
-  winrt::com_ptr<ABI::Windows::Graphics::Capture::IDirect3D11CaptureFrame>
-      frame;
-  auto hr = frame_pool_->TryGetNextFrame(frame.put());
-  if (SUCCEEDED(hr) && frame) {
-    winrt::com_ptr<
-        ABI::Windows::Graphics::DirectX::Direct3D11::IDirect3DSurface>
-        frame_surface;
-
-    if (SUCCEEDED(frame->get_Surface(frame_surface.put()))) {
-      last_frame_ =
-          util::TryGetDXGIInterfaceFromObject<ID3D11Texture2D>(frame_surface);
-      has_frame = !ShouldDropFrame();
+  if (auto frame = frame_source_->TryGetNextFrame()) {
+    last_frame_ = std::move(*frame);
+    util::RecordFlightEvent(instance_id_, util::FlightEventType::kFrameArrived);
+
+    D3D11_TEXTURE2D_DESC desc;
+    last_frame_->GetDesc(&desc);
+    // 4 bytes per pixel, see kPixelFormat.
+    const auto bytes = static_cast<size_t>(desc.Width) * desc.Height * 4;
+    const auto decision =
+        frame_pacer_.OnFrameArrived(bytes, FramePacer::Clock::now());
+    if (decision == FramePacer::Decision::kPublish) {
+      has_frame = true;
+    } else {
+      util::RecordFlightEvent(instance_id_,
+                              util::FlightEventType::kFrameDropped,
+                              static_cast<uint64_t>(decision));
+    }
+    if (!first_frame_traced_) {
+      first_frame_traced_ = true;
+      util::RecordTraceSpan("TextureBridge::FirstFrameArrived", started_at_);
     }
   }
 
   if (needs_update_) {
-    ABI::Windows::Graphics::SizeInt32 size;
-    capture_item_->get_Size(&size);
-    frame_pool_->Recreate(
-        graphics_context_->device(),
-        static_cast<ABI::Windows::Graphics::DirectX::DirectXPixelFormat>(
-            kPixelFormat),
-        kNumBuffers, size);
+    frame_source_->Recreate();
     needs_update_ = false;
   }
 
@@ -140,23 +87,35 @@ void TextureBridge::OnFrameArrived() {
   }
 }
 
-bool TextureBridge::ShouldDropFrame() {
-  if (!frame_duration_.has_value()) {
+void TextureBridge::SetFrameScheduler(FrameScheduler* frame_scheduler) {
+  const std::lock_guard<std::mutex> lock(mutex_);
+  frame_pacer_.SetFrameScheduler(frame_scheduler);
+}
+
+void TextureBridge::SetFrameSchedulingHints(
+    const FrameScheduler::Hints& hints) {
+  const std::lock_guard<std::mutex> lock(mutex_);
+  frame_pacer_.SetFrameSchedulingHints(hints);
+}
+
+bool TextureBridge::PublishDeferredFrame() {
+  const std::lock_guard<std::mutex> lock(mutex_);
+  if (!is_running_ || !last_frame_) {
+    frame_pacer_.DiscardDeferredFrame();
     return false;
   }
-  auto now = std::chrono::high_resolution_clock::now();
-
-  bool should_drop_frame = false;
-  if (last_frame_timestamp_.has_value()) {
-    auto diff = std::chrono::duration_cast<std::chrono::milliseconds>(
-        now - last_frame_timestamp_.value());
-    should_drop_frame = diff < frame_duration_.value();
+  if (!frame_pacer_.PublishDeferredFrame(FramePacer::Clock::now())) {
+    return false;
   }
-
-  if (!should_drop_frame) {
-    last_frame_timestamp_ = now;
+  if (frame_available_) {
+    frame_available_();
   }
-  return should_drop_frame;
+  return true;
+}
+
+FramePacer::FrameCounts TextureBridge::TakeFrameCounts() {
+  const std::lock_guard<std::mutex> lock(mutex_);
+  return frame_pacer_.TakeFrameCounts();
 }
 
 void TextureBridge::NotifySurfaceSizeChanged() {
@@ -166,11 +125,5 @@ void TextureBridge::NotifySurfaceSizeChanged() {
 
 void TextureBridge::SetFpsLimit(std::optional<int> max_fps) {
   const std::lock_guard<std::mutex> lock(mutex_);
-  auto value = max_fps.value_or(0);
-  if (value != 0) {
-    frame_duration_ = FrameDuration(1000.0 / value);
-  } else {
-    frame_duration_.reset();
-    last_frame_timestamp_.reset();
-  }
+  frame_pacer_.SetFpsLimit(max_fps);
 }
@@ -6,24 +6,28 @@
 #include <chrono>
 #include <cstdint>
 #include <functional>
+#include <memory>
 #include <mutex>
 #include <optional>
 
+#include "capture_frame_source.h"
+#include "frame_pacer.h"
+#include "frame_scheduler.h"
+#include "frame_source.h"
 #include "graphics_context.h"
-
-typedef struct {
-  size_t width;
-  size_t height;
-} Size;
+#include "util/flight_recorder.h"
+#include "util/trace.h"
 
 class TextureBridge {
  public:
   typedef std::function<void()> FrameAvailableCallback;
   typedef std::function<void(Size size)> SurfaceSizeChangedCallback;
-  typedef std::chrono::duration<double, std::milli> FrameDuration;
+  typedef FrameSource<winrt::com_ptr<ID3D11Texture2D>> TextureFrameSource;
 
   TextureBridge(GraphicsContext* graphics_context,
                 ABI::Windows::UI::Composition::IVisual* visual);
+  TextureBridge(GraphicsContext* graphics_context,
+                std::unique_ptr<TextureFrameSource> frame_source);
   virtual ~TextureBridge();
 
   bool Start();
@@ -40,35 +44,44 @@ class TextureBridge {
   void NotifySurfaceSizeChanged();
   void SetFpsLimit(std::optional<int> max_fps);
 
+  // Registers this bridge with a plugin-wide scheduler that decides when
+  // frames may be published.
+  void SetFrameScheduler(FrameScheduler* frame_scheduler);
+  void SetFrameSchedulingHints(const FrameScheduler::Hints& hints);
+
+  // Publishes the last frame if the scheduler deferred it and now allows
+  // it. Returns whether it was published.
+  bool PublishDeferredFrame();
+
+  // Returns the frames that arrived since the previous call.
+  FramePacer::FrameCounts TakeFrameCounts();
+
+  // Identifies this bridge's records in the flight recorder.
+  void SetInstanceId(uint32_t instance_id) { instance_id_ = instance_id; }
+
  protected:
   bool is_running_ = false;
 
   const GraphicsContext* graphics_context_;
   std::mutex mutex_;
-  std::optional<FrameDuration> frame_duration_ = std::nullopt;
+  FramePacer frame_pacer_;
 
   FrameAvailableCallback frame_available_;
   SurfaceSizeChangedCallback surface_size_changed_;
   std::atomic<bool> needs_update_ = false;
   winrt::com_ptr<ID3D11Texture2D> last_frame_;
-  std::optional<std::chrono::high_resolution_clock::time_point>
-      last_frame_timestamp_;
 
-  winrt::com_ptr<ABI::Windows::Graphics::Capture::IGraphicsCaptureItem>
-      capture_item_;
-  winrt::com_ptr<ABI::Windows::Graphics::Capture::IDirect3D11CaptureFramePool>
-      frame_pool_;
-  winrt::com_ptr<ABI::Windows::Graphics::Capture::IGraphicsCaptureSession>
-      capture_session_;
+  std::atomic<uint32_t> instance_id_ = 0;
+
+  // Used to trace the time from starting the capture to the first frame.
+  util::TraceClock::time_point started_at_;
+  bool first_frame_traced_ = true;
+  bool first_surface_traced_ = true;
 
-  EventRegistrationToken on_closed_token_ = {};
-  EventRegistrationToken on_frame_arrived_token_ = {};
+  std::unique_ptr<TextureFrameSource> frame_source_;
 
   virtual void StopInternal();
   void OnFrameArrived();
-  bool ShouldDropFrame();
 
-  // corresponds to DXGI_FORMAT_B8G8R8A8_UNORM
-  static constexpr auto kPixelFormat = ABI::Windows::Graphics::DirectX::
-      DirectXPixelFormat::DirectXPixelFormat_B8G8R8A8UIntNormalized;
+  static constexpr auto kPixelFormat = CaptureFrameSource::kPixelFormat;
 };
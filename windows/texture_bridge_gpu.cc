@@ -4,6 +4,12 @@
 
 #include "util/direct3d11.interop.h"
 
+namespace {
+// Copies taking longer than this are reported as hitches to the flight
+// recorder.
+constexpr auto kCopyHitchThreshold = std::chrono::milliseconds(50);
+}  // namespace
+
 TextureBridgeGpu::TextureBridgeGpu(
     GraphicsContext* graphics_context,
     ABI::Windows::UI::Composition::IVisual* visual)
@@ -79,12 +85,31 @@ TextureBridgeGpu::GetSurfaceDescriptor(size_t width, size_t height) {
   }
 
   if (last_frame_) {
+    const auto copy_start = util::FlightRecorder::Clock::now();
     ProcessFrame(last_frame_);
+    const auto copy_duration = util::FlightRecorder::Clock::now() - copy_start;
+    util::RecordFlightEvent(
+        instance_id_, util::FlightEventType::kFrameCopied,
+        std::chrono::duration_cast<std::chrono::nanoseconds>(copy_duration)
+            .count());
+    if (copy_duration > kCopyHitchThreshold) {
+      util::FlightRecorder::Global().ReportHitch();
+    }
   }
 
   if (surface_) {
     // Gets released in the SurfaceDescriptor's release callback.
     surface_->AddRef();
+    util::RecordFlightEvent(
+        instance_id_, util::FlightEventType::kDescriptorServed,
+        static_cast<uint64_t>(surface_size_.width) << 32 |
+            static_cast<uint32_t>(surface_size_.height));
+
+    if (!first_surface_traced_) {
+      first_surface_traced_ = true;
+      util::RecordTraceSpan("TextureBridge::FirstSurfaceDescriptor",
+                            started_at_);
+    }
   }
 
   return &surface_descriptor_;
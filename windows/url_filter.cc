@@ -0,0 +1,503 @@
+#include "url_filter.h"
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+#include "util/http_headers.h"
+
+namespace {
+// Literal parts of patterns shorter than this occur in too many URLs to
+// index a rule by.
+constexpr size_t kMinTokenSize = 2;
+// Longer literal parts are indexed by their start, which keeps the
+// automaton small and is as selective in practice.
+constexpr size_t kMaxTokenSize = 16;
+
+constexpr std::pair<std::string_view, uint32_t> kResourceTypes[] = {
+    {"document", UrlFilter::kDocument},
+    {"subdocument", UrlFilter::kSubdocument},
+    {"stylesheet", UrlFilter::kStylesheet},
+    {"script", UrlFilter::kScript},
+    {"image", UrlFilter::kImage},
+    {"font", UrlFilter::kFont},
+    {"media", UrlFilter::kMedia},
+    {"object", UrlFilter::kObject},
+    {"xmlhttprequest", UrlFilter::kXmlHttpRequest},
+    {"websocket", UrlFilter::kWebSocket},
+    {"ping", UrlFilter::kPing},
+    {"other", UrlFilter::kOther},
+    {"all", UrlFilter::kAllTypes},
+};
+
+char Fold(char c) { return c >= 'A' && c <= 'Z' ? c + ('a' - 'A') : c; }
+
+std::string FoldString(std::string_view text) {
+  std::string folded(text);
+  std::transform(folded.begin(), folded.end(), folded.begin(), Fold);
+  return folded;
+}
+
+bool HasUppercase(std::string_view text) {
+  return std::any_of(text.begin(), text.end(),
+                     [](char c) { return c >= 'A' && c <= 'Z'; });
+}
+
+// Whether |c| matches "^": anything but a letter, a digit or one of "_-.%".
+bool IsSeparator(char c) {
+  const auto byte = static_cast<unsigned char>(c);
+  return !((byte >= 'a' && byte <= 'z') || (byte >= 'A' && byte <= 'Z') ||
+           (byte >= '0' && byte <= '9') || byte == '_' || byte == '-' ||
+           byte == '.' || byte == '%');
+}
+
+bool IsDomainCharacter(char c) {
+  return (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == '-' ||
+         c == '_' || c == '.';
+}
+
+// Whether |pattern| matches |text| from its start, or from any position if
+// not |anchored_start|, and up to its end, or to any position if not
+// |anchored_end|. |pattern| is in lowercase if |fold|.
+bool MatchesPattern(std::string_view pattern, std::string_view text,
+                    bool anchored_start, bool anchored_end, bool fold) {
+  // Greedy matching that backtracks to the last star only, which is enough
+  // since a star matches any sequence. An unanchored start is a star before
+  // the pattern.
+  size_t p = 0;
+  size_t t = 0;
+  bool star = !anchored_start;
+  size_t star_p = 0;
+  size_t star_t = 0;
+  for (;;) {
+    if (p == pattern.size()) {
+      if (!anchored_end || t == text.size()) {
+        return true;
+      }
+    } else if (t < text.size()) {
+      const auto c = pattern[p];
+      if (c == '*') {
+        star = true;
+        star_p = ++p;
+        star_t = t;
+        continue;
+      }
+      if (c == '^' ? IsSeparator(text[t])
+                   : c == (fold ? Fold(text[t]) : text[t])) {
+        ++p;
+        ++t;
+        continue;
+      }
+    } else {
+      // Stars match nothing, and separators the end, at the end.
+      while (p < pattern.size() && (pattern[p] == '*' || pattern[p] == '^')) {
+        ++p;
+      }
+      if (p == pattern.size()) {
+        return true;
+      }
+    }
+    if (!star || star_t >= text.size()) {
+      return false;
+    }
+    p = star_p;
+    t = ++star_t;
+  }
+}
+
+// Returns the host of |url| and sets |begin| to its position.
+std::string_view GetHost(std::string_view url, size_t& begin) {
+  // Schemes are short, so a loop is quicker than find("://").
+  size_t i = 0;
+  while (i < url.size() && url[i] != ':' && url[i] != '/') {
+    ++i;
+  }
+  if (url.substr(i, 3) != "://") {
+    begin = std::string_view::npos;
+    return std::string_view();
+  }
+  begin = i + 3;
+  size_t end = begin;
+  size_t port = std::string_view::npos;
+  for (; end < url.size(); ++end) {
+    const auto c = url[end];
+    if (c == '/' || c == '?' || c == '#') {
+      break;
+    }
+    if (c == '@') {
+      begin = end + 1;
+      port = std::string_view::npos;
+    } else if (c == ':' && port == std::string_view::npos) {
+      port = end;
+    }
+  }
+  const auto host = url.substr(begin, end - begin);
+  if (!host.empty() && host.front() == '[') {
+    return host.substr(0, host.find(']') + 1);
+  }
+  return port == std::string_view::npos ? host
+                                        : url.substr(begin, port - begin);
+}
+
+// Returns the part of |host| a site registers, e.g. "example.co.uk" for
+// "www.example.co.uk". Without the public suffix list, this assumes that
+// country domains with a short second-level label, such as "co.uk" and
+// "com.au", are public suffixes.
+std::string_view GetSite(std::string_view host) {
+  const auto last_dot = host.rfind('.');
+  if (last_dot == std::string_view::npos || last_dot == 0 ||
+      last_dot + 1 == host.size() ||
+      (host.back() >= '0' && host.back() <= '9')) {
+    return host;
+  }
+  auto dot = host.rfind('.', last_dot - 1);
+  if (dot == std::string_view::npos) {
+    return host;
+  }
+  if (host.size() - last_dot - 1 == 2 && last_dot - dot - 1 <= 3 && dot > 0) {
+    dot = host.rfind('.', dot - 1);
+  }
+  return dot == std::string_view::npos ? host : host.substr(dot + 1);
+}
+
+bool IsSubdomainOf(std::string_view host, std::string_view domain) {
+  return host.size() >= domain.size() &&
+         host.substr(host.size() - domain.size()) == domain &&
+         (host.size() == domain.size() ||
+          host[host.size() - domain.size() - 1] == '.');
+}
+
+// Returns the longest literal part of |pattern|, cut to kMaxTokenSize.
+std::string_view GetToken(std::string_view pattern) {
+  std::string_view token;
+  size_t begin = 0;
+  while (begin < pattern.size()) {
+    const auto end = std::min(pattern.find_first_of("*^", begin),
+                              pattern.size());
+    if (end - begin > token.size()) {
+      token = pattern.substr(begin, end - begin);
+    }
+    begin = end + 1;
+  }
+  return token.substr(0, kMaxTokenSize);
+}
+}  // namespace
+
+struct UrlFilter::Context {
+  const Request& request;
+  // Hosts in lowercase.
+  std::string_view host;
+  size_t host_begin = 0;
+  std::string_view document_host;
+  std::string folded_host;
+  // Zero until known.
+  int third_party = 0;
+
+  explicit Context(const Request& request)
+      : request(request), document_host(request.document_host) {
+    host = GetHost(request.url, host_begin);
+    if (HasUppercase(host)) {
+      folded_host = FoldString(host);
+      host = folded_host;
+    }
+  }
+
+  bool IsThirdParty() {
+    if (third_party == 0) {
+      third_party =
+          !document_host.empty() && GetSite(host) != GetSite(document_host)
+              ? 1
+              : -1;
+    }
+    return third_party > 0;
+  }
+};
+
+// static
+std::unique_ptr<UrlFilter> UrlFilter::Compile(std::string_view rules) {
+  return std::unique_ptr<UrlFilter>(new UrlFilter(rules));
+}
+
+// static
+std::string UrlFilter::GetDocumentHost(std::string_view url) {
+  size_t begin = 0;
+  return FoldString(GetHost(url, begin));
+}
+
+UrlFilter::UrlFilter(std::string_view rules)
+    : text_(rules), folded_text_(FoldString(rules)) {
+  std::vector<std::string_view> blocking_tokens;
+  std::vector<std::string_view> exception_tokens;
+
+  const std::string_view text = text_;
+  size_t line_begin = 0;
+  while (line_begin < text.size()) {
+    const auto line_end = std::min(text.find('\n', line_begin), text.size());
+    auto line = text.substr(line_begin, line_end - line_begin);
+    while (!line.empty() && line.back() == '\r') {
+      line.remove_suffix(1);
+    }
+    line = util::Trim(line);
+    const auto offset = static_cast<size_t>(line.data() - text.data());
+    line_begin = line_end + 1;
+    // Comments and the header of the list.
+    if (line.empty() || line.front() == '!' || line.front() == '[') {
+      continue;
+    }
+
+    bool exception = false;
+    Rule rule;
+    if (!ParseRule(offset, line.size(), exception, rule)) {
+      ++skipped_rule_count_;
+      continue;
+    }
+
+    const auto index = static_cast<uint32_t>(rules_.size());
+    auto& rule_set = exception ? exception_rules_ : blocking_rules_;
+    const auto pattern = std::string_view(folded_text_)
+                             .substr(rule.pattern_offset, rule.pattern_size);
+    if (rule.host_anchor && !rule.end_anchor && !rule.match_case &&
+        pattern.size() > 1 && pattern.back() == '^' &&
+        pattern.front() != '.' && pattern[pattern.size() - 2] != '.' &&
+        std::all_of(pattern.begin(), pattern.end() - 1, IsDomainCharacter)) {
+      rule_set.domains.Add(pattern.substr(0, pattern.size() - 1), index);
+    } else if (const auto token = GetToken(pattern);
+               token.size() >= kMinTokenSize) {
+      (exception ? exception_tokens : blocking_tokens).push_back(token);
+      rule_set.token_rules.push_back(index);
+    } else {
+      rule_set.generic_rules.push_back(index);
+    }
+    rules_.push_back(rule);
+  }
+
+  blocking_rules_.tokens = util::AhoCorasick::Build(blocking_tokens);
+  exception_rules_.tokens = util::AhoCorasick::Build(exception_tokens);
+  hits_.resize(rules_.size());
+}
+
+bool UrlFilter::ParseRule(size_t offset, size_t size, bool& exception,
+                          Rule& rule) {
+  const auto line = std::string_view(text_).substr(offset, size);
+  if (line.find("##") != std::string_view::npos ||
+      line.find("#@#") != std::string_view::npos ||
+      line.find("#?#") != std::string_view::npos ||
+      line.find("#$#") != std::string_view::npos) {
+    return false;
+  }
+
+  rule.text_offset = static_cast<uint32_t>(offset);
+  rule.text_size = static_cast<uint32_t>(size);
+  auto begin = offset;
+  auto end = offset + size;
+  exception = line.substr(0, 2) == "@@";
+  if (exception) {
+    begin += 2;
+  }
+
+  const auto dollar = line.rfind('$');
+  if (dollar != std::string_view::npos && offset + dollar >= begin) {
+    const auto options = std::string_view(folded_text_)
+                             .substr(offset + dollar + 1, end - offset -
+                                                              dollar - 1);
+    if (!ParseOptions(options, rule)) {
+      return false;
+    }
+    end = offset + dollar;
+  }
+
+  const auto pattern = std::string_view(text_).substr(begin, end - begin);
+  if (pattern.size() >= 2 && pattern.front() == '/' && pattern.back() == '/') {
+    // Regular expressions.
+    return false;
+  }
+  if (pattern.substr(0, 2) == "||") {
+    rule.host_anchor = true;
+    begin += 2;
+  } else if (pattern.substr(0, 1) == "|") {
+    rule.start_anchor = true;
+    begin += 1;
+  }
+  if (end > begin && text_[end - 1] == '|') {
+    rule.end_anchor = true;
+    end -= 1;
+  }
+  rule.pattern_offset = static_cast<uint32_t>(begin);
+  rule.pattern_size = static_cast<uint32_t>(end - begin);
+  return true;
+}
+
+bool UrlFilter::ParseOptions(std::string_view options, Rule& rule) {
+  uint32_t included_types = 0;
+  uint32_t excluded_types = 0;
+  while (!options.empty()) {
+    const auto comma = options.find(',');
+    auto option = options.substr(0, comma);
+    options = comma == std::string_view::npos ? std::string_view()
+                                              : options.substr(comma + 1);
+    const bool negated = !option.empty() && option.front() == '~';
+    if (negated) {
+      option.remove_prefix(1);
+    }
+
+    const auto type = std::find_if(
+        std::begin(kResourceTypes), std::end(kResourceTypes),
+        [option](const auto& entry) { return entry.first == option; });
+    if (type != std::end(kResourceTypes)) {
+      (negated ? excluded_types : included_types) |= type->second;
+    } else if (option == "third-party" || option == "3p") {
+      rule.third_party = negated ? -1 : 1;
+    } else if (option == "first-party" || option == "1p") {
+      rule.third_party = negated ? 1 : -1;
+    } else if (option == "match-case" && !negated) {
+      rule.match_case = true;
+    } else if (option.substr(0, 7) == "domain=" && !negated) {
+      rule.first_domain = static_cast<uint32_t>(rule_domains_.size());
+      auto domains = option.substr(7);
+      while (!domains.empty()) {
+        const auto bar = domains.find('|');
+        auto domain = domains.substr(0, bar);
+        domains = bar == std::string_view::npos ? std::string_view()
+                                                : domains.substr(bar + 1);
+        const bool excluded = !domain.empty() && domain.front() == '~';
+        if (excluded) {
+          domain.remove_prefix(1);
+        }
+        if (!domain.empty()) {
+          rule_domains_.push_back({domain, excluded});
+        }
+      }
+      rule.domain_count =
+          static_cast<uint32_t>(rule_domains_.size()) - rule.first_domain;
+    } else {
+      // Rules whose options aren't understood could block what they are
+      // meant to spare, such as popups or the pages of some sites only.
+      return false;
+    }
+  }
+
+  rule.types = (included_types ? included_types : kAllTypes) & ~excluded_types;
+  return rule.types != 0;
+}
+
+bool UrlFilter::ShouldBlock(const Request& request) {
+  Context context(request);
+  const auto blocking_rule = FindMatch(blocking_rules_, context);
+  if (blocking_rule == kNoRule) {
+    return false;
+  }
+  const auto exception_rule = FindMatch(exception_rules_, context);
+  if (exception_rule != kNoRule) {
+    ++hits_[exception_rule];
+    return false;
+  }
+  ++hits_[blocking_rule];
+  return true;
+}
+
+std::vector<UrlFilter::RuleHits> UrlFilter::GetHits() const {
+  std::vector<RuleHits> hits;
+  for (size_t i = 0; i < rules_.size(); ++i) {
+    if (hits_[i]) {
+      hits.push_back({std::string_view(text_).substr(rules_[i].text_offset,
+                                                     rules_[i].text_size),
+                      hits_[i]});
+    }
+  }
+  return hits;
+}
+
+void UrlFilter::ResetHits() { std::fill(hits_.begin(), hits_.end(), 0); }
+
+uint32_t UrlFilter::FindMatch(const RuleSet& rule_set,
+                              Context& context) const {
+  uint32_t found = kNoRule;
+  rule_set.domains.ForEachMatch(context.host, [&](uint32_t rule) {
+    if (!AppliesTo(rules_[rule], context)) {
+      return true;
+    }
+    found = rule;
+    return false;
+  });
+  if (found != kNoRule) {
+    return found;
+  }
+
+  rule_set.tokens.ForEachMatch(
+      context.request.url, [&](uint32_t pattern, size_t) {
+        const auto rule = rule_set.token_rules[pattern];
+        if (!AppliesTo(rules_[rule], context) ||
+            !MatchesUrl(rules_[rule], context)) {
+          return true;
+        }
+        found = rule;
+        return false;
+      });
+  if (found != kNoRule) {
+    return found;
+  }
+
+  for (const auto rule : rule_set.generic_rules) {
+    if (AppliesTo(rules_[rule], context) && MatchesUrl(rules_[rule], context)) {
+      return rule;
+    }
+  }
+  return kNoRule;
+}
+
+bool UrlFilter::AppliesTo(const Rule& rule, Context& context) const {
+  if (!(rule.types & context.request.type) ||
+      (rule.third_party && (rule.third_party > 0) != context.IsThirdParty())) {
+    return false;
+  }
+  if (!rule.domain_count) {
+    return true;
+  }
+
+  // Navigations are made from the document they load.
+  const auto document_host = context.request.document_host.empty()
+                                 ? context.host
+                                 : context.document_host;
+  bool restricted = false;
+  bool included = false;
+  for (uint32_t i = 0; i < rule.domain_count; ++i) {
+    const auto& domain = rule_domains_[rule.first_domain + i];
+    if (IsSubdomainOf(document_host, domain.domain)) {
+      if (domain.excluded) {
+        return false;
+      }
+      included = true;
+    }
+    restricted = restricted || !domain.excluded;
+  }
+  return included || !restricted;
+}
+
+bool UrlFilter::MatchesUrl(const Rule& rule, const Context& context) const {
+  const auto pattern =
+      std::string_view(rule.match_case ? text_ : folded_text_)
+          .substr(rule.pattern_offset, rule.pattern_size);
+  const auto url = context.request.url;
+  const bool fold = !rule.match_case;
+  if (!rule.host_anchor) {
+    return MatchesPattern(pattern, url, rule.start_anchor, rule.end_anchor,
+                          fold);
+  }
+
+  // The pattern starts at the host or at one of its labels.
+  if (context.host.empty()) {
+    return false;
+  }
+  const auto host_end = context.host_begin + context.host.size();
+  for (auto start = context.host_begin;;) {
+    if (MatchesPattern(pattern, url.substr(start), true, rule.end_anchor,
+                       fold)) {
+      return true;
+    }
+    const auto dot = url.find('.', start);
+    if (dot == std::string_view::npos || dot >= host_end) {
+      return false;
+    }
+    start = dot + 1;
+  }
+}
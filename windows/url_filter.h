@@ -0,0 +1,147 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "util/aho_corasick.h"
+#include "util/domain_trie.h"
+
+// Decides which requests to block from rule lists in the filter syntax of
+// Adblock Plus, which EasyList and most other lists use:
+//
+//   ||example.com^      the host example.com and its subdomains
+//   |https:// .gif|     anchors to the start or end of the URL
+//   * ^                 any characters, and a separator or the end
+//   @@                  exception, which lets matching requests through
+//   $options            resource types (negated with ~), third-party,
+//                       first-party, domain=a.com|~b.a.com and match-case
+//
+// Element hiding rules, regular expressions and rules with other options
+// are skipped.
+//
+// Rules that block whole domains are kept in a trie of domain labels, and
+// all others are indexed by their longest literal part in an Aho-Corasick
+// automaton and only checked in full when that part occurs in the URL. A
+// request thus costs a lookup per host label and one pass over its URL,
+// however many rules there are.
+//
+// Counts the requests each rule decided. Not thread-safe.
+class UrlFilter {
+ public:
+  // Bit mask.
+  enum ResourceType : uint32_t {
+    kDocument = 1 << 0,
+    kSubdocument = 1 << 1,
+    kStylesheet = 1 << 2,
+    kScript = 1 << 3,
+    kImage = 1 << 4,
+    kFont = 1 << 5,
+    kMedia = 1 << 6,
+    kObject = 1 << 7,
+    kXmlHttpRequest = 1 << 8,
+    kWebSocket = 1 << 9,
+    kPing = 1 << 10,
+    kOther = 1 << 11,
+    kAllTypes = (1 << 12) - 1,
+  };
+
+  struct Request {
+    std::string_view url;
+    // Host of the document the request is made from, as returned by
+    // GetDocumentHost. Empty for navigations, which are made from the
+    // document they load.
+    std::string_view document_host;
+    // One or more ResourceTypes.
+    uint32_t type = kOther;
+  };
+
+  struct RuleHits {
+    std::string_view rule;
+    uint64_t hits;
+  };
+
+  // Compiles |rules|, one per line.
+  static std::unique_ptr<UrlFilter> Compile(std::string_view rules);
+
+  // Returns the host of the document at |url| in lowercase, to be kept while
+  // the document is loaded rather than parsed for each of its requests.
+  static std::string GetDocumentHost(std::string_view url);
+
+  UrlFilter(const UrlFilter&) = delete;
+  UrlFilter& operator=(const UrlFilter&) = delete;
+
+  // Whether |request| matches a blocking rule and no exception.
+  bool ShouldBlock(const Request& request);
+
+  // Number of rules that were compiled, and that were skipped.
+  size_t rule_count() const { return rules_.size(); }
+  size_t skipped_rule_count() const { return skipped_rule_count_; }
+
+  // Returns the rules that decided requests, in the order of the list, with
+  // the number of requests each decided.
+  std::vector<RuleHits> GetHits() const;
+  void ResetHits();
+
+ private:
+  static constexpr uint32_t kNoRule = UINT32_MAX;
+
+  struct Rule {
+    // Offsets into |text_| and |folded_text_|.
+    uint32_t text_offset = 0;
+    uint32_t text_size = 0;
+    uint32_t pattern_offset = 0;
+    uint32_t pattern_size = 0;
+    uint32_t types = kAllTypes;
+    // Entries in |rule_domains_|.
+    uint32_t first_domain = 0;
+    uint32_t domain_count = 0;
+    // Positive to match third-party requests only, negative for first-party
+    // requests only.
+    int8_t third_party = 0;
+    bool host_anchor = false;
+    bool start_anchor = false;
+    bool end_anchor = false;
+    bool match_case = false;
+  };
+
+  struct RuleDomain {
+    std::string_view domain;
+    bool excluded;
+  };
+
+  // The compiled rules of one kind, blocking or exception.
+  struct RuleSet {
+    // Rules that match whole domains.
+    util::DomainTrie domains;
+    // Rules by the pattern of |tokens| they are indexed by.
+    util::AhoCorasick tokens;
+    std::vector<uint32_t> token_rules;
+    // Rules without a literal part to index them by.
+    std::vector<uint32_t> generic_rules;
+  };
+
+  struct Context;
+
+  // The rule list as given, and in lowercase.
+  const std::string text_;
+  const std::string folded_text_;
+  std::vector<Rule> rules_;
+  std::vector<RuleDomain> rule_domains_;
+  size_t skipped_rule_count_ = 0;
+  RuleSet blocking_rules_;
+  RuleSet exception_rules_;
+  std::vector<uint64_t> hits_;
+
+  explicit UrlFilter(std::string_view rules);
+
+  // Parses the rule at |offset| in |text_|. Returns false to skip it.
+  bool ParseRule(size_t offset, size_t size, bool& exception, Rule& rule);
+  bool ParseOptions(std::string_view options, Rule& rule);
+  uint32_t FindMatch(const RuleSet& rule_set, Context& context) const;
+  bool AppliesTo(const Rule& rule, Context& context) const;
+  bool MatchesUrl(const Rule& rule, const Context& context) const;
+};
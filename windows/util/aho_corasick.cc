@@ -0,0 +1,169 @@
+#include "aho_corasick.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace util {
+
+namespace {
+// States up to this depth get a row of transitions. Rows of the states one
+// level deeper would take about class count times more memory.
+constexpr uint32_t kDenseDepth = 2;
+
+struct TrieNode {
+  // Sorted by label.
+  std::vector<std::pair<uint8_t, uint32_t>> children;
+  std::vector<uint32_t> outputs;
+};
+
+uint32_t FindChild(const TrieNode& node, uint8_t label) {
+  const auto it = std::lower_bound(
+      node.children.begin(), node.children.end(), label,
+      [](const auto& child, uint8_t value) { return child.first < value; });
+  return it != node.children.end() && it->first == label ? it->second
+                                                         : UINT32_MAX;
+}
+}  // namespace
+
+// static
+AhoCorasick AhoCorasick::Build(const std::vector<std::string_view>& patterns) {
+  AhoCorasick automaton;
+
+  auto& classes = automaton.classes_;
+  for (const auto& pattern : patterns) {
+    automaton.max_pattern_size_ =
+        std::max(automaton.max_pattern_size_, pattern.size());
+    for (const auto c : pattern) {
+      const auto byte = Fold(c);
+      if (!classes[byte]) {
+        classes[byte] = static_cast<uint8_t>(automaton.class_count_++);
+      }
+    }
+  }
+  for (int byte = 'A'; byte <= 'Z'; ++byte) {
+    classes[byte] = classes[byte + ('a' - 'A')];
+  }
+
+  std::vector<TrieNode> nodes(1);
+  for (uint32_t i = 0; i < patterns.size(); ++i) {
+    if (patterns[i].empty()) {
+      continue;
+    }
+    uint32_t node = 0;
+    for (const auto c : patterns[i]) {
+      const auto label = classes[static_cast<uint8_t>(c)];
+      auto& children = nodes[node].children;
+      const auto it = std::lower_bound(
+          children.begin(), children.end(), label,
+          [](const auto& child, uint8_t value) { return child.first < value; });
+      if (it != children.end() && it->first == label) {
+        node = it->second;
+        continue;
+      }
+      const auto child = static_cast<uint32_t>(nodes.size());
+      children.insert(it, {label, child});
+      nodes.emplace_back();
+      node = child;
+    }
+    nodes[node].outputs.push_back(i);
+  }
+
+  // States are numbered in breadth-first order, so the shallow states that
+  // most of a scan goes through are close together, and the failure state
+  // of each state comes before it.
+  std::vector<uint32_t> order;
+  std::vector<uint32_t> state_of(nodes.size());
+  order.reserve(nodes.size());
+  order.push_back(0);
+  size_t level_end = 1;
+  for (size_t i = 0, depth = 0; i < order.size(); ++i) {
+    if (i == level_end) {
+      level_end = order.size();
+      ++depth;
+    }
+    if (depth <= kDenseDepth) {
+      automaton.dense_state_count_ = static_cast<uint32_t>(i + 1);
+    }
+    for (const auto& [label, child] : nodes[order[i]].children) {
+      state_of[child] = static_cast<uint32_t>(order.size());
+      order.push_back(child);
+    }
+  }
+
+  const auto class_count = automaton.class_count_;
+  std::vector<uint32_t> failure_nodes(nodes.size(), 0);
+  auto& states = automaton.states_;
+  auto& rows = automaton.dense_transitions_;
+  states.resize(nodes.size());
+  rows.resize(static_cast<size_t>(automaton.dense_state_count_) * class_count);
+  for (uint32_t i = 0; i < order.size(); ++i) {
+    const auto node = order[i];
+    auto& state = states[i];
+
+    if (node != 0) {
+      const auto failure_state = state_of[failure_nodes[node]];
+      state.failure = failure_state;
+      const auto& failure = states[failure_state];
+      state.output_link =
+          failure.output_count ? failure_state : failure.output_link;
+    }
+    for (const auto& [label, child] : nodes[node].children) {
+      // The failure of a child is the deepest state that the failure chain
+      // of its parent can continue with the same label.
+      uint32_t failure = UINT32_MAX;
+      if (node != 0) {
+        for (auto candidate = failure_nodes[node];;
+             candidate = failure_nodes[candidate]) {
+          failure = FindChild(nodes[candidate], label);
+          if (failure != UINT32_MAX || candidate == 0) {
+            break;
+          }
+        }
+      }
+      failure_nodes[child] = failure == UINT32_MAX ? 0 : failure;
+    }
+
+    if (i < automaton.dense_state_count_) {
+      // Labels without a child continue from the failure state, whose row
+      // is complete already since it is shallower.
+      const auto row = rows.begin() + static_cast<size_t>(i) * class_count;
+      if (i != 0) {
+        const auto failure_row =
+            rows.begin() + static_cast<size_t>(state.failure) * class_count;
+        std::copy(failure_row, failure_row + class_count, row);
+      }
+      for (const auto& [label, child] : nodes[node].children) {
+        row[label] = state_of[child];
+      }
+    } else {
+      state.first_transition = static_cast<uint32_t>(automaton.labels_.size());
+      state.transition_count =
+          static_cast<uint32_t>(nodes[node].children.size());
+      for (const auto& [label, child] : nodes[node].children) {
+        automaton.labels_.push_back(label);
+        automaton.targets_.push_back(state_of[child]);
+      }
+    }
+
+    state.first_output = static_cast<uint32_t>(automaton.outputs_.size());
+    state.output_count = static_cast<uint32_t>(nodes[node].outputs.size());
+    automaton.outputs_.insert(automaton.outputs_.end(),
+                              nodes[node].outputs.begin(),
+                              nodes[node].outputs.end());
+    // Frees the outputs as soon as they are copied, since the trie of a
+    // large pattern set takes much more memory than the automaton.
+    nodes[node].outputs = std::vector<uint32_t>();
+  }
+
+  for (auto* transitions : {&rows, &automaton.targets_}) {
+    for (auto& target : *transitions) {
+      const auto& state = states[target];
+      if (state.output_count || state.output_link != kNone) {
+        target |= kReportsOutputs;
+      }
+    }
+  }
+  return automaton;
+}
+
+}  // namespace util
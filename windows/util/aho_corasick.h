@@ -0,0 +1,161 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace util {
+
+// Aho-Corasick automaton that finds all occurrences of a set of patterns in
+// one pass over a text, whatever the number of patterns.
+//
+// Matching ignores ASCII case: patterns are folded when the automaton is
+// built, and the text while it is scanned.
+//
+// The bytes of the patterns are mapped to a small alphabet of classes, with
+// one class for all bytes that no pattern contains. The shallow states,
+// which a scan spends most of its time in, have a row of transitions
+// indexed by class that already follows the failure links, so they take one
+// step per byte. Deeper states, of which there are many more, keep arrays
+// of their labels and targets.
+class AhoCorasick {
+ public:
+  AhoCorasick() = default;
+
+  // Builds the automaton. Patterns are identified by their position in
+  // |patterns| and may repeat. Empty patterns are ignored.
+  static AhoCorasick Build(const std::vector<std::string_view>& patterns);
+
+  // Calls |callback(pattern, end)| for each occurrence of a pattern in
+  // |text|, where |end| is the position just past it, in no particular
+  // order. Stops when the callback returns false. Returns false if it stopped.
+  template <typename Callback>
+  bool ForEachMatch(std::string_view text, Callback callback) const;
+
+  size_t state_count() const { return states_.size(); }
+
+ private:
+  static constexpr uint32_t kNone = UINT32_MAX;
+  // Set in transitions to states with outputs to report, so that a scan
+  // doesn't need to look them up for every byte.
+  static constexpr uint32_t kReportsOutputs = 1u << 31;
+  // Shorter texts are scanned in one piece.
+  static constexpr size_t kMinSplitSize = 48;
+
+  struct State {
+    uint32_t first_transition = 0;
+    uint32_t transition_count = 0;
+    // State of the longest proper suffix of this one that is in the trie.
+    uint32_t failure = 0;
+    // Patterns that end in this state.
+    uint32_t first_output = 0;
+    uint32_t output_count = 0;
+    // Nearest state along the failure links with outputs, or kNone.
+    uint32_t output_link = kNone;
+  };
+
+  uint8_t classes_[256] = {};
+  uint32_t class_count_ = 1;
+  // States are numbered breadth first, so the states with rows come first.
+  uint32_t dense_state_count_ = 0;
+  size_t max_pattern_size_ = 0;
+  std::vector<State> states_;
+  // Labels are classes.
+  std::vector<uint8_t> labels_;
+  std::vector<uint32_t> targets_;
+  std::vector<uint32_t> dense_transitions_;
+  std::vector<uint32_t> outputs_;
+
+  static uint8_t Fold(char c) {
+    const auto byte = static_cast<uint8_t>(c);
+    return byte >= 'A' && byte <= 'Z' ? byte + ('a' - 'A') : byte;
+  }
+
+  // |state| and the result may have kReportsOutputs set.
+  uint32_t GetNextState(uint32_t state, uint8_t label) const {
+    state &= ~kReportsOutputs;
+    for (;;) {
+      if (state < dense_state_count_) {
+        return dense_transitions_[state * class_count_ + label];
+      }
+      const auto& current = states_[state];
+      const auto labels = labels_.data() + current.first_transition;
+      for (uint32_t i = 0; i < current.transition_count; ++i) {
+        if (labels[i] == label) {
+          return targets_[current.first_transition + i];
+        }
+      }
+      state = current.failure;
+    }
+  }
+};
+
+template <typename Callback>
+bool AhoCorasick::ForEachMatch(std::string_view text,
+                               Callback callback) const {
+  if (states_.empty()) {
+    return true;
+  }
+
+  const auto report = [this, &callback](uint32_t state, size_t end) {
+    if (!(state & kReportsOutputs)) {
+      return true;
+    }
+    state &= ~kReportsOutputs;
+    auto output = states_[state].output_count ? state
+                                              : states_[state].output_link;
+    while (output != kNone) {
+      const auto& matched = states_[output];
+      for (uint32_t i = 0; i < matched.output_count; ++i) {
+        if (!callback(outputs_[matched.first_output + i], end)) {
+          return false;
+        }
+      }
+      output = matched.output_link;
+    }
+    return true;
+  };
+
+  // Each step waits for the state of the previous one, so the text is
+  // scanned as two halves at once, which the CPU overlaps. The second half
+  // starts early enough to see the patterns that end in it whole, and only
+  // reports those.
+  const size_t middle = text.size() / 2;
+  const size_t second_begin =
+      middle > max_pattern_size_ ? middle - max_pattern_size_ + 1 : 0;
+  if (text.size() < kMinSplitSize || second_begin == 0) {
+    uint32_t state = 0;
+    for (size_t i = 0; i < text.size(); ++i) {
+      state = GetNextState(state, classes_[static_cast<uint8_t>(text[i])]);
+      if (!report(state, i + 1)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  uint32_t first_state = 0;
+  uint32_t second_state = 0;
+  size_t j = second_begin;
+  for (size_t i = 0; i < middle; ++i, ++j) {
+    first_state = GetNextState(first_state,
+                               classes_[static_cast<uint8_t>(text[i])]);
+    second_state = GetNextState(second_state,
+                                classes_[static_cast<uint8_t>(text[j])]);
+    if (!report(first_state, i + 1) ||
+        (j >= middle && !report(second_state, j + 1))) {
+      return false;
+    }
+  }
+  for (; j < text.size(); ++j) {
+    second_state = GetNextState(second_state,
+                                classes_[static_cast<uint8_t>(text[j])]);
+    if (j >= middle && !report(second_state, j + 1)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace util
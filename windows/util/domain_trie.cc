@@ -0,0 +1,61 @@
+#include "domain_trie.h"
+
+namespace util {
+
+namespace {
+constexpr size_t kInitialSlots = 64;
+}  // namespace
+
+DomainTrie::DomainTrie() : nodes_(1), slots_(kInitialSlots) {}
+
+void DomainTrie::Add(std::string_view domain, uint32_t value) {
+  uint32_t node = 0;
+  size_t end = domain.size();
+  while (end > 0) {
+    const auto dot = domain.rfind('.', end - 1);
+    const auto begin = dot == std::string_view::npos ? 0 : dot + 1;
+    const auto label = domain.substr(begin, end - begin);
+    const auto hash = HashEdge(node, label);
+    auto child = FindChild(node, label, hash);
+    if (child == kNone) {
+      child = static_cast<uint32_t>(nodes_.size());
+      Node new_node;
+      new_node.parent = node;
+      new_node.label_offset = static_cast<uint32_t>(labels_.size());
+      new_node.label_size = static_cast<uint32_t>(label.size());
+      labels_.append(label);
+      nodes_.push_back(new_node);
+      Insert(hash, child);
+    }
+    node = child;
+    if (dot == std::string_view::npos) {
+      break;
+    }
+    end = dot;
+  }
+
+  values_.push_back({value, nodes_[node].first_value});
+  nodes_[node].first_value = static_cast<uint32_t>(values_.size() - 1);
+}
+
+void DomainTrie::Insert(uint64_t hash, uint32_t node) {
+  // Nodes other than the root are edges.
+  if ((nodes_.size() - 1) * 2 > slots_.size()) {
+    std::vector<Slot> slots(slots_.size() * 2);
+    slots_.swap(slots);
+    for (const auto& slot : slots) {
+      if (slot.node != kNone) {
+        Insert(slot.hash, slot.node);
+      }
+    }
+  }
+
+  const size_t mask = slots_.size() - 1;
+  size_t i = hash & mask;
+  while (slots_[i].node != kNone) {
+    i = (i + 1) & mask;
+  }
+  slots_[i] = {hash, node};
+}
+
+}  // namespace util
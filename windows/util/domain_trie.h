@@ -0,0 +1,123 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "hash.h"
+
+namespace util {
+
+// Maps domains to values and finds the values of a host and of all the
+// domains it is a subdomain of.
+//
+// The trie is keyed by labels from the top-level domain down, so a lookup
+// walks the labels of the host from the right and stops at the first one
+// that no domain continues with. Its edges are kept in one hash table keyed
+// by the parent and the label.
+class DomainTrie {
+ public:
+  DomainTrie();
+
+  // Adds |value| for |domain|, which must be in lowercase.
+  void Add(std::string_view domain, uint32_t value);
+
+  // Calls |callback(value)| for the values of |host|, which must be in
+  // lowercase, and of its parent domains, the top-level domain first. Stops
+  // when the callback returns false. Returns false if it stopped.
+  template <typename Callback>
+  bool ForEachMatch(std::string_view host, Callback callback) const;
+
+  size_t node_count() const { return nodes_.size(); }
+
+ private:
+  static constexpr uint32_t kNone = UINT32_MAX;
+
+  struct Node {
+    uint32_t parent = kNone;
+    // Label in |labels_|.
+    uint32_t label_offset = 0;
+    uint32_t label_size = 0;
+    // Head of the list of values in |values_|, or kNone.
+    uint32_t first_value = kNone;
+  };
+
+  struct Slot {
+    uint64_t hash = 0;
+    uint32_t node = kNone;
+  };
+
+  struct Value {
+    uint32_t value;
+    uint32_t next;
+  };
+
+  std::vector<Node> nodes_;
+  std::string labels_;
+  std::vector<Value> values_;
+  // Open addressing with linear probing, at most half full.
+  std::vector<Slot> slots_;
+
+  // Labels are short, so hashing them a byte at a time inline is quicker
+  // than Hash64.
+  static uint64_t HashEdge(uint32_t parent, std::string_view label) {
+    constexpr uint64_t kMultiplier = 0x9e3779b97f4a7c15ull;
+    uint64_t hash = parent;
+    for (const auto c : label) {
+      hash = (hash + static_cast<uint8_t>(c)) * kMultiplier;
+    }
+    return Mix64(hash);
+  }
+
+  // Returns the child of |parent| for |label|, or kNone.
+  uint32_t FindChild(uint32_t parent, std::string_view label,
+                     uint64_t hash) const {
+    const size_t mask = slots_.size() - 1;
+    for (size_t i = hash & mask;; i = (i + 1) & mask) {
+      const auto& slot = slots_[i];
+      if (slot.node == kNone) {
+        return kNone;
+      }
+      if (slot.hash == hash) {
+        const auto& node = nodes_[slot.node];
+        if (node.parent == parent &&
+            std::string_view(labels_).substr(node.label_offset,
+                                             node.label_size) == label) {
+          return slot.node;
+        }
+      }
+    }
+  }
+
+  void Insert(uint64_t hash, uint32_t node);
+};
+
+template <typename Callback>
+bool DomainTrie::ForEachMatch(std::string_view host, Callback callback) const {
+  uint32_t node = 0;
+  size_t end = host.size();
+  while (end > 0) {
+    const auto dot = host.rfind('.', end - 1);
+    const auto begin = dot == std::string_view::npos ? 0 : dot + 1;
+    const auto label = host.substr(begin, end - begin);
+    node = FindChild(node, label, HashEdge(node, label));
+    if (node == kNone) {
+      return true;
+    }
+    for (auto value = nodes_[node].first_value; value != kNone;
+         value = values_[value].next) {
+      if (!callback(values_[value].value)) {
+        return false;
+      }
+    }
+    if (dot == std::string_view::npos) {
+      break;
+    }
+    end = dot;
+  }
+  return true;
+}
+
+}  // namespace util
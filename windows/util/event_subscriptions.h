@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace util {
+
+// Keeps event handlers registered only while their events have subscribers.
+//
+// Subscriptions are a bitmask with one bit per event stream. Each handler is
+// bound to one or more bits and is registered while any of them is set.
+class EventSubscriptions {
+ public:
+  typedef std::function<void()> Action;
+
+  EventSubscriptions() = default;
+  EventSubscriptions(const EventSubscriptions&) = delete;
+  EventSubscriptions& operator=(const EventSubscriptions&) = delete;
+
+  // Adds a handler that is registered while any of the bits in |mask| is
+  // subscribed. Takes effect with the next call to Update.
+  void AddHandler(uint32_t mask, Action register_handler,
+                  Action unregister_handler) {
+    handlers_.push_back(
+        {mask, std::move(register_handler), std::move(unregister_handler)});
+  }
+
+  // Sets the subscribed bits, registering and unregistering handlers as
+  // needed.
+  void Update(uint32_t subscriptions) {
+    subscriptions_ = subscriptions;
+    for (auto& handler : handlers_) {
+      const bool wanted = (handler.mask & subscriptions) != 0;
+      if (wanted == handler.registered) {
+        continue;
+      }
+      handler.registered = wanted;
+      if (wanted) {
+        handler.register_handler();
+      } else {
+        handler.unregister_handler();
+      }
+    }
+  }
+
+  // Unregisters all handlers.
+  void Clear() { Update(0); }
+
+  bool IsSubscribed(uint32_t mask) const {
+    return (subscriptions_ & mask) != 0;
+  }
+  uint32_t subscriptions() const { return subscriptions_; }
+
+  // Number of handlers currently registered.
+  size_t registered_count() const {
+    size_t count = 0;
+    for (const auto& handler : handlers_) {
+      count += handler.registered ? 1 : 0;
+    }
+    return count;
+  }
+
+ private:
+  struct Handler {
+    uint32_t mask;
+    Action register_handler;
+    Action unregister_handler;
+    bool registered = false;
+  };
+
+  std::vector<Handler> handlers_;
+  uint32_t subscriptions_ = 0;
+};
+
+}  // namespace util
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <utility>
+
+namespace util {
+
+// Thread-safe cache for values that are expensive to resolve and cheap to
+// copy, such as ref-counted activation factories.
+//
+// Each key is resolved at most once. Failed resolutions (values that convert
+// to false) are not cached and are retried on the next lookup. The resolver
+// is invoked with the cache locked and must not call back into the cache.
+template <typename Key, typename Value, typename Compare = std::less<Key>>
+class FactoryCache {
+ public:
+  typedef std::function<Value(const Key&)> Resolver;
+
+  explicit FactoryCache(Resolver resolver) : resolver_(std::move(resolver)) {}
+
+  // Returns a copy of the cached value, resolving it first if needed.
+  Value Get(const Key& key) {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    const auto it = values_.find(key);
+    if (it != values_.end()) {
+      return it->second;
+    }
+
+    auto value = resolver_(key);
+    if (value) {
+      values_.emplace(key, value);
+    }
+    return value;
+  }
+
+  // Drops all cached values.
+  void Clear() {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    values_.clear();
+  }
+
+  size_t size() const {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    return values_.size();
+  }
+
+ private:
+  Resolver resolver_;
+  mutable std::mutex mutex_;
+  std::map<Key, Value, Compare> values_;
+};
+
+}  // namespace util
@@ -0,0 +1,215 @@
+#include "flight_recorder.h"
+
+#include <sstream>
+
+namespace util {
+
+namespace {
+// Number of records kept by the global recorder (32 bytes each).
+constexpr size_t kGlobalCapacity = 16384;
+
+constexpr char kMagic[4] = {'W', 'V', 'F', 'R'};
+constexpr uint32_t kVersion = 1;
+constexpr size_t kHeaderSize = 16;
+constexpr size_t kRecordSize = 24;
+
+void PutUint(std::string& out, uint64_t value, size_t bytes) {
+  for (size_t i = 0; i < bytes; ++i) {
+    out.push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+  }
+}
+
+uint64_t GetUint(std::string_view data, size_t offset, size_t bytes) {
+  uint64_t value = 0;
+  for (size_t i = 0; i < bytes; ++i) {
+    value |= static_cast<uint64_t>(static_cast<uint8_t>(data[offset + i]))
+             << (8 * i);
+  }
+  return value;
+}
+
+const char* GetEventName(FlightEventType type) {
+  switch (type) {
+    case FlightEventType::kFrameArrived:
+      return "FrameArrived";
+    case FlightEventType::kFrameDropped:
+      return "FrameDropped";
+    case FlightEventType::kFrameCopied:
+      return "FrameCopied";
+    case FlightEventType::kDescriptorServed:
+      return "DescriptorServed";
+    case FlightEventType::kInputReceived:
+      return "InputReceived";
+    case FlightEventType::kInputDispatched:
+      return "InputDispatched";
+    case FlightEventType::kResize:
+      return "Resize";
+  }
+  return "Unknown";
+}
+}  // namespace
+
+FlightRecorder::FlightRecorder(size_t capacity) {
+  size_t size = 1;
+  while (size < capacity) {
+    size <<= 1;
+  }
+  mask_ = size - 1;
+  slots_ = std::make_unique<Slot[]>(size);
+}
+
+// static
+FlightRecorder& FlightRecorder::Global() {
+  static FlightRecorder* recorder = new FlightRecorder(kGlobalCapacity);
+  return *recorder;
+}
+
+void FlightRecorder::Record(uint32_t instance_id, FlightEventType type,
+                            uint64_t value, Clock::time_point now) {
+  const auto index = head_.fetch_add(1, std::memory_order_relaxed);
+  auto& slot = slots_[index & mask_];
+
+  slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  slot.timestamp_ns.store(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          now.time_since_epoch())
+          .count(),
+      std::memory_order_relaxed);
+  slot.instance_and_type.store(
+      static_cast<uint64_t>(instance_id) << 32 | static_cast<uint32_t>(type),
+      std::memory_order_relaxed);
+  slot.value.store(value, std::memory_order_relaxed);
+  slot.sequence.store(2 * index + 2, std::memory_order_release);
+}
+
+std::vector<FlightRecord> FlightRecorder::Snapshot() const {
+  const auto head = head_.load(std::memory_order_acquire);
+  const auto begin = head > capacity() ? head - capacity() : 0;
+
+  std::vector<FlightRecord> records;
+  records.reserve(static_cast<size_t>(head - begin));
+  for (auto index = begin; index < head; ++index) {
+    const auto& slot = slots_[index & mask_];
+    const auto sequence = slot.sequence.load(std::memory_order_acquire);
+    if (sequence != 2 * index + 2) {
+      // Still being written or already overwritten.
+      continue;
+    }
+
+    const auto timestamp_ns =
+        slot.timestamp_ns.load(std::memory_order_relaxed);
+    const auto instance_and_type =
+        slot.instance_and_type.load(std::memory_order_relaxed);
+    const auto value = slot.value.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.sequence.load(std::memory_order_relaxed) != sequence) {
+      continue;
+    }
+
+    records.push_back(
+        {timestamp_ns, static_cast<uint32_t>(instance_and_type >> 32),
+         static_cast<FlightEventType>(instance_and_type & 0xffffffff),
+         value});
+  }
+  return records;
+}
+
+void FlightRecorder::SetHitchHandler(HitchHandler handler,
+                                     Clock::duration min_interval) {
+  const std::lock_guard<std::mutex> lock(hitch_mutex_);
+  hitch_handler_ = std::move(handler);
+  hitch_interval_ = min_interval;
+  last_hitch_.reset();
+}
+
+void FlightRecorder::ReportHitch(Clock::time_point now) {
+  HitchHandler handler;
+  {
+    const std::lock_guard<std::mutex> lock(hitch_mutex_);
+    if (!hitch_handler_ ||
+        (last_hitch_.has_value() && now - *last_hitch_ < hitch_interval_)) {
+      return;
+    }
+    last_hitch_ = now;
+    handler = hitch_handler_;
+  }
+  handler();
+}
+
+// static
+std::string FlightRecorder::Encode(const std::vector<FlightRecord>& records) {
+  std::string out;
+  out.reserve(kHeaderSize + records.size() * kRecordSize);
+  out.append(kMagic, sizeof(kMagic));
+  PutUint(out, kVersion, 4);
+  PutUint(out, kRecordSize, 4);
+  PutUint(out, records.size(), 4);
+  for (const auto& record : records) {
+    PutUint(out, record.timestamp_ns, 8);
+    PutUint(out, record.instance_id, 4);
+    PutUint(out, static_cast<uint32_t>(record.type), 4);
+    PutUint(out, record.value, 8);
+  }
+  return out;
+}
+
+// static
+std::optional<std::vector<FlightRecord>> FlightRecorder::Decode(
+    std::string_view data) {
+  if (data.size() < kHeaderSize ||
+      data.substr(0, sizeof(kMagic)) !=
+          std::string_view(kMagic, sizeof(kMagic)) ||
+      GetUint(data, 4, 4) != kVersion) {
+    return std::nullopt;
+  }
+
+  // Newer writers may append fields to each record.
+  const auto record_size = GetUint(data, 8, 4);
+  const auto count = GetUint(data, 12, 4);
+  if (record_size < kRecordSize ||
+      (data.size() - kHeaderSize) / record_size < count) {
+    return std::nullopt;
+  }
+
+  std::vector<FlightRecord> records;
+  records.reserve(static_cast<size_t>(count));
+  for (size_t i = 0; i < count; ++i) {
+    const auto offset = kHeaderSize + i * record_size;
+    records.push_back(
+        {GetUint(data, offset, 8),
+         static_cast<uint32_t>(GetUint(data, offset + 8, 4)),
+         static_cast<FlightEventType>(GetUint(data, offset + 12, 4)),
+         GetUint(data, offset + 16, 8)});
+  }
+  return records;
+}
+
+// static
+std::string FlightRecorder::ToChromeTrace(
+    const std::vector<FlightRecord>& records, uint32_t process_id) {
+  std::ostringstream out;
+  out.setf(std::ios::fixed);
+  out.precision(3);
+  out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+  bool first = true;
+  for (const auto& record : records) {
+    if (!first) {
+      out << ',';
+    }
+    first = false;
+
+    // Instances are shown as threads; timestamps are in microseconds.
+    out << "{\"name\":\"" << GetEventName(record.type)
+        << "\",\"ph\":\"i\",\"s\":\"t\",\"ts\":"
+        << record.timestamp_ns / 1000.0 << ",\"pid\":" << process_id
+        << ",\"tid\":" << record.instance_id
+        << ",\"args\":{\"value\":" << record.value << "}}";
+  }
+
+  out << "]}";
+  return out.str();
+}
+
+}  // namespace util
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace util {
+
+enum class FlightEventType : uint32_t {
+  kFrameArrived = 1,
+  // value: 1 if dropped by the FPS limit, 2 if deferred by the frame budget.
+  kFrameDropped = 2,
+  // value: copy duration in nanoseconds.
+  kFrameCopied = 3,
+  // value: width << 32 | height of the served surface.
+  kDescriptorServed = 4,
+  // value: FlightInputKind.
+  kInputReceived = 5,
+  kInputDispatched = 6,
+  // value: width << 32 | height.
+  kResize = 7,
+};
+
+enum class FlightInputKind : uint64_t {
+  kCursorPos = 1,
+  kPointerButton = 2,
+  kPointerUpdate = 3,
+  kScroll = 4,
+};
+
+struct FlightRecord {
+  uint64_t timestamp_ns;
+  uint32_t instance_id;
+  FlightEventType type;
+  uint64_t value;
+};
+
+// Fixed-size ring of compact binary records that can be written
+// concurrently from any thread without locking. Once the ring is full, the
+// oldest records are overwritten.
+//
+// Each slot is guarded by a sequence number, so that snapshots taken while
+// records are being written skip torn slots instead of returning garbage.
+class FlightRecorder {
+ public:
+  typedef std::chrono::steady_clock Clock;
+  typedef std::function<void()> HitchHandler;
+
+  // |capacity| is rounded up to the next power of two.
+  explicit FlightRecorder(size_t capacity);
+
+  // The process-wide recorder all instances write to.
+  static FlightRecorder& Global();
+
+  void Record(uint32_t instance_id, FlightEventType type, uint64_t value = 0,
+              Clock::time_point now = Clock::now());
+
+  // Returns the records currently in the ring, oldest first.
+  std::vector<FlightRecord> Snapshot() const;
+
+  size_t capacity() const { return mask_ + 1; }
+
+  // Sets the handler that is called on the reporting thread when a hitch is
+  // reported, at most once per |min_interval|. Pass nullptr to remove it.
+  void SetHitchHandler(HitchHandler handler, Clock::duration min_interval);
+  void ReportHitch(Clock::time_point now = Clock::now());
+
+  // Portable snapshot file format: a 16 byte header ("WVFR", version,
+  // record size, record count) followed by the records, all little endian.
+  static std::string Encode(const std::vector<FlightRecord>& records);
+  static std::optional<std::vector<FlightRecord>> Decode(
+      std::string_view data);
+
+  // Converts records into Chrome trace instant events for offline analysis.
+  static std::string ToChromeTrace(const std::vector<FlightRecord>& records,
+                                   uint32_t process_id);
+
+ private:
+  struct Slot {
+    // 0 while empty, 2 * index + 1 while being written and 2 * index + 2
+    // once the record at ring index |index| is complete.
+    std::atomic<uint64_t> sequence = 0;
+    std::atomic<uint64_t> timestamp_ns = 0;
+    std::atomic<uint64_t> instance_and_type = 0;
+    std::atomic<uint64_t> value = 0;
+  };
+
+  size_t mask_;
+  std::unique_ptr<Slot[]> slots_;
+  std::atomic<uint64_t> head_ = 0;
+
+  std::mutex hitch_mutex_;
+  HitchHandler hitch_handler_;
+  Clock::duration hitch_interval_ = Clock::duration::zero();
+  std::optional<Clock::time_point> last_hitch_;
+};
+
+// Records an event in the global flight recorder.
+inline void RecordFlightEvent(uint32_t instance_id, FlightEventType type,
+                              uint64_t value = 0) {
+  FlightRecorder::Global().Record(instance_id, type, value);
+}
+
+}  // namespace util
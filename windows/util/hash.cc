@@ -0,0 +1,24 @@
+#include "hash.h"
+
+#include <cstring>
+
+namespace util {
+
+uint64_t Hash64(std::string_view data, uint64_t seed) {
+  constexpr uint64_t kMultiplier = 0x9e3779b97f4a7c15ull;
+  uint64_t hash = seed ^ (data.size() * kMultiplier);
+  size_t i = 0;
+  for (; i + 8 <= data.size(); i += 8) {
+    uint64_t word;
+    std::memcpy(&word, data.data() + i, sizeof(word));
+    hash = (hash ^ word) * kMultiplier;
+    hash ^= hash >> 32;
+  }
+  uint64_t tail = 0;
+  if (i < data.size()) {
+    std::memcpy(&tail, data.data() + i, data.size() - i);
+  }
+  return Mix64(hash ^ tail);
+}
+
+}  // namespace util
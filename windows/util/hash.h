@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+namespace util {
+
+// Finalizer of MurmurHash3: spreads every input bit over all output bits.
+inline uint64_t Mix64(uint64_t value) {
+  value ^= value >> 33;
+  value *= 0xff51afd7ed558ccdull;
+  value ^= value >> 33;
+  value *= 0xc4ceb9fe1a85ec53ull;
+  value ^= value >> 33;
+  return value;
+}
+
+// Fast non-cryptographic 64-bit hash of |data|, reading eight bytes per
+// step. Not suitable for data chosen to collide.
+uint64_t Hash64(std::string_view data, uint64_t seed = 0);
+
+}  // namespace util
@@ -0,0 +1,157 @@
+#include "http_headers.h"
+
+#include <algorithm>
+#include <iterator>
+
+namespace util {
+
+namespace {
+constexpr std::string_view kMonths[] = {"Jan", "Feb", "Mar", "Apr",
+                                        "May", "Jun", "Jul", "Aug",
+                                        "Sep", "Oct", "Nov", "Dec"};
+
+inline char ToLower(char c) {
+  return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+// Days since 1970-01-01 of a date in the proleptic Gregorian calendar.
+int64_t DaysFromCivil(int64_t year, int64_t month, int64_t day) {
+  year -= month <= 2;
+  const int64_t era = (year >= 0 ? year : year - 399) / 400;
+  const int64_t year_of_era = year - era * 400;
+  const int64_t day_of_year =
+      (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+  const int64_t day_of_era =
+      year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+  return era * 146097 + day_of_era - 719468;
+}
+
+// Parses |digits| digits at the start of |text| and removes them.
+bool ConsumeNumber(std::string_view& text, size_t digits, int64_t& value) {
+  uint64_t number = 0;
+  if (text.size() < digits || !ParseNumber(text.substr(0, digits), number)) {
+    return false;
+  }
+  text.remove_prefix(digits);
+  value = static_cast<int64_t>(number);
+  return true;
+}
+
+bool Consume(std::string_view& text, char c) {
+  if (text.empty() || text.front() != c) {
+    return false;
+  }
+  text.remove_prefix(1);
+  return true;
+}
+}  // namespace
+
+bool EqualsIgnoreCase(std::string_view a, std::string_view b) {
+  return a.size() == b.size() &&
+         std::equal(a.begin(), a.end(), b.begin(),
+                    [](char x, char y) { return ToLower(x) == ToLower(y); });
+}
+
+std::string_view Trim(std::string_view value) {
+  while (!value.empty() && (value.front() == ' ' || value.front() == '\t')) {
+    value.remove_prefix(1);
+  }
+  while (!value.empty() && (value.back() == ' ' || value.back() == '\t')) {
+    value.remove_suffix(1);
+  }
+  return value;
+}
+
+bool ParseNumber(std::string_view text, uint64_t& value) {
+  if (text.empty() || text.size() > 18) {
+    return false;
+  }
+  value = 0;
+  for (const char c : text) {
+    if (c < '0' || c > '9') {
+      return false;
+    }
+    value = value * 10 + static_cast<uint64_t>(c - '0');
+  }
+  return true;
+}
+
+void AddHeader(std::string& headers, std::string_view name,
+               std::string_view value) {
+  if (!headers.empty()) {
+    headers += "\r\n";
+  }
+  headers += name;
+  headers += ": ";
+  headers += value;
+}
+
+std::optional<std::string_view> FindHeader(std::string_view headers,
+                                           std::string_view name) {
+  std::optional<std::string_view> result;
+  ForEachHeader(headers, [&](std::string_view header_name,
+                             std::string_view value) {
+    if (EqualsIgnoreCase(header_name, name)) {
+      result = value;
+      return false;
+    }
+    return true;
+  });
+  return result;
+}
+
+std::optional<int64_t> ParseHttpDate(std::string_view value) {
+  // Both formats start with the day name, which is redundant.
+  auto text = Trim(value);
+  const auto comma = text.find(',');
+  if (comma == std::string_view::npos) {
+    return std::nullopt;
+  }
+  text = Trim(text.substr(comma + 1));
+
+  // "06 Nov 1994" or "06-Nov-94".
+  int64_t day = 0;
+  int64_t year = 0;
+  if (!ConsumeNumber(text, 2, day) || text.size() < 5) {
+    return std::nullopt;
+  }
+  const char separator = text.front();
+  if (separator != ' ' && separator != '-') {
+    return std::nullopt;
+  }
+  const auto month_name = text.substr(1, 3);
+  const auto month =
+      std::find(std::begin(kMonths), std::end(kMonths), month_name) -
+      std::begin(kMonths) + 1;
+  text.remove_prefix(4);
+  if (month > 12 || !Consume(text, separator)) {
+    return std::nullopt;
+  }
+  if (separator == ' ') {
+    if (!ConsumeNumber(text, 4, year)) {
+      return std::nullopt;
+    }
+  } else {
+    // Two digit years are taken to be within 50 years of 2000, close
+    // enough to what RFC 9110 asks for.
+    if (!ConsumeNumber(text, 2, year)) {
+      return std::nullopt;
+    }
+    year += year < 50 ? 2000 : 1900;
+  }
+
+  int64_t hour = 0;
+  int64_t minute = 0;
+  int64_t second = 0;
+  if (!Consume(text, ' ') || !ConsumeNumber(text, 2, hour) ||
+      !Consume(text, ':') || !ConsumeNumber(text, 2, minute) ||
+      !Consume(text, ':') || !ConsumeNumber(text, 2, second) ||
+      Trim(text) != "GMT" || day < 1 || day > 31 || hour > 23 ||
+      minute > 59 || second > 60) {
+    return std::nullopt;
+  }
+  return DaysFromCivil(year, month, day) * 86400 + hour * 3600 +
+         minute * 60 + second;
+}
+
+}  // namespace util
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace util {
+
+// Helpers for HTTP header blocks in the format WebView2 takes for responses:
+// "Name: value" lines separated by CRLF.
+
+bool EqualsIgnoreCase(std::string_view a, std::string_view b);
+
+// Removes leading and trailing spaces and tabs.
+std::string_view Trim(std::string_view value);
+
+// Parses a non-negative decimal number of at most 18 digits.
+bool ParseNumber(std::string_view text, uint64_t& value);
+
+// Appends the header |name| to |headers|.
+void AddHeader(std::string& headers, std::string_view name,
+               std::string_view value);
+
+// Calls |callback(name, value)| for each header in |headers|, with the
+// value trimmed. Stops early if |callback| returns false.
+template <typename Callback>
+void ForEachHeader(std::string_view headers, Callback callback) {
+  while (!headers.empty()) {
+    const auto end = headers.find("\r\n");
+    const auto line = headers.substr(0, end);
+    headers = end == std::string_view::npos ? std::string_view()
+                                            : headers.substr(end + 2);
+    const auto colon = line.find(':');
+    if (colon == std::string_view::npos) {
+      continue;
+    }
+    if (!callback(Trim(line.substr(0, colon)), Trim(line.substr(colon + 1)))) {
+      return;
+    }
+  }
+}
+
+// Returns the value of the first header |name| in |headers|.
+std::optional<std::string_view> FindHeader(std::string_view headers,
+                                           std::string_view name);
+
+// Parses an HTTP-date, either an IMF-fixdate such as
+// "Sun, 06 Nov 1994 08:49:37 GMT" or the obsolete RFC 850 format, into
+// seconds since the Unix epoch.
+std::optional<int64_t> ParseHttpDate(std::string_view value);
+
+}  // namespace util
@@ -0,0 +1,258 @@
+#pragma once
+
+#include <charconv>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <variant>
+
+#include "json_string.h"
+
+namespace util {
+
+// Decodes JSON text straight into a tree of |Value|s, such as
+// flutter::EncodableValue, without an intermediate DOM.
+//
+// |Value| must be constructible from std::monostate, bool, int32_t, int64_t,
+// double, std::string, |List| and |Map|. |List| must support push_back and
+// |Map| insert_or_assign with |Value| keys.
+//
+// Numbers are mapped like Dart's jsonDecode does: integers become int32_t or
+// int64_t depending on their size, and integers that don't fit into 64 bits,
+// -0 and numbers with a fraction or exponent become doubles. Duplicate keys
+// keep the last value. Unpaired surrogate escapes are replaced with U+FFFD,
+// as the result has to be valid UTF-8. The input must be valid UTF-8.
+template <typename Value, typename List, typename Map>
+class JsonDecoder {
+ public:
+  // Maximum nesting depth of arrays and objects.
+  static constexpr int kMaxDepth = 512;
+
+  // Returns std::nullopt if |json| is not a single well-formed JSON value.
+  static std::optional<Value> Decode(std::string_view json) {
+    JsonDecoder decoder(json);
+    Value value;
+    decoder.SkipWhitespace();
+    if (!decoder.ParseValue(value)) {
+      return std::nullopt;
+    }
+    decoder.SkipWhitespace();
+    if (decoder.pos_ != decoder.end_) {
+      return std::nullopt;
+    }
+    return value;
+  }
+
+ private:
+  const char* pos_;
+  const char* end_;
+  int depth_ = 0;
+
+  explicit JsonDecoder(std::string_view json)
+      : pos_(json.data()), end_(json.data() + json.size()) {}
+
+  void SkipWhitespace() {
+    while (pos_ != end_ &&
+           (*pos_ == ' ' || *pos_ == '\n' || *pos_ == '\r' || *pos_ == '\t')) {
+      ++pos_;
+    }
+  }
+
+  bool Consume(std::string_view literal) {
+    if (static_cast<size_t>(end_ - pos_) < literal.size() ||
+        std::memcmp(pos_, literal.data(), literal.size()) != 0) {
+      return false;
+    }
+    pos_ += literal.size();
+    return true;
+  }
+
+  bool ParseValue(Value& out) {
+    if (pos_ == end_) {
+      return false;
+    }
+    switch (*pos_) {
+      case '{':
+        return ParseObject(out);
+      case '[':
+        return ParseArray(out);
+      case '"': {
+        std::string string;
+        if (!ParseString(string)) {
+          return false;
+        }
+        out = Value(std::move(string));
+        return true;
+      }
+      case 't':
+        out = Value(true);
+        return Consume("true");
+      case 'f':
+        out = Value(false);
+        return Consume("false");
+      case 'n':
+        out = Value(std::monostate());
+        return Consume("null");
+      default:
+        return ParseNumber(out);
+    }
+  }
+
+  bool ParseObject(Value& out) {
+    if (++depth_ > kMaxDepth) {
+      return false;
+    }
+    ++pos_;
+    Map map;
+    SkipWhitespace();
+    if (pos_ != end_ && *pos_ == '}') {
+      ++pos_;
+    } else {
+      while (true) {
+        std::string key;
+        Value value;
+        if (pos_ == end_ || *pos_ != '"' || !ParseString(key)) {
+          return false;
+        }
+        SkipWhitespace();
+        if (pos_ == end_ || *pos_ != ':') {
+          return false;
+        }
+        ++pos_;
+        SkipWhitespace();
+        if (!ParseValue(value)) {
+          return false;
+        }
+        map.insert_or_assign(Value(std::move(key)), std::move(value));
+        SkipWhitespace();
+        if (pos_ == end_) {
+          return false;
+        }
+        if (*pos_++ == '}') {
+          break;
+        }
+        if (pos_[-1] != ',') {
+          return false;
+        }
+        SkipWhitespace();
+      }
+    }
+    --depth_;
+    out = Value(std::move(map));
+    return true;
+  }
+
+  bool ParseArray(Value& out) {
+    if (++depth_ > kMaxDepth) {
+      return false;
+    }
+    ++pos_;
+    List list;
+    SkipWhitespace();
+    if (pos_ != end_ && *pos_ == ']') {
+      ++pos_;
+    } else {
+      while (true) {
+        Value value;
+        if (!ParseValue(value)) {
+          return false;
+        }
+        list.push_back(std::move(value));
+        SkipWhitespace();
+        if (pos_ == end_) {
+          return false;
+        }
+        if (*pos_++ == ']') {
+          break;
+        }
+        if (pos_[-1] != ',') {
+          return false;
+        }
+        SkipWhitespace();
+      }
+    }
+    --depth_;
+    out = Value(std::move(list));
+    return true;
+  }
+
+  bool ParseString(std::string& out) {
+    ++pos_;
+    return JsonStringDecoder::Decode(pos_, end_, out);
+  }
+
+  static bool IsDigit(char c) { return c >= '0' && c <= '9'; }
+
+  bool ParseNumber(Value& out) {
+    const char* begin = pos_;
+    bool is_integer = true;
+    if (pos_ != end_ && *pos_ == '-') {
+      ++pos_;
+    }
+    if (pos_ == end_ || !IsDigit(*pos_)) {
+      return false;
+    }
+    if (*pos_ == '0') {
+      ++pos_;
+    } else {
+      while (pos_ != end_ && IsDigit(*pos_)) {
+        ++pos_;
+      }
+    }
+    if (pos_ != end_ && *pos_ == '.') {
+      is_integer = false;
+      ++pos_;
+      if (pos_ == end_ || !IsDigit(*pos_)) {
+        return false;
+      }
+      while (pos_ != end_ && IsDigit(*pos_)) {
+        ++pos_;
+      }
+    }
+    if (pos_ != end_ && (*pos_ == 'e' || *pos_ == 'E')) {
+      is_integer = false;
+      ++pos_;
+      if (pos_ != end_ && (*pos_ == '+' || *pos_ == '-')) {
+        ++pos_;
+      }
+      if (pos_ == end_ || !IsDigit(*pos_)) {
+        return false;
+      }
+      while (pos_ != end_ && IsDigit(*pos_)) {
+        ++pos_;
+      }
+    }
+
+    if (is_integer && std::string_view(begin, pos_ - begin) != "-0") {
+      int64_t value;
+      const auto [ptr, ec] = std::from_chars(begin, pos_, value);
+      if (ec == std::errc()) {
+        if (value >= std::numeric_limits<int32_t>::min() &&
+            value <= std::numeric_limits<int32_t>::max()) {
+          out = Value(static_cast<int32_t>(value));
+        } else {
+          out = Value(value);
+        }
+        return true;
+      }
+    }
+
+    double value;
+    const auto [ptr, ec] = std::from_chars(begin, pos_, value);
+    if (ec == std::errc::result_out_of_range) {
+      // Overflows to infinity and underflows to zero, like Dart does.
+      value = std::strtod(std::string(begin, pos_).c_str(), nullptr);
+    } else if (ec != std::errc()) {
+      return false;
+    }
+    out = Value(value);
+    return true;
+  }
+};
+
+}  // namespace util
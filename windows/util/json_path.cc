@@ -0,0 +1,244 @@
+#include "json_path.h"
+
+#include <charconv>
+#include <cstring>
+
+#include "json_string.h"
+
+namespace util {
+
+namespace {
+
+class Scanner {
+ public:
+  explicit Scanner(std::string_view json)
+      : pos_(json.data()), end_(json.data() + json.size()) {}
+
+  // Moves to the member |segment| of the object or to the element
+  // |segment| of the array at the current position.
+  bool Enter(std::string_view segment) {
+    SkipWhitespace();
+    if (pos_ == end_) {
+      return false;
+    }
+    if (*pos_ == '{') {
+      ++pos_;
+      return EnterMember(segment);
+    }
+    if (*pos_ == '[') {
+      ++pos_;
+      return EnterElement(segment);
+    }
+    return false;
+  }
+
+  // Moves into the array at the current position. Returns false if there is
+  // none.
+  bool EnterArray() {
+    if (!Consume('[')) {
+      return false;
+    }
+    SkipWhitespace();
+    return true;
+  }
+
+  // Moves past the next element of the array that is being iterated, and
+  // the comma after it. Returns std::nullopt at the end of the array.
+  std::optional<std::string_view> NextElement() {
+    if (Consume(']')) {
+      return std::nullopt;
+    }
+    const auto element = SkipValue();
+    if (!element || (!Consume(',') && (pos_ == end_ || *pos_ != ']'))) {
+      pos_ = end_;
+      return std::nullopt;
+    }
+    return element;
+  }
+
+  // Moves past the value at the current position and returns its text.
+  std::optional<std::string_view> SkipValue() {
+    SkipWhitespace();
+    const char* begin = pos_;
+    if (pos_ == end_) {
+      return std::nullopt;
+    }
+    if (*pos_ == '"') {
+      return SkipString();
+    }
+    if (*pos_ == '{' || *pos_ == '[') {
+      int depth = 0;
+      do {
+        if (pos_ == end_) {
+          return std::nullopt;
+        }
+        const char c = *pos_;
+        if (c == '"') {
+          if (!SkipString()) {
+            return std::nullopt;
+          }
+          continue;
+        }
+        if (c == '{' || c == '[') {
+          ++depth;
+        } else if (c == '}' || c == ']') {
+          --depth;
+        }
+        ++pos_;
+      } while (depth > 0);
+      return std::string_view(begin, pos_ - begin);
+    }
+    while (pos_ != end_ && *pos_ != ',' && *pos_ != '}' && *pos_ != ']' &&
+           !IsWhitespace(*pos_)) {
+      ++pos_;
+    }
+    if (pos_ == begin) {
+      return std::nullopt;
+    }
+    return std::string_view(begin, pos_ - begin);
+  }
+
+ private:
+  const char* pos_;
+  const char* end_;
+
+  static bool IsWhitespace(char c) {
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+  }
+
+  void SkipWhitespace() {
+    while (pos_ != end_ && IsWhitespace(*pos_)) {
+      ++pos_;
+    }
+  }
+
+  bool Consume(char c) {
+    SkipWhitespace();
+    if (pos_ == end_ || *pos_ != c) {
+      return false;
+    }
+    ++pos_;
+    return true;
+  }
+
+  // Moves past the string at the current position, which must start with a
+  // quote, and returns its text with the quotes.
+  //
+  // Jumps from quote to quote with memchr, which is much quicker than
+  // looking at each byte, since strings make up most of the params.
+  std::optional<std::string_view> SkipString() {
+    const char* begin = pos_++;
+    while (const auto quote = static_cast<const char*>(
+               std::memchr(pos_, '"', end_ - pos_))) {
+      pos_ = quote + 1;
+      // The quote is escaped if an odd number of backslashes precede it.
+      size_t backslashes = 0;
+      while (quote - backslashes > begin && quote[-1 - backslashes] == '\\') {
+        ++backslashes;
+      }
+      if (backslashes % 2 == 0) {
+        return std::string_view(begin, pos_ - begin);
+      }
+    }
+    pos_ = end_;
+    return std::nullopt;
+  }
+
+  static bool NameEquals(std::string_view text, std::string_view name) {
+    const auto raw = text.substr(1, text.size() - 2);
+    if (raw.find('\\') == std::string_view::npos) {
+      return raw == name;
+    }
+    const auto decoded = DecodeJsonString(text);
+    return decoded && *decoded == name;
+  }
+
+  bool EnterMember(std::string_view name) {
+    if (Consume('}')) {
+      return false;
+    }
+    while (true) {
+      SkipWhitespace();
+      if (pos_ == end_ || *pos_ != '"') {
+        return false;
+      }
+      const auto key = SkipString();
+      if (!key || !Consume(':')) {
+        return false;
+      }
+      if (NameEquals(*key, name)) {
+        return true;
+      }
+      if (!SkipValue() || !Consume(',')) {
+        return false;
+      }
+    }
+  }
+
+  bool EnterElement(std::string_view segment) {
+    size_t index;
+    const auto [ptr, ec] =
+        std::from_chars(segment.data(), segment.data() + segment.size(), index);
+    if (ec != std::errc() || ptr != segment.data() + segment.size() ||
+        Consume(']')) {
+      return false;
+    }
+    for (size_t i = 0; i < index; ++i) {
+      if (!SkipValue() || !Consume(',')) {
+        return false;
+      }
+    }
+    SkipWhitespace();
+    return pos_ != end_ && *pos_ != ']';
+  }
+};
+
+}  // namespace
+
+std::optional<std::string_view> FindJsonValue(std::string_view json,
+                                              std::string_view path) {
+  Scanner scanner(json);
+  if (!path.empty()) {
+    for (size_t begin = 0;;) {
+      const auto dot = path.find('.', begin);
+      if (!scanner.Enter(path.substr(
+              begin, dot == std::string_view::npos ? dot : dot - begin))) {
+        return std::nullopt;
+      }
+      if (dot == std::string_view::npos) {
+        break;
+      }
+      begin = dot + 1;
+    }
+  }
+  return scanner.SkipValue();
+}
+
+bool ForEachJsonElement(
+    std::string_view json,
+    const std::function<void(std::string_view)>& callback) {
+  Scanner scanner(json);
+  if (!scanner.EnterArray()) {
+    return false;
+  }
+  while (const auto element = scanner.NextElement()) {
+    callback(*element);
+  }
+  return true;
+}
+
+std::optional<std::string> DecodeJsonString(std::string_view text) {
+  if (text.size() < 2 || text.front() != '"') {
+    return std::nullopt;
+  }
+  std::string out;
+  out.reserve(text.size() - 2);
+  const char* pos = text.data() + 1;
+  const char* end = text.data() + text.size();
+  if (!JsonStringDecoder::Decode(pos, end, out) || pos != end) {
+    return std::nullopt;
+  }
+  return out;
+}
+
+}  // namespace util
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace util {
+
+// Returns the JSON text of the value at |path| in |json|, or std::nullopt if
+// there is none. |path| is a list of object member names and array indices
+// separated by dots, such as "request.headers" or "args.0.value"; an empty
+// path is the whole document.
+//
+// Only the values on the way to the result are parsed. The others are
+// skipped without being validated, so a malformed document may still yield
+// a value.
+std::optional<std::string_view> FindJsonValue(std::string_view json,
+                                              std::string_view path);
+
+// Calls |callback| with the JSON text of each element of the array |json|.
+// Returns false if |json| is not an array.
+bool ForEachJsonElement(std::string_view json,
+                        const std::function<void(std::string_view)>& callback);
+
+// Decodes the JSON string literal |text|, including its quotes, like
+// JsonDecoder does. Returns std::nullopt if it is not a well-formed string.
+std::optional<std::string> DecodeJsonString(std::string_view text);
+
+}  // namespace util
@@ -0,0 +1,172 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace util {
+
+// Decodes the contents of JSON string literals. Shared by JsonDecoder and
+// DecodeJsonString, so that both accept and produce the same strings.
+class JsonStringDecoder {
+ public:
+  // Decodes the string that starts at |pos|, just past its opening quote,
+  // appends its contents to |out| and moves |pos| past the closing quote.
+  // Unpaired surrogate escapes are replaced with U+FFFD, as the result has
+  // to be valid UTF-8. Returns false if the string contains a control
+  // character or an invalid escape, or isn't closed before |end|.
+  static bool Decode(const char*& pos, const char* end, std::string& out) {
+    while (true) {
+      const auto run = ScanPlainRun(pos, end);
+      out.append(pos, run);
+      pos += run;
+      if (pos == end) {
+        return false;
+      }
+      const char c = *pos++;
+      if (c == '"') {
+        return true;
+      }
+      if (c != '\\' || !DecodeEscape(pos, end, out)) {
+        // Unescaped control character or invalid escape.
+        return false;
+      }
+    }
+  }
+
+  // Returns the length of the prefix of [begin, end) that can be copied
+  // verbatim, i.e. that contains no quote, backslash or control character.
+  // Scans eight bytes at a time.
+  static size_t ScanPlainRun(const char* begin, const char* end) {
+    constexpr uint64_t kOnes = 0x0101010101010101;
+    constexpr uint64_t kHighBits = 0x8080808080808080;
+    const char* pos = begin;
+    while (end - pos >= 8) {
+      uint64_t word;
+      std::memcpy(&word, pos, 8);
+      const uint64_t quote = word ^ (kOnes * '"');
+      const uint64_t backslash = word ^ (kOnes * '\\');
+      // Sets the high bit of every byte that is zero, or below 0x20.
+      const uint64_t special = ((quote - kOnes) & ~quote) |
+                               ((backslash - kOnes) & ~backslash) |
+                               ((word - kOnes * 0x20) & ~word);
+      if (special & kHighBits) {
+        break;
+      }
+      pos += 8;
+    }
+    while (pos != end && *pos != '"' && *pos != '\\' &&
+           static_cast<unsigned char>(*pos) >= 0x20) {
+      ++pos;
+    }
+    return pos - begin;
+  }
+
+ private:
+  static bool ParseHex4(const char*& pos, const char* end, uint32_t& out) {
+    if (end - pos < 4) {
+      return false;
+    }
+    out = 0;
+    for (int i = 0; i < 4; ++i) {
+      const char c = *pos++;
+      out <<= 4;
+      if (c >= '0' && c <= '9') {
+        out |= c - '0';
+      } else if (c >= 'a' && c <= 'f') {
+        out |= c - 'a' + 10;
+      } else if (c >= 'A' && c <= 'F') {
+        out |= c - 'A' + 10;
+      } else {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  static void AppendUtf8(std::string& out, uint32_t code_point) {
+    if (code_point < 0x80) {
+      out.push_back(static_cast<char>(code_point));
+    } else if (code_point < 0x800) {
+      out.push_back(static_cast<char>(0xc0 | (code_point >> 6)));
+      out.push_back(static_cast<char>(0x80 | (code_point & 0x3f)));
+    } else if (code_point < 0x10000) {
+      out.push_back(static_cast<char>(0xe0 | (code_point >> 12)));
+      out.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3f)));
+      out.push_back(static_cast<char>(0x80 | (code_point & 0x3f)));
+    } else {
+      out.push_back(static_cast<char>(0xf0 | (code_point >> 18)));
+      out.push_back(static_cast<char>(0x80 | ((code_point >> 12) & 0x3f)));
+      out.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3f)));
+      out.push_back(static_cast<char>(0x80 | (code_point & 0x3f)));
+    }
+  }
+
+  // Decodes the escape sequence at |pos|, just past its backslash.
+  static bool DecodeEscape(const char*& pos, const char* end,
+                           std::string& out) {
+    if (pos == end) {
+      return false;
+    }
+    switch (*pos++) {
+      case '"':
+        out.push_back('"');
+        return true;
+      case '\\':
+        out.push_back('\\');
+        return true;
+      case '/':
+        out.push_back('/');
+        return true;
+      case 'b':
+        out.push_back('\b');
+        return true;
+      case 'f':
+        out.push_back('\f');
+        return true;
+      case 'n':
+        out.push_back('\n');
+        return true;
+      case 'r':
+        out.push_back('\r');
+        return true;
+      case 't':
+        out.push_back('\t');
+        return true;
+      case 'u':
+        break;
+      default:
+        return false;
+    }
+
+    uint32_t code_unit;
+    if (!ParseHex4(pos, end, code_unit)) {
+      return false;
+    }
+    while (code_unit >= 0xd800 && code_unit < 0xdc00 && end - pos >= 2 &&
+           pos[0] == '\\' && pos[1] == 'u') {
+      pos += 2;
+      uint32_t low;
+      if (!ParseHex4(pos, end, low)) {
+        return false;
+      }
+      if (low >= 0xdc00 && low < 0xe000) {
+        AppendUtf8(out,
+                   0x10000 + ((code_unit - 0xd800) << 10) + (low - 0xdc00));
+        return true;
+      }
+      // The high surrogate is unpaired; the next escape is handled on its
+      // own.
+      AppendUtf8(out, 0xfffd);
+      code_unit = low;
+    }
+    if (code_unit >= 0xd800 && code_unit < 0xe000) {
+      code_unit = 0xfffd;
+    }
+    AppendUtf8(out, code_unit);
+    return true;
+  }
+};
+
+}  // namespace util
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace util {
+
+// Reuses objects that are expensive to create, such as the COM objects
+// allocated by the WebView2 environment, for a small set of short-lived
+// keys such as pointer ids.
+//
+// Each key in use holds one object. Releasing a key returns its object to
+// an idle list from which new keys are served. Every object handed out is
+// reset first, so callers never see state left behind by a previous use.
+// The pool holds at most |max_size| objects; if more keys are in use, the
+// least recently used key loses its object.
+//
+// |Value| must be copyable and convert to false if creation failed, e.g. a
+// COM smart pointer. Not thread-safe.
+template <typename Key, typename Value>
+class KeyedObjectPool {
+ public:
+  typedef std::function<Value()> Factory;
+  typedef std::function<void(Value&)> Resetter;
+
+  KeyedObjectPool(Factory factory, Resetter resetter, size_t max_size)
+      : factory_(std::move(factory)),
+        resetter_(std::move(resetter)),
+        max_size_(max_size) {}
+
+  // Returns the reset object for |key|, reusing the one |key| already holds
+  // or an idle one if possible. Returns a value that converts to false if a
+  // new object had to be created and creation failed.
+  Value Acquire(const Key& key) {
+    const auto use = ++use_counter_;
+    for (auto& entry : in_use_) {
+      if (entry.key == key) {
+        entry.last_use = use;
+        resetter_(entry.value);
+        ++reused_count_;
+        return entry.value;
+      }
+    }
+
+    Value value;
+    if (!idle_.empty()) {
+      value = std::move(idle_.back());
+      idle_.pop_back();
+      resetter_(value);
+      ++reused_count_;
+    } else {
+      value = factory_();
+      if (!value) {
+        return value;
+      }
+      ++created_count_;
+    }
+
+    if (in_use_.size() >= max_size_ && !in_use_.empty()) {
+      EvictLeastRecentlyUsed();
+    }
+    if (in_use_.size() < max_size_) {
+      in_use_.push_back({key, value, use});
+    }
+    return value;
+  }
+
+  // Returns the object held by |key| to the idle list.
+  void Release(const Key& key) {
+    for (auto it = in_use_.begin(); it != in_use_.end(); ++it) {
+      if (it->key == key) {
+        idle_.push_back(std::move(it->value));
+        in_use_.erase(it);
+        return;
+      }
+    }
+  }
+
+  // Releases all objects.
+  void Clear() {
+    in_use_.clear();
+    idle_.clear();
+  }
+
+  size_t size() const { return in_use_.size() + idle_.size(); }
+  size_t idle_size() const { return idle_.size(); }
+  uint64_t created_count() const { return created_count_; }
+  uint64_t reused_count() const { return reused_count_; }
+
+ private:
+  struct Entry {
+    Key key;
+    Value value;
+    uint64_t last_use;
+  };
+
+  Factory factory_;
+  Resetter resetter_;
+  size_t max_size_;
+  std::vector<Entry> in_use_;
+  std::vector<Value> idle_;
+  uint64_t use_counter_ = 0;
+  uint64_t created_count_ = 0;
+  uint64_t reused_count_ = 0;
+
+  void EvictLeastRecentlyUsed() {
+    auto oldest = in_use_.begin();
+    for (auto it = in_use_.begin(); it != in_use_.end(); ++it) {
+      if (it->last_use < oldest->last_use) {
+        oldest = it;
+      }
+    }
+    in_use_.erase(oldest);
+  }
+};
+
+}  // namespace util
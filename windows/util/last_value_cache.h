@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+
+namespace util {
+
+// Remembers the last value reported for a state-like event so that exact
+// duplicates can be dropped before they are encoded and sent to Dart.
+template <typename T>
+class LastValueCache {
+ public:
+  // Returns true if |value| differs from the cached value (or nothing has been
+  // cached yet) and stores it. Returns false and bumps the suppression counter
+  // otherwise.
+  bool Update(const T& value) {
+    if (value_.has_value() && *value_ == value) {
+      ++suppressed_count_;
+      return false;
+    }
+    value_ = value;
+    return true;
+  }
+
+  // Forgets the cached value so that the next update is always reported.
+  // The suppression counter is kept.
+  void Reset() { value_.reset(); }
+
+  const std::optional<T>& value() const { return value_; }
+  uint64_t suppressed_count() const { return suppressed_count_; }
+
+ private:
+  std::optional<T> value_;
+  uint64_t suppressed_count_ = 0;
+};
+
+}  // namespace util
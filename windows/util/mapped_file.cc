@@ -0,0 +1,103 @@
+#include "mapped_file.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+
+#include "string_converter.h"
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace util {
+
+#if defined(_WIN32)
+
+std::unique_ptr<MappedFile> MappedFile::Open(const std::string& path) {
+  const HANDLE file =
+      CreateFileW(ScratchUtf16(path).c_str(), GENERIC_READ, FILE_SHARE_READ,
+                  nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    return nullptr;
+  }
+
+  std::unique_ptr<MappedFile> mapped_file(new MappedFile());
+  mapped_file->file_ = file;
+
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(file, &size) ||
+      static_cast<uint64_t>(size.QuadPart) > SIZE_MAX) {
+    return nullptr;
+  }
+  // Empty files can't be mapped.
+  if (size.QuadPart == 0) {
+    return mapped_file;
+  }
+
+  mapped_file->mapping_ =
+      CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (!mapped_file->mapping_) {
+    return nullptr;
+  }
+  mapped_file->data_ = static_cast<const uint8_t*>(
+      MapViewOfFile(mapped_file->mapping_, FILE_MAP_READ, 0, 0, 0));
+  if (!mapped_file->data_) {
+    return nullptr;
+  }
+  mapped_file->size_ = static_cast<size_t>(size.QuadPart);
+  return mapped_file;
+}
+
+MappedFile::~MappedFile() {
+  if (data_) {
+    UnmapViewOfFile(data_);
+  }
+  if (mapping_) {
+    CloseHandle(mapping_);
+  }
+  if (file_) {
+    CloseHandle(file_);
+  }
+}
+
+#else
+
+std::unique_ptr<MappedFile> MappedFile::Open(const std::string& path) {
+  const int file = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (file < 0) {
+    return nullptr;
+  }
+
+  std::unique_ptr<MappedFile> mapped_file(new MappedFile());
+  struct stat status;
+  if (fstat(file, &status) != 0) {
+    close(file);
+    return nullptr;
+  }
+  // Empty files can't be mapped.
+  if (status.st_size > 0) {
+    void* data = mmap(nullptr, static_cast<size_t>(status.st_size),
+                      PROT_READ, MAP_SHARED, file, 0);
+    if (data == MAP_FAILED) {
+      close(file);
+      return nullptr;
+    }
+    mapped_file->data_ = static_cast<const uint8_t*>(data);
+    mapped_file->size_ = static_cast<size_t>(status.st_size);
+  }
+  // The mapping stays valid after the file is closed.
+  close(file);
+  return mapped_file;
+}
+
+MappedFile::~MappedFile() {
+  if (data_) {
+    munmap(const_cast<uint8_t*>(data_), size_);
+  }
+}
+
+#endif
+
+}  // namespace util
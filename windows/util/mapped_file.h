@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace util {
+
+// A read-only memory mapping of a whole file. Pages are only read from disk
+// when they are first accessed, and stay shared with other mappings of the
+// same file.
+class MappedFile {
+ public:
+  // Maps the file at |path| (UTF-8). Returns nullptr if it can't be opened
+  // or mapped.
+  static std::unique_ptr<MappedFile> Open(const std::string& path);
+
+  ~MappedFile();
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  const uint8_t* data() const { return data_; }
+  size_t size() const { return size_; }
+
+ private:
+  const uint8_t* data_ = nullptr;
+  size_t size_ = 0;
+#if defined(_WIN32)
+  void* file_ = nullptr;
+  void* mapping_ = nullptr;
+#endif
+
+  MappedFile() = default;
+};
+
+}  // namespace util
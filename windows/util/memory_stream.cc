@@ -0,0 +1,116 @@
+#include "memory_stream.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <utility>
+
+namespace util {
+
+MemoryStream::MemoryStream(const uint8_t* data, size_t size,
+                           std::shared_ptr<const void> owner)
+    : data_(data), size_(size), owner_(std::move(owner)) {}
+
+STDMETHODIMP MemoryStream::Read(void* buffer, ULONG size, ULONG* read) {
+  const auto count =
+      static_cast<ULONG>(std::min<size_t>(size, size_ - position_));
+  std::memcpy(buffer, data_ + position_, count);
+  position_ += count;
+  if (read) {
+    *read = count;
+  }
+  return count < size ? S_FALSE : S_OK;
+}
+
+STDMETHODIMP MemoryStream::Write(const void* buffer, ULONG size,
+                                 ULONG* written) {
+  return STG_E_ACCESSDENIED;
+}
+
+STDMETHODIMP MemoryStream::Seek(LARGE_INTEGER move, DWORD origin,
+                                ULARGE_INTEGER* position) {
+  int64_t base = 0;
+  switch (origin) {
+    case STREAM_SEEK_SET:
+      break;
+    case STREAM_SEEK_CUR:
+      base = static_cast<int64_t>(position_);
+      break;
+    case STREAM_SEEK_END:
+      base = static_cast<int64_t>(size_);
+      break;
+    default:
+      return STG_E_INVALIDFUNCTION;
+  }
+  const int64_t target = base + move.QuadPart;
+  if (target < 0) {
+    return STG_E_INVALIDFUNCTION;
+  }
+  // Seeking past the end is allowed; reads there return nothing.
+  position_ = std::min(static_cast<size_t>(target), size_);
+  if (position) {
+    position->QuadPart = position_;
+  }
+  return S_OK;
+}
+
+STDMETHODIMP MemoryStream::SetSize(ULARGE_INTEGER size) {
+  return STG_E_ACCESSDENIED;
+}
+
+STDMETHODIMP MemoryStream::CopyTo(IStream* stream, ULARGE_INTEGER size,
+                                  ULARGE_INTEGER* read,
+                                  ULARGE_INTEGER* written) {
+  const auto count = static_cast<ULONG>(
+      std::min<uint64_t>({size.QuadPart, size_ - position_, ULONG_MAX}));
+  ULONG count_written = 0;
+  const auto hr = stream->Write(data_ + position_, count, &count_written);
+  position_ += count;
+  if (read) {
+    read->QuadPart = count;
+  }
+  if (written) {
+    written->QuadPart = count_written;
+  }
+  return hr;
+}
+
+STDMETHODIMP MemoryStream::Commit(DWORD flags) { return S_OK; }
+
+STDMETHODIMP MemoryStream::Revert() { return STG_E_REVERTED; }
+
+STDMETHODIMP MemoryStream::LockRegion(ULARGE_INTEGER offset,
+                                      ULARGE_INTEGER size, DWORD type) {
+  return STG_E_INVALIDFUNCTION;
+}
+
+STDMETHODIMP MemoryStream::UnlockRegion(ULARGE_INTEGER offset,
+                                        ULARGE_INTEGER size, DWORD type) {
+  return STG_E_INVALIDFUNCTION;
+}
+
+STDMETHODIMP MemoryStream::Stat(STATSTG* stat, DWORD flags) {
+  if (!stat) {
+    return STG_E_INVALIDPOINTER;
+  }
+  *stat = {};
+  stat->type = STGTY_STREAM;
+  stat->cbSize.QuadPart = size_;
+  stat->grfMode = STGM_READ;
+  return S_OK;
+}
+
+STDMETHODIMP MemoryStream::Clone(IStream** stream) {
+  if (!stream) {
+    return STG_E_INVALIDPOINTER;
+  }
+  auto clone = Microsoft::WRL::Make<MemoryStream>(data_, size_, owner_);
+  if (!clone) {
+    return E_OUTOFMEMORY;
+  }
+  clone->position_ = position_;
+  *stream = clone.Detach();
+  return S_OK;
+}
+
+}  // namespace util
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <objidl.h>
+#include <wrl.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace util {
+
+// Read-only IStream over memory owned by |owner|, e.g. a memory-mapped
+// file, so that WebView2 can read a response body without a copy.
+class MemoryStream
+    : public Microsoft::WRL::RuntimeClass<
+          Microsoft::WRL::RuntimeClassFlags<Microsoft::WRL::ClassicCom>,
+          Microsoft::WRL::ChainInterfaces<IStream, ISequentialStream>> {
+ public:
+  MemoryStream(const uint8_t* data, size_t size,
+               std::shared_ptr<const void> owner);
+
+  // ISequentialStream
+  STDMETHODIMP Read(void* buffer, ULONG size, ULONG* read) override;
+  STDMETHODIMP Write(const void* buffer, ULONG size, ULONG* written) override;
+
+  // IStream
+  STDMETHODIMP Seek(LARGE_INTEGER move, DWORD origin,
+                    ULARGE_INTEGER* position) override;
+  STDMETHODIMP SetSize(ULARGE_INTEGER size) override;
+  STDMETHODIMP CopyTo(IStream* stream, ULARGE_INTEGER size,
+                      ULARGE_INTEGER* read, ULARGE_INTEGER* written) override;
+  STDMETHODIMP Commit(DWORD flags) override;
+  STDMETHODIMP Revert() override;
+  STDMETHODIMP LockRegion(ULARGE_INTEGER offset, ULARGE_INTEGER size,
+                          DWORD type) override;
+  STDMETHODIMP UnlockRegion(ULARGE_INTEGER offset, ULARGE_INTEGER size,
+                            DWORD type) override;
+  STDMETHODIMP Stat(STATSTG* stat, DWORD flags) override;
+  STDMETHODIMP Clone(IStream** stream) override;
+
+ private:
+  const uint8_t* data_;
+  size_t size_;
+  size_t position_ = 0;
+  std::shared_ptr<const void> owner_;
+};
+
+}  // namespace util
@@ -0,0 +1,153 @@
+#include "perfect_hash.h"
+
+#include <algorithm>
+#include <iterator>
+
+#include "hash.h"
+
+namespace util {
+
+namespace {
+// Average number of keys per bucket. Larger buckets make the index smaller
+// and slower to build.
+constexpr size_t kKeysPerBucket = 4;
+// The table has this many slots per key. Spare slots make it much quicker
+// to place the last buckets.
+constexpr double kSlotsPerKey = 1.25;
+// Attempts per bucket before starting over with a new hash seed.
+constexpr uint32_t kMaxBucketSeed = 1 << 16;
+static_assert(kMaxBucketSeed - 1 <= UINT16_MAX);
+constexpr int kMaxAttempts = 8;
+
+constexpr uint64_t kMultiplier = 0x9e3779b97f4a7c15ull;
+
+// Maps |value| to [0, range) without a division.
+inline uint32_t Reduce(uint32_t value, size_t range) {
+  return static_cast<uint32_t>((static_cast<uint64_t>(value) * range) >> 32);
+}
+
+inline uint32_t GetBucket(uint64_t hash, size_t bucket_count) {
+  return Reduce(static_cast<uint32_t>(hash >> 32), bucket_count);
+}
+
+inline uint32_t GetSlot(uint64_t hash, uint32_t bucket_seed,
+                        size_t slot_count) {
+  const auto slot_hash = Mix64(hash + bucket_seed * kMultiplier);
+  return Reduce(static_cast<uint32_t>(slot_hash), slot_count);
+}
+}  // namespace
+
+std::optional<PerfectHashIndex> PerfectHashIndex::Build(
+    const std::vector<std::string_view>& keys) {
+  if (keys.size() >= kNotFound) {
+    return std::nullopt;
+  }
+
+  PerfectHashIndex index;
+  index.size_ = keys.size();
+  if (keys.empty()) {
+    return index;
+  }
+
+  const size_t bucket_count =
+      (keys.size() + kKeysPerBucket - 1) / kKeysPerBucket;
+  const size_t slot_count =
+      static_cast<size_t>(keys.size() * kSlotsPerKey) + 1;
+  std::vector<uint64_t> hashes(keys.size());
+  // The keys of each bucket, laid out bucket after bucket.
+  std::vector<uint32_t> bucket_starts(bucket_count + 1);
+  std::vector<uint32_t> bucket_keys(keys.size());
+  std::vector<uint32_t> order(bucket_count);
+  uint32_t candidate_slots[64];
+
+  for (int attempt = 0; attempt < kMaxAttempts; ++attempt) {
+    index.seed_ = Mix64(attempt + 1);
+    index.bucket_seeds_.assign(bucket_count, 0);
+    index.slots_.assign(slot_count, kNotFound);
+
+    std::fill(bucket_starts.begin(), bucket_starts.end(), 0);
+    for (uint32_t i = 0; i < keys.size(); ++i) {
+      hashes[i] = Hash64(keys[i], index.seed_);
+      ++bucket_starts[GetBucket(hashes[i], bucket_count) + 1];
+    }
+    size_t max_bucket_size = 0;
+    for (size_t i = 0; i < bucket_count; ++i) {
+      max_bucket_size = std::max<size_t>(max_bucket_size, bucket_starts[i + 1]);
+      bucket_starts[i + 1] += bucket_starts[i];
+    }
+    if (max_bucket_size > std::size(candidate_slots)) {
+      continue;
+    }
+    std::vector<uint32_t> bucket_ends(bucket_starts.begin(),
+                                      bucket_starts.end() - 1);
+    for (uint32_t i = 0; i < keys.size(); ++i) {
+      bucket_keys[bucket_ends[GetBucket(hashes[i], bucket_count)]++] = i;
+    }
+
+    // The largest buckets are placed first, while most slots are free.
+    for (uint32_t i = 0; i < bucket_count; ++i) {
+      order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(),
+                     [&bucket_starts](uint32_t a, uint32_t b) {
+                       return bucket_starts[a + 1] - bucket_starts[a] >
+                              bucket_starts[b + 1] - bucket_starts[b];
+                     });
+
+    bool placed_all = true;
+    for (const auto bucket : order) {
+      const auto members = bucket_keys.data() + bucket_starts[bucket];
+      const size_t size = bucket_starts[bucket + 1] - bucket_starts[bucket];
+      if (size == 0) {
+        break;
+      }
+
+      bool placed = false;
+      for (uint32_t bucket_seed = 0; bucket_seed < kMaxBucketSeed;
+           ++bucket_seed) {
+        size_t candidates = 0;
+        for (; candidates < size; ++candidates) {
+          const auto slot =
+              GetSlot(hashes[members[candidates]], bucket_seed, slot_count);
+          if (index.slots_[slot] != kNotFound ||
+              std::find(candidate_slots, candidate_slots + candidates,
+                        slot) != candidate_slots + candidates) {
+            break;
+          }
+          candidate_slots[candidates] = slot;
+        }
+        if (candidates == size) {
+          for (size_t i = 0; i < size; ++i) {
+            index.slots_[candidate_slots[i]] = members[i];
+          }
+          index.bucket_seeds_[bucket] = static_cast<uint16_t>(bucket_seed);
+          placed = true;
+          break;
+        }
+      }
+      if (!placed) {
+        placed_all = false;
+        break;
+      }
+    }
+    if (placed_all) {
+      return index;
+    }
+  }
+  return std::nullopt;
+}
+
+uint32_t PerfectHashIndex::Find(std::string_view key) const {
+  if (slots_.empty()) {
+    return kNotFound;
+  }
+  return slots_[FindSlot(key)];
+}
+
+uint32_t PerfectHashIndex::FindSlot(std::string_view key) const {
+  const auto hash = Hash64(key, seed_);
+  const auto bucket_seed = bucket_seeds_[GetBucket(hash, bucket_seeds_.size())];
+  return GetSlot(hash, bucket_seed, slots_.size());
+}
+
+}  // namespace util
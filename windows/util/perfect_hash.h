@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace util {
+
+// Perfect hash index over a fixed set of distinct string keys, built with
+// hash and displace: keys are grouped into buckets by one hash of the key,
+// and each bucket is given a seed under which a second hash puts all of its
+// keys into free slots.
+//
+// A lookup hashes the key once and reads two arrays, no matter how many keys
+// there are. It returns the only key the queried key can be, so callers must
+// still compare the two.
+class PerfectHashIndex {
+ public:
+  static constexpr uint32_t kNotFound = UINT32_MAX;
+
+  PerfectHashIndex() = default;
+
+  // Returns std::nullopt if no index could be found, e.g. because |keys|
+  // contains duplicates.
+  static std::optional<PerfectHashIndex> Build(
+      const std::vector<std::string_view>& keys);
+
+  // Returns the position in the keys passed to Build of the only key that
+  // |key| may be equal to, or kNotFound if there is none.
+  uint32_t Find(std::string_view key) const;
+
+  // Returns the slot |key| maps to. Callers that store their values in slot
+  // order, with key_at(slot) giving the value of each slot, look up with
+  // FindSlot and skip reading the slot table. Requires slot_count() > 0.
+  uint32_t FindSlot(std::string_view key) const;
+  // Returns the position of the key in |slot|, or kNotFound if it's free.
+  uint32_t key_at(uint32_t slot) const { return slots_[slot]; }
+  size_t slot_count() const { return slots_.size(); }
+
+  size_t size() const { return size_; }
+
+ private:
+  uint64_t seed_ = 0;
+  size_t size_ = 0;
+  // Seed of the slot hash of each bucket. Seeds are tried up to 2^16, so
+  // 16 bits keep the table small enough to stay in cache.
+  std::vector<uint16_t> bucket_seeds_;
+  // Position of the key in each slot, or kNotFound.
+  std::vector<uint32_t> slots_;
+};
+
+}  // namespace util
@@ -58,7 +58,10 @@ RoHelper::RoHelper(RO_INIT_TYPE init_type)
       mFpRoUninitialize(nullptr),
       mWinRtAvailable(false),
       mComBaseModule(nullptr),
-      mCoreMessagingModule(nullptr) {
+      mCoreMessagingModule(nullptr),
+      mFactoryCache([this](const ActivationFactoryKey& key) {
+        return ResolveActivationFactory(key);
+      }) {
 #ifdef WINUWP
   mFpWindowsCreateStringReference = &::WindowsCreateStringReference;
   mFpRoInitialize = &::RoInitialize;
@@ -125,6 +128,9 @@ RoHelper::RoHelper(RO_INIT_TYPE init_type)
 }
 
 RoHelper::~RoHelper() {
+  // Factories must be released before WinRT is uninitialized.
+  mFactoryCache.Clear();
+
 #ifndef WINUWP
   if (mWinRtAvailable) {
     RoUninitialize();
@@ -211,6 +217,23 @@ HRESULT RoHelper::GetActivationFactory(const HSTRING act,
   return hr;
 }
 
+winrt::com_ptr<::IUnknown> RoHelper::ResolveActivationFactory(
+    const ActivationFactoryKey& key) {
+  HSTRING className;
+  HSTRING_HEADER classNameHeader;
+  if (FAILED(GetStringReference(key.class_name.c_str(), &className,
+                                &classNameHeader))) {
+    return nullptr;
+  }
+
+  winrt::com_ptr<::IUnknown> factory;
+  if (FAILED(GetActivationFactory(className, key.interface_id,
+                                  factory.put_void()))) {
+    return nullptr;
+  }
+  return factory;
+}
+
 HRESULT RoHelper::WindowsCompareStringOrdinal(HSTRING one, HSTRING two,
                                               int* result) {
   if (!mWinRtAvailable) {
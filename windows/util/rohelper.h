@@ -41,12 +41,44 @@
 #include <dispatcherqueue.h>
 #include <roapi.h>
 #include <windows.ui.composition.interop.h>
+#include <winrt/base.h>
+
+#include <cstring>
+#include <string>
+
+#include "factory_cache.h"
 
 namespace rx {
+// Identifies an activation factory by runtime class and interface.
+struct ActivationFactoryKey {
+  std::wstring class_name;
+  IID interface_id;
+
+  bool operator<(const ActivationFactoryKey& other) const {
+    if (class_name != other.class_name) {
+      return class_name < other.class_name;
+    }
+    return std::memcmp(&interface_id, &other.interface_id, sizeof(IID)) < 0;
+  }
+};
+
 class RoHelper {
  public:
   RoHelper(RO_INIT_TYPE init_type);
   ~RoHelper();
+
+  // Returns the activation factory of |class_name| for interface |T|.
+  // Factories are resolved once and shared, so this is cheap to call
+  // repeatedly. Returns nullptr on failure.
+  template <typename T>
+  winrt::com_ptr<T> GetActivationFactory(PCWSTR class_name) {
+    const auto factory = mFactoryCache.Get({class_name, __uuidof(T)});
+    winrt::com_ptr<T> result;
+    // The cached pointer was queried for |T|.
+    result.copy_from(static_cast<T*>(factory.get()));
+    return result;
+  }
+
   bool WinRtAvailable() const;
   bool SupportedWindowsRelease();
   HRESULT GetStringReference(PCWSTR source, HSTRING* act,
@@ -93,5 +125,10 @@ class RoHelper {
 
   HMODULE mComBaseModule;
   HMODULE mCoreMessagingModule;
+
+  util::FactoryCache<ActivationFactoryKey, winrt::com_ptr<::IUnknown>>
+      mFactoryCache;
+  winrt::com_ptr<::IUnknown> ResolveActivationFactory(
+      const ActivationFactoryKey& key);
 };
 }  // namespace rx
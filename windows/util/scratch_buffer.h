@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+
+namespace util {
+
+// Reusable buffer for short-lived temporaries, such as strings that are
+// converted only to be passed to an API that copies them.
+//
+// The buffer grows as needed and is kept between uses, so repeated
+// conversions of similar size don't allocate. It tracks the largest size
+// used over a window of |kShrinkWindow| uses and releases its memory at the
+// end of a window if that high-water mark is well below its capacity, so a
+// single large conversion doesn't pin memory forever.
+template <typename CharT>
+class ScratchBuffer {
+ public:
+  // Number of uses the high-water mark is tracked over.
+  static constexpr size_t kShrinkWindow = 64;
+  // Capacity that is always kept, regardless of use.
+  static constexpr size_t kRetainedCapacity = 4096;
+
+  ScratchBuffer() = default;
+  ScratchBuffer(const ScratchBuffer&) = delete;
+  ScratchBuffer& operator=(const ScratchBuffer&) = delete;
+
+  // Returns storage for at least |size| characters, valid until the next
+  // call to Acquire.
+  CharT* Acquire(size_t size) {
+    in_use_ = size;
+    if (size > capacity_) {
+      size_t capacity = capacity_ ? capacity_ : 256;
+      while (capacity < size) {
+        capacity *= 2;
+      }
+      data_.reset(new CharT[capacity]);
+      capacity_ = capacity;
+    }
+    return data_.get();
+  }
+
+  // Ends the use started by the last call to Acquire.
+  void Release() {
+    if (in_use_ > high_water_mark_) {
+      high_water_mark_ = in_use_;
+    }
+    in_use_ = 0;
+    if (++uses_ < kShrinkWindow) {
+      return;
+    }
+
+    if (capacity_ > kRetainedCapacity && high_water_mark_ < capacity_ / 4) {
+      data_.reset();
+      capacity_ = 0;
+    }
+    uses_ = 0;
+    high_water_mark_ = 0;
+  }
+
+  size_t capacity() const { return capacity_; }
+  size_t high_water_mark() const { return high_water_mark_; }
+
+ private:
+  std::unique_ptr<CharT[]> data_;
+  size_t capacity_ = 0;
+  size_t in_use_ = 0;
+  size_t high_water_mark_ = 0;
+  size_t uses_ = 0;
+};
+
+}  // namespace util
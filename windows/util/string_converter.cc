@@ -1,29 +1,47 @@
 #include "string_converter.h"
 
-#include <windows.h>
+#include "scratch_buffer.h"
+#include "utf_transcoder.h"
 
 namespace util {
+
+static_assert(sizeof(wchar_t) == sizeof(char16_t),
+              "wchar_t is expected to hold UTF-16 code units");
+
+namespace {
+// Number of ScratchUtf16 instances that can be alive at once on a thread
+// before falling back to allocating.
+constexpr int kMaxScratchDepth = 4;
+
+struct ScratchState {
+  ScratchBuffer<wchar_t> buffers[kMaxScratchDepth];
+  int depth = 0;
+};
+
+ScratchState& GetScratchState() {
+  thread_local ScratchState state;
+  return state;
+}
+}  // namespace
+
 std::string Utf8FromUtf16(std::wstring_view utf16_string) {
   if (utf16_string.empty()) {
     return std::string();
   }
 
-  auto src_length = static_cast<int>(utf16_string.size());
-  int target_length =
-      ::WideCharToMultiByte(CP_UTF8, WC_ERR_INVALID_CHARS, utf16_string.data(),
-                            src_length, nullptr, 0, nullptr, nullptr);
-
+  // Transcode in a single pass into a buffer sized for the worst case
+  // instead of measuring the output first.
   std::string utf8_string;
-  if (target_length <= 0 || target_length > utf8_string.max_size()) {
-    return utf8_string;
-  }
-  utf8_string.resize(target_length);
-  int converted_length = ::WideCharToMultiByte(
-      CP_UTF8, WC_ERR_INVALID_CHARS, utf16_string.data(), src_length,
-      utf8_string.data(), target_length, nullptr, nullptr);
-  if (converted_length == 0) {
+  utf8_string.resize(MaxUtf8LengthForUtf16(utf16_string.size()));
+  auto converted_length = TranscodeUtf16ToUtf8(
+      std::u16string_view(
+          reinterpret_cast<const char16_t*>(utf16_string.data()),
+          utf16_string.size()),
+      utf8_string.data());
+  if (!converted_length) {
     return std::string();
   }
+  utf8_string.resize(*converted_length);
   return utf8_string;
 }
 
@@ -32,23 +50,41 @@ std::wstring Utf16FromUtf8(std::string_view utf8_string) {
     return std::wstring();
   }
 
-  auto src_length = static_cast<int>(utf8_string.size());
-  int target_length =
-      ::MultiByteToWideChar(CP_UTF8, MB_ERR_INVALID_CHARS, utf8_string.data(),
-                            src_length, nullptr, 0);
-
   std::wstring utf16_string;
-  if (target_length <= 0 || target_length > utf16_string.max_size()) {
-    return utf16_string;
-  }
-  utf16_string.resize(target_length);
-  int converted_length =
-      ::MultiByteToWideChar(CP_UTF8, MB_ERR_INVALID_CHARS, utf8_string.data(),
-                            src_length, utf16_string.data(), target_length);
-  if (converted_length == 0) {
+  utf16_string.resize(MaxUtf16LengthForUtf8(utf8_string.size()));
+  auto converted_length = TranscodeUtf8ToUtf16(
+      utf8_string, reinterpret_cast<char16_t*>(utf16_string.data()));
+  if (!converted_length) {
     return std::wstring();
   }
+  utf16_string.resize(*converted_length);
   return utf16_string;
 }
 
+ScratchUtf16::ScratchUtf16(std::string_view utf8_string) {
+  auto& state = GetScratchState();
+  if (state.depth == kMaxScratchDepth) {
+    fallback_ = Utf16FromUtf8(utf8_string);
+    data_ = fallback_.c_str();
+    size_ = fallback_.size();
+    return;
+  }
+
+  depth_ = state.depth++;
+  auto* data = state.buffers[depth_].Acquire(
+      MaxUtf16LengthForUtf8(utf8_string.size()) + 1);
+  size_ = TranscodeUtf8ToUtf16(utf8_string, reinterpret_cast<char16_t*>(data))
+              .value_or(0);
+  data[size_] = L'\0';
+  data_ = data;
+}
+
+ScratchUtf16::~ScratchUtf16() {
+  if (depth_ >= 0) {
+    auto& state = GetScratchState();
+    state.buffers[depth_].Release();
+    state.depth = depth_;
+  }
+}
+
 }  // namespace util
@@ -1,8 +1,38 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 
 namespace util {
 std::string Utf8FromUtf16(std::wstring_view utf16_string);
 std::wstring Utf16FromUtf8(std::string_view utf8_string);
+
+// Converts a UTF-8 string to UTF-16 in a thread-local scratch buffer
+// instead of a new std::wstring, for passing temporaries to APIs that copy
+// their arguments:
+//
+//   webview->Navigate(util::ScratchUtf16(url).c_str());
+//
+// The result is null-terminated, empty if the input is invalid, and valid
+// for the lifetime of the object. Instances on the same thread must be
+// destroyed in reverse order of creation, as temporaries and locals are.
+class ScratchUtf16 {
+ public:
+  explicit ScratchUtf16(std::string_view utf8_string);
+  ~ScratchUtf16();
+
+  ScratchUtf16(const ScratchUtf16&) = delete;
+  ScratchUtf16& operator=(const ScratchUtf16&) = delete;
+
+  const wchar_t* c_str() const { return data_; }
+  std::wstring_view view() const { return std::wstring_view(data_, size_); }
+
+ private:
+  const wchar_t* data_;
+  size_t size_ = 0;
+  // Index of the scratch buffer in use, or -1 if nested too deeply and
+  // |fallback_| holds the result.
+  int depth_ = -1;
+  std::wstring fallback_;
+};
 }  // namespace util
@@ -0,0 +1,204 @@
+#include "trace.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+namespace util {
+
+namespace {
+// Number of spans kept per thread.
+constexpr size_t kRingCapacity = 1024;
+
+struct Span {
+  const char* name;
+  int64_t start_ns;
+  int64_t duration_ns;
+};
+
+// The fields are atomic because exporting threads may read a slot while its
+// thread overwrites it.
+struct SpanSlot {
+  std::atomic<const char*> name;
+  std::atomic<int64_t> start_ns;
+  std::atomic<int64_t> duration_ns;
+};
+
+// Written by its thread only, which makes |count| a sequence counter: while
+// it is n, slot n % kRingCapacity may be partially written, and all older
+// slots still in the ring are complete.
+struct Ring {
+  uint32_t thread_index = 0;
+  std::array<SpanSlot, kRingCapacity> spans;
+  std::atomic<uint64_t> count = 0;
+};
+
+// Keeps the rings of exited threads until they have been exported.
+struct Registry {
+  std::mutex mutex;
+  std::vector<std::shared_ptr<Ring>> rings;
+  uint32_t next_thread_index = 1;
+};
+
+// Number of rings of exited threads kept if they are never exported.
+constexpr size_t kMaxExitedRings = 64;
+
+// Rings that only the registry references belong to exited threads.
+bool IsExited(const std::shared_ptr<Ring>& ring) {
+  return ring.use_count() == 1;
+}
+
+std::atomic<bool> g_enabled = true;
+
+Registry& GetRegistry() {
+  static Registry* registry = new Registry();
+  return *registry;
+}
+
+Ring& GetThreadRing() {
+  thread_local const std::shared_ptr<Ring> ring = [] {
+    auto ring = std::make_shared<Ring>();
+    auto& registry = GetRegistry();
+    const std::lock_guard<std::mutex> lock(registry.mutex);
+    auto exited = static_cast<size_t>(std::count_if(
+        registry.rings.begin(), registry.rings.end(), IsExited));
+    // Drops the oldest rings of exited threads, which keeps the registry
+    // bounded in processes that start many short-lived threads.
+    for (auto it = registry.rings.begin();
+         exited > kMaxExitedRings && it != registry.rings.end();) {
+      if (IsExited(*it)) {
+        it = registry.rings.erase(it);
+        --exited;
+      } else {
+        ++it;
+      }
+    }
+    ring->thread_index = registry.next_thread_index++;
+    registry.rings.push_back(ring);
+    return ring;
+  }();
+  return *ring;
+}
+
+int64_t ToNanoseconds(TraceClock::duration duration) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(duration)
+      .count();
+}
+
+void WriteJsonString(std::ostringstream& out, const char* value) {
+  out << '"';
+  for (auto c = value; *c; ++c) {
+    if (*c == '"' || *c == '\\') {
+      out << '\\';
+    }
+    out << *c;
+  }
+  out << '"';
+}
+}  // namespace
+
+void RecordTraceSpan(const char* name, TraceClock::time_point start,
+                     TraceClock::time_point end) {
+  if (!g_enabled.load(std::memory_order_relaxed)) {
+    return;
+  }
+
+  auto& ring = GetThreadRing();
+  const auto index = ring.count.load(std::memory_order_relaxed);
+  // Orders the previous increment of |count| before the writes below, so
+  // that readers seeing any of them also see that the slot is being reused.
+  std::atomic_thread_fence(std::memory_order_release);
+  auto& slot = ring.spans[index % kRingCapacity];
+  slot.name.store(name, std::memory_order_relaxed);
+  slot.start_ns.store(ToNanoseconds(start.time_since_epoch()),
+                      std::memory_order_relaxed);
+  slot.duration_ns.store(ToNanoseconds(end - start),
+                         std::memory_order_relaxed);
+  ring.count.store(index + 1, std::memory_order_release);
+}
+
+void SetTracingEnabled(bool enabled) {
+  g_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool IsTracingEnabled() { return g_enabled.load(std::memory_order_relaxed); }
+
+std::string ExportChromeTrace(uint32_t process_id) {
+  std::vector<std::shared_ptr<Ring>> rings;
+  {
+    auto& registry = GetRegistry();
+    const std::lock_guard<std::mutex> lock(registry.mutex);
+    rings = registry.rings;
+  }
+
+  std::ostringstream out;
+  out.setf(std::ios::fixed);
+  out.precision(3);
+  out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+  bool first = true;
+  std::vector<Span> spans;
+  spans.reserve(kRingCapacity);
+  for (const auto& ring : rings) {
+    // Copies the ring, then drops the copies of slots its thread may have
+    // started to overwrite meanwhile.
+    const auto count = ring->count.load(std::memory_order_acquire);
+    const auto begin = count > kRingCapacity ? count - kRingCapacity : 0;
+    spans.clear();
+    for (auto i = begin; i < count; ++i) {
+      const auto& slot = ring->spans[i % kRingCapacity];
+      spans.push_back({slot.name.load(std::memory_order_relaxed),
+                       slot.start_ns.load(std::memory_order_relaxed),
+                       slot.duration_ns.load(std::memory_order_relaxed)});
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const auto writing = ring->count.load(std::memory_order_relaxed);
+    const auto valid_begin =
+        writing >= kRingCapacity ? writing - kRingCapacity + 1 : 0;
+
+    for (auto i = std::max(begin, valid_begin); i < count; ++i) {
+      const auto& span = spans[i - begin];
+      if (!first) {
+        out << ',';
+      }
+      first = false;
+
+      // Timestamps are in microseconds.
+      out << "{\"name\":";
+      WriteJsonString(out, span.name);
+      out << ",\"ph\":\"X\",\"ts\":" << span.start_ns / 1000.0
+          << ",\"dur\":" << span.duration_ns / 1000.0
+          << ",\"pid\":" << process_id << ",\"tid\":" << ring->thread_index
+          << '}';
+    }
+  }
+
+  out << "]}";
+
+  // The rings of exited threads won't change anymore once exported. Rings
+  // registered during the export are kept until the next one.
+  std::vector<const Ring*> exported;
+  for (const auto& ring : rings) {
+    exported.push_back(ring.get());
+  }
+  rings.clear();
+  {
+    auto& registry = GetRegistry();
+    const std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.rings.erase(
+        std::remove_if(registry.rings.begin(), registry.rings.end(),
+                       [&exported](const std::shared_ptr<Ring>& ring) {
+                         return IsExited(ring) &&
+                                std::find(exported.begin(), exported.end(),
+                                          ring.get()) != exported.end();
+                       }),
+        registry.rings.end());
+  }
+  return out.str();
+}
+
+}  // namespace util
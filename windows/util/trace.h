@@ -0,0 +1,55 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace util {
+
+typedef std::chrono::steady_clock TraceClock;
+
+// Records a completed span on the calling thread's trace ring. |name| is
+// stored by pointer and must be a string literal.
+//
+// Each thread keeps the most recent spans in a preallocated ring, so
+// recording never allocates after the thread's first span.
+void RecordTraceSpan(const char* name, TraceClock::time_point start,
+                     TraceClock::time_point end);
+
+inline void RecordTraceSpan(const char* name, TraceClock::time_point start) {
+  RecordTraceSpan(name, start, TraceClock::now());
+}
+
+void SetTracingEnabled(bool enabled);
+bool IsTracingEnabled();
+
+// Returns the recorded spans of all threads in the Chrome trace event
+// format, which can be loaded into chrome://tracing or Perfetto.
+std::string ExportChromeTrace(uint32_t process_id);
+
+// Records the lifetime of the enclosing scope.
+class ScopedTraceSpan {
+ public:
+  explicit ScopedTraceSpan(const char* name)
+      : name_(name), enabled_(IsTracingEnabled()) {
+    if (enabled_) {
+      start_ = TraceClock::now();
+    }
+  }
+
+  ~ScopedTraceSpan() {
+    if (enabled_) {
+      RecordTraceSpan(name_, start_);
+    }
+  }
+
+  ScopedTraceSpan(const ScopedTraceSpan&) = delete;
+  ScopedTraceSpan& operator=(const ScopedTraceSpan&) = delete;
+
+ private:
+  const char* name_;
+  bool enabled_;
+  TraceClock::time_point start_;
+};
+
+}  // namespace util
@@ -0,0 +1,356 @@
+#include "utf_transcoder.h"
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(_M_X64) || defined(__x86_64__) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define UTIL_UTF_SSE2 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define UTIL_UTF_TARGET_AVX2
+#else
+#include <cpuid.h>
+#define UTIL_UTF_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#define UTIL_UTF_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace util {
+
+namespace {
+
+// Converts the longest prefix of |input| that consists of whole blocks of
+// ASCII characters. Returns the number of characters converted.
+typedef size_t (*AsciiToUtf16Kernel)(const uint8_t* input, size_t length,
+                                     char16_t* output);
+typedef size_t (*AsciiToUtf8Kernel)(const char16_t* input, size_t length,
+                                    uint8_t* output);
+
+#if !defined(UTIL_UTF_SSE2) && !defined(UTIL_UTF_NEON)
+size_t AsciiToUtf16Scalar(const uint8_t* input, size_t length,
+                          char16_t* output) {
+  // Eight bytes at a time.
+  size_t i = 0;
+  for (; i + 8 <= length; i += 8) {
+    uint64_t block;
+    std::memcpy(&block, input + i, sizeof(block));
+    if (block & 0x8080808080808080ull) {
+      break;
+    }
+    for (size_t j = 0; j < 8; ++j) {
+      output[i + j] = input[i + j];
+    }
+  }
+  return i;
+}
+
+size_t AsciiToUtf8Scalar(const char16_t* input, size_t length,
+                         uint8_t* output) {
+  size_t i = 0;
+  for (; i + 4 <= length; i += 4) {
+    uint64_t block;
+    std::memcpy(&block, input + i, sizeof(block));
+    if (block & 0xff80ff80ff80ff80ull) {
+      break;
+    }
+    for (size_t j = 0; j < 4; ++j) {
+      output[i + j] = static_cast<uint8_t>(input[i + j]);
+    }
+  }
+  return i;
+}
+#endif
+
+#if defined(UTIL_UTF_SSE2)
+size_t AsciiToUtf16Sse2(const uint8_t* input, size_t length,
+                        char16_t* output) {
+  const auto zero = _mm_setzero_si128();
+  size_t i = 0;
+  for (; i + 16 <= length; i += 16) {
+    const auto bytes =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i));
+    if (_mm_movemask_epi8(bytes) != 0) {
+      break;
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i),
+                     _mm_unpacklo_epi8(bytes, zero));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i + 8),
+                     _mm_unpackhi_epi8(bytes, zero));
+  }
+  return i;
+}
+
+size_t AsciiToUtf8Sse2(const char16_t* input, size_t length,
+                       uint8_t* output) {
+  const auto non_ascii = _mm_set1_epi16(static_cast<short>(0xff80));
+  const auto zero = _mm_setzero_si128();
+  size_t i = 0;
+  for (; i + 16 <= length; i += 16) {
+    const auto low =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i));
+    const auto high =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i + 8));
+    const auto ascii = _mm_cmpeq_epi16(
+        _mm_and_si128(_mm_or_si128(low, high), non_ascii), zero);
+    if (_mm_movemask_epi8(ascii) != 0xffff) {
+      break;
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i),
+                     _mm_packus_epi16(low, high));
+  }
+  return i;
+}
+
+UTIL_UTF_TARGET_AVX2 size_t AsciiToUtf16Avx2(const uint8_t* input,
+                                             size_t length,
+                                             char16_t* output) {
+  size_t i = 0;
+  for (; i + 32 <= length; i += 32) {
+    const auto bytes =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input + i));
+    if (_mm256_movemask_epi8(bytes) != 0) {
+      break;
+    }
+    _mm256_storeu_si256(
+        reinterpret_cast<__m256i*>(output + i),
+        _mm256_cvtepu8_epi16(_mm256_castsi256_si128(bytes)));
+    _mm256_storeu_si256(
+        reinterpret_cast<__m256i*>(output + i + 16),
+        _mm256_cvtepu8_epi16(_mm256_extracti128_si256(bytes, 1)));
+  }
+  return i;
+}
+
+UTIL_UTF_TARGET_AVX2 size_t AsciiToUtf8Avx2(const char16_t* input,
+                                            size_t length, uint8_t* output) {
+  const auto non_ascii = _mm256_set1_epi16(static_cast<short>(0xff80));
+  size_t i = 0;
+  for (; i + 32 <= length; i += 32) {
+    const auto low =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input + i));
+    const auto high =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input + i + 16));
+    if (!_mm256_testz_si256(_mm256_or_si256(low, high), non_ascii)) {
+      break;
+    }
+    // packus works per 128-bit lane; restore the order afterwards.
+    const auto packed = _mm256_permute4x64_epi64(
+        _mm256_packus_epi16(low, high), 0b11011000);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(output + i), packed);
+  }
+  return i;
+}
+
+bool HasAvx2() {
+#if defined(_MSC_VER) && !defined(__clang__)
+  int info[4];
+  __cpuid(info, 0);
+  if (info[0] < 7) {
+    return false;
+  }
+  __cpuid(info, 1);
+  // OSXSAVE and AVX, and the OS saves the YMM registers.
+  if ((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0 ||
+      (_xgetbv(0) & 0x6) != 0x6) {
+    return false;
+  }
+  __cpuidex(info, 7, 0);
+  return (info[1] & (1 << 5)) != 0;
+#else
+  return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif  // UTIL_UTF_SSE2
+
+#if defined(UTIL_UTF_NEON)
+size_t AsciiToUtf16Neon(const uint8_t* input, size_t length,
+                        char16_t* output) {
+  size_t i = 0;
+  for (; i + 16 <= length; i += 16) {
+    const auto bytes = vld1q_u8(input + i);
+    if (vmaxvq_u8(bytes) >= 0x80) {
+      break;
+    }
+    vst1q_u16(reinterpret_cast<uint16_t*>(output + i),
+              vmovl_u8(vget_low_u8(bytes)));
+    vst1q_u16(reinterpret_cast<uint16_t*>(output + i + 8),
+              vmovl_u8(vget_high_u8(bytes)));
+  }
+  return i;
+}
+
+size_t AsciiToUtf8Neon(const char16_t* input, size_t length,
+                       uint8_t* output) {
+  size_t i = 0;
+  for (; i + 16 <= length; i += 16) {
+    const auto low = vld1q_u16(reinterpret_cast<const uint16_t*>(input + i));
+    const auto high =
+        vld1q_u16(reinterpret_cast<const uint16_t*>(input + i + 8));
+    if (vmaxvq_u16(vorrq_u16(low, high)) >= 0x80) {
+      break;
+    }
+    vst1q_u8(output + i, vcombine_u8(vmovn_u16(low), vmovn_u16(high)));
+  }
+  return i;
+}
+#endif  // UTIL_UTF_NEON
+
+struct Kernels {
+  AsciiToUtf16Kernel to_utf16;
+  AsciiToUtf8Kernel to_utf8;
+};
+
+Kernels SelectKernels() {
+#if defined(UTIL_UTF_SSE2)
+  if (HasAvx2()) {
+    return {&AsciiToUtf16Avx2, &AsciiToUtf8Avx2};
+  }
+  return {&AsciiToUtf16Sse2, &AsciiToUtf8Sse2};
+#elif defined(UTIL_UTF_NEON)
+  return {&AsciiToUtf16Neon, &AsciiToUtf8Neon};
+#else
+  return {&AsciiToUtf16Scalar, &AsciiToUtf8Scalar};
+#endif
+}
+
+const Kernels& GetKernels() {
+  static const Kernels kernels = SelectKernels();
+  return kernels;
+}
+
+inline bool IsContinuation(uint8_t byte) { return (byte & 0xc0) == 0x80; }
+
+}  // namespace
+
+std::optional<size_t> TranscodeUtf8ToUtf16(std::string_view input,
+                                           char16_t* output) {
+  const auto kernel = GetKernels().to_utf16;
+  const auto data = reinterpret_cast<const uint8_t*>(input.data());
+  const auto length = input.size();
+
+  size_t i = 0;
+  size_t written = 0;
+  while (i < length) {
+    const uint8_t lead = data[i];
+    if (lead < 0x80) {
+      const auto count = kernel(data + i, length - i, output + written);
+      i += count;
+      written += count;
+      // Remainder of the run that didn't fill a whole block.
+      while (i < length && data[i] < 0x80) {
+        output[written++] = data[i++];
+      }
+      continue;
+    }
+
+    uint32_t code_point;
+    if (lead < 0xc2) {
+      // Stray continuation byte or overlong two-byte sequence.
+      return std::nullopt;
+    } else if (lead < 0xe0) {
+      if (i + 1 >= length || !IsContinuation(data[i + 1])) {
+        return std::nullopt;
+      }
+      code_point = (lead & 0x1f) << 6 | (data[i + 1] & 0x3f);
+      i += 2;
+    } else if (lead < 0xf0) {
+      if (i + 2 >= length || !IsContinuation(data[i + 2])) {
+        return std::nullopt;
+      }
+      // Rejects overlong encodings and surrogates.
+      const uint8_t second = data[i + 1];
+      const uint8_t min = lead == 0xe0 ? 0xa0 : 0x80;
+      const uint8_t max = lead == 0xed ? 0x9f : 0xbf;
+      if (second < min || second > max) {
+        return std::nullopt;
+      }
+      code_point = (lead & 0x0f) << 12 | (second & 0x3f) << 6 |
+                   (data[i + 2] & 0x3f);
+      i += 3;
+    } else if (lead < 0xf5) {
+      if (i + 3 >= length || !IsContinuation(data[i + 2]) ||
+          !IsContinuation(data[i + 3])) {
+        return std::nullopt;
+      }
+      // Rejects overlong encodings and code points above U+10FFFF.
+      const uint8_t second = data[i + 1];
+      const uint8_t min = lead == 0xf0 ? 0x90 : 0x80;
+      const uint8_t max = lead == 0xf4 ? 0x8f : 0xbf;
+      if (second < min || second > max) {
+        return std::nullopt;
+      }
+      code_point = (lead & 0x07) << 18 | (second & 0x3f) << 12 |
+                   (data[i + 2] & 0x3f) << 6 | (data[i + 3] & 0x3f);
+      i += 4;
+    } else {
+      return std::nullopt;
+    }
+
+    if (code_point >= 0x10000) {
+      code_point -= 0x10000;
+      output[written++] = static_cast<char16_t>(0xd800 | (code_point >> 10));
+      output[written++] = static_cast<char16_t>(0xdc00 | (code_point & 0x3ff));
+    } else {
+      output[written++] = static_cast<char16_t>(code_point);
+    }
+  }
+  return written;
+}
+
+std::optional<size_t> TranscodeUtf16ToUtf8(std::u16string_view input,
+                                           char* output) {
+  const auto kernel = GetKernels().to_utf8;
+  const auto data = input.data();
+  const auto length = input.size();
+  const auto out = reinterpret_cast<uint8_t*>(output);
+
+  size_t i = 0;
+  size_t written = 0;
+  while (i < length) {
+    uint32_t code_point = data[i];
+    if (code_point < 0x80) {
+      const auto count = kernel(data + i, length - i, out + written);
+      i += count;
+      written += count;
+      while (i < length && data[i] < 0x80) {
+        out[written++] = static_cast<uint8_t>(data[i++]);
+      }
+      continue;
+    }
+
+    if (code_point < 0x800) {
+      out[written++] = static_cast<uint8_t>(0xc0 | (code_point >> 6));
+      out[written++] = static_cast<uint8_t>(0x80 | (code_point & 0x3f));
+      ++i;
+      continue;
+    }
+
+    if (code_point >= 0xd800 && code_point <= 0xdfff) {
+      // Only a high surrogate followed by a low surrogate is valid.
+      if (code_point > 0xdbff || i + 1 >= length || data[i + 1] < 0xdc00 ||
+          data[i + 1] > 0xdfff) {
+        return std::nullopt;
+      }
+      code_point =
+          0x10000 + ((code_point - 0xd800) << 10) + (data[i + 1] - 0xdc00);
+      out[written++] = static_cast<uint8_t>(0xf0 | (code_point >> 18));
+      out[written++] = static_cast<uint8_t>(0x80 | ((code_point >> 12) & 0x3f));
+      out[written++] = static_cast<uint8_t>(0x80 | ((code_point >> 6) & 0x3f));
+      out[written++] = static_cast<uint8_t>(0x80 | (code_point & 0x3f));
+      i += 2;
+      continue;
+    }
+
+    out[written++] = static_cast<uint8_t>(0xe0 | (code_point >> 12));
+    out[written++] = static_cast<uint8_t>(0x80 | ((code_point >> 6) & 0x3f));
+    out[written++] = static_cast<uint8_t>(0x80 | (code_point & 0x3f));
+    ++i;
+  }
+  return written;
+}
+
+}  // namespace util
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <string_view>
+
+namespace util {
+
+// Validating single-pass UTF-8 <-> UTF-16 transcoders.
+//
+// Both write into a caller-provided buffer that must be large enough for the
+// worst case (see the |Max...Length| functions) and return the number of
+// code units written, or std::nullopt if the input is not well-formed.
+// Overlong encodings, encoded surrogates, code points above U+10FFFF,
+// truncated sequences and unpaired surrogates are all rejected, like
+// MB_ERR_INVALID_CHARS and WC_ERR_INVALID_CHARS do.
+//
+// Runs of ASCII are converted with SIMD kernels (SSE2, AVX2 if supported by
+// the CPU, or NEON) where available.
+
+constexpr size_t MaxUtf16LengthForUtf8(size_t utf8_length) {
+  return utf8_length;
+}
+
+constexpr size_t MaxUtf8LengthForUtf16(size_t utf16_length) {
+  return utf16_length * 3;
+}
+
+std::optional<size_t> TranscodeUtf8ToUtf16(std::string_view input,
+                                           char16_t* output);
+std::optional<size_t> TranscodeUtf16ToUtf8(std::u16string_view input,
+                                           char* output);
+
+}  // namespace util
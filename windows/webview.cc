@@ -2,10 +2,13 @@
 
 #include <wrl.h>
 
+#include <chrono>
 #include <format>
 #include <iostream>
 
 #include "util/composition.desktop.interop.h"
+#include "util/http_headers.h"
+#include "util/memory_stream.h"
 #include "util/string_converter.h"
 #include "webview_host.h"
 
@@ -13,6 +16,106 @@ using namespace Microsoft::WRL;
 
 namespace {
 
+// Maximum number of pooled pointer infos. Touch screens track up to ten
+// contacts.
+constexpr size_t kMaxPooledPointerInfos = 10;
+
+// Filter for the WebResourceRequested events of all requests to |host_name|.
+std::string GetHostResourceFilter(const std::string& host_name) {
+  return "*://" + host_name + "/*";
+}
+
+// Returns the value of the header |name|, or an empty string if the request
+// has no such header.
+std::string GetRequestHeader(ICoreWebView2HttpRequestHeaders* headers,
+                             const wchar_t* name) {
+  BOOL contains = FALSE;
+  wil::unique_cotaskmem_string value;
+  if (FAILED(headers->Contains(name, &contains)) || !contains ||
+      FAILED(headers->GetHeader(name, &value))) {
+    return std::string();
+  }
+  return util::Utf8FromUtf16(value.get());
+}
+
+// Returns the headers of |headers| as "Name: value" lines separated by CRLF.
+std::string GetResponseHeaders(ICoreWebView2HttpResponseHeaders* headers) {
+  std::string result;
+  wil::com_ptr<ICoreWebView2HttpHeadersCollectionIterator> iterator;
+  if (FAILED(headers->GetIterator(iterator.put()))) {
+    return result;
+  }
+  BOOL has_current = FALSE;
+  while (SUCCEEDED(iterator->get_HasCurrentHeader(&has_current)) &&
+         has_current) {
+    wil::unique_cotaskmem_string name;
+    wil::unique_cotaskmem_string value;
+    if (SUCCEEDED(iterator->GetCurrentHeader(&name, &value))) {
+      util::AddHeader(result, util::Utf8FromUtf16(name.get()),
+                      util::Utf8FromUtf16(value.get()));
+    }
+    BOOL has_next = FALSE;
+    if (FAILED(iterator->MoveNext(&has_next)) || !has_next) {
+      break;
+    }
+  }
+  return result;
+}
+
+// Reads |stream| to its end into |contents|. Fails if it holds more than
+// |max_size| bytes.
+bool ReadStream(IStream* stream, size_t max_size, std::string& contents) {
+  constexpr ULONG kChunkSize = 64 * 1024;
+  for (;;) {
+    const auto size = contents.size();
+    contents.resize(size + kChunkSize);
+    ULONG read = 0;
+    const auto result = stream->Read(contents.data() + size, kChunkSize, &read);
+    contents.resize(size + read);
+    if (FAILED(result) || contents.size() > max_size) {
+      return false;
+    }
+    if (result == S_FALSE || read == 0) {
+      return true;
+    }
+  }
+}
+
+// The time in seconds since the Unix epoch, as used by the response cache.
+int64_t GetUnixTime() {
+  return std::chrono::duration_cast<std::chrono::seconds>(
+             std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
+// Returns the UrlFilter::ResourceType of requests made in |context|.
+uint32_t GetUrlFilterType(COREWEBVIEW2_WEB_RESOURCE_CONTEXT context) {
+  switch (context) {
+    case COREWEBVIEW2_WEB_RESOURCE_CONTEXT_DOCUMENT:
+      // Frames are documents too.
+      return UrlFilter::kDocument | UrlFilter::kSubdocument;
+    case COREWEBVIEW2_WEB_RESOURCE_CONTEXT_STYLESHEET:
+      return UrlFilter::kStylesheet;
+    case COREWEBVIEW2_WEB_RESOURCE_CONTEXT_IMAGE:
+      return UrlFilter::kImage;
+    case COREWEBVIEW2_WEB_RESOURCE_CONTEXT_MEDIA:
+      return UrlFilter::kMedia;
+    case COREWEBVIEW2_WEB_RESOURCE_CONTEXT_FONT:
+      return UrlFilter::kFont;
+    case COREWEBVIEW2_WEB_RESOURCE_CONTEXT_SCRIPT:
+      return UrlFilter::kScript;
+    case COREWEBVIEW2_WEB_RESOURCE_CONTEXT_XML_HTTP_REQUEST:
+    case COREWEBVIEW2_WEB_RESOURCE_CONTEXT_FETCH:
+      return UrlFilter::kXmlHttpRequest;
+    case COREWEBVIEW2_WEB_RESOURCE_CONTEXT_WEBSOCKET:
+      return UrlFilter::kWebSocket;
+    case COREWEBVIEW2_WEB_RESOURCE_CONTEXT_PING:
+      return UrlFilter::kPing;
+    default:
+      return UrlFilter::kOther;
+  }
+}
+
 inline void ConvertColor(COREWEBVIEW2_COLOR& webview_color, int32_t color) {
   webview_color.B = color & 0xFF;
   webview_color.G = (color >> 8) & 0xFF;
@@ -62,7 +165,23 @@ Webview::Webview(
     : composition_controller_(std::move(composition_controller)),
       host_(host),
       hwnd_(hwnd),
-      owns_window_(owns_window) {
+      owns_window_(owns_window),
+      pointer_info_pool_(
+          [host]() { return host->CreateWebViewPointerInfo(); },
+          [](wil::com_ptr<ICoreWebView2PointerInfo>& pointer_info) {
+            pointer_info->put_PointerFlags(POINTER_FLAG_NONE);
+            pointer_info->put_TouchFlags(TOUCH_FLAG_NONE);
+            pointer_info->put_TouchMask(TOUCH_MASK_NONE);
+            pointer_info->put_TouchPressure(0);
+          },
+          kMaxPooledPointerInfos),
+      devtools_subscriptions_(
+          [this](const std::string& event) {
+            return AddDevToolsProtocolEventReceiver(event);
+          },
+          [this](const std::string& event) {
+            RemoveDevToolsProtocolEventReceiver(event);
+          }) {
   webview_controller_ =
       composition_controller_.try_query<ICoreWebView2Controller3>();
 
@@ -83,7 +202,6 @@ Webview::Webview(
     settings->put_AreDefaultContextMenusEnabled(FALSE);
   }
 
-  EnableSecurityUpdates();
   RegisterEventHandlers();
 
   is_valid_ = CreateSurface(host->compositor(), hwnd, offscreen_only);
@@ -144,28 +262,82 @@ bool Webview::CreateSurface(
 
 void Webview::EnableSecurityUpdates() {
   if (SUCCEEDED(webview_->CallDevToolsProtocolMethod(L"Security.enable", L"{}",
-                                                     nullptr)) &&
-      SUCCEEDED(webview_->GetDevToolsProtocolEventReceiver(
-          L"Security.securityStateChanged",
-          &devtools_protocol_event_receiver_))) {
-    devtools_protocol_event_receiver_->add_DevToolsProtocolEventReceived(
-        Callback<ICoreWebView2DevToolsProtocolEventReceivedEventHandler>(
-            [this](ICoreWebView2* sender,
-                   ICoreWebView2DevToolsProtocolEventReceivedEventArgs* args)
-                -> HRESULT {
-              if (devtools_protocol_event_callback_) {
-                wil::unique_cotaskmem_string json_args;
-                if (args->get_ParameterObjectAsJson(&json_args) == S_OK) {
-                  std::string json = util::Utf8FromUtf16(json_args.get());
-                  devtools_protocol_event_callback_(json.c_str());
-                }
-              }
+                                                     nullptr))) {
+    security_subscription_ = devtools_subscriptions_.Subscribe(
+        "Security.securityStateChanged", DevToolsEventFilter());
+  }
+}
 
+void Webview::DisableSecurityUpdates() {
+  devtools_subscriptions_.Unsubscribe(security_subscription_);
+  security_subscription_ = DevToolsSubscriptions::kNoSubscription;
+  webview_->CallDevToolsProtocolMethod(L"Security.disable", L"{}", nullptr);
+}
+
+bool Webview::AddDevToolsProtocolEventReceiver(const std::string& event) {
+  DevToolsProtocolEventReceiver entry;
+  if (!webview_ || FAILED(webview_->GetDevToolsProtocolEventReceiver(
+                       util::ScratchUtf16(event).c_str(),
+                       entry.receiver.put()))) {
+    return false;
+  }
+  // The params are converted once for all the subscriptions to the event.
+  const auto hr = entry.receiver->add_DevToolsProtocolEventReceived(
+      Callback<ICoreWebView2DevToolsProtocolEventReceivedEventHandler>(
+          [this, event](
+              ICoreWebView2* sender,
+              ICoreWebView2DevToolsProtocolEventReceivedEventArgs* args)
+              -> HRESULT {
+            wil::unique_cotaskmem_string json_args;
+            if (args->get_ParameterObjectAsJson(&json_args) != S_OK) {
               return S_OK;
-            })
-            .Get(),
-        &event_registrations_.devtools_protocol_event_token_);
+            }
+            const auto params = util::Utf8FromUtf16(json_args.get());
+            devtools_subscriptions_.Dispatch(
+                event, params, [this, &params](DevToolsSubscriptions::Id id) {
+                  if (id == security_subscription_) {
+                    if (devtools_protocol_event_callback_) {
+                      devtools_protocol_event_callback_(params);
+                    }
+                  } else if (devtools_protocol_event_received_callback_) {
+                    devtools_protocol_event_received_callback_(id, params);
+                  }
+                });
+            return S_OK;
+          })
+          .Get(),
+      &entry.token);
+  if (FAILED(hr)) {
+    return false;
   }
+  devtools_protocol_event_receivers_.insert_or_assign(event, std::move(entry));
+  return true;
+}
+
+void Webview::RemoveDevToolsProtocolEventReceiver(const std::string& event) {
+  const auto it = devtools_protocol_event_receivers_.find(event);
+  if (it == devtools_protocol_event_receivers_.end()) {
+    return;
+  }
+  it->second.receiver->remove_DevToolsProtocolEventReceived(it->second.token);
+  devtools_protocol_event_receivers_.erase(it);
+}
+
+DevToolsSubscriptions::Id Webview::SubscribeDevToolsProtocolEvent(
+    const std::string& event, DevToolsEventFilter filter) {
+  if (!IsValid()) {
+    return DevToolsSubscriptions::kNoSubscription;
+  }
+  return devtools_subscriptions_.Subscribe(event, std::move(filter));
+}
+
+bool Webview::UnsubscribeDevToolsProtocolEvent(DevToolsSubscriptions::Id id) {
+  return id != security_subscription_ &&
+         devtools_subscriptions_.Unsubscribe(id);
+}
+
+void Webview::SetEventSubscriptions(uint32_t subscriptions) {
+  event_subscriptions_.Update(subscriptions);
 }
 
 void Webview::RegisterEventHandlers() {
@@ -173,7 +345,7 @@ void Webview::RegisterEventHandlers() {
     return;
   }
 
-  webview_->add_ContentLoading(
+  auto content_loading_handler =
       Callback<ICoreWebView2ContentLoadingEventHandler>(
           [this](ICoreWebView2* sender, IUnknown* args) -> HRESULT {
             if (loading_state_changed_callback_) {
@@ -181,11 +353,19 @@ void Webview::RegisterEventHandlers() {
             }
 
             return S_OK;
-          })
-          .Get(),
-      &event_registrations_.content_loading_token_);
+          });
+  event_subscriptions_.AddHandler(
+      WebviewEvents::kLoadingStateChanged,
+      [this, handler = std::move(content_loading_handler)]() {
+        webview_->add_ContentLoading(
+            handler.Get(), &event_registrations_.content_loading_token_);
+      },
+      [this]() {
+        webview_->remove_ContentLoading(
+            event_registrations_.content_loading_token_);
+      });
 
-  webview_->add_NavigationCompleted(
+  auto navigation_completed_handler =
       Callback<ICoreWebView2NavigationCompletedEventHandler>(
           [this](ICoreWebView2* sender,
                  ICoreWebView2NavigationCompletedEventArgs* args) -> HRESULT {
@@ -203,11 +383,19 @@ void Webview::RegisterEventHandlers() {
             }
 
             return S_OK;
-          })
-          .Get(),
-      &event_registrations_.navigation_completed_token_);
+          });
+  event_subscriptions_.AddHandler(
+      WebviewEvents::kLoadingStateChanged | WebviewEvents::kLoadError,
+      [this, handler = std::move(navigation_completed_handler)]() {
+        webview_->add_NavigationCompleted(
+            handler.Get(), &event_registrations_.navigation_completed_token_);
+      },
+      [this]() {
+        webview_->remove_NavigationCompleted(
+            event_registrations_.navigation_completed_token_);
+      });
 
-  webview_->add_HistoryChanged(
+  auto history_changed_handler =
       Callback<ICoreWebView2HistoryChangedEventHandler>(
           [this](ICoreWebView2* sender, IUnknown* args) -> HRESULT {
             if (history_changed_callback_) {
@@ -219,38 +407,62 @@ void Webview::RegisterEventHandlers() {
             }
 
             return S_OK;
-          })
-          .Get(),
-      &event_registrations_.history_changed_token_);
+          });
+  event_subscriptions_.AddHandler(
+      WebviewEvents::kHistoryChanged,
+      [this, handler = std::move(history_changed_handler)]() {
+        webview_->add_HistoryChanged(
+            handler.Get(), &event_registrations_.history_changed_token_);
+      },
+      [this]() {
+        webview_->remove_HistoryChanged(
+            event_registrations_.history_changed_token_);
+      });
 
-  webview_->add_SourceChanged(
+  auto source_changed_handler =
       Callback<ICoreWebView2SourceChangedEventHandler>(
           [this](ICoreWebView2* sender, IUnknown* args) -> HRESULT {
-            LPWSTR wurl;
+            wil::unique_cotaskmem_string wurl;
             if (url_changed_callback_ && webview_->get_Source(&wurl) == S_OK) {
-              std::string url = util::Utf8FromUtf16(wurl);
+              std::string url = util::Utf8FromUtf16(wurl.get());
               url_changed_callback_(url);
             }
 
             return S_OK;
-          })
-          .Get(),
-      &event_registrations_.source_changed_token_);
+          });
+  event_subscriptions_.AddHandler(
+      WebviewEvents::kUrlChanged,
+      [this, handler = std::move(source_changed_handler)]() {
+        webview_->add_SourceChanged(
+            handler.Get(), &event_registrations_.source_changed_token_);
+      },
+      [this]() {
+        webview_->remove_SourceChanged(
+            event_registrations_.source_changed_token_);
+      });
 
-  webview_->add_DocumentTitleChanged(
+  auto document_title_changed_handler =
       Callback<ICoreWebView2DocumentTitleChangedEventHandler>(
           [this](ICoreWebView2* sender, IUnknown* args) -> HRESULT {
-            LPWSTR wtitle;
+            wil::unique_cotaskmem_string wtitle;
             if (document_title_changed_callback_ &&
                 webview_->get_DocumentTitle(&wtitle) == S_OK) {
-              std::string title = util::Utf8FromUtf16(wtitle);
+              std::string title = util::Utf8FromUtf16(wtitle.get());
               document_title_changed_callback_(title);
             }
 
             return S_OK;
-          })
-          .Get(),
-      &event_registrations_.document_title_changed_token_);
+          });
+  event_subscriptions_.AddHandler(
+      WebviewEvents::kTitleChanged,
+      [this, handler = std::move(document_title_changed_handler)]() {
+        webview_->add_DocumentTitleChanged(
+            handler.Get(), &event_registrations_.document_title_changed_token_);
+      },
+      [this]() {
+        webview_->remove_DocumentTitleChanged(
+            event_registrations_.document_title_changed_token_);
+      });
 
   composition_controller_->add_CursorChanged(
       Callback<ICoreWebView2CursorChangedEventHandler>(
@@ -288,7 +500,7 @@ void Webview::RegisterEventHandlers() {
           .Get(),
       &event_registrations_.lost_focus_token_);
 
-  webview_->add_WebMessageReceived(
+  auto web_message_received_handler =
       Callback<ICoreWebView2WebMessageReceivedEventHandler>(
           [this](ICoreWebView2* sender,
                  ICoreWebView2WebMessageReceivedEventArgs* args) -> HRESULT {
@@ -300,9 +512,17 @@ void Webview::RegisterEventHandlers() {
             }
 
             return S_OK;
-          })
-          .Get(),
-      &event_registrations_.web_message_received_token_);
+          });
+  event_subscriptions_.AddHandler(
+      WebviewEvents::kWebMessageReceived,
+      [this, handler = std::move(web_message_received_handler)]() {
+        webview_->add_WebMessageReceived(
+            handler.Get(), &event_registrations_.web_message_received_token_);
+      },
+      [this]() {
+        webview_->remove_WebMessageReceived(
+            event_registrations_.web_message_received_token_);
+      });
 
   webview_->add_PermissionRequested(
       Callback<ICoreWebView2PermissionRequestedEventHandler>(
@@ -359,7 +579,7 @@ void Webview::RegisterEventHandlers() {
           .Get(),
       &event_registrations_.new_windows_requested_token_);
 
-  webview_->add_ContainsFullScreenElementChanged(
+  auto fullscreen_element_changed_handler =
       Callback<ICoreWebView2ContainsFullScreenElementChangedEventHandler>(
           [this](ICoreWebView2* sender, IUnknown* args) -> HRESULT {
             BOOL flag = FALSE;
@@ -368,9 +588,18 @@ void Webview::RegisterEventHandlers() {
               contains_fullscreen_element_changed_callback_(flag);
             }
             return S_OK;
-          })
-          .Get(),
-      &event_registrations_.contains_fullscreen_element_changed_token_);
+          });
+  event_subscriptions_.AddHandler(
+      WebviewEvents::kContainsFullScreenElementChanged,
+      [this, handler = std::move(fullscreen_element_changed_handler)]() {
+        webview_->add_ContainsFullScreenElementChanged(
+            handler.Get(),
+            &event_registrations_.contains_fullscreen_element_changed_token_);
+      },
+      [this]() {
+        webview_->remove_ContainsFullScreenElementChanged(
+            event_registrations_.contains_fullscreen_element_changed_token_);
+      });
 
   auto webview24 = webview_.try_query<ICoreWebView2_4>();
   if (webview24) {
@@ -417,6 +646,14 @@ void Webview::RegisterEventHandlers() {
             .Get(),
         &event_registrations_.download_starting_token_);
   }
+
+  event_subscriptions_.AddHandler(
+      WebviewEvents::kSecurityStateChanged,
+      [this]() { EnableSecurityUpdates(); },
+      [this]() { DisableSecurityUpdates(); });
+
+  // Everything is subscribed until Dart reports its listeners.
+  event_subscriptions_.Update(WebviewEvents::kAll);
 }
 
 void Webview::SetSurfaceSize(size_t width, size_t height, float scale_factor) {
@@ -477,7 +714,7 @@ bool Webview::SetCacheDisabled(bool disabled) {
   }
   std::string json = std::format("{{\"disableCache\":{}}}", disabled);
   return webview_->CallDevToolsProtocolMethod(L"Network.setCacheDisabled",
-                                              util::Utf16FromUtf8(json).c_str(),
+                                              util::ScratchUtf16(json).c_str(),
                                               nullptr) == S_OK;
 }
 
@@ -487,7 +724,7 @@ void Webview::SetPopupWindowPolicy(WebviewPopupWindowPolicy policy) {
 
 bool Webview::SetUserAgent(const std::string& user_agent) {
   if (settings2_) {
-    return settings2_->put_UserAgent(util::Utf16FromUtf8(user_agent).c_str()) ==
+    return settings2_->put_UserAgent(util::ScratchUtf16(user_agent).c_str()) ==
            S_OK;
   }
   return false;
@@ -579,25 +816,27 @@ void Webview::SetPointerUpdate(int32_t pointer,
   rect.top = point.y - 2;
   rect.bottom = point.y + 2;
 
-  host_->CreateWebViewPointerInfo(
-      [this, pointer, event, pointerFlags, point, rect, pressure](
-          wil::com_ptr<ICoreWebView2PointerInfo> pointerInfo,
-          std::unique_ptr<WebviewCreationError> error) {
-        if (pointerInfo) {
-          ICoreWebView2PointerInfo* pInfo = pointerInfo.get();
-          pInfo->put_PointerId(pointer);
-          pInfo->put_PointerKind(PT_TOUCH);
-          pInfo->put_PointerFlags(pointerFlags);
-          pInfo->put_TouchFlags(TOUCH_FLAG_NONE);
-          pInfo->put_TouchMask(TOUCH_MASK_CONTACTAREA | TOUCH_MASK_PRESSURE);
-          pInfo->put_TouchPressure(
-              std::clamp((UINT32)(pressure == 0.0 ? 1024 : 1024 * pressure),
-                         (UINT32)0, (UINT32)1024));
-          pInfo->put_PixelLocationRaw(point);
-          pInfo->put_TouchContactRaw(rect);
-          composition_controller_->SendPointerInput(event, pInfo);
-        }
-      });
+  const auto pointerInfo = pointer_info_pool_.Acquire(pointer);
+  if (pointerInfo) {
+    ICoreWebView2PointerInfo* pInfo = pointerInfo.get();
+    pInfo->put_PointerId(pointer);
+    pInfo->put_PointerKind(PT_TOUCH);
+    pInfo->put_PointerFlags(pointerFlags);
+    pInfo->put_TouchFlags(TOUCH_FLAG_NONE);
+    pInfo->put_TouchMask(TOUCH_MASK_CONTACTAREA | TOUCH_MASK_PRESSURE);
+    pInfo->put_TouchPressure(
+        std::clamp((UINT32)(pressure == 0.0 ? 1024 : 1024 * pressure),
+                   (UINT32)0, (UINT32)1024));
+    pInfo->put_PixelLocationRaw(point);
+    pInfo->put_TouchContactRaw(rect);
+    composition_controller_->SendPointerInput(event, pInfo);
+  }
+
+  // Flutter assigns a new pointer id to every touch.
+  if (eventKind == WebviewPointerEventKind::Up ||
+      eventKind == WebviewPointerEventKind::Leave) {
+    pointer_info_pool_.Release(pointer);
+  }
 }
 
 void Webview::SetPointerButtonState(WebviewPointerButton button, bool is_down) {
@@ -672,13 +911,13 @@ void Webview::SetScrollDelta(double delta_x, double delta_y) {
 
 void Webview::LoadUrl(const std::string& url) {
   if (IsValid()) {
-    webview_->Navigate(util::Utf16FromUtf8(url).c_str());
+    webview_->Navigate(util::ScratchUtf16(url).c_str());
   }
 }
 
 void Webview::LoadStringContent(const std::string& content) {
   if (IsValid()) {
-    webview_->NavigateToString(util::Utf16FromUtf8(content).c_str());
+    webview_->NavigateToString(util::ScratchUtf16(content).c_str());
   }
 }
 
@@ -716,7 +955,7 @@ void Webview::AddScriptToExecuteOnDocumentCreated(
     AddScriptToExecuteOnDocumentCreatedCallback callback) {
   if (IsValid()) {
     if (SUCCEEDED(webview_->AddScriptToExecuteOnDocumentCreated(
-            util::Utf16FromUtf8(script).c_str(),
+            util::ScratchUtf16(script).c_str(),
             Callback<
                 ICoreWebView2AddScriptToExecuteOnDocumentCreatedCompletedHandler>(
                 [callback](HRESULT result, LPCWSTR wsid) -> HRESULT {
@@ -736,7 +975,7 @@ void Webview::RemoveScriptToExecuteOnDocumentCreated(
     const std::string& script_id) {
   if (IsValid()) {
     webview_->RemoveScriptToExecuteOnDocumentCreated(
-        util::Utf16FromUtf8(script_id).c_str());
+        util::ScratchUtf16(script_id).c_str());
   }
 }
 
@@ -744,7 +983,7 @@ void Webview::ExecuteScript(const std::string& script,
                             ScriptExecutedCallback callback) {
   if (IsValid()) {
     if (SUCCEEDED(webview_->ExecuteScript(
-            util::Utf16FromUtf8(script).c_str(),
+            util::ScratchUtf16(script).c_str(),
             Callback<ICoreWebView2ExecuteScriptCompletedHandler>(
                 [callback](HRESULT result, LPCWSTR json_result_object) {
                   callback(SUCCEEDED(result),
@@ -759,11 +998,32 @@ void Webview::ExecuteScript(const std::string& script,
   callback(false, std::string());
 }
 
+void Webview::CallDevToolsProtocolMethod(
+    const std::string& method, const std::string& params,
+    DevToolsProtocolMethodCalledCallback callback) {
+  if (IsValid()) {
+    if (SUCCEEDED(webview_->CallDevToolsProtocolMethod(
+            util::ScratchUtf16(method).c_str(),
+            util::ScratchUtf16(params).c_str(),
+            Callback<ICoreWebView2CallDevToolsProtocolMethodCompletedHandler>(
+                [callback](HRESULT result, LPCWSTR json_result) {
+                  callback(SUCCEEDED(result),
+                           util::Utf8FromUtf16(json_result));
+                  return S_OK;
+                })
+                .Get()))) {
+      return;
+    }
+  }
+
+  callback(false, std::string());
+}
+
 bool Webview::PostWebMessage(const std::string& json) {
   if (!IsValid()) {
     return false;
   }
-  return webview_->PostWebMessageAsJson(util::Utf16FromUtf8(json).c_str()) ==
+  return webview_->PostWebMessageAsJson(util::ScratchUtf16(json).c_str()) ==
          S_OK;
 }
 
@@ -829,15 +1089,42 @@ bool Webview::SetVirtualHostNameMapping(
   }
 
   return webview->SetVirtualHostNameToFolderMapping(
-      util::Utf16FromUtf8(hostName).c_str(), util::Utf16FromUtf8(path).c_str(),
+      util::ScratchUtf16(hostName).c_str(), util::ScratchUtf16(path).c_str(),
       accessKindIntValue);
 }
 
+bool Webview::SetVirtualHostNameArchiveMapping(
+    const std::string& hostName, std::shared_ptr<const AssetArchive> archive,
+    const std::string& fallbackPath) {
+  if (!IsValid()) {
+    return false;
+  }
+
+  // A host that is mapped already has its filter.
+  if (!asset_server_.ClearMapping(hostName) &&
+      FAILED(webview_->AddWebResourceRequestedFilter(
+          util::ScratchUtf16(GetHostResourceFilter(hostName)).c_str(),
+          COREWEBVIEW2_WEB_RESOURCE_CONTEXT_ALL))) {
+    return false;
+  }
+  asset_server_.SetMapping(hostName, std::move(archive), fallbackPath);
+  UpdateWebResourceRequestedHandler();
+  return true;
+}
+
 bool Webview::ClearVirtualHostNameMapping(const std::string& hostName) {
   if (!IsValid()) {
     return false;
   }
 
+  if (asset_server_.ClearMapping(hostName)) {
+    webview_->RemoveWebResourceRequestedFilter(
+        util::ScratchUtf16(GetHostResourceFilter(hostName)).c_str(),
+        COREWEBVIEW2_WEB_RESOURCE_CONTEXT_ALL);
+    UpdateWebResourceRequestedHandler();
+    return true;
+  }
+
   wil::com_ptr<ICoreWebView2_3> webview;
   webview = webview_.query<ICoreWebView2_3>();
   if (!webview) {
@@ -845,7 +1132,333 @@ bool Webview::ClearVirtualHostNameMapping(const std::string& hostName) {
   }
 
   return webview->ClearVirtualHostNameToFolderMapping(
-      util::Utf16FromUtf8(hostName).c_str());
+      util::ScratchUtf16(hostName).c_str());
+}
+
+void Webview::UpdateWebResourceRequestedHandler() {
+  const bool needed = !asset_server_.empty() || response_cache_ || url_filter_;
+  if (needed == web_resource_requested_registered_) {
+    return;
+  }
+
+  if (!needed) {
+    webview_->remove_WebResourceRequested(
+        event_registrations_.web_resource_requested_token_);
+    web_resource_requested_registered_ = false;
+    return;
+  }
+
+  const auto handler = Callback<ICoreWebView2WebResourceRequestedEventHandler>(
+      [this](ICoreWebView2* sender,
+             ICoreWebView2WebResourceRequestedEventArgs* args) -> HRESULT {
+        HandleWebResourceRequest(args);
+        return S_OK;
+      });
+  web_resource_requested_registered_ =
+      SUCCEEDED(webview_->add_WebResourceRequested(
+          handler.Get(), &event_registrations_.web_resource_requested_token_));
+}
+
+void Webview::HandleWebResourceRequest(
+    ICoreWebView2WebResourceRequestedEventArgs* args) {
+  wil::com_ptr<ICoreWebView2WebResourceRequest> request;
+  wil::com_ptr<ICoreWebView2HttpRequestHeaders> headers;
+  wil::unique_cotaskmem_string uri;
+  wil::unique_cotaskmem_string method;
+  if (FAILED(args->get_Request(request.put())) ||
+      FAILED(request->get_Uri(&uri)) || FAILED(request->get_Method(&method)) ||
+      FAILED(request->get_Headers(headers.put()))) {
+    return;
+  }
+
+  const auto uri_utf8 = util::Utf8FromUtf16(uri.get());
+  if (url_filter_ && IsBlockedByUrlFilter(args, uri_utf8)) {
+    const auto web_response =
+        host_->CreateWebResourceResponse(nullptr, 403, "Blocked", "");
+    if (web_response) {
+      args->put_Response(web_response.get());
+    }
+    return;
+  }
+
+  const auto method_utf8 = util::Utf8FromUtf16(method.get());
+  std::optional<AssetServer::Response> response;
+  if (!asset_server_.empty()) {
+    const auto range = GetRequestHeader(headers.get(), L"Range");
+    const auto accept_encoding =
+        GetRequestHeader(headers.get(), L"Accept-Encoding");
+    const auto if_none_match =
+        GetRequestHeader(headers.get(), L"If-None-Match");
+
+    AssetServer::Request asset_request;
+    asset_request.method = method_utf8;
+    asset_request.uri = uri_utf8;
+    asset_request.range = range;
+    asset_request.accept_encoding = accept_encoding;
+    asset_request.if_none_match = if_none_match;
+    response = asset_server_.Handle(asset_request);
+  }
+  if (!response) {
+    if (response_cache_) {
+      ServeFromResponseCache(args, uri_utf8, method_utf8, headers.get());
+    }
+    return;
+  }
+
+  // The stream reads straight from the mapped archive, which it keeps open.
+  Microsoft::WRL::ComPtr<util::MemoryStream> content;
+  if (response->body) {
+    content = Make<util::MemoryStream>(response->body, response->body_size,
+                                       response->archive);
+  }
+  const auto web_response = host_->CreateWebResourceResponse(
+      content.Get(), response->status, response->reason, response->headers);
+  if (web_response) {
+    args->put_Response(web_response.get());
+  }
+}
+
+bool Webview::IsBlockedByUrlFilter(
+    ICoreWebView2WebResourceRequestedEventArgs* args, const std::string& uri) {
+  COREWEBVIEW2_WEB_RESOURCE_CONTEXT context;
+  if (FAILED(args->get_ResourceContext(&context))) {
+    context = COREWEBVIEW2_WEB_RESOURCE_CONTEXT_OTHER;
+  }
+
+  UrlFilter::Request request;
+  request.url = uri;
+  request.type = GetUrlFilterType(context);
+  // Subresources are made from the top-level document. Documents are taken
+  // to be loaded from themselves, since frames can't be told apart from
+  // navigations.
+  if (context != COREWEBVIEW2_WEB_RESOURCE_CONTEXT_DOCUMENT) {
+    request.document_host = document_host_;
+  }
+  return url_filter_->ShouldBlock(request);
+}
+
+void Webview::UpdateDocumentHost() {
+  wil::unique_cotaskmem_string source;
+  if (SUCCEEDED(webview_->get_Source(&source))) {
+    document_host_ =
+        UrlFilter::GetDocumentHost(util::Utf8FromUtf16(source.get()));
+  } else {
+    document_host_.clear();
+  }
+}
+
+bool Webview::SetUrlFilter(std::unique_ptr<UrlFilter> filter) {
+  if (!IsValid()) {
+    return false;
+  }
+
+  // Every request has to be seen to be filtered.
+  if (!url_filter_ && filter &&
+      FAILED(webview_->AddWebResourceRequestedFilter(
+          L"*", COREWEBVIEW2_WEB_RESOURCE_CONTEXT_ALL))) {
+    return false;
+  }
+  if (url_filter_ && !filter) {
+    webview_->RemoveWebResourceRequestedFilter(
+        L"*", COREWEBVIEW2_WEB_RESOURCE_CONTEXT_ALL);
+    webview_->remove_SourceChanged(
+        event_registrations_.url_filter_source_changed_token_);
+    document_host_.clear();
+  }
+  if (!url_filter_ && filter) {
+    // The source changes when a navigation commits, so that requests of the
+    // previous document that are still in flight keep its host.
+    webview_->add_SourceChanged(
+        Callback<ICoreWebView2SourceChangedEventHandler>(
+            [this](ICoreWebView2* /*sender*/, IUnknown* /*args*/) -> HRESULT {
+              UpdateDocumentHost();
+              return S_OK;
+            })
+            .Get(),
+        &event_registrations_.url_filter_source_changed_token_);
+    UpdateDocumentHost();
+  }
+  url_filter_ = std::move(filter);
+  UpdateWebResourceRequestedHandler();
+  return true;
+}
+
+bool Webview::SetResponseCache(std::shared_ptr<ResponseCache> cache,
+                               std::vector<CachePolicy::Rule> rules) {
+  if (!IsValid()) {
+    return false;
+  }
+
+  for (const auto& rule : cache_policy_.rules()) {
+    if (rule.mode != CachePolicy::Mode::kNever) {
+      webview_->RemoveWebResourceRequestedFilter(
+          util::ScratchUtf16(rule.url_pattern).c_str(),
+          COREWEBVIEW2_WEB_RESOURCE_CONTEXT_ALL);
+    }
+  }
+  if (!cache) {
+    rules.clear();
+  }
+  if (rules.empty()) {
+    cache.reset();
+  }
+
+  // kNever rules only carve exceptions out of the others, so they need no
+  // filter of their own.
+  for (const auto& rule : rules) {
+    if (rule.mode != CachePolicy::Mode::kNever) {
+      webview_->AddWebResourceRequestedFilter(
+          util::ScratchUtf16(rule.url_pattern).c_str(),
+          COREWEBVIEW2_WEB_RESOURCE_CONTEXT_ALL);
+    }
+  }
+  response_cache_ = std::move(cache);
+  cache_policy_.SetRules(std::move(rules));
+  UpdateWebResourceRequestedHandler();
+  UpdateWebResourceResponseReceivedHandler();
+  return true;
+}
+
+void Webview::ServeFromResponseCache(
+    ICoreWebView2WebResourceRequestedEventArgs* args, const std::string& uri,
+    const std::string& method, ICoreWebView2HttpRequestHeaders* headers) {
+  const auto rule = cache_policy_.Match(uri);
+  if (!rule) {
+    return;
+  }
+
+  const auto range = GetRequestHeader(headers, L"Range");
+  const auto cache_control = GetRequestHeader(headers, L"Cache-Control");
+  const auto pragma = GetRequestHeader(headers, L"Pragma");
+  const auto authorization = GetRequestHeader(headers, L"Authorization");
+  CachePolicy::Request request;
+  request.method = method;
+  request.range = range;
+  request.cache_control = cache_control;
+  request.pragma = pragma;
+  request.authorization = authorization;
+  if (!CachePolicy::CanServe(*rule, request)) {
+    return;
+  }
+  const auto entry = response_cache_->Lookup(uri, GetUnixTime());
+  if (!entry) {
+    return;
+  }
+
+  // The stream keeps the entry alive, even if the cache evicts it.
+  std::string response_headers = entry->headers;
+  util::AddHeader(response_headers, "Content-Length",
+                  std::to_string(entry->body.size()));
+  const auto content = Make<util::MemoryStream>(
+      reinterpret_cast<const uint8_t*>(entry->body.data()), entry->body.size(),
+      entry);
+  const auto web_response = host_->CreateWebResourceResponse(
+      content.Get(), 200, "OK", response_headers);
+  if (web_response) {
+    args->put_Response(web_response.get());
+  }
+}
+
+void Webview::UpdateWebResourceResponseReceivedHandler() {
+  const bool needed = response_cache_ != nullptr;
+  if (needed == web_resource_response_received_registered_) {
+    return;
+  }
+
+  auto webview = webview_.try_query<ICoreWebView2_2>();
+  if (!webview) {
+    return;
+  }
+  if (!needed) {
+    webview->remove_WebResourceResponseReceived(
+        event_registrations_.web_resource_response_received_token_);
+    web_resource_response_received_registered_ = false;
+    return;
+  }
+
+  const auto handler =
+      Callback<ICoreWebView2WebResourceResponseReceivedEventHandler>(
+          [this](ICoreWebView2* sender,
+                 ICoreWebView2WebResourceResponseReceivedEventArgs* args)
+              -> HRESULT {
+            StoreResponse(args);
+            return S_OK;
+          });
+  web_resource_response_received_registered_ =
+      SUCCEEDED(webview->add_WebResourceResponseReceived(
+          handler.Get(),
+          &event_registrations_.web_resource_response_received_token_));
+}
+
+void Webview::StoreResponse(
+    ICoreWebView2WebResourceResponseReceivedEventArgs* args) {
+  wil::com_ptr<ICoreWebView2WebResourceRequest> request;
+  wil::unique_cotaskmem_string uri;
+  if (!response_cache_ || FAILED(args->get_Request(request.put())) ||
+      FAILED(request->get_Uri(&uri))) {
+    return;
+  }
+  const auto uri_utf8 = util::Utf8FromUtf16(uri.get());
+  const auto rule = cache_policy_.Match(uri_utf8);
+  if (!rule) {
+    return;
+  }
+
+  wil::unique_cotaskmem_string method;
+  wil::com_ptr<ICoreWebView2HttpRequestHeaders> request_headers;
+  wil::com_ptr<ICoreWebView2WebResourceResponseView> response;
+  wil::com_ptr<ICoreWebView2HttpResponseHeaders> response_headers;
+  int status = 0;
+  if (FAILED(request->get_Method(&method)) ||
+      FAILED(request->get_Headers(request_headers.put())) ||
+      FAILED(args->get_Response(response.put())) ||
+      FAILED(response->get_StatusCode(&status)) ||
+      FAILED(response->get_Headers(response_headers.put()))) {
+    return;
+  }
+
+  const auto method_utf8 = util::Utf8FromUtf16(method.get());
+  const auto range = GetRequestHeader(request_headers.get(), L"Range");
+  const auto cache_control =
+      GetRequestHeader(request_headers.get(), L"Cache-Control");
+  const auto pragma = GetRequestHeader(request_headers.get(), L"Pragma");
+  const auto authorization =
+      GetRequestHeader(request_headers.get(), L"Authorization");
+  CachePolicy::Request cache_request;
+  cache_request.method = method_utf8;
+  cache_request.range = range;
+  cache_request.cache_control = cache_control;
+  cache_request.pragma = pragma;
+  cache_request.authorization = authorization;
+
+  const auto headers = GetResponseHeaders(response_headers.get());
+  const auto now = GetUnixTime();
+  const auto expiry =
+      CachePolicy::GetExpiry(*rule, cache_request, status, headers, now);
+  // Responses served from the cache are reported too, and are skipped since
+  // a fresh entry exists.
+  if (!expiry || response_cache_->Contains(uri_utf8, now)) {
+    return;
+  }
+
+  // The content is decoded, and complete once the request has finished.
+  // Captures no |this|, since it may complete after the webview is gone.
+  ResponseCache::Entry entry;
+  entry.url = uri_utf8;
+  entry.headers = CachePolicy::GetStoredHeaders(headers);
+  entry.expires_at = *expiry;
+  response->GetContent(
+      Callback<ICoreWebView2WebResourceResponseViewGetContentCompletedHandler>(
+          [cache = response_cache_, entry = std::move(entry)](
+              HRESULT result, IStream* content) mutable -> HRESULT {
+            if (SUCCEEDED(result) && content &&
+                ReadStream(content, static_cast<size_t>(cache->max_body_size()),
+                           entry.body)) {
+              cache->Store(std::move(entry));
+            }
+            return S_OK;
+          })
+          .Get());
 }
 
 void Webview::UpdateDownloadProgress(ICoreWebView2DownloadOperation* download) {
@@ -6,7 +6,19 @@
 #include <windows.ui.composition.h>
 #include <winrt/base.h>
 
+#include <cstdint>
 #include <functional>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "asset_server.h"
+#include "cache_policy.h"
+#include "devtools_subscriptions.h"
+#include "response_cache.h"
+#include "url_filter.h"
+#include "util/event_subscriptions.h"
+#include "util/keyed_object_pool.h"
 
 class WebviewHost;
 
@@ -38,6 +50,21 @@ enum class WebviewPopupWindowPolicy { Allow, Deny, ShowInSameWindow };
 
 enum class WebviewHostResourceAccessKind { Deny, Allow, DenyCors };
 
+// Events whose WebView2 handlers can be unregistered while they have no
+// listeners. All of them are registered until Dart unsubscribes. The values
+// are the bits of the subscription mask sent by Dart.
+struct WebviewEvents {
+  static constexpr uint32_t kUrlChanged = 1 << 0;
+  static constexpr uint32_t kLoadingStateChanged = 1 << 1;
+  static constexpr uint32_t kLoadError = 1 << 2;
+  static constexpr uint32_t kHistoryChanged = 1 << 3;
+  static constexpr uint32_t kSecurityStateChanged = 1 << 4;
+  static constexpr uint32_t kTitleChanged = 1 << 5;
+  static constexpr uint32_t kWebMessageReceived = 1 << 6;
+  static constexpr uint32_t kContainsFullScreenElementChanged = 1 << 7;
+  static constexpr uint32_t kAll = (1 << 8) - 1;
+};
+
 struct WebviewHistoryChanged {
   BOOL can_go_back;
   BOOL can_go_forward;
@@ -98,12 +125,14 @@ struct EventRegistrations {
   EventRegistrationToken lost_focus_token_{};
   EventRegistrationToken web_message_received_token_{};
   EventRegistrationToken permission_requested_token_{};
-  EventRegistrationToken devtools_protocol_event_token_{};
   EventRegistrationToken new_windows_requested_token_{};
   EventRegistrationToken contains_fullscreen_element_changed_token_{};
   EventRegistrationToken download_starting_token_{};
   EventRegistrationToken download_bytes_received_token_{};
   EventRegistrationToken download_state_changed_token_{};
+  EventRegistrationToken web_resource_requested_token_{};
+  EventRegistrationToken web_resource_response_received_token_{};
+  EventRegistrationToken url_filter_source_changed_token_{};
 };
 
 class Webview {
@@ -116,6 +145,11 @@ class Webview {
       OnLoadErrorCallback;
   typedef std::function<void(WebviewHistoryChanged)> HistoryChangedCallback;
   typedef std::function<void(const std::string&)> DevtoolsProtocolEventCallback;
+  typedef std::function<void(DevToolsSubscriptions::Id subscription,
+                             const std::string& params)>
+      DevToolsProtocolEventReceivedCallback;
+  typedef std::function<void(bool, const std::string&)>
+      DevToolsProtocolMethodCalledCallback;
   typedef std::function<void(const std::string&)> DocumentTitleChangedCallback;
   typedef std::function<void(size_t width, size_t height)>
       SurfaceSizeChangedCallback;
@@ -162,6 +196,18 @@ class Webview {
   void ExecuteScript(const std::string& script,
                      ScriptExecutedCallback callback);
   bool PostWebMessage(const std::string& json);
+  // Calls the DevTools protocol |method| with the JSON object |params|.
+  // |callback| gets whether the call succeeded and the JSON of its result,
+  // or of its error if it failed.
+  void CallDevToolsProtocolMethod(
+      const std::string& method, const std::string& params,
+      DevToolsProtocolMethodCalledCallback callback);
+  // Passes the params of the DevTools protocol |event| that match |filter|
+  // to the DevToolsProtocolEventReceivedCallback until unsubscribed. Returns
+  // DevToolsSubscriptions::kNoSubscription on failure.
+  DevToolsSubscriptions::Id SubscribeDevToolsProtocolEvent(
+      const std::string& event, DevToolsEventFilter filter);
+  bool UnsubscribeDevToolsProtocolEvent(DevToolsSubscriptions::Id id);
   bool ClearCookies();
   bool ClearCache();
   bool SetCacheDisabled(bool disabled);
@@ -176,10 +222,35 @@ class Webview {
   bool SetVirtualHostNameMapping(const std::string& hostName,
                                  const std::string& path,
                                  WebviewHostResourceAccessKind accessKind);
+  // Serves |hostName| from |archive| instead of a folder. Paths that aren't
+  // in the archive get |fallbackPath| if it is not empty.
+  bool SetVirtualHostNameArchiveMapping(
+      const std::string& hostName, std::shared_ptr<const AssetArchive> archive,
+      const std::string& fallbackPath);
+  // Removes the folder or archive mapping of |hostName|.
   bool ClearVirtualHostNameMapping(const std::string& hostName);
 
+  // Answers requests that match |rules| from |cache|, and stores the
+  // responses to them that the rules allow. Passing no rules stops using the
+  // cache.
+  bool SetResponseCache(std::shared_ptr<ResponseCache> cache,
+                        std::vector<CachePolicy::Rule> rules);
+  ResponseCache* response_cache() const { return response_cache_.get(); }
+
+  // Blocks the requests that |filter| matches with an empty 403 response.
+  // Passing nullptr stops filtering.
+  bool SetUrlFilter(std::unique_ptr<UrlFilter> filter);
+  UrlFilter* url_filter() const { return url_filter_.get(); }
+
   void UpdateDownloadProgress(ICoreWebView2DownloadOperation* download);
 
+  // Registers the handlers of the events in |subscriptions| (see
+  // WebviewEvents) and unregisters all others.
+  void SetEventSubscriptions(uint32_t subscriptions);
+  uint32_t event_subscriptions() const {
+    return event_subscriptions_.subscriptions();
+  }
+
   void OnUrlChanged(UrlChangedCallback callback) {
     url_changed_callback_ = std::move(callback);
   }
@@ -228,6 +299,11 @@ class Webview {
     devtools_protocol_event_callback_ = std::move(callback);
   }
 
+  void OnDevToolsProtocolEventReceived(
+      DevToolsProtocolEventReceivedCallback callback) {
+    devtools_protocol_event_received_callback_ = std::move(callback);
+  }
+
   void OnContainsFullScreenElementChanged(
       ContainsFullScreenElementChangedCallback callback) {
     contains_fullscreen_element_changed_callback_ = std::move(callback);
@@ -241,13 +317,24 @@ class Webview {
   wil::com_ptr<ICoreWebView2CompositionController> composition_controller_;
   wil::com_ptr<ICoreWebView2Controller3> webview_controller_;
   wil::com_ptr<ICoreWebView2> webview_;
-  wil::com_ptr<ICoreWebView2DevToolsProtocolEventReceiver>
-      devtools_protocol_event_receiver_;
   wil::com_ptr<ICoreWebView2Settings2> settings2_;
   POINT last_cursor_pos_ = {0, 0};
   VirtualKeyState virtual_keys_;
+  // Reused by the updates of a touch instead of allocating a new pointer
+  // info from the environment for each of them.
+  util::KeyedObjectPool<int32_t, wil::com_ptr<ICoreWebView2PointerInfo>>
+      pointer_info_pool_;
   WebviewPopupWindowPolicy popup_window_policy_ =
       WebviewPopupWindowPolicy::Allow;
+  AssetServer asset_server_;
+  std::shared_ptr<ResponseCache> response_cache_;
+  CachePolicy cache_policy_;
+  std::unique_ptr<UrlFilter> url_filter_;
+  // Host of the top-level document while a URL filter is set, updated when
+  // its source changes.
+  std::string document_host_;
+  bool web_resource_requested_registered_ = false;
+  bool web_resource_response_received_registered_ = false;
 
   winrt::com_ptr<ABI::Windows::UI::Composition::IVisual> surface_;
   winrt::com_ptr<ABI::Windows::UI::Composition::Desktop::IDesktopWindowTarget>
@@ -255,6 +342,19 @@ class Webview {
 
   WebviewHost* host_;
   EventRegistrations event_registrations_{};
+  util::EventSubscriptions event_subscriptions_;
+
+  struct DevToolsProtocolEventReceiver {
+    wil::com_ptr<ICoreWebView2DevToolsProtocolEventReceiver> receiver;
+    EventRegistrationToken token{};
+  };
+  // Receivers by event, shared by the subscriptions to it.
+  std::unordered_map<std::string, DevToolsProtocolEventReceiver>
+      devtools_protocol_event_receivers_;
+  DevToolsSubscriptions devtools_subscriptions_;
+  // Subscription of the securityStateChanged event stream.
+  DevToolsSubscriptions::Id security_subscription_ =
+      DevToolsSubscriptions::kNoSubscription;
 
   UrlChangedCallback url_changed_callback_;
   LoadingStateChangedCallback loading_state_changed_callback_;
@@ -268,6 +368,8 @@ class Webview {
   WebMessageReceivedCallback web_message_received_callback_;
   PermissionRequestedCallback permission_requested_callback_;
   DevtoolsProtocolEventCallback devtools_protocol_event_callback_;
+  DevToolsProtocolEventReceivedCallback
+      devtools_protocol_event_received_callback_;
   ContainsFullScreenElementChangedCallback
       contains_fullscreen_element_changed_callback_;
 
@@ -280,5 +382,23 @@ class Webview {
       HWND hwnd, bool offscreen_only);
   void RegisterEventHandlers();
   void EnableSecurityUpdates();
+  void DisableSecurityUpdates();
+  bool AddDevToolsProtocolEventReceiver(const std::string& event);
+  void RemoveDevToolsProtocolEventReceiver(const std::string& event);
   void SendScroll(double offset, bool horizontal);
+  // Registers the WebResourceRequested handler while requests need to be
+  // intercepted, and unregisters it otherwise.
+  void UpdateWebResourceRequestedHandler();
+  void HandleWebResourceRequest(
+      ICoreWebView2WebResourceRequestedEventArgs* args);
+  bool IsBlockedByUrlFilter(ICoreWebView2WebResourceRequestedEventArgs* args,
+                            const std::string& uri);
+  void UpdateDocumentHost();
+  void ServeFromResponseCache(ICoreWebView2WebResourceRequestedEventArgs* args,
+                              const std::string& uri, const std::string& method,
+                              ICoreWebView2HttpRequestHeaders* headers);
+  // Registers the WebResourceResponseReceived handler while responses are
+  // cached.
+  void UpdateWebResourceResponseReceivedHandler();
+  void StoreResponse(ICoreWebView2WebResourceResponseReceivedEventArgs* args);
 };
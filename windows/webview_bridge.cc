@@ -3,9 +3,18 @@
 #include <flutter/event_stream_handler_functions.h>
 #include <flutter/method_result_functions.h>
 
+#include <algorithm>
+#include <filesystem>
 #include <format>
 
+#include "asset_archive.h"
+#include "method_args.h"
+#include "method_call_log.h"
+#include "response_cache.h"
 #include "texture_bridge_gpu.h"
+#include "url_filter.h"
+#include "util/json_decoder.h"
+#include "util/string_converter.h"
 
 namespace {
 constexpr auto kErrorInvalidArgs = "invalidArguments";
@@ -36,48 +45,86 @@ constexpr auto kMethodResume = "resume";
 constexpr auto kMethodSetVirtualHostNameMapping = "setVirtualHostNameMapping";
 constexpr auto kMethodClearVirtualHostNameMapping =
     "clearVirtualHostNameMapping";
+constexpr auto kMethodSetVirtualHostNameArchiveMapping =
+    "setVirtualHostNameArchiveMapping";
+constexpr auto kMethodSetResponseCache = "setResponseCache";
+constexpr auto kMethodClearResponseCache = "clearResponseCache";
+constexpr auto kMethodSetUrlFilter = "setUrlFilter";
+constexpr auto kMethodGetUrlFilterHits = "getUrlFilterHits";
+constexpr auto kMethodCallDevToolsProtocolMethod = "callDevToolsProtocolMethod";
+constexpr auto kMethodSubscribeDevToolsProtocolEvent =
+    "subscribeDevToolsProtocolEvent";
+constexpr auto kMethodUnsubscribeDevToolsProtocolEvent =
+    "unsubscribeDevToolsProtocolEvent";
+constexpr auto kMethodSetPerformanceMetricsSampling =
+    "setPerformanceMetricsSampling";
 constexpr auto kMethodClearCookies = "clearCookies";
 constexpr auto kMethodClearCache = "clearCache";
 constexpr auto kMethodSetCacheDisabled = "setCacheDisabled";
 constexpr auto kMethodSetPopupWindowPolicy = "setPopupWindowPolicy";
 constexpr auto kMethodSetFpsLimit = "setFpsLimit";
+constexpr auto kMethodSetFrameSchedulingHints = "setFrameSchedulingHints";
+constexpr auto kMethodSetPermissionDecision = "setPermissionDecision";
+constexpr auto kMethodClearPermissionDecisions = "clearPermissionDecisions";
+constexpr auto kMethodSetPermissionAnswerTtl = "setPermissionAnswerTtl";
+constexpr auto kMethodSetNativeJsonDecoding = "setNativeJsonDecoding";
+constexpr auto kMethodSetEventSubscriptions = "setEventSubscriptions";
+constexpr auto kMethodGetSuppressedEventCounts = "getSuppressedEventCounts";
+constexpr auto kMethodSetTouchPrediction = "setTouchPrediction";
 
 constexpr auto kEventType = "type";
 constexpr auto kEventValue = "value";
+constexpr auto kEventDecoded = "decoded";
 
 constexpr auto kErrorNotSupported = "not_supported";
 constexpr auto kScriptFailed = "script_failed";
 constexpr auto kMethodFailed = "method_failed";
 
-static const std::optional<std::pair<double, double>> GetPointFromArgs(
-    const flutter::EncodableValue* args) {
-  const flutter::EncodableList* list =
-      std::get_if<flutter::EncodableList>(args);
-  if (!list || list->size() != 2) {
-    return std::nullopt;
-  }
-  const auto x = std::get_if<double>(&(*list)[0]);
-  const auto y = std::get_if<double>(&(*list)[1]);
-  if (!x || !y) {
-    return std::nullopt;
-  }
-  return std::make_pair(*x, *y);
+// Sampling more often than this measures the sampling more than the page.
+constexpr auto kMinPerformanceSampleInterval = std::chrono::milliseconds(100);
+
+static std::optional<flutter::EncodableValue> DecodeJson(
+    const std::string& json) {
+  return util::JsonDecoder<flutter::EncodableValue, flutter::EncodableList,
+                           flutter::EncodableMap>::Decode(json);
 }
 
-static const std::optional<std::tuple<double, double, double>>
-GetPointAndScaleFactorFromArgs(const flutter::EncodableValue* args) {
-  const flutter::EncodableList* list =
-      std::get_if<flutter::EncodableList>(args);
-  if (!list || list->size() != 3) {
-    return std::nullopt;
+// Returns the phase of a touch for the pointer predictor, or nothing if
+// |kind| neither moves nor starts or ends a touch.
+static std::optional<PointerPredictor::Phase> GetPointerPhase(
+    WebviewPointerEventKind kind) {
+  switch (kind) {
+    case WebviewPointerEventKind::Down:
+      return PointerPredictor::Phase::kDown;
+    case WebviewPointerEventKind::Update:
+      return PointerPredictor::Phase::kMove;
+    case WebviewPointerEventKind::Up:
+    case WebviewPointerEventKind::Leave:
+      return PointerPredictor::Phase::kUp;
+    default:
+      return std::nullopt;
   }
-  const auto x = std::get_if<double>(&(*list)[0]);
-  const auto y = std::get_if<double>(&(*list)[1]);
-  const auto z = std::get_if<double>(&(*list)[2]);
-  if (!x || !y || !z) {
-    return std::nullopt;
+}
+
+static int64_t GetArrivalTimestamp() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// Method calls that count as user interaction, which resumes a webview that
+// has been suspended by the plugin to save memory.
+static bool IsInteraction(const std::string& method_name) {
+  for (const auto name :
+       {kMethodSetCursorPos, kMethodSetPointerUpdate, kMethodSetPointerButton,
+        kMethodSetScrollDelta, kMethodLoadUrl, kMethodLoadStringContent,
+        kMethodReload, kMethodGoBack, kMethodGoForward, kMethodExecuteScript,
+        kMethodPostWebMessage, kMethodOpenDevTools, kMethodResume}) {
+    if (method_name.compare(name) == 0) {
+      return true;
+    }
   }
-  return std::make_tuple(*x, *y, *z);
+  return false;
 }
 
 static const std::string& GetCursorName(const HCURSOR cursor) {
@@ -138,10 +185,12 @@ static const std::string& GetCursorName(const HCURSOR cursor) {
 WebviewBridge::WebviewBridge(flutter::BinaryMessenger* messenger,
                              flutter::TextureRegistrar* texture_registrar,
                              GraphicsContext* graphics_context,
+                             FrameScheduler* frame_scheduler,
                              std::unique_ptr<Webview> webview)
     : webview_(std::move(webview)), texture_registrar_(texture_registrar) {
   texture_bridge_ =
       std::make_unique<TextureBridgeGpu>(graphics_context, webview_->surface());
+  texture_bridge_->SetFrameScheduler(frame_scheduler);
 
   flutter_texture_ =
       std::make_unique<flutter::TextureVariant>(flutter::GpuSurfaceTexture(
@@ -153,6 +202,7 @@ WebviewBridge::WebviewBridge(flutter::BinaryMessenger* messenger,
           }));
 
   texture_id_ = texture_registrar->RegisterTexture(flutter_texture_.get());
+  texture_bridge_->SetInstanceId(static_cast<uint32_t>(texture_id_));
   texture_bridge_->SetOnFrameAvailable(
       [this]() { texture_registrar_->MarkTextureFrameAvailable(texture_id_); });
   // texture_bridge_->SetOnSurfaceSizeChanged([this](Size size) {
@@ -182,6 +232,8 @@ WebviewBridge::WebviewBridge(flutter::BinaryMessenger* messenger,
              std::unique_ptr<flutter::EventSink<flutter::EncodableValue>>&&
                  events) {
         event_sink_ = std::move(events);
+        // A new listener has to receive the current state again.
+        state_event_caches_.Reset();
         RegisterEventHandlers();
         return nullptr;
       },
@@ -194,12 +246,31 @@ WebviewBridge::WebviewBridge(flutter::BinaryMessenger* messenger,
 }
 
 WebviewBridge::~WebviewBridge() {
+  Detach();
+  UnregisterTexture();
+}
+
+void WebviewBridge::Detach() {
   method_channel_->SetMethodCallHandler(nullptr);
-  texture_registrar_->UnregisterTexture(texture_id_);
+  event_channel_->SetStreamHandler(nullptr);
+  event_sink_ = nullptr;
+  interaction_callback_ = nullptr;
+  performance_sampler_ = nullptr;
+  performance_sampling_changed_callback_ = nullptr;
+}
+
+void WebviewBridge::UnregisterTexture() {
+  if (texture_registered_) {
+    texture_registered_ = false;
+    texture_registrar_->UnregisterTexture(texture_id_);
+  }
 }
 
 void WebviewBridge::RegisterEventHandlers() {
   webview_->OnUrlChanged([this](const std::string& url) {
+    if (!state_event_caches_.url.Update(url)) {
+      return;
+    }
     const auto event = flutter::EncodableValue(flutter::EncodableMap{
         {flutter::EncodableValue(kEventType),
          flutter::EncodableValue("urlChanged")},
@@ -251,6 +322,11 @@ void WebviewBridge::RegisterEventHandlers() {
   });
 
   webview_->OnHistoryChanged([this](WebviewHistoryChanged historyChanged) {
+    if (!state_event_caches_.history.Update(
+            {static_cast<bool>(historyChanged.can_go_back),
+             static_cast<bool>(historyChanged.can_go_forward)})) {
+      return;
+    }
     const auto event = flutter::EncodableValue(flutter::EncodableMap{
         {flutter::EncodableValue(kEventType),
          flutter::EncodableValue("historyChanged")},
@@ -275,7 +351,35 @@ void WebviewBridge::RegisterEventHandlers() {
     EmitEvent(event);
   });
 
+  webview_->OnDevToolsProtocolEventReceived(
+      [this](DevToolsSubscriptions::Id subscription, const std::string& json) {
+        auto params = flutter::EncodableValue(json);
+        bool decoded = false;
+        if (decode_json_natively_) {
+          // Falls back to the JSON text if decoding fails.
+          if (auto value = DecodeJson(json)) {
+            params = std::move(*value);
+            decoded = true;
+          }
+        }
+        const auto event = flutter::EncodableValue(flutter::EncodableMap{
+            {flutter::EncodableValue(kEventType),
+             flutter::EncodableValue("devToolsProtocolEvent")},
+            {flutter::EncodableValue(kEventValue),
+             flutter::EncodableValue(flutter::EncodableMap{
+                 {flutter::EncodableValue("subscription"),
+                  flutter::EncodableValue(static_cast<int64_t>(subscription))},
+                 {flutter::EncodableValue("params"), std::move(params)},
+             })},
+            {flutter::EncodableValue(kEventDecoded),
+             flutter::EncodableValue(decoded)}});
+        EmitEvent(event);
+      });
+
   webview_->OnDocumentTitleChanged([this](const std::string& title) {
+    if (!state_event_caches_.title.Update(title)) {
+      return;
+    }
     const auto event = flutter::EncodableValue(flutter::EncodableMap{
         {flutter::EncodableValue(kEventType),
          flutter::EncodableValue("titleChanged")},
@@ -289,6 +393,10 @@ void WebviewBridge::RegisterEventHandlers() {
   });
 
   webview_->OnCursorChanged([this](const HCURSOR cursor) {
+    // Compare the raw handles so that unchanged cursors skip the name lookup.
+    if (!state_event_caches_.cursor.Update(cursor)) {
+      return;
+    }
     const auto& name = GetCursorName(cursor);
     const auto event = flutter::EncodableValue(
         flutter::EncodableMap{{flutter::EncodableValue(kEventType),
@@ -298,6 +406,21 @@ void WebviewBridge::RegisterEventHandlers() {
   });
 
   webview_->OnWebMessageReceived([this](const std::string& message) {
+    if (decode_json_natively_) {
+      // Falls back to the JSON text if decoding fails, which Dart then
+      // reports as an error.
+      if (auto value = DecodeJson(message)) {
+        const auto event = flutter::EncodableValue(flutter::EncodableMap{
+            {flutter::EncodableValue(kEventType),
+             flutter::EncodableValue("webMessageReceived")},
+            {flutter::EncodableValue(kEventValue), std::move(*value)},
+            {flutter::EncodableValue(kEventDecoded),
+             flutter::EncodableValue(true)}});
+        EmitEvent(event);
+        return;
+      }
+    }
+
     const auto event = flutter::EncodableValue(
         flutter::EncodableMap{{flutter::EncodableValue(kEventType),
                                flutter::EncodableValue("webMessageReceived")},
@@ -328,17 +451,38 @@ void WebviewBridge::OnPermissionRequested(
     WebviewPermissionKind permissionKind,
     bool isUserInitiated,
     Webview::WebviewPermissionRequestedCompleter completer) {
+  // Answer from the native cache if possible. This completes the WebView2
+  // deferral synchronously instead of holding it for a Dart round trip.
+  const auto cached = permission_cache_->Lookup(
+      url, static_cast<int32_t>(permissionKind), isUserInitiated,
+      PermissionCache::Clock::now());
+  if (cached.has_value()) {
+    return completer(*cached ? WebviewPermissionState::Allow
+                             : WebviewPermissionState::Deny);
+  }
+
   auto args = std::make_unique<flutter::EncodableValue>(flutter::EncodableMap{
       {"url", url},
       {"isUserInitiated", isUserInitiated},
       {"permissionKind", static_cast<int>(permissionKind)}});
 
+  // Dart's answer is stored for the same origin, kind and initiation, so
+  // that repeated requests are answered natively.
+  std::weak_ptr<PermissionCache> weak_cache = permission_cache_;
+  const auto ttl = permission_answer_ttl_;
   method_channel_->InvokeMethod(
       "permissionRequested", std::move(args),
       std::make_unique<flutter::MethodResultFunctions<flutter::EncodableValue>>(
-          [completer](const flutter::EncodableValue* result) {
+          [completer, weak_cache, ttl, url, permissionKind,
+           isUserInitiated](const flutter::EncodableValue* result) {
             auto allow = std::get_if<bool>(result);
             if (allow != nullptr) {
+              const auto cache = weak_cache.lock();
+              if (cache && ttl.has_value()) {
+                cache->Set(url, static_cast<int32_t>(permissionKind),
+                           isUserInitiated, *allow, ttl,
+                           PermissionCache::Clock::now());
+              }
               return completer(*allow ? WebviewPermissionState::Allow
                                       : WebviewPermissionState::Deny);
             }
@@ -352,30 +496,173 @@ void WebviewBridge::OnPermissionRequested(
           [completer]() { completer(WebviewPermissionState::Default); }));
 }
 
+void WebviewBridge::RecordInputEvent(util::FlightEventType type,
+                                     util::FlightInputKind kind) {
+  util::RecordFlightEvent(static_cast<uint32_t>(texture_id_), type,
+                          static_cast<uint64_t>(kind));
+}
+
+void WebviewBridge::Suspend() {
+  if (suspended_) {
+    return;
+  }
+  suspended_ = true;
+  texture_bridge_->Stop();
+  webview_->Suspend();
+}
+
+void WebviewBridge::Resume() {
+  if (!suspended_) {
+    return;
+  }
+  suspended_ = false;
+  webview_->Resume();
+  texture_bridge_->Start();
+}
+
+std::optional<PerformanceSampler::Clock::time_point>
+WebviewBridge::NextPerformanceSample() const {
+  if (!performance_sampler_) {
+    return std::nullopt;
+  }
+  return performance_sampler_->next_sample();
+}
+
+void WebviewBridge::SamplePerformance(
+    PerformanceSampler::Clock::time_point now) {
+  const auto sampler = performance_sampler_;
+  if (!sampler || !sampler->BeginSample(now)) {
+    return;
+  }
+  // A suspended page does nothing worth measuring, and the first sample
+  // after resuming only restarts the interval.
+  if (suspended_) {
+    sampler->AbortSample(now);
+    return NotifyPerformanceSamplingChanged();
+  }
+
+  std::weak_ptr<PerformanceSampler> weak_sampler = sampler;
+  webview_->CallDevToolsProtocolMethod(
+      "Performance.getMetrics", "{}",
+      [this, weak_sampler](bool success, const std::string& metrics) {
+        const auto sampler = weak_sampler.lock();
+        if (!sampler) {
+          return;
+        }
+        if (!success) {
+          sampler->AbortSample(PerformanceSampler::Clock::now());
+          return NotifyPerformanceSamplingChanged();
+        }
+        if (!sampler->include_memory()) {
+          return EndPerformanceSample(*sampler, metrics, std::string());
+        }
+        webview_->CallDevToolsProtocolMethod(
+            "Runtime.getHeapUsage", "{}",
+            [this, weak_sampler, metrics](bool success,
+                                          const std::string& heap_usage) {
+              if (const auto sampler = weak_sampler.lock()) {
+                EndPerformanceSample(*sampler, metrics,
+                                     success ? heap_usage : std::string());
+              }
+            });
+      });
+}
+
+void WebviewBridge::SetPerformanceSampling(std::chrono::milliseconds interval,
+                                           bool include_memory) {
+  const bool was_sampling = performance_sampler_ != nullptr;
+  performance_sampler_ = nullptr;
+  if (interval.count() > 0) {
+    performance_sampler_ = std::make_shared<PerformanceSampler>(
+        std::max<PerformanceSampler::Clock::duration>(
+            interval, kMinPerformanceSampleInterval),
+        include_memory);
+    if (!was_sampling) {
+      webview_->CallDevToolsProtocolMethod(
+          "Performance.enable", "{}", [](bool, const std::string&) {});
+    }
+    // Frames before the first sample don't belong to any interval.
+    texture_bridge_->TakeFrameCounts();
+  } else if (was_sampling) {
+    webview_->CallDevToolsProtocolMethod("Performance.disable", "{}",
+                                         [](bool, const std::string&) {});
+  }
+  NotifyPerformanceSamplingChanged();
+}
+
+void WebviewBridge::EndPerformanceSample(PerformanceSampler& sampler,
+                                         const std::string& metrics,
+                                         const std::string& heap_usage) {
+  const auto record =
+      sampler.EndSample(metrics, heap_usage, texture_bridge_->TakeFrameCounts(),
+                        PerformanceSampler::Clock::now());
+  if (record) {
+    const auto event = flutter::EncodableValue(flutter::EncodableMap{
+        {flutter::EncodableValue(kEventType),
+         flutter::EncodableValue("performanceMetrics")},
+        {flutter::EncodableValue(kEventValue),
+         flutter::EncodableValue(
+             std::vector<double>(record->begin(), record->end()))},
+    });
+    EmitEvent(event);
+  }
+  NotifyPerformanceSamplingChanged();
+}
+
+void WebviewBridge::NotifyPerformanceSamplingChanged() {
+  if (performance_sampling_changed_callback_) {
+    performance_sampling_changed_callback_();
+  }
+}
+
 void WebviewBridge::HandleMethodCall(
     const flutter::MethodCall<flutter::EncodableValue>& method_call,
     std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
   const auto& method_name = method_call.method_name();
 
+  auto& recorder = MethodCallRecorder::Global();
+  if (recorder.recording()) {
+    recorder.Record(texture_id_, method_name, method_call.arguments());
+  }
+
+  if (interaction_callback_ && IsInteraction(method_name)) {
+    interaction_callback_();
+  }
+
   // setCursorPos: [double x, double y]
   if (method_name.compare(kMethodSetCursorPos) == 0) {
     const auto point = GetPointFromArgs(method_call.arguments());
     if (point) {
+      RecordInputEvent(util::FlightEventType::kInputReceived,
+                       util::FlightInputKind::kCursorPos);
       webview_->SetCursorPos(point->first, point->second);
+      RecordInputEvent(util::FlightEventType::kInputDispatched,
+                       util::FlightInputKind::kCursorPos);
       return result->Success();
     }
     return result->Error(kErrorInvalidArgs);
   }
 
   // setPointerUpdate:
-  // [int pointer, int event, double x, double y, double size, double pressure]
+  // [int pointer, int event, double x, double y, double size, double pressure,
+  //  int timestampUs?]
   if (method_name.compare(kMethodSetPointerUpdate) == 0) {
     const flutter::EncodableList* list =
         std::get_if<flutter::EncodableList>(method_call.arguments());
-    if (!list || list->size() != 6) {
+    if (!list || (list->size() != 6 && list->size() != 7)) {
       return result->Error(kErrorInvalidArgs);
     }
 
+    // Updates without the timestamp of the Flutter event are timed on
+    // arrival.
+    std::optional<int64_t> timestamp_us;
+    if (list->size() == 7) {
+      timestamp_us = GetIntegerValue((*list)[6]);
+      if (!timestamp_us) {
+        return result->Error(kErrorInvalidArgs);
+      }
+    }
+
     const auto pointer = std::get_if<int32_t>(&(*list)[0]);
     const auto event = std::get_if<int32_t>(&(*list)[1]);
     const auto x = std::get_if<double>(&(*list)[2]);
@@ -384,9 +671,20 @@ void WebviewBridge::HandleMethodCall(
     const auto pressure = std::get_if<double>(&(*list)[5]);
 
     if (pointer && event && x && y && size && pressure) {
-      webview_->SetPointerUpdate(*pointer,
-                                 static_cast<WebviewPointerEventKind>(*event),
-                                 *x, *y, *size, *pressure);
+      RecordInputEvent(util::FlightEventType::kInputReceived,
+                       util::FlightInputKind::kPointerUpdate);
+      const auto kind = static_cast<WebviewPointerEventKind>(*event);
+      auto position = std::make_pair(*x, *y);
+      const auto phase = GetPointerPhase(kind);
+      if (phase && pointer_predictor_.enabled()) {
+        position = pointer_predictor_.Update(
+            *pointer, *phase, timestamp_us.value_or(GetArrivalTimestamp()), *x,
+            *y);
+      }
+      webview_->SetPointerUpdate(*pointer, kind, position.first,
+                                 position.second, *size, *pressure);
+      RecordInputEvent(util::FlightEventType::kInputDispatched,
+                       util::FlightInputKind::kPointerUpdate);
       return result->Success();
     }
     return result->Error(kErrorInvalidArgs);
@@ -396,7 +694,11 @@ void WebviewBridge::HandleMethodCall(
   if (method_name.compare(kMethodSetScrollDelta) == 0) {
     const auto delta = GetPointFromArgs(method_call.arguments());
     if (delta) {
+      RecordInputEvent(util::FlightEventType::kInputReceived,
+                       util::FlightInputKind::kScroll);
       webview_->SetScrollDelta(delta->first, delta->second);
+      RecordInputEvent(util::FlightEventType::kInputDispatched,
+                       util::FlightInputKind::kScroll);
       return result->Success();
     }
     return result->Error(kErrorInvalidArgs);
@@ -412,8 +714,12 @@ void WebviewBridge::HandleMethodCall(
       const auto buttonValue = std::get_if<int32_t>(&button->second);
       const auto isDownValue = std::get_if<bool>(&isDown->second);
       if (buttonValue && isDownValue) {
+        RecordInputEvent(util::FlightEventType::kInputReceived,
+                         util::FlightInputKind::kPointerButton);
         webview_->SetPointerButtonState(
             static_cast<WebviewPointerButton>(*buttonValue), *isDownValue);
+        RecordInputEvent(util::FlightEventType::kInputDispatched,
+                         util::FlightInputKind::kPointerButton);
         return result->Success();
       }
     }
@@ -425,12 +731,17 @@ void WebviewBridge::HandleMethodCall(
     auto size = GetPointAndScaleFactorFromArgs(method_call.arguments());
     if (size) {
       const auto [width, height, scale_factor] = size.value();
+      util::RecordFlightEvent(
+          static_cast<uint32_t>(texture_id_), util::FlightEventType::kResize,
+          static_cast<uint64_t>(width) << 32 | static_cast<uint32_t>(height));
 
       webview_->SetSurfaceSize(static_cast<size_t>(width),
                                static_cast<size_t>(height),
                                static_cast<float>(scale_factor));
 
-      texture_bridge_->Start();
+      if (!suspended_) {
+        texture_bridge_->Start();
+      }
       return result->Success();
     }
     return result->Error(kErrorInvalidArgs);
@@ -489,15 +800,13 @@ void WebviewBridge::HandleMethodCall(
 
   // suspend
   if (method_name.compare(kMethodSuspend) == 0) {
-    texture_bridge_->Stop();
-    webview_->Suspend();
+    Suspend();
     return result->Success();
   }
 
   // resume
   if (method_name.compare(kMethodResume) == 0) {
-    webview_->Resume();
-    texture_bridge_->Start();
+    Resume();
     return result->Success();
   }
 
@@ -522,6 +831,34 @@ void WebviewBridge::HandleMethodCall(
     return result->Error(kErrorInvalidArgs);
   }
 
+  // setVirtualHostNameArchiveMapping:
+  // {"hostName": string, "path": string, "fallbackPath": string?}
+  if (method_name.compare(kMethodSetVirtualHostNameArchiveMapping) == 0) {
+    const auto map =
+        std::get_if<flutter::EncodableMap>(method_call.arguments());
+    if (!map) {
+      return result->Error(kErrorInvalidArgs);
+    }
+    const auto host_name = GetOptionalValue<std::string>(*map, "hostName");
+    const auto path = GetOptionalValue<std::string>(*map, "path");
+    if (!host_name || !path) {
+      return result->Error(kErrorInvalidArgs);
+    }
+
+    std::string error;
+    auto archive = AssetArchive::OpenShared(*path, error);
+    if (!archive) {
+      return result->Error(kMethodFailed, error);
+    }
+    if (!webview_->SetVirtualHostNameArchiveMapping(
+            *host_name, std::move(archive),
+            GetOptionalValue<std::string>(*map, "fallbackPath")
+                .value_or(std::string()))) {
+      return result->Error(kMethodFailed);
+    }
+    return result->Success();
+  }
+
   // clearVirtualHostNameMapping: string
   if (method_name.compare(kMethodClearVirtualHostNameMapping) == 0) {
     if (const auto hostName =
@@ -533,6 +870,196 @@ void WebviewBridge::HandleMethodCall(
     return result->Error(kErrorInvalidArgs);
   }
 
+  // setResponseCache:
+  // {"path": string, "rules": [{"urlPattern": string, "mode": int,
+  //  "maxAgeSeconds": int?}], "maxMemoryBytes": int?, "maxDiskBytes": int?}
+  if (method_name.compare(kMethodSetResponseCache) == 0) {
+    const auto map =
+        std::get_if<flutter::EncodableMap>(method_call.arguments());
+    if (!map) {
+      return result->Error(kErrorInvalidArgs);
+    }
+    const auto path = GetOptionalValue<std::string>(*map, "path");
+    const auto rules_it = map->find(flutter::EncodableValue("rules"));
+    if (!path || rules_it == map->end()) {
+      return result->Error(kErrorInvalidArgs);
+    }
+    auto rules = GetCacheRulesFromArgs(&rules_it->second);
+    if (!rules) {
+      return result->Error(kErrorInvalidArgs);
+    }
+
+    std::shared_ptr<ResponseCache> cache;
+    if (!rules->empty()) {
+      std::string error;
+      cache = ResponseCache::OpenShared(
+          std::filesystem::path(util::Utf16FromUtf8(*path)), error);
+      if (!cache) {
+        return result->Error(kMethodFailed, error);
+      }
+      ResponseCache::Limits limits;
+      if (const auto bytes = GetOptionalInteger(*map, "maxMemoryBytes")) {
+        limits.max_memory_bytes =
+            static_cast<uint64_t>(std::max<int64_t>(*bytes, 0));
+      }
+      if (const auto bytes = GetOptionalInteger(*map, "maxDiskBytes")) {
+        limits.max_disk_bytes =
+            static_cast<uint64_t>(std::max<int64_t>(*bytes, 0));
+      }
+      cache->SetLimits(limits);
+    }
+    if (!webview_->SetResponseCache(std::move(cache), std::move(*rules))) {
+      return result->Error(kMethodFailed);
+    }
+    return result->Success();
+  }
+
+  // clearResponseCache
+  if (method_name.compare(kMethodClearResponseCache) == 0) {
+    if (const auto cache = webview_->response_cache()) {
+      cache->Clear();
+    }
+    return result->Success();
+  }
+
+  // setUrlFilter
+  if (method_name.compare(kMethodSetUrlFilter) == 0) {
+    const auto rules = std::get_if<std::string>(method_call.arguments());
+    if (!rules) {
+      return result->Error(kErrorInvalidArgs);
+    }
+
+    std::unique_ptr<UrlFilter> filter;
+    int64_t rule_count = 0;
+    int64_t skipped_rule_count = 0;
+    if (!rules->empty()) {
+      filter = UrlFilter::Compile(*rules);
+      rule_count = static_cast<int64_t>(filter->rule_count());
+      skipped_rule_count = static_cast<int64_t>(filter->skipped_rule_count());
+    }
+    if (!webview_->SetUrlFilter(std::move(filter))) {
+      return result->Error(kMethodFailed);
+    }
+    return result->Success(flutter::EncodableValue(flutter::EncodableMap{
+        {flutter::EncodableValue("ruleCount"),
+         flutter::EncodableValue(rule_count)},
+        {flutter::EncodableValue("skippedRuleCount"),
+         flutter::EncodableValue(skipped_rule_count)},
+    }));
+  }
+
+  // getUrlFilterHits
+  if (method_name.compare(kMethodGetUrlFilterHits) == 0) {
+    const auto map =
+        std::get_if<flutter::EncodableMap>(method_call.arguments());
+    const bool reset =
+        map && GetOptionalValue<bool>(*map, "reset").value_or(false);
+
+    // Hits of rules that are listed more than once are added up.
+    flutter::EncodableMap hits;
+    if (const auto filter = webview_->url_filter()) {
+      for (const auto& rule : filter->GetHits()) {
+        auto& value = hits[flutter::EncodableValue(std::string(rule.rule))];
+        const auto previous = std::get_if<int64_t>(&value);
+        value = flutter::EncodableValue(static_cast<int64_t>(rule.hits) +
+                                        (previous ? *previous : 0));
+      }
+      if (reset) {
+        filter->ResetHits();
+      }
+    }
+    return result->Success(flutter::EncodableValue(std::move(hits)));
+  }
+
+  // callDevToolsProtocolMethod: {method: string, params: string?,
+  // decode: bool?}
+  if (method_name.compare(kMethodCallDevToolsProtocolMethod) == 0) {
+    const auto map =
+        std::get_if<flutter::EncodableMap>(method_call.arguments());
+    const auto method =
+        map ? GetOptionalValue<std::string>(*map, "method") : std::nullopt;
+    if (!method) {
+      return result->Error(kErrorInvalidArgs);
+    }
+    const auto params =
+        GetOptionalValue<std::string>(*map, "params").value_or("{}");
+    const bool decode = GetOptionalValue<bool>(*map, "decode").value_or(false);
+
+    std::shared_ptr<flutter::MethodResult<flutter::EncodableValue>>
+        shared_result = std::move(result);
+    webview_->CallDevToolsProtocolMethod(
+        *method, params,
+        [shared_result, decode](bool success, const std::string& json_result) {
+          if (!success) {
+            // The result is the protocol error, if there is one.
+            shared_result->Error(kMethodFailed,
+                                 "Calling the DevTools protocol method failed.",
+                                 json_result.empty()
+                                     ? flutter::EncodableValue()
+                                     : flutter::EncodableValue(json_result));
+          } else if (!decode) {
+            shared_result->Success(json_result);
+          } else if (auto value = DecodeJson(json_result)) {
+            shared_result->Success(*value);
+          } else {
+            shared_result->Error(kMethodFailed,
+                                 "Decoding the method result failed.");
+          }
+        });
+    return;
+  }
+
+  // subscribeDevToolsProtocolEvent: {event: string, filter: list?}
+  if (method_name.compare(kMethodSubscribeDevToolsProtocolEvent) == 0) {
+    const auto map =
+        std::get_if<flutter::EncodableMap>(method_call.arguments());
+    const auto event =
+        map ? GetOptionalValue<std::string>(*map, "event") : std::nullopt;
+    if (!event) {
+      return result->Error(kErrorInvalidArgs);
+    }
+    const auto it = map->find(flutter::EncodableValue("filter"));
+    auto filter = GetDevToolsEventFilterFromArgs(
+        it != map->end() ? &it->second : nullptr);
+    if (!filter) {
+      return result->Error(kErrorInvalidArgs);
+    }
+    const auto subscription =
+        webview_->SubscribeDevToolsProtocolEvent(*event, std::move(*filter));
+    if (subscription == DevToolsSubscriptions::kNoSubscription) {
+      return result->Error(kMethodFailed);
+    }
+    return result->Success(
+        flutter::EncodableValue(static_cast<int64_t>(subscription)));
+  }
+
+  // unsubscribeDevToolsProtocolEvent: int
+  if (method_name.compare(kMethodUnsubscribeDevToolsProtocolEvent) == 0) {
+    const auto args = method_call.arguments();
+    const auto subscription = args ? GetIntegerValue(*args) : std::nullopt;
+    if (!subscription) {
+      return result->Error(kErrorInvalidArgs);
+    }
+    webview_->UnsubscribeDevToolsProtocolEvent(
+        static_cast<DevToolsSubscriptions::Id>(*subscription));
+    return result->Success();
+  }
+
+  // setPerformanceMetricsSampling: {intervalMs: int, includeMemory: bool?}
+  if (method_name.compare(kMethodSetPerformanceMetricsSampling) == 0) {
+    const auto map =
+        std::get_if<flutter::EncodableMap>(method_call.arguments());
+    const auto interval_ms =
+        map ? GetOptionalInteger(*map, "intervalMs") : std::nullopt;
+    if (!interval_ms || *interval_ms < 0) {
+      return result->Error(kErrorInvalidArgs);
+    }
+    SetPerformanceSampling(
+        std::chrono::milliseconds(*interval_ms),
+        GetOptionalValue<bool>(*map, "includeMemory").value_or(false));
+    return result->Success();
+  }
+
   if (method_name.compare(kMethodAddScriptToExecuteOnDocumentCreated) == 0) {
     if (const auto script = std::get_if<std::string>(method_call.arguments())) {
       std::shared_ptr<flutter::MethodResult<flutter::EncodableValue>>
@@ -564,24 +1091,39 @@ void WebviewBridge::HandleMethodCall(
     return result->Error(kErrorInvalidArgs);
   }
 
-  // executeScript: string
+  // executeScript: string | {"script": string, "decode": bool}
+  // Returns the result as JSON text, or decoded if "decode" is set.
   if (method_name.compare(kMethodExecuteScript) == 0) {
-    if (const auto script = std::get_if<std::string>(method_call.arguments())) {
-      std::shared_ptr<flutter::MethodResult<flutter::EncodableValue>>
-          shared_result = std::move(result);
-
-      webview_->ExecuteScript(
-          *script,
-          [shared_result](bool success, const std::string& json_result) {
-            if (success) {
-              shared_result->Success(json_result);
-            } else {
-              shared_result->Error(kScriptFailed, "Executing script failed.");
-            }
-          });
-      return;
+    std::optional<std::string> script;
+    bool decode = false;
+    if (const auto value = std::get_if<std::string>(method_call.arguments())) {
+      script = *value;
+    } else if (const auto map = std::get_if<flutter::EncodableMap>(
+                   method_call.arguments())) {
+      script = GetOptionalValue<std::string>(*map, "script");
+      decode = GetOptionalValue<bool>(*map, "decode").value_or(false);
     }
-    return result->Error(kErrorInvalidArgs);
+    if (!script) {
+      return result->Error(kErrorInvalidArgs);
+    }
+
+    std::shared_ptr<flutter::MethodResult<flutter::EncodableValue>>
+        shared_result = std::move(result);
+    webview_->ExecuteScript(
+        *script,
+        [shared_result, decode](bool success, const std::string& json_result) {
+          if (!success) {
+            shared_result->Error(kScriptFailed, "Executing script failed.");
+          } else if (!decode) {
+            shared_result->Success(json_result);
+          } else if (auto value = DecodeJson(json_result)) {
+            shared_result->Success(*value);
+          } else {
+            shared_result->Error(kScriptFailed,
+                                 "Decoding the script result failed.");
+          }
+        });
+    return;
   }
 
   // postWebMessage: string
@@ -687,6 +1229,144 @@ void WebviewBridge::HandleMethodCall(
     return result->Error(kErrorInvalidArgs);
   }
 
+  // setPermissionDecision: {"origin": string, "permissionKind": int,
+  // "isUserInitiated": bool?, "allow": bool, "ttlMs": int?}
+  if (method_name.compare(kMethodSetPermissionDecision) == 0) {
+    const auto map =
+        std::get_if<flutter::EncodableMap>(method_call.arguments());
+    if (!map) {
+      return result->Error(kErrorInvalidArgs);
+    }
+
+    const auto origin = GetOptionalValue<std::string>(*map, "origin");
+    const auto kind = GetOptionalValue<int32_t>(*map, "permissionKind");
+    const auto allow = GetOptionalValue<bool>(*map, "allow");
+    if (!origin || !kind || !allow) {
+      return result->Error(kErrorInvalidArgs);
+    }
+
+    const auto ttl_ms = GetOptionalInteger(*map, "ttlMs");
+    if (ttl_ms && *ttl_ms <= 0) {
+      return result->Error(kErrorInvalidArgs);
+    }
+    std::optional<PermissionCache::Clock::duration> ttl;
+    if (ttl_ms) {
+      ttl = std::chrono::milliseconds(*ttl_ms);
+    }
+
+    permission_cache_->Set(*origin, *kind,
+                          GetOptionalValue<bool>(*map, "isUserInitiated"),
+                          *allow, ttl, PermissionCache::Clock::now());
+    return result->Success();
+  }
+
+  // clearPermissionDecisions: {"origin": string?, "permissionKind": int?}
+  if (method_name.compare(kMethodClearPermissionDecisions) == 0) {
+    const auto map =
+        std::get_if<flutter::EncodableMap>(method_call.arguments());
+    if (!map) {
+      return result->Error(kErrorInvalidArgs);
+    }
+
+    const auto origin = GetOptionalValue<std::string>(*map, "origin");
+    permission_cache_->Invalidate(
+        origin ? std::make_optional<std::string_view>(*origin) : std::nullopt,
+        GetOptionalValue<int32_t>(*map, "permissionKind"));
+    return result->Success();
+  }
+
+  // setPermissionAnswerTtl: int? (milliseconds, null to not store answers)
+  if (method_name.compare(kMethodSetPermissionAnswerTtl) == 0) {
+    const auto args = method_call.arguments();
+    if (!args || args->IsNull()) {
+      permission_answer_ttl_ = std::nullopt;
+      return result->Success();
+    }
+    const auto ttl_ms = GetIntegerValue(*args);
+    if (!ttl_ms || *ttl_ms <= 0) {
+      return result->Error(kErrorInvalidArgs);
+    }
+    permission_answer_ttl_ = std::chrono::milliseconds(*ttl_ms);
+    return result->Success();
+  }
+
+  // setFrameSchedulingHints:
+  // {"focused": bool?, "visible": bool?, "priority": double?}
+  if (method_name.compare(kMethodSetFrameSchedulingHints) == 0) {
+    const auto map =
+        std::get_if<flutter::EncodableMap>(method_call.arguments());
+    if (!map) {
+      return result->Error(kErrorInvalidArgs);
+    }
+
+    FrameScheduler::Hints hints;
+    hints.focused = GetOptionalValue<bool>(*map, "focused").value_or(false);
+    hints.visible = GetOptionalValue<bool>(*map, "visible").value_or(true);
+    hints.priority = GetOptionalValue<double>(*map, "priority").value_or(1.0);
+    texture_bridge_->SetFrameSchedulingHints(hints);
+    return result->Success();
+  }
+
+  // setEventSubscriptions: int (see WebviewEvents)
+  if (method_name.compare(kMethodSetEventSubscriptions) == 0) {
+    if (const auto subscriptions =
+            std::get_if<int32_t>(method_call.arguments())) {
+      const auto mask = static_cast<uint32_t>(*subscriptions);
+      state_event_caches_.Reset(webview_->event_subscriptions() ^ mask);
+      webview_->SetEventSubscriptions(mask);
+      return result->Success();
+    }
+    return result->Error(kErrorInvalidArgs);
+  }
+
+  // getSuppressedEventCounts
+  if (method_name.compare(kMethodGetSuppressedEventCounts) == 0) {
+    return result->Success(flutter::EncodableValue(flutter::EncodableMap{
+        {flutter::EncodableValue("urlChanged"),
+         flutter::EncodableValue(static_cast<int64_t>(
+             state_event_caches_.url.suppressed_count()))},
+        {flutter::EncodableValue("titleChanged"),
+         flutter::EncodableValue(static_cast<int64_t>(
+             state_event_caches_.title.suppressed_count()))},
+        {flutter::EncodableValue("cursorChanged"),
+         flutter::EncodableValue(static_cast<int64_t>(
+             state_event_caches_.cursor.suppressed_count()))},
+        {flutter::EncodableValue("historyChanged"),
+         flutter::EncodableValue(static_cast<int64_t>(
+             state_event_caches_.history.suppressed_count()))},
+    }));
+  }
+
+  // setNativeJsonDecoding: bool
+  if (method_name.compare(kMethodSetNativeJsonDecoding) == 0) {
+    if (const auto enabled = std::get_if<bool>(method_call.arguments())) {
+      decode_json_natively_ = *enabled;
+      return result->Success();
+    }
+    return result->Error(kErrorInvalidArgs);
+  }
+
+  // setTouchPrediction: {"lookaheadUs": int, "maxDistance": double?}
+  if (method_name.compare(kMethodSetTouchPrediction) == 0) {
+    const auto map =
+        std::get_if<flutter::EncodableMap>(method_call.arguments());
+    if (!map) {
+      return result->Error(kErrorInvalidArgs);
+    }
+
+    const auto lookahead_us = GetOptionalValue<int32_t>(*map, "lookaheadUs");
+    if (!lookahead_us || *lookahead_us < 0) {
+      return result->Error(kErrorInvalidArgs);
+    }
+
+    PointerPredictor::Options options;
+    options.lookahead = std::chrono::microseconds(*lookahead_us);
+    options.max_distance = GetOptionalValue<double>(*map, "maxDistance")
+                               .value_or(options.max_distance);
+    pointer_predictor_.SetOptions(options);
+    return result->Success();
+  }
+
   if (method_name.compare(kMethodSetFpsLimit) == 0) {
     if (const auto value = std::get_if<int32_t>(method_call.arguments())) {
       texture_bridge_->SetFpsLimit(*value == 0 ? std::nullopt
@@ -5,17 +5,63 @@
 #include <flutter/standard_method_codec.h>
 #include <flutter/texture_registrar.h>
 
+#include <chrono>
+#include <functional>
 #include <memory>
+#include <optional>
+#include <string>
+#include <utility>
 
+#include "frame_scheduler.h"
 #include "graphics_context.h"
+#include "performance_sampler.h"
+#include "permission_cache.h"
+#include "pointer_predictor.h"
 #include "texture_bridge.h"
+#include "util/flight_recorder.h"
+#include "util/last_value_cache.h"
 #include "webview.h"
 
+// Last-value caches for the state-like events that WebView2 tends to report
+// repeatedly with unchanged values (e.g. during SPA navigations).
+struct StateEventCaches {
+  util::LastValueCache<std::string> url;
+  util::LastValueCache<std::string> title;
+  util::LastValueCache<HCURSOR> cursor;
+  util::LastValueCache<std::pair<bool, bool>> history;
+
+  void Reset() {
+    url.Reset();
+    title.Reset();
+    cursor.Reset();
+    history.Reset();
+  }
+
+  // Forgets the values of the events in |events| (see WebviewEvents). Used
+  // when their subscription changes, as the changes that happened while
+  // their handlers were unregistered were never seen.
+  void Reset(uint32_t events) {
+    if (events & WebviewEvents::kUrlChanged) {
+      url.Reset();
+    }
+    if (events & WebviewEvents::kTitleChanged) {
+      title.Reset();
+    }
+    if (events & WebviewEvents::kHistoryChanged) {
+      history.Reset();
+    }
+  }
+};
+
 class WebviewBridge {
  public:
+  typedef std::function<void()> InteractionCallback;
+  typedef std::function<void()> PerformanceSamplingChangedCallback;
+
   WebviewBridge(flutter::BinaryMessenger* messenger,
                 flutter::TextureRegistrar* texture_registrar,
                 GraphicsContext* graphics_context,
+                FrameScheduler* frame_scheduler,
                 std::unique_ptr<Webview> webview);
   ~WebviewBridge();
 
@@ -23,6 +69,39 @@ class WebviewBridge {
 
   int64_t texture_id() const { return texture_id_; }
 
+  const StateEventCaches& state_event_caches() const {
+    return state_event_caches_;
+  }
+
+  // Stops handling method calls and emitting events. Used to dispose of the
+  // bridge in stages.
+  void Detach();
+  void UnregisterTexture();
+
+  // Stops rendering and suspends the webview's renderer process.
+  void Suspend();
+  void Resume();
+  bool suspended() const { return suspended_; }
+
+  // Called before handling a method call that counts as user interaction.
+  void OnInteraction(InteractionCallback callback) {
+    interaction_callback_ = std::move(callback);
+  }
+
+  // Returns when the next performance sample is due, or std::nullopt if
+  // performance metrics aren't sampled or a sample is being taken.
+  std::optional<PerformanceSampler::Clock::time_point> NextPerformanceSample()
+      const;
+
+  // Takes the performance sample that is due at |now|, if there is one.
+  void SamplePerformance(PerformanceSampler::Clock::time_point now);
+
+  // Called when the result of NextPerformanceSample changes.
+  void OnPerformanceSamplingChanged(
+      PerformanceSamplingChangedCallback callback) {
+    performance_sampling_changed_callback_ = std::move(callback);
+  }
+
  private:
   std::unique_ptr<flutter::TextureVariant> flutter_texture_;
   std::unique_ptr<TextureBridge> texture_bridge_;
@@ -35,11 +114,36 @@ class WebviewBridge {
 
   flutter::TextureRegistrar* texture_registrar_;
   int64_t texture_id_;
+  bool texture_registered_ = true;
+  StateEventCaches state_event_caches_;
+  // Shared with the pending permission requests, which store Dart's answer
+  // if the bridge still exists when it arrives.
+  std::shared_ptr<PermissionCache> permission_cache_ =
+      std::make_shared<PermissionCache>();
+  // How long Dart's answers to permission requests are stored, if at all.
+  std::optional<PermissionCache::Clock::duration> permission_answer_ttl_;
+  PointerPredictor pointer_predictor_;
+  bool suspended_ = false;
+  // Whether web messages and script results are decoded from JSON before
+  // they are sent to Dart.
+  bool decode_json_natively_ = false;
+  InteractionCallback interaction_callback_;
+  // Shared with the pending sample, which is dropped if sampling is stopped
+  // or restarted before its metrics arrive.
+  std::shared_ptr<PerformanceSampler> performance_sampler_;
+  PerformanceSamplingChangedCallback performance_sampling_changed_callback_;
 
   void HandleMethodCall(
       const flutter::MethodCall<flutter::EncodableValue>& method_call,
       std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
   void RegisterEventHandlers();
+  void RecordInputEvent(util::FlightEventType type, util::FlightInputKind kind);
+  void SetPerformanceSampling(std::chrono::milliseconds interval,
+                              bool include_memory);
+  void EndPerformanceSample(PerformanceSampler& sampler,
+                            const std::string& metrics,
+                            const std::string& heap_usage);
+  void NotifyPerformanceSamplingChanged();
 
   template <typename T>
   void EmitEvent(const T& value) {
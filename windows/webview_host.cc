@@ -1,10 +1,13 @@
 #include "webview_host.h"
 
+#include <psapi.h>
+#include <wil/resource.h>
 #include <wrl.h>
-#include <future>
 #include <iostream>
 
 #include "util/rohelper.h"
+#include "util/string_converter.h"
+#include "util/trace.h"
 
 using namespace Microsoft::WRL;
 
@@ -37,11 +40,19 @@ static std::wstring GetBrowserFolderFromEnvOrArg(
 
 // ────────────────────────────────────────────────
 // Create WebView host
-std::unique_ptr<WebviewHost> WebviewHost::Create(
+void WebviewHost::Create(
         WebviewPlatform* platform,
         std::optional<std::wstring> user_data_directory,
         std::optional<std::wstring> browser_exe_path,
-        std::optional<std::string> arguments) {
+        std::optional<std::string> arguments,
+        HostCreationCallback callback) {
+    // Spans the whole asynchronous creation.
+    callback = [callback, start = util::TraceClock::now()](
+            std::unique_ptr<WebviewHost> host,
+            std::unique_ptr<WebviewCreationError> error) {
+        util::RecordTraceSpan("WebviewHost::Create", start);
+        callback(std::move(host), std::move(error));
+    };
 
     wil::com_ptr<CoreWebView2EnvironmentOptions> opts;
     if (arguments.has_value()) {
@@ -80,19 +91,40 @@ std::unique_ptr<WebviewHost> WebviewHost::Create(
     std::wcerr << L"[WebviewHost] resolved dataDirArg = "
                << (dataDirArg ? dataDirArg : L"(null)") << std::endl;
 
-    std::promise<HRESULT> result_promise;
-    wil::com_ptr<ICoreWebView2Environment> env;
-
+    // The completion handler runs later on this thread's message loop, so
+    // the platform thread keeps pumping messages while the browser process
+    // starts up.
     HRESULT beginHr = CreateCoreWebView2EnvironmentWithOptions(
             browserFolderArg,
             dataDirArg,
             opts.get(),
             Callback<ICoreWebView2CreateCoreWebView2EnvironmentCompletedHandler>(
-                    [&result_promise, &env](HRESULT r, ICoreWebView2Environment* createdEnv) -> HRESULT {
+                    [platform, callback](HRESULT r, ICoreWebView2Environment* createdEnv) -> HRESULT {
                         std::wcerr << L"[WebviewHost] completion handler called, HRESULT=0x"
                                    << std::hex << r << std::dec << std::endl;
-                        result_promise.set_value(r);
-                        env.swap(createdEnv);
+                        if (FAILED(r)) {
+                            callback(nullptr, WebviewCreationError::create(
+                                    r, "CreateCoreWebView2EnvironmentWithOptions completion failed."));
+                            return S_OK;
+                        }
+
+                        if (!createdEnv) {
+                            callback(nullptr, WebviewCreationError::create(
+                                    E_POINTER, "WebView2 environment pointer is null after successful creation."));
+                            return S_OK;
+                        }
+
+                        wil::com_ptr<ICoreWebView2Environment> env(createdEnv);
+                        auto env3 = env.try_query<ICoreWebView2Environment3>();
+                        if (!env3) {
+                            callback(nullptr, WebviewCreationError::create(
+                                    E_NOINTERFACE, "Failed to QI ICoreWebView2Environment3."));
+                            return S_OK;
+                        }
+
+                        std::wcerr << L"[WebviewHost] Successfully created WebView2 environment." << std::endl;
+                        callback(std::unique_ptr<WebviewHost>(new WebviewHost(platform, std::move(env3))),
+                                 nullptr);
                         return S_OK;
                     })
                     .Get());
@@ -100,29 +132,9 @@ std::unique_ptr<WebviewHost> WebviewHost::Create(
     if (FAILED(beginHr)) {
         std::cerr << "[WebviewHost] CreateCoreWebView2EnvironmentWithOptions call failed immediately. HRESULT=0x"
                   << std::hex << beginHr << std::dec << std::endl;
-        return {};
-    }
-
-    HRESULT completedHr = result_promise.get_future().get();
-    if (FAILED(completedHr)) {
-        std::cerr << "[WebviewHost] CreateCoreWebView2EnvironmentWithOptions completion failed. HRESULT=0x"
-                  << std::hex << completedHr << std::dec << std::endl;
-        return {};
-    }
-
-    if (!env) {
-        std::cerr << "[WebviewHost] WebView2 environment pointer is null after successful creation.\n";
-        return {};
-    }
-
-    auto env3 = env.try_query<ICoreWebView2Environment3>();
-    if (!env3) {
-        std::cerr << "[WebviewHost] Failed to QI ICoreWebView2Environment3.\n";
-        return {};
+        callback(nullptr, WebviewCreationError::create(
+                beginHr, "CreateCoreWebView2EnvironmentWithOptions failed."));
     }
-
-    std::wcerr << L"[WebviewHost] Successfully created WebView2 environment." << std::endl;
-    return std::unique_ptr<WebviewHost>(new WebviewHost(platform, std::move(env3)));
 }
 
 // ────────────────────────────────────────────────
@@ -150,18 +162,75 @@ void WebviewHost::CreateWebview(HWND hwnd, bool offscreen_only,
             });
 }
 
-void WebviewHost::CreateWebViewPointerInfo(PointerInfoCreationCallback callback) {
-    ICoreWebView2PointerInfo* pointer = nullptr;
-    auto hr = webview_env_->CreateCoreWebView2PointerInfo(&pointer);
-    if (FAILED(hr)) {
-        callback(nullptr, WebviewCreationError::create(hr, "CreateWebViewPointerInfo failed."));
-    } else {
-        callback(std::move(wil::com_ptr<ICoreWebView2PointerInfo>(pointer)), nullptr);
+wil::com_ptr<ICoreWebView2PointerInfo> WebviewHost::CreateWebViewPointerInfo() {
+    wil::com_ptr<ICoreWebView2PointerInfo> pointer;
+    if (FAILED(webview_env_->CreateCoreWebView2PointerInfo(pointer.put()))) {
+        return nullptr;
     }
+    return pointer;
+}
+
+wil::com_ptr<ICoreWebView2WebResourceResponse>
+WebviewHost::CreateWebResourceResponse(IStream* content, int status,
+                                       std::string_view reason,
+                                       std::string_view headers) {
+    wil::com_ptr<ICoreWebView2WebResourceResponse> response;
+    if (FAILED(webview_env_->CreateWebResourceResponse(
+            content, status, util::ScratchUtf16(reason).c_str(),
+            util::ScratchUtf16(headers).c_str(), response.put()))) {
+        return nullptr;
+    }
+    return response;
+}
+
+std::optional<uint64_t> WebviewHost::GetMemoryUsage() const {
+    auto env8 = webview_env_.try_query<ICoreWebView2Environment8>();
+    if (!env8) {
+        return std::nullopt;
+    }
+
+    wil::com_ptr<ICoreWebView2ProcessInfoCollection> processes;
+    UINT32 count = 0;
+    if (FAILED(env8->GetProcessInfos(processes.put())) ||
+        FAILED(processes->get_Count(&count))) {
+        return std::nullopt;
+    }
+
+    uint64_t total = 0;
+    for (UINT32 i = 0; i < count; ++i) {
+        wil::com_ptr<ICoreWebView2ProcessInfo> info;
+        INT32 process_id = 0;
+        if (FAILED(processes->GetValueAtIndex(i, info.put())) ||
+            FAILED(info->get_ProcessId(&process_id))) {
+            continue;
+        }
+
+        // Processes may exit while being enumerated.
+        wil::unique_handle process(OpenProcess(
+                PROCESS_QUERY_LIMITED_INFORMATION, FALSE,
+                static_cast<DWORD>(process_id)));
+        PROCESS_MEMORY_COUNTERS_EX counters = {};
+        if (process &&
+            GetProcessMemoryInfo(
+                    process.get(),
+                    reinterpret_cast<PROCESS_MEMORY_COUNTERS*>(&counters),
+                    sizeof(counters))) {
+            total += counters.PrivateUsage;
+        }
+    }
+    return total;
 }
 
 void WebviewHost::CreateWebViewCompositionController(
         HWND hwnd, CompositionControllerCreationCallback callback) {
+    callback = [callback, start = util::TraceClock::now()](
+            wil::com_ptr<ICoreWebView2CompositionController> controller,
+            std::unique_ptr<WebviewCreationError> error) {
+        util::RecordTraceSpan("WebviewHost::CreateCompositionController",
+                              start);
+        callback(std::move(controller), std::move(error));
+    };
+
     auto hr = webview_env_->CreateCoreWebView2CompositionController(
             hwnd,
             Callback<ICoreWebView2CreateCoreWebView2CompositionControllerCompletedHandler>(
@@ -4,7 +4,10 @@
 #include <WebView2EnvironmentOptions.h>
 #include <wil/com.h>
 
+#include <cstdint>
 #include <functional>
+#include <optional>
+#include <string_view>
 
 #include "graphics_context.h"
 #include "webview.h"
@@ -26,26 +29,40 @@ struct WebviewCreationError {
 
 class WebviewHost {
  public:
+  typedef std::function<void(std::unique_ptr<WebviewHost>,
+                             std::unique_ptr<WebviewCreationError>)>
+      HostCreationCallback;
   typedef std::function<void(std::unique_ptr<Webview>,
                              std::unique_ptr<WebviewCreationError>)>
       WebviewCreationCallback;
   typedef std::function<void(wil::com_ptr<ICoreWebView2CompositionController>,
                              std::unique_ptr<WebviewCreationError>)>
       CompositionControllerCreationCallback;
-  typedef std::function<void(wil::com_ptr<ICoreWebView2PointerInfo>,
-                             std::unique_ptr<WebviewCreationError>)>
-      PointerInfoCreationCallback;
 
-  static std::unique_ptr<WebviewHost> Create(
-      WebviewPlatform* platform,
-      std::optional<std::wstring> user_data_directory = std::nullopt,
-      std::optional<std::wstring> browser_exe_path = std::nullopt,
-      std::optional<std::string> arguments = std::nullopt);
+  // Creates the WebView2 environment without blocking the calling thread.
+  // |callback| is invoked on the calling thread once the environment has
+  // been created or its creation has failed.
+  static void Create(WebviewPlatform* platform,
+                     std::optional<std::wstring> user_data_directory,
+                     std::optional<std::wstring> browser_exe_path,
+                     std::optional<std::string> arguments,
+                     HostCreationCallback callback);
 
   void CreateWebview(HWND hwnd, bool offscreen_only, bool owns_window,
                      WebviewCreationCallback callback);
 
-  void CreateWebViewPointerInfo(PointerInfoCreationCallback cb);
+  // Returns nullptr if the pointer info can't be created.
+  wil::com_ptr<ICoreWebView2PointerInfo> CreateWebViewPointerInfo();
+
+  // Returns a response for a WebResourceRequested event, or nullptr if it
+  // can't be created. |headers| are "Name: value" lines separated by CRLF.
+  wil::com_ptr<ICoreWebView2WebResourceResponse> CreateWebResourceResponse(
+      IStream* content, int status, std::string_view reason,
+      std::string_view headers);
+
+  // Returns the private memory committed by all processes of this
+  // environment or std::nullopt if the runtime can't enumerate them.
+  std::optional<uint64_t> GetMemoryUsage() const;
 
   winrt::com_ptr<ABI::Windows::UI::Composition::ICompositor> compositor()
       const {
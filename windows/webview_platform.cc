@@ -8,8 +8,11 @@
 #include <filesystem>
 #include <iostream>
 
+#include "util/trace.h"
+
 WebviewPlatform::WebviewPlatform()
         : rohelper_(std::make_unique<rx::RoHelper>(RO_INIT_SINGLETHREADED)) {
+    util::ScopedTraceSpan span("WebviewPlatform::WebviewPlatform");
     if (!rohelper_->WinRtAvailable()) return;
 
     // Reuse an existing DispatcherQueue on this thread if there is one.
@@ -42,25 +45,18 @@ WebviewPlatform::WebviewPlatform()
         return;
     }
 
-    graphics_context_ = std::make_unique<GraphicsContext>(rohelper_.get());
+    {
+        util::ScopedTraceSpan graphics_span("GraphicsContext::GraphicsContext");
+        graphics_context_ = std::make_unique<GraphicsContext>(rohelper_.get());
+    }
     valid_ = graphics_context_->IsValid();
 }
 
 bool WebviewPlatform::IsGraphicsCaptureSessionSupported() {
-    HSTRING className;
-    HSTRING_HEADER classNameHeader;
-
-    if (FAILED(rohelper_->GetStringReference(
-            RuntimeClass_Windows_Graphics_Capture_GraphicsCaptureSession,
-            &className, &classNameHeader))) {
-        return false;
-    }
-
-    ABI::Windows::Graphics::Capture::IGraphicsCaptureSessionStatics* capture_session_statics;
-    if (FAILED(rohelper_->GetActivationFactory(
-            className,
-            __uuidof(ABI::Windows::Graphics::Capture::IGraphicsCaptureSessionStatics),
-            (void**)&capture_session_statics))) {
+    const auto capture_session_statics = rohelper_->GetActivationFactory<
+            ABI::Windows::Graphics::Capture::IGraphicsCaptureSessionStatics>(
+            RuntimeClass_Windows_Graphics_Capture_GraphicsCaptureSession);
+    if (!capture_session_statics) {
         return false;
     }
 
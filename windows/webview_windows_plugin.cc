@@ -5,11 +5,28 @@
 #include <flutter/standard_method_codec.h>
 #include <windows.h>
 
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <map>
 #include <memory>
 #include <string>
 #include <unordered_map>
-
+#include <vector>
+
+#include "async_resource.h"
+#include "dispose_queue.h"
+#include "environment_registry.h"
+#include "frame_scheduler.h"
+#include "method_args.h"
+#include "method_call_log.h"
+#include "prewarm_pool.h"
+#include "suspend_policy.h"
+#include "util/flight_recorder.h"
 #include "util/string_converter.h"
+#include "util/trace.h"
 #include "webview_bridge.h"
 #include "webview_host.h"
 #include "webview_platform.h"
@@ -23,26 +40,67 @@ constexpr auto kMethodInitialize = "initialize";
 constexpr auto kMethodDispose = "dispose";
 constexpr auto kMethodInitializeEnvironment = "initializeEnvironment";
 constexpr auto kMethodGetWebViewVersion = "getWebViewVersion";
+constexpr auto kMethodSetPrewarmPoolOptions = "setPrewarmPoolOptions";
+constexpr auto kMethodSetEnvironmentGracePeriod = "setEnvironmentGracePeriod";
+constexpr auto kMethodSetFrameBudget = "setFrameBudget";
+constexpr auto kMethodSetSuspendPolicy = "setSuspendPolicy";
+constexpr auto kMethodExportTrace = "exportTrace";
+constexpr auto kMethodSnapshotFlightRecorder = "snapshotFlightRecorder";
+constexpr auto kMethodSetFlightRecorderOptions = "setFlightRecorderOptions";
+constexpr auto kMethodStartMethodCallRecording = "startMethodCallRecording";
+constexpr auto kMethodStopMethodCallRecording = "stopMethodCallRecording";
 
 constexpr auto kErrorCodeInvalidId = "invalid_id";
+constexpr auto kErrorCodeInvalidProfile = "invalid_profile";
 constexpr auto kErrorCodeEnvironmentCreationFailed =
     "environment_creation_failed";
 constexpr auto kErrorCodeEnvironmentAlreadyInitialized =
     "environment_already_initialized";
 constexpr auto kErrorCodeWebviewCreationFailed = "webview_creation_failed";
 constexpr auto kErrorUnsupportedPlatform = "unsupported_platform";
+constexpr auto kErrorInvalidArgs = "invalidArguments";
 
-template <typename T>
-std::optional<T> GetOptionalValue(const flutter::EncodableMap& map,
-                                  const std::string& key) {
-  const auto it = map.find(flutter::EncodableValue(key));
-  if (it != map.end()) {
-    const auto val = std::get_if<T>(&it->second);
-    if (val) {
-      return *val;
-    }
+constexpr UINT_PTR kPoolTrimTimerId = 1;
+constexpr UINT_PTR kEnvironmentCollectionTimerId = 2;
+constexpr UINT_PTR kMemoryCheckTimerId = 3;
+constexpr UINT_PTR kDisposeTimerId = 4;
+constexpr UINT_PTR kPerformanceSampleTimerId = 5;
+constexpr UINT_PTR kDeferredFrameTimerId = 6;
+
+// Time spent tearing down disposed instances per timer tick.
+constexpr auto kDisposeSliceBudget = std::chrono::milliseconds(4);
+
+// Posted to the message window when the flight recorder detected a hitch.
+constexpr UINT kHitchSnapshotMessage = WM_APP + 1;
+
+// Posted to the message window when the frame scheduler deferred a frame
+// or may allow deferred frames to be published now.
+constexpr UINT kDeferredFrameMessage = WM_APP + 2;
+
+// Limits how often hitch snapshots are written.
+constexpr auto kMinHitchSnapshotInterval = std::chrono::seconds(10);
+
+// How long an environment without webviews is kept alive.
+constexpr auto kDefaultEnvironmentGracePeriod = std::chrono::seconds(60);
+
+// If set, the trace is written to this file when the plugin is destroyed.
+constexpr auto kTraceFileEnvironmentVariable = L"WEBVIEW_WINDOWS_TRACE_FILE";
+
+// How often the memory usage is compared against the suspend policy.
+constexpr auto kDefaultMemoryCheckInterval = std::chrono::seconds(5);
+
+typedef AsyncResource<WebviewHost, WebviewCreationError> AsyncWebviewHost;
+
+void ReplyEnvironmentCreationError(
+    flutter::MethodResult<flutter::EncodableValue>& result,
+    const WebviewCreationError* error) {
+  if (error) {
+    return result.Error(
+        kErrorCodeEnvironmentCreationFailed,
+        std::format("Creating the environment failed: {} (HRESULT: {:#010x})",
+                    error->message, error->hr));
   }
-  return std::nullopt;
+  result.Error(kErrorCodeEnvironmentCreationFailed);
 }
 
 class WebviewWindowsPlugin : public flutter::Plugin {
@@ -56,17 +114,65 @@ class WebviewWindowsPlugin : public flutter::Plugin {
 
  private:
   std::unique_ptr<WebviewPlatform> platform_;
-  std::unique_ptr<WebviewHost> webview_host_;
+  // Shared frame budget of all texture bridges.
+  FrameScheduler frame_scheduler_;
+  // WebView2 environments shared by all webviews with equal keys.
+  RefCountedRegistry<EnvironmentKey, AsyncWebviewHost> environments_;
+  // Environment keys by profile name. The empty name is the default profile.
+  std::map<std::string, EnvironmentKey> profiles_;
   std::unordered_map<int64_t, std::unique_ptr<WebviewBridge>> instances_;
+  std::unordered_map<int64_t, EnvironmentKey> instance_environments_;
+  // Disposed instances that are still being torn down.
+  StagedDisposeQueue dispose_queue_;
+  // Suspends the least recently used instances under memory pressure.
+  SuspendPolicy suspend_policy_;
+  std::chrono::steady_clock::duration memory_check_interval_ =
+      kDefaultMemoryCheckInterval;
+  // Flight recorder snapshots are written here on hitches, if set.
+  std::optional<std::filesystem::path> hitch_snapshot_directory_;
+  // Prewarmed webviews for the default profile.
+  PrewarmPool<WebviewBridge> pool_;
+  // The environment the pool holds a reference to, which its instances
+  // were created in.
+  std::optional<EnvironmentKey> pool_environment_;
 
   WNDCLASS window_class_ = {};
+  WNDCLASS message_window_class_ = {};
+  HWND message_window_ = nullptr;
   flutter::TextureRegistrar* textures_;
   flutter::BinaryMessenger* messenger_;
 
   bool InitPlatform();
 
+  EnvironmentKey DefaultProfileKey();
+  AsyncWebviewHost& GetEnvironment(const EnvironmentKey& key);
+  void UpdatePoolEnvironmentRef();
+  void ScheduleEnvironmentCollection();
+
+  typedef std::function<void(std::unique_ptr<WebviewBridge>,
+                             std::unique_ptr<WebviewCreationError>)>
+      BridgeCreationCallback;
+  void CreateWebviewBridge(WebviewHost* host, BridgeCreationCallback callback);
   void CreateWebviewInstance(
+      const std::string& profile,
       std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>>);
+  int64_t AddInstance(std::unique_ptr<WebviewBridge> bridge,
+                      const EnvironmentKey& key);
+  void EnforceSuspendPolicy();
+  std::optional<uint64_t> GetMemoryUsage() const;
+  void ScheduleMemoryCheck();
+  void WriteHitchSnapshot();
+  void ScheduleDispose();
+  void SchedulePoolTrim();
+  void SamplePerformance();
+  void SchedulePerformanceSampling();
+  void PublishDeferredFrames();
+  void ScheduleDeferredFrames();
+  void ScheduleTimer(UINT_PTR id,
+                     std::optional<std::chrono::steady_clock::time_point> at);
+
+  static LRESULT CALLBACK MessageWindowProc(HWND hwnd, UINT message,
+                                            WPARAM wparam, LPARAM lparam);
   // Called when a method is called on this plugin's channel from Dart.
   void HandleMethodCall(
       const flutter::MethodCall<flutter::EncodableValue>& method_call,
@@ -94,58 +200,488 @@ void WebviewWindowsPlugin::RegisterWithRegistrar(
 
 WebviewWindowsPlugin::WebviewWindowsPlugin(flutter::TextureRegistrar* textures,
                                            flutter::BinaryMessenger* messenger)
-    : textures_(textures), messenger_(messenger) {
+    : environments_(kDefaultEnvironmentGracePeriod),
+      pool_([this](PrewarmPool<WebviewBridge>::CreatedCallback done) {
+        const auto environment = environments_.Find(DefaultProfileKey());
+        if (!environment || !environment->get()) {
+          return done(nullptr);
+        }
+        CreateWebviewBridge(
+            environment->get(),
+            [this, done](std::unique_ptr<WebviewBridge> bridge,
+                         std::unique_ptr<WebviewCreationError> error) {
+              done(std::move(bridge));
+              SchedulePoolTrim();
+            });
+      }),
+      textures_(textures),
+      messenger_(messenger) {
   window_class_.lpszClassName = L"FlutterWebviewMessage";
   window_class_.lpfnWndProc = &DefWindowProc;
   RegisterClass(&window_class_);
+
+  // Receives the plugin's own timer messages.
+  message_window_class_.lpszClassName = L"FlutterWebviewPluginMessage";
+  message_window_class_.lpfnWndProc = &WebviewWindowsPlugin::MessageWindowProc;
+  RegisterClass(&message_window_class_);
+  message_window_ = CreateWindowEx(
+      0, message_window_class_.lpszClassName, L"", 0, 0, 0, 0, 0,
+      HWND_MESSAGE, nullptr, message_window_class_.hInstance, nullptr);
+  SetWindowLongPtr(message_window_, GWLP_USERDATA,
+                   reinterpret_cast<LONG_PTR>(this));
+
+  // Frames are deferred on rendering threads; retry them on the platform
+  // thread, which owns the timers.
+  frame_scheduler_.SetDeferredFrameCallback([window = message_window_]() {
+    PostMessage(window, kDeferredFrameMessage, 0, 0);
+  });
 }
 
 WebviewWindowsPlugin::~WebviewWindowsPlugin() {
+  dispose_queue_.Flush();
+  util::FlightRecorder::Global().SetHitchHandler(nullptr, {});
+  frame_scheduler_.SetDeferredFrameCallback(nullptr);
+  DestroyWindow(message_window_);
+  pool_.Clear();
   instances_.clear();
+  environments_.Clear();
+  UnregisterClass(message_window_class_.lpszClassName, nullptr);
   UnregisterClass(window_class_.lpszClassName, nullptr);
+  MethodCallRecorder::Global().Stop();
+
+  wchar_t trace_file[MAX_PATH];
+  const auto length = GetEnvironmentVariable(kTraceFileEnvironmentVariable,
+                                             trace_file, MAX_PATH);
+  if (length > 0 && length < MAX_PATH) {
+    std::ofstream out(trace_file, std::ios::binary);
+    out << util::ExportChromeTrace(GetCurrentProcessId());
+  }
+}
+
+// static
+LRESULT CALLBACK WebviewWindowsPlugin::MessageWindowProc(HWND hwnd,
+                                                         UINT message,
+                                                         WPARAM wparam,
+                                                         LPARAM lparam) {
+  auto plugin = reinterpret_cast<WebviewWindowsPlugin*>(
+      GetWindowLongPtr(hwnd, GWLP_USERDATA));
+  if (plugin && message == kHitchSnapshotMessage) {
+    plugin->WriteHitchSnapshot();
+    return 0;
+  }
+  if (plugin && message == kDeferredFrameMessage) {
+    plugin->ScheduleDeferredFrames();
+    return 0;
+  }
+  if (plugin && message == WM_TIMER) {
+    switch (wparam) {
+      case kPoolTrimTimerId:
+        plugin->pool_.Trim(PrewarmPool<WebviewBridge>::Clock::now());
+        plugin->SchedulePoolTrim();
+        return 0;
+      case kEnvironmentCollectionTimerId:
+        plugin->environments_.Collect(std::chrono::steady_clock::now());
+        plugin->ScheduleEnvironmentCollection();
+        return 0;
+      case kMemoryCheckTimerId:
+        plugin->EnforceSuspendPolicy();
+        plugin->ScheduleMemoryCheck();
+        return 0;
+      case kDisposeTimerId:
+        plugin->dispose_queue_.RunSlice(kDisposeSliceBudget);
+        plugin->ScheduleDispose();
+        return 0;
+      case kPerformanceSampleTimerId:
+        plugin->SamplePerformance();
+        plugin->SchedulePerformanceSampling();
+        return 0;
+      case kDeferredFrameTimerId:
+        plugin->PublishDeferredFrames();
+        plugin->ScheduleDeferredFrames();
+        return 0;
+    }
+  }
+  return DefWindowProc(hwnd, message, wparam, lparam);
+}
+
+void WebviewWindowsPlugin::ScheduleTimer(
+    UINT_PTR id, std::optional<std::chrono::steady_clock::time_point> at) {
+  if (!at.has_value()) {
+    KillTimer(message_window_, id);
+    return;
+  }
+
+  const auto delay = std::chrono::duration_cast<std::chrono::milliseconds>(
+                         *at - std::chrono::steady_clock::now())
+                         .count();
+  SetTimer(message_window_, id,
+           static_cast<UINT>(std::max<int64_t>(delay, USER_TIMER_MINIMUM)),
+           nullptr);
+}
+
+void WebviewWindowsPlugin::SchedulePoolTrim() {
+  ScheduleTimer(kPoolTrimTimerId, pool_.NextExpiry());
+}
+
+void WebviewWindowsPlugin::ScheduleEnvironmentCollection() {
+  ScheduleTimer(kEnvironmentCollectionTimerId,
+                environments_.NextCollection());
+}
+
+void WebviewWindowsPlugin::ScheduleDispose() {
+  // WM_TIMER is only delivered when no other messages are pending, so
+  // teardown runs in idle slices.
+  ScheduleTimer(kDisposeTimerId,
+                dispose_queue_.empty()
+                    ? std::nullopt
+                    : std::make_optional(std::chrono::steady_clock::now()));
+}
+
+void WebviewWindowsPlugin::SamplePerformance() {
+  const auto now = std::chrono::steady_clock::now();
+  for (const auto& [texture_id, bridge] : instances_) {
+    bridge->SamplePerformance(now);
+  }
+}
+
+void WebviewWindowsPlugin::SchedulePerformanceSampling() {
+  // One timer serves all instances, so that sampling several of them
+  // doesn't wake the message loop more often than the shortest interval.
+  std::optional<std::chrono::steady_clock::time_point> next;
+  for (const auto& [texture_id, bridge] : instances_) {
+    const auto at = bridge->NextPerformanceSample();
+    if (at.has_value() && (!next.has_value() || *at < *next)) {
+      next = at;
+    }
+  }
+  ScheduleTimer(kPerformanceSampleTimerId, next);
+}
+
+void WebviewWindowsPlugin::PublishDeferredFrames() {
+  for (const auto& [texture_id, bridge] : instances_) {
+    bridge->texture_bridge()->PublishDeferredFrame();
+  }
+}
+
+void WebviewWindowsPlugin::ScheduleDeferredFrames() {
+  ScheduleTimer(kDeferredFrameTimerId, frame_scheduler_.NextDeferredFrameRetry(
+                                           std::chrono::steady_clock::now()));
+}
+
+void WebviewWindowsPlugin::WriteHitchSnapshot() {
+  if (!hitch_snapshot_directory_.has_value()) {
+    return;
+  }
+
+  const auto timestamp =
+      std::chrono::duration_cast<std::chrono::milliseconds>(
+          std::chrono::system_clock::now().time_since_epoch())
+          .count();
+  const auto path =
+      *hitch_snapshot_directory_ /
+      std::format("flight-{}-{}.wvfr", GetCurrentProcessId(), timestamp);
+  std::ofstream out(path, std::ios::binary);
+  out << util::FlightRecorder::Encode(
+      util::FlightRecorder::Global().Snapshot());
+}
+
+void WebviewWindowsPlugin::ScheduleMemoryCheck() {
+  if (!suspend_policy_.budget().max_memory_bytes.has_value() ||
+      instances_.empty()) {
+    return ScheduleTimer(kMemoryCheckTimerId, std::nullopt);
+  }
+  ScheduleTimer(kMemoryCheckTimerId,
+                std::chrono::steady_clock::now() + memory_check_interval_);
+}
+
+std::optional<uint64_t> WebviewWindowsPlugin::GetMemoryUsage() const {
+  std::optional<uint64_t> total;
+  environments_.ForEach(
+      [&total](const EnvironmentKey& key, const AsyncWebviewHost& environment) {
+        if (const auto host = environment.get()) {
+          if (const auto usage = host->GetMemoryUsage()) {
+            total = total.value_or(0) + *usage;
+          }
+        }
+      });
+  return total;
+}
+
+void WebviewWindowsPlugin::EnforceSuspendPolicy() {
+  std::optional<uint64_t> memory_usage;
+  if (suspend_policy_.budget().max_memory_bytes.has_value()) {
+    memory_usage = GetMemoryUsage();
+  }
+
+  for (const auto texture_id : suspend_policy_.Evaluate(memory_usage)) {
+    const auto it = instances_.find(texture_id);
+    if (it != instances_.end()) {
+      it->second->Suspend();
+    }
+  }
+}
+
+int64_t WebviewWindowsPlugin::AddInstance(std::unique_ptr<WebviewBridge> bridge,
+                                          const EnvironmentKey& key) {
+  const auto texture_id = bridge->texture_id();
+
+  // Resume the instance transparently if it has been suspended by the policy.
+  bridge->OnInteraction([this, texture_id]() {
+    if (suspend_policy_.Touch(texture_id, std::chrono::steady_clock::now())) {
+      const auto it = instances_.find(texture_id);
+      if (it != instances_.end()) {
+        it->second->Resume();
+      }
+      EnforceSuspendPolicy();
+    }
+  });
+  bridge->OnPerformanceSamplingChanged(
+      [this]() { SchedulePerformanceSampling(); });
+
+  instances_[texture_id] = std::move(bridge);
+  instance_environments_[texture_id] = key;
+  suspend_policy_.Add(texture_id, std::chrono::steady_clock::now());
+  EnforceSuspendPolicy();
+  ScheduleMemoryCheck();
+  return texture_id;
 }
 
 void WebviewWindowsPlugin::HandleMethodCall(
     const flutter::MethodCall<flutter::EncodableValue>& method_call,
     std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
   if (method_call.method_name().compare(kMethodInitializeEnvironment) == 0) {
-    if (webview_host_) {
-      return result->Error(kErrorCodeEnvironmentAlreadyInitialized,
-                           "The webview environment is already initialized");
-    }
-
     if (!InitPlatform()) {
       return result->Error(kErrorUnsupportedPlatform,
                            "The platform is not supported");
     }
 
     const auto& map = std::get<flutter::EncodableMap>(*method_call.arguments());
+    const auto profile =
+        GetOptionalValue<std::string>(map, "profile").value_or("");
+
+    const auto existing = profiles_.find(profile);
+    if (existing != profiles_.end()) {
+      const auto environment = environments_.Find(existing->second);
+      if (environment &&
+          (environment->state() == AsyncWebviewHost::State::kCreating ||
+           environment->state() == AsyncWebviewHost::State::kReady)) {
+        return result->Error(kErrorCodeEnvironmentAlreadyInitialized,
+                             "The webview environment is already initialized");
+      }
+    }
 
-    std::optional<std::wstring> browser_exe_wpath = std::nullopt;
-    std::optional<std::string> browser_exe_path =
-        GetOptionalValue<std::string>(map, "browserExePath");
-    if (browser_exe_path) {
-      browser_exe_wpath = util::Utf16FromUtf8(*browser_exe_path);
+    EnvironmentKey key;
+    if (const auto browser_exe_path =
+            GetOptionalValue<std::string>(map, "browserExePath")) {
+      key.browser_exe_path = util::Utf16FromUtf8(*browser_exe_path);
     }
 
-    std::optional<std::wstring> user_data_wpath = std::nullopt;
-    std::optional<std::string> user_data_path =
-        GetOptionalValue<std::string>(map, "userDataPath");
-    if (user_data_path) {
-      user_data_wpath = util::Utf16FromUtf8(*user_data_path);
+    if (const auto user_data_path =
+            GetOptionalValue<std::string>(map, "userDataPath")) {
+      key.user_data_directory = util::Utf16FromUtf8(*user_data_path);
     } else {
-      user_data_wpath = platform_->GetDefaultDataDirectory();
+      key.user_data_directory =
+          platform_->GetDefaultDataDirectory().value_or(L"");
+    }
+
+    key.arguments =
+        GetOptionalValue<std::string>(map, "additionalArguments").value_or("");
+
+    profiles_[profile] = key;
+
+    // Keep the environment referenced until it has settled so that it isn't
+    // collected while Dart is waiting for it.
+    auto& environment = GetEnvironment(key);
+    environments_.AddRef(key);
+    if (profile.empty()) {
+      UpdatePoolEnvironmentRef();
+    }
+
+    // Replies once the environment is ready; the platform thread is not
+    // blocked in the meantime.
+    std::shared_ptr<flutter::MethodResult<flutter::EncodableValue>>
+        shared_result = std::move(result);
+    environment.Await([shared_result, key, this](
+                          WebviewHost* host,
+                          const WebviewCreationError* error) {
+      environments_.Release(key, std::chrono::steady_clock::now());
+      ScheduleEnvironmentCollection();
+      if (!host) {
+        return ReplyEnvironmentCreationError(*shared_result, error);
+      }
+      shared_result->Success();
+    });
+    return;
+  }
+
+  // setEnvironmentGracePeriod: int milliseconds
+  if (method_call.method_name().compare(kMethodSetEnvironmentGracePeriod) ==
+      0) {
+    const auto grace_period = std::get_if<int32_t>(method_call.arguments());
+    if (!grace_period || *grace_period < 0) {
+      return result->Error(kErrorInvalidArgs);
+    }
+    environments_.SetGracePeriod(std::chrono::milliseconds(*grace_period));
+    ScheduleEnvironmentCollection();
+    return result->Success();
+  }
+
+  // setFrameBudget: {"maxFps": int?, "maxCopyBytesPerSecond": int?}
+  if (method_call.method_name().compare(kMethodSetFrameBudget) == 0) {
+    const auto map =
+        std::get_if<flutter::EncodableMap>(method_call.arguments());
+    if (!map) {
+      return result->Error(kErrorInvalidArgs);
+    }
+
+    FrameScheduler::Budget budget;
+    if (const auto max_fps = GetOptionalValue<int32_t>(*map, "maxFps")) {
+      if (*max_fps <= 0) {
+        return result->Error(kErrorInvalidArgs);
+      }
+      budget.frames_per_second = *max_fps;
+    }
+    if (const auto bytes = GetOptionalInteger(*map, "maxCopyBytesPerSecond")) {
+      budget.copy_bytes_per_second = static_cast<double>(*bytes);
+    }
+    if (budget.copy_bytes_per_second.value_or(1.0) <= 0.0) {
+      return result->Error(kErrorInvalidArgs);
+    }
+
+    frame_scheduler_.SetBudget(budget);
+    return result->Success();
+  }
+
+  // setSuspendPolicy:
+  // {"maxActiveWebviews": int?, "maxMemoryBytes": int?,
+  //  "memoryCheckIntervalMs": int?}
+  if (method_call.method_name().compare(kMethodSetSuspendPolicy) == 0) {
+    const auto map =
+        std::get_if<flutter::EncodableMap>(method_call.arguments());
+    if (!map) {
+      return result->Error(kErrorInvalidArgs);
+    }
+
+    SuspendPolicy::Budget budget;
+    if (const auto max_active =
+            GetOptionalValue<int32_t>(*map, "maxActiveWebviews")) {
+      if (*max_active < 1) {
+        return result->Error(kErrorInvalidArgs);
+      }
+      budget.max_active = static_cast<size_t>(*max_active);
     }
+    if (const auto bytes = GetOptionalInteger(*map, "maxMemoryBytes")) {
+      if (*bytes < 0) {
+        return result->Error(kErrorInvalidArgs);
+      }
+      budget.max_memory_bytes = static_cast<uint64_t>(*bytes);
+    }
+    std::chrono::steady_clock::duration interval = kDefaultMemoryCheckInterval;
+    if (const auto interval_ms =
+            GetOptionalInteger(*map, "memoryCheckIntervalMs")) {
+      // A non-positive interval would check the memory on every timer tick.
+      if (*interval_ms <= 0) {
+        return result->Error(kErrorInvalidArgs);
+      }
+      interval = std::chrono::milliseconds(*interval_ms);
+    }
+
+    memory_check_interval_ = interval;
+    suspend_policy_.SetBudget(budget);
+    EnforceSuspendPolicy();
+    ScheduleMemoryCheck();
+    return result->Success();
+  }
+
+  if (method_call.method_name().compare(kMethodSnapshotFlightRecorder) == 0) {
+    const auto data = util::FlightRecorder::Encode(
+        util::FlightRecorder::Global().Snapshot());
+    return result->Success(flutter::EncodableValue(
+        std::vector<uint8_t>(data.begin(), data.end())));
+  }
 
-    std::optional<std::string> additional_args =
-        GetOptionalValue<std::string>(map, "additionalArguments");
+  // setFlightRecorderOptions: {"hitchSnapshotDirectory": string?}
+  if (method_call.method_name().compare(kMethodSetFlightRecorderOptions) ==
+      0) {
+    const auto map =
+        std::get_if<flutter::EncodableMap>(method_call.arguments());
+    if (!map) {
+      return result->Error(kErrorInvalidArgs);
+    }
 
-    webview_host_ = std::move(WebviewHost::Create(
-        platform_.get(), user_data_wpath, browser_exe_wpath, additional_args));
-    if (!webview_host_) {
-      return result->Error(kErrorCodeEnvironmentCreationFailed);
+    const auto directory =
+        GetOptionalValue<std::string>(*map, "hitchSnapshotDirectory");
+    if (!directory) {
+      hitch_snapshot_directory_.reset();
+      util::FlightRecorder::Global().SetHitchHandler(nullptr, {});
+      return result->Success();
     }
 
+    hitch_snapshot_directory_ =
+        std::filesystem::path(util::Utf16FromUtf8(*directory));
+    // Hitches are reported on rendering threads; write the snapshot on the
+    // platform thread instead.
+    util::FlightRecorder::Global().SetHitchHandler(
+        [window = message_window_]() {
+          PostMessage(window, kHitchSnapshotMessage, 0, 0);
+        },
+        kMinHitchSnapshotInterval);
+    return result->Success();
+  }
+
+  // startMethodCallRecording: string path
+  if (method_call.method_name().compare(kMethodStartMethodCallRecording) ==
+      0) {
+    const auto path = std::get_if<std::string>(method_call.arguments());
+    if (!path) {
+      return result->Error(kErrorInvalidArgs);
+    }
+    if (!MethodCallRecorder::Global().Start(
+            std::filesystem::path(util::Utf16FromUtf8(*path)))) {
+      return result->Error(kErrorInvalidArgs, "Opening the file failed.");
+    }
+    return result->Success();
+  }
+
+  if (method_call.method_name().compare(kMethodStopMethodCallRecording) ==
+      0) {
+    MethodCallRecorder::Global().Stop();
+    return result->Success();
+  }
+
+  if (method_call.method_name().compare(kMethodExportTrace) == 0) {
+    return result->Success(flutter::EncodableValue(
+        util::ExportChromeTrace(GetCurrentProcessId())));
+  }
+
+  // setPrewarmPoolOptions: {"size": int, "idleTimeoutMs": int?}
+  if (method_call.method_name().compare(kMethodSetPrewarmPoolOptions) == 0) {
+    // The pool is bound to the default profile, whose key depends on the
+    // platform.
+    if (!InitPlatform()) {
+      return result->Error(kErrorUnsupportedPlatform,
+                           "The platform is not supported");
+    }
+
+    const auto map =
+        std::get_if<flutter::EncodableMap>(method_call.arguments());
+    if (!map) {
+      return result->Error(kErrorInvalidArgs);
+    }
+
+    const auto size = GetOptionalValue<int32_t>(*map, "size");
+    if (!size || *size < 0) {
+      return result->Error(kErrorInvalidArgs);
+    }
+
+    std::optional<PrewarmPool<WebviewBridge>::Clock::duration> idle_timeout;
+    if (const auto timeout = GetOptionalValue<int32_t>(*map, "idleTimeoutMs")) {
+      idle_timeout = std::chrono::milliseconds(*timeout);
+    }
+
+    pool_.SetLimits(static_cast<size_t>(*size), idle_timeout);
+    UpdatePoolEnvironmentRef();
+    SchedulePoolTrim();
     return result->Success();
   }
 
@@ -161,15 +697,48 @@ void WebviewWindowsPlugin::HandleMethodCall(
     }
   }
 
+  // initialize: {"profile": string?}
   if (method_call.method_name().compare(kMethodInitialize) == 0) {
-    return CreateWebviewInstance(std::move(result));
+    std::string profile;
+    if (const auto map =
+            std::get_if<flutter::EncodableMap>(method_call.arguments())) {
+      profile = GetOptionalValue<std::string>(*map, "profile").value_or("");
+    }
+    return CreateWebviewInstance(profile, std::move(result));
   }
 
   if (method_call.method_name().compare(kMethodDispose) == 0) {
     if (const auto texture_id = std::get_if<int64_t>(method_call.arguments())) {
       const auto it = instances_.find(*texture_id);
       if (it != instances_.end()) {
+        std::shared_ptr<WebviewBridge> bridge = std::move(it->second);
         instances_.erase(it);
+        suspend_policy_.Remove(*texture_id);
+        ScheduleMemoryCheck();
+        SchedulePerformanceSampling();
+
+        // Dart is acknowledged right away; the instance is torn down over
+        // the next idle slices.
+        bridge->Detach();
+        std::vector<StagedDisposeQueue::Stage> stages = {
+            [bridge]() { bridge->texture_bridge()->Stop(); },
+            [bridge]() { bridge->UnregisterTexture(); },
+            // Destroys the webview and its window.
+            [bridge]() mutable { bridge.reset(); },
+        };
+
+        // The environment has to outlive its webviews.
+        const auto environment = instance_environments_.find(*texture_id);
+        if (environment != instance_environments_.end()) {
+          stages.push_back([this, key = environment->second]() {
+            environments_.Release(key, std::chrono::steady_clock::now());
+            ScheduleEnvironmentCollection();
+          });
+          instance_environments_.erase(environment);
+        }
+
+        dispose_queue_.Enqueue(std::move(stages));
+        ScheduleDispose();
         return result->Success();
       }
     }
@@ -179,60 +748,187 @@ void WebviewWindowsPlugin::HandleMethodCall(
   }
 }
 
+EnvironmentKey WebviewWindowsPlugin::DefaultProfileKey() {
+  const auto it = profiles_.find("");
+  if (it != profiles_.end()) {
+    return it->second;
+  }
+  return {platform_->GetDefaultDataDirectory().value_or(L""), L"", ""};
+}
+
+AsyncWebviewHost& WebviewWindowsPlugin::GetEnvironment(
+    const EnvironmentKey& key) {
+  auto& environment = environments_.GetOrCreate(
+      key, [] { return std::make_unique<AsyncWebviewHost>(); },
+      std::chrono::steady_clock::now());
+
+  const auto started = environment.Start(
+      [this, key](AsyncWebviewHost::CompletionCallback done) {
+        auto optional = [](const auto& value) {
+          return value.empty() ? std::nullopt : std::make_optional(value);
+        };
+        WebviewHost::Create(platform_.get(),
+                            optional(key.user_data_directory),
+                            optional(key.browser_exe_path),
+                            optional(key.arguments), std::move(done));
+      });
+
+  if (started && key == DefaultProfileKey()) {
+    // Start prewarming as soon as the environment is available.
+    environment.Await(
+        [this](WebviewHost* host, const WebviewCreationError* error) {
+          if (host) {
+            pool_.Refill();
+          }
+        });
+    UpdatePoolEnvironmentRef();
+  }
+  ScheduleEnvironmentCollection();
+  return environment;
+}
+
+void WebviewWindowsPlugin::UpdatePoolEnvironmentRef() {
+  // The default environment stays alive as long as prewarming is enabled.
+  const auto key = DefaultProfileKey();
+  const auto wants_ref = pool_.size() > 0;
+  if (pool_environment_.has_value() &&
+      (!wants_ref || !(*pool_environment_ == key))) {
+    if (!(*pool_environment_ == key)) {
+      // The default profile moved to another environment. Instances of the
+      // old one must not be handed out for it.
+      pool_.Drain();
+    }
+    environments_.Release(*pool_environment_,
+                          std::chrono::steady_clock::now());
+    pool_environment_.reset();
+    ScheduleEnvironmentCollection();
+  }
+  if (wants_ref && !pool_environment_.has_value() &&
+      environments_.AddRef(key)) {
+    pool_environment_ = key;
+  }
+
+  const auto environment = environments_.Find(key);
+  if (environment && environment->get()) {
+    pool_.Refill();
+  }
+}
+
+void WebviewWindowsPlugin::CreateWebviewBridge(
+    WebviewHost* host, BridgeCreationCallback callback) {
+  auto hwnd =
+      CreateWindowEx(0, window_class_.lpszClassName, L"", 0, 0, 0, 0, 0,
+                     HWND_MESSAGE, nullptr, window_class_.hInstance, nullptr);
+  if (!hwnd) {
+    return callback(nullptr,
+                    WebviewCreationError::create(
+                        HRESULT_FROM_WIN32(GetLastError()),
+                        "Failed to create the webview's message window."));
+  }
+
+  host->CreateWebview(
+      hwnd, true, true,
+      [callback, hwnd, this](std::unique_ptr<Webview> webview,
+                             std::unique_ptr<WebviewCreationError> error) {
+        if (!webview) {
+          // The webview owns the window only once it has been created.
+          DestroyWindow(hwnd);
+          return callback(nullptr, std::move(error));
+        }
+
+        callback(std::make_unique<WebviewBridge>(
+                     messenger_, textures_, platform_->graphics_context(),
+                     &frame_scheduler_, std::move(webview)),
+                 nullptr);
+      });
+}
+
 void WebviewWindowsPlugin::CreateWebviewInstance(
+    const std::string& profile,
     std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
   if (!InitPlatform()) {
     return result->Error(kErrorUnsupportedPlatform,
                          "The platform is not supported");
   }
 
-  if (!webview_host_) {
-    webview_host_ = std::move(WebviewHost::Create(
-        platform_.get(), platform_->GetDefaultDataDirectory()));
-    if (!webview_host_) {
-      return result->Error(kErrorCodeEnvironmentCreationFailed);
-    }
+  if (!profile.empty() && profiles_.find(profile) == profiles_.end()) {
+    return result->Error(kErrorCodeInvalidProfile,
+                         std::format("Unknown profile: {}", profile));
   }
 
-  auto hwnd =
-      CreateWindowEx(0, window_class_.lpszClassName, L"", 0, 0, 0, 0, 0,
-                     HWND_MESSAGE, nullptr, window_class_.hInstance, nullptr);
+  if (profile.empty() && profiles_.find(profile) == profiles_.end()) {
+    profiles_[profile] = DefaultProfileKey();
+  }
+
+  const auto key = profiles_[profile];
+  auto& environment = GetEnvironment(key);
 
+  // The reference is handed over to the instance or dropped on failure.
+  environments_.AddRef(key);
+
+  // Queued until the environment is ready.
   std::shared_ptr<flutter::MethodResult<flutter::EncodableValue>>
       shared_result = std::move(result);
-  webview_host_->CreateWebview(
-      hwnd, true, true,
-      [shared_result, this](std::unique_ptr<Webview> webview,
-                            std::unique_ptr<WebviewCreationError> error) {
-        if (!webview) {
-          if (error) {
-            return shared_result->Error(
-                kErrorCodeWebviewCreationFailed,
-                std::format(
-                    "Creating the webview failed: {} (HRESULT: {:#010x})",
-                    error->message, error->hr));
+  environment.Await([shared_result, key, this](
+                        WebviewHost* host, const WebviewCreationError* error) {
+    if (!host) {
+      environments_.Release(key, std::chrono::steady_clock::now());
+      ScheduleEnvironmentCollection();
+      return ReplyEnvironmentCreationError(*shared_result, error);
+    }
+
+    // Hand out a prewarmed instance if there is one.
+    if (key == DefaultProfileKey()) {
+      if (auto bridge = pool_.Take()) {
+        const auto texture_id = AddInstance(std::move(bridge), key);
+        pool_.Refill();
+        SchedulePoolTrim();
+
+        return shared_result->Success(
+            flutter::EncodableValue(flutter::EncodableMap{
+                {flutter::EncodableValue("textureId"),
+                 flutter::EncodableValue(texture_id)},
+            }));
+      }
+    }
+
+    CreateWebviewBridge(
+        host,
+        [shared_result, key, this](
+            std::unique_ptr<WebviewBridge> bridge,
+            std::unique_ptr<WebviewCreationError> error) {
+          if (!bridge) {
+            environments_.Release(key, std::chrono::steady_clock::now());
+            ScheduleEnvironmentCollection();
+            if (error) {
+              return shared_result->Error(
+                  kErrorCodeWebviewCreationFailed,
+                  std::format(
+                      "Creating the webview failed: {} (HRESULT: {:#010x})",
+                      error->message, error->hr));
+            }
+            return shared_result->Error(kErrorCodeWebviewCreationFailed,
+                                        "Creating the webview failed.");
           }
-          return shared_result->Error(kErrorCodeWebviewCreationFailed,
-                                      "Creating the webview failed.");
-        }
 
-        auto bridge = std::make_unique<WebviewBridge>(
-            messenger_, textures_, platform_->graphics_context(),
-            std::move(webview));
-        auto texture_id = bridge->texture_id();
-        instances_[texture_id] = std::move(bridge);
+          const auto texture_id = AddInstance(std::move(bridge), key);
 
-        auto response = flutter::EncodableValue(flutter::EncodableMap{
-            {flutter::EncodableValue("textureId"),
-             flutter::EncodableValue(texture_id)},
-        });
+          auto response = flutter::EncodableValue(flutter::EncodableMap{
+              {flutter::EncodableValue("textureId"),
+               flutter::EncodableValue(texture_id)},
+          });
 
-        shared_result->Success(response);
-      });
+          shared_result->Success(response);
+          if (key == DefaultProfileKey()) {
+            pool_.Refill();
+          }
+        });
+  });
 }
 
 bool WebviewWindowsPlugin::InitPlatform() {
   if (!platform_) {
+    util::ScopedTraceSpan span("WebviewWindowsPlugin::InitPlatform");
     platform_ = std::make_unique<WebviewPlatform>();
   }
   return platform_->IsSupported();